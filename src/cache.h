@@ -34,6 +34,51 @@
 #define C2_CACHE_SIZE (NUM_VEC_PROC * VEC_SIZE * 6) + (NUM_VEC_PROC * VEC_SIZE)
 
 #ifdef WITH_VECTORIZATION
+
+#ifdef HYDRO_CACHE_FIELDS
+
+/* Expansions of the HYDRO_CACHE_FIELDS() list of the hydro scheme (see its
+ * hydro_part.h) generating the arrays of the #cache, their allocation and the
+ * gathering and padding of the particle data. The _J versions act on the
+ * arrays of a second cache, whose local names are suffixed with a j. */
+#define CACHE_FIELD_DECLARE(name, field) float *restrict name SWIFT_CACHE_ALIGN;
+#define CACHE_FIELD_ALLOC(name, field) \
+  error += posix_memalign((void **)&c->name, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+#define CACHE_FIELD_FREE(name, field) free(c->name);
+#define CACHE_FIELD_POINTER(name, field) \
+  swift_declare_aligned_ptr(float, name, ci_cache->name, SWIFT_CACHE_ALIGNMENT);
+#define CACHE_FIELD_POINTER_J(name, field)                  \
+  swift_declare_aligned_ptr(float, name##j, cj_cache->name, \
+                            SWIFT_CACHE_ALIGNMENT);
+#define CACHE_FIELD_READ(name, field) name[i] = p->field;
+#define CACHE_FIELD_READ_J(name, field) name##j[i] = p->field;
+#define CACHE_FIELD_PAD(name, field) name[i] = 1.f;
+#define CACHE_FIELD_PAD_J(name, field) name##j[i] = 1.f;
+
+/* Same for the HYDRO_CACHE_HALF_FIELDS() list, whose arrays are stored as
+ * #half_float. */
+#ifndef HYDRO_CACHE_HALF_FIELDS
+#define HYDRO_CACHE_HALF_FIELDS(FIELD)
+#endif
+#define CACHE_HALF_FIELD_DECLARE(name, field) \
+  half_float *restrict name SWIFT_CACHE_ALIGN;
+#define CACHE_HALF_FIELD_ALLOC(name, field)                       \
+  error += posix_memalign((void **)&c->name, SWIFT_CACHE_ALIGNMENT, \
+                          sizeHalfBytes);
+#define CACHE_HALF_FIELD_POINTER(name, field)                 \
+  swift_declare_aligned_ptr(half_float, name, ci_cache->name, \
+                            SWIFT_CACHE_ALIGNMENT);
+#define CACHE_HALF_FIELD_POINTER_J(name, field)                    \
+  swift_declare_aligned_ptr(half_float, name##j, cj_cache->name, \
+                            SWIFT_CACHE_ALIGNMENT);
+#define CACHE_HALF_FIELD_READ(name, field) name[i] = half_float_pack(p->field);
+#define CACHE_HALF_FIELD_READ_J(name, field) \
+  name##j[i] = half_float_pack(p->field);
+#define CACHE_HALF_FIELD_PAD(name, field) name[i] = half_float_pack(1.f);
+#define CACHE_HALF_FIELD_PAD_J(name, field) name##j[i] = half_float_pack(1.f);
+
+#endif /* HYDRO_CACHE_FIELDS */
+
 /* Cache struct to hold a local copy of a cells' particle
  * properties required for density/force calculations.*/
 struct cache {
@@ -65,20 +110,13 @@ struct cache {
   /* Maximum index into neighbouring cell for particles that are in range. */
   int *restrict max_index SWIFT_CACHE_ALIGN;
 
-  /* Particle density. */
-  float *restrict rho SWIFT_CACHE_ALIGN;
-
-  /* Particle smoothing length gradient. */
-  float *restrict grad_h SWIFT_CACHE_ALIGN;
+#ifdef HYDRO_CACHE_FIELDS
+  /* Particle properties specific to the hydro scheme. */
+  HYDRO_CACHE_FIELDS(CACHE_FIELD_DECLARE)
 
-  /* Pressure over density squared. */
-  float *restrict pOrho2 SWIFT_CACHE_ALIGN;
-
-  /* Balsara switch. */
-  float *restrict balsara SWIFT_CACHE_ALIGN;
-
-  /* Particle sound speed. */
-  float *restrict soundspeed SWIFT_CACHE_ALIGN;
+  /* And the ones kept at half precision. */
+  HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_DECLARE)
+#endif
 
   /* Cache size. */
   int count;
@@ -128,6 +166,9 @@ __attribute__((always_inline)) INLINE void cache_init(struct cache *c,
   if (rem > 0) pad += VEC_SIZE - rem;
   size_t sizeBytes = (count + pad) * sizeof(float);
   size_t sizeIntBytes = (count + pad) * sizeof(int);
+#ifdef HYDRO_CACHE_FIELDS
+  size_t sizeHalfBytes = (count + pad) * sizeof(half_float);
+#endif
   int error = 0;
 
   /* Free memory if cache has already been allocated. */
@@ -141,11 +182,10 @@ __attribute__((always_inline)) INLINE void cache_init(struct cache *c,
     free(c->vz);
     free(c->h);
     free(c->max_index);
-    free(c->rho);
-    free(c->grad_h);
-    free(c->pOrho2);
-    free(c->balsara);
-    free(c->soundspeed);
+#ifdef HYDRO_CACHE_FIELDS
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_FREE)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_FIELD_FREE)
+#endif
   }
 
   error += posix_memalign((void **)&c->x, SWIFT_CACHE_ALIGNMENT, sizeBytes);
@@ -158,15 +198,10 @@ __attribute__((always_inline)) INLINE void cache_init(struct cache *c,
   error += posix_memalign((void **)&c->h, SWIFT_CACHE_ALIGNMENT, sizeBytes);
   error += posix_memalign((void **)&c->max_index, SWIFT_CACHE_ALIGNMENT,
                           sizeIntBytes);
-  error += posix_memalign((void **)&c->rho, SWIFT_CACHE_ALIGNMENT, sizeBytes);
-  error +=
-      posix_memalign((void **)&c->grad_h, SWIFT_CACHE_ALIGNMENT, sizeBytes);
-  error +=
-      posix_memalign((void **)&c->pOrho2, SWIFT_CACHE_ALIGNMENT, sizeBytes);
-  error +=
-      posix_memalign((void **)&c->balsara, SWIFT_CACHE_ALIGNMENT, sizeBytes);
-  error +=
-      posix_memalign((void **)&c->soundspeed, SWIFT_CACHE_ALIGNMENT, sizeBytes);
+#ifdef HYDRO_CACHE_FIELDS
+  HYDRO_CACHE_FIELDS(CACHE_FIELD_ALLOC)
+  HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_ALLOC)
+#endif
 
   if (error != 0)
     error("Couldn't allocate cache, no. of particles: %d", (int)count);
@@ -184,7 +219,7 @@ __attribute__((always_inline)) INLINE int cache_read_particles(
     const struct cell *restrict const ci,
     struct cache *restrict const ci_cache) {
 
-#if defined(GADGET2_SPH)
+#ifdef HYDRO_CACHE_FIELDS
 
   /* Let the compiler know that the data is aligned and create pointers to the
    * arrays inside the cache. */
@@ -265,7 +300,7 @@ __attribute__((always_inline)) INLINE int cache_read_particles_subset_self(
     const struct cell *restrict const ci,
     struct cache *restrict const ci_cache) {
 
-#if defined(GADGET2_SPH)
+#ifdef HYDRO_CACHE_FIELDS
 
   /* Let the compiler know that the data is aligned and create pointers to the
    * arrays inside the cache. */
@@ -343,12 +378,13 @@ __attribute__((always_inline)) INLINE int cache_read_particles_subset_self(
  * @param loc The cell location to remove from the particle positions.
  * @param flipped Flag to check whether the cells have been flipped or not.
  */
-__attribute__((always_inline)) INLINE void cache_read_particles_subset_pair(
+__attribute__((always_inline)) INLINE static void
+cache_read_particles_subset_pair(
     const struct cell *restrict const ci, struct cache *restrict const ci_cache,
     const struct sort_entry *restrict sort_i, int *first_pi, int *last_pi,
     const double *loc, const int flipped) {
 
-#if defined(GADGET2_SPH)
+#ifdef HYDRO_CACHE_FIELDS
 
   /* Let the compiler know that the data is aligned and create pointers to the
    * arrays inside the cache. */
@@ -381,7 +417,7 @@ __attribute__((always_inline)) INLINE void cache_read_particles_subset_pair(
     /* Shift the particles positions to a local frame so single precision can be
      * used instead of double precision. */
     for (int i = 0; i < *last_pi; i++) {
-      const int idx = sort_i[i].i;
+      const int idx = sort_get_i(sort_i, i);
 
       /* Put inhibited particles out of range. */
       if (parts[idx].time_bin >= time_bin_inhibited) {
@@ -439,7 +475,7 @@ __attribute__((always_inline)) INLINE void cache_read_particles_subset_pair(
     /* Shift the particles positions to a local frame so single precision can be
      * used instead of double precision. */
     for (int i = 0; i < ci_cache_count; i++) {
-      const int idx = sort_i[i + *first_pi].i;
+      const int idx = sort_get_i(sort_i, i + *first_pi);
 
       /* Put inhibited particles out of range. */
       if (parts[idx].time_bin >= time_bin_inhibited) {
@@ -491,11 +527,11 @@ __attribute__((always_inline)) INLINE void cache_read_particles_subset_pair(
  * @param ci_cache The cache.
  * @return uninhibited_count The no. of uninhibited particles.
  */
-__attribute__((always_inline)) INLINE int cache_read_force_particles(
+__attribute__((always_inline)) INLINE static int cache_read_force_particles(
     const struct cell *restrict const ci,
     struct cache *restrict const ci_cache) {
 
-#if defined(GADGET2_SPH)
+#ifdef HYDRO_CACHE_FIELDS
 
   /* Let the compiler know that the data is aligned and create pointers to the
    * arrays inside the cache. */
@@ -507,15 +543,8 @@ __attribute__((always_inline)) INLINE int cache_read_force_particles(
   swift_declare_aligned_ptr(float, vx, ci_cache->vx, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vy, ci_cache->vy, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vz, ci_cache->vz, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, rho, ci_cache->rho, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, grad_h, ci_cache->grad_h,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, pOrho2, ci_cache->pOrho2,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, balsara, ci_cache->balsara,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, soundspeed, ci_cache->soundspeed,
-                            SWIFT_CACHE_ALIGNMENT);
+  HYDRO_CACHE_FIELDS(CACHE_FIELD_POINTER)
+  HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_POINTER)
 
   const int count = ci->hydro.count;
   const struct part *restrict parts = ci->hydro.parts;
@@ -530,34 +559,31 @@ __attribute__((always_inline)) INLINE int cache_read_force_particles(
    * used instead of double precision. */
   for (int i = 0; i < count; i++) {
 
+    const struct part *restrict p = &parts[i];
+
     /* Skip inhibited particles. */
-    if (parts[i].time_bin >= time_bin_inhibited) {
+    if (p->time_bin >= time_bin_inhibited) {
       x[i] = pos_padded[0];
       y[i] = pos_padded[1];
       z[i] = pos_padded[2];
       h[i] = h_padded;
-      rho[i] = 1.f;
-      grad_h[i] = 1.f;
-      pOrho2[i] = 1.f;
-      balsara[i] = 1.f;
-      soundspeed[i] = 1.f;
+      m[i] = 1.f;
+      HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD)
+      HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD)
 
       continue;
     }
 
-    x[i] = (float)(parts[i].x[0] - loc[0]);
-    y[i] = (float)(parts[i].x[1] - loc[1]);
-    z[i] = (float)(parts[i].x[2] - loc[2]);
-    h[i] = parts[i].h;
-    m[i] = parts[i].mass;
-    vx[i] = parts[i].v[0];
-    vy[i] = parts[i].v[1];
-    vz[i] = parts[i].v[2];
-    rho[i] = parts[i].rho;
-    grad_h[i] = parts[i].force.f;
-    pOrho2[i] = parts[i].force.P_over_rho2;
-    balsara[i] = parts[i].force.balsara;
-    soundspeed[i] = parts[i].force.soundspeed;
+    x[i] = (float)(p->x[0] - loc[0]);
+    y[i] = (float)(p->x[1] - loc[1]);
+    z[i] = (float)(p->x[2] - loc[2]);
+    h[i] = p->h;
+    m[i] = p->mass;
+    vx[i] = p->v[0];
+    vy[i] = p->v[1];
+    vz[i] = p->v[2];
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_READ)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_READ)
   }
 
   /* Pad cache if there is a serial remainder. */
@@ -573,11 +599,9 @@ __attribute__((always_inline)) INLINE int cache_read_force_particles(
       y[i] = pos_padded[1];
       z[i] = pos_padded[2];
       h[i] = h_padded;
-      rho[i] = 1.f;
-      grad_h[i] = 1.f;
-      pOrho2[i] = 1.f;
-      balsara[i] = 1.f;
-      soundspeed[i] = 1.f;
+      m[i] = 1.f;
+      HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD)
+      HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD)
     }
   }
 
@@ -604,7 +628,8 @@ __attribute__((always_inline)) INLINE int cache_read_force_particles(
  * @param first_pi The first particle in cell ci that is in range.
  * @param last_pj The last particle in cell cj that is in range.
  */
-__attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
+__attribute__((always_inline)) INLINE static void
+cache_read_two_partial_cells_sorted(
     const struct cell *restrict const ci, const struct cell *restrict const cj,
     struct cache *restrict const ci_cache,
     struct cache *restrict const cj_cache,
@@ -665,7 +690,7 @@ __attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
   /* Shift the particles positions to a local frame (ci frame) so single
    * precision can be used instead of double precision.  */
   for (int i = 0; i < ci_cache_count; i++) {
-    const int idx = sort_i[i + first_pi_align].i;
+    const int idx = sort_get_i(sort_i, i + first_pi_align);
 
     /* Put inhibited particles out of range. */
     if (parts_i[idx].time_bin >= time_bin_inhibited) {
@@ -689,7 +714,7 @@ __attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
     vx[i] = parts_i[idx].v[0];
     vy[i] = parts_i[idx].v[1];
     vz[i] = parts_i[idx].v[2];
-#ifdef GADGET2_SPH
+#ifdef HYDRO_CACHE_FIELDS
     m[i] = parts_i[idx].mass;
 #endif
   }
@@ -767,7 +792,7 @@ __attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
   const float h_padded_j = cj->hydro.h_max / 4.;
 
   for (int i = 0; i <= last_pj_align; i++) {
-    const int idx = sort_j[i].i;
+    const int idx = sort_get_i(sort_j, i);
 
     /* Put inhibited particles out of range. */
     if (parts_j[idx].time_bin >= time_bin_inhibited) {
@@ -791,7 +816,7 @@ __attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
     vxj[i] = parts_j[idx].v[0];
     vyj[i] = parts_j[idx].v[1];
     vzj[i] = parts_j[idx].v[2];
-#ifdef GADGET2_SPH
+#ifdef HYDRO_CACHE_FIELDS
     mj[i] = parts_j[idx].mass;
 #endif
   }
@@ -856,7 +881,7 @@ __attribute__((always_inline)) INLINE void cache_read_two_partial_cells_sorted(
  * @param first_pi The first particle in cell ci that is in range.
  * @param last_pj The last particle in cell cj that is in range.
  */
-__attribute__((always_inline)) INLINE void
+__attribute__((always_inline)) INLINE static void
 cache_read_two_partial_cells_sorted_force(
     const struct cell *const ci, const struct cell *const cj,
     struct cache *const ci_cache, struct cache *const cj_cache,
@@ -885,6 +910,8 @@ cache_read_two_partial_cells_sorted_force(
     if (*last_pj + pad < cj->hydro.count) *last_pj += pad;
   }
 
+#ifdef HYDRO_CACHE_FIELDS
+
   /* Get some local pointers */
   const int first_pi_align = *first_pi;
   const int last_pj_align = *last_pj;
@@ -906,15 +933,8 @@ cache_read_two_partial_cells_sorted_force(
   swift_declare_aligned_ptr(float, vx, ci_cache->vx, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vy, ci_cache->vy, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vz, ci_cache->vz, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, rho, ci_cache->rho, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, grad_h, ci_cache->grad_h,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, pOrho2, ci_cache->pOrho2,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, balsara, ci_cache->balsara,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, soundspeed, ci_cache->soundspeed,
-                            SWIFT_CACHE_ALIGNMENT);
+  HYDRO_CACHE_FIELDS(CACHE_FIELD_POINTER)
+  HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_POINTER)
 
   int ci_cache_count = ci->hydro.count - first_pi_align;
   const double max_dx = max(ci->hydro.dx_max_part, cj->hydro.dx_max_part);
@@ -927,10 +947,11 @@ cache_read_two_partial_cells_sorted_force(
    * precision can be  used instead of double precision.  */
   for (int i = 0; i < ci_cache_count; i++) {
 
-    const int idx = sort_i[i + first_pi_align].i;
+    const struct part *restrict p =
+        &parts_i[sort_get_i(sort_i, i + first_pi_align)];
 
     /* Put inhibited particles out of range. */
-    if (parts_i[idx].time_bin >= time_bin_inhibited) {
+    if (p->time_bin >= time_bin_inhibited) {
       x[i] = pos_padded_i[0];
       y[i] = pos_padded_i[1];
       z[i] = pos_padded_i[2];
@@ -939,30 +960,22 @@ cache_read_two_partial_cells_sorted_force(
       vx[i] = 1.f;
       vy[i] = 1.f;
       vz[i] = 1.f;
-      rho[i] = 1.f;
-      grad_h[i] = 1.f;
-      pOrho2[i] = 1.f;
-      balsara[i] = 1.f;
-      soundspeed[i] = 1.f;
+      HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD)
+      HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD)
 
       continue;
     }
 
-    x[i] = (float)(parts_i[idx].x[0] - total_ci_shift[0]);
-    y[i] = (float)(parts_i[idx].x[1] - total_ci_shift[1]);
-    z[i] = (float)(parts_i[idx].x[2] - total_ci_shift[2]);
-    h[i] = parts_i[idx].h;
-    vx[i] = parts_i[idx].v[0];
-    vy[i] = parts_i[idx].v[1];
-    vz[i] = parts_i[idx].v[2];
-#ifdef GADGET2_SPH
-    m[i] = parts_i[idx].mass;
-    rho[i] = parts_i[idx].rho;
-    grad_h[i] = parts_i[idx].force.f;
-    pOrho2[i] = parts_i[idx].force.P_over_rho2;
-    balsara[i] = parts_i[idx].force.balsara;
-    soundspeed[i] = parts_i[idx].force.soundspeed;
-#endif
+    x[i] = (float)(p->x[0] - total_ci_shift[0]);
+    y[i] = (float)(p->x[1] - total_ci_shift[1]);
+    z[i] = (float)(p->x[2] - total_ci_shift[2]);
+    h[i] = p->h;
+    m[i] = p->mass;
+    vx[i] = p->v[0];
+    vy[i] = p->v[1];
+    vz[i] = p->v[2];
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_READ)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_READ)
   }
 
   /* Pad cache with fake particles that exist outside the cell so will not
@@ -978,11 +991,8 @@ cache_read_two_partial_cells_sorted_force(
     vx[i] = 1.f;
     vy[i] = 1.f;
     vz[i] = 1.f;
-    rho[i] = 1.f;
-    grad_h[i] = 1.f;
-    pOrho2[i] = 1.f;
-    balsara[i] = 1.f;
-    soundspeed[i] = 1.f;
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD)
   }
 
   /* Let the compiler know that the data is aligned and create pointers to the
@@ -995,15 +1005,8 @@ cache_read_two_partial_cells_sorted_force(
   swift_declare_aligned_ptr(float, vxj, cj_cache->vx, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vyj, cj_cache->vy, SWIFT_CACHE_ALIGNMENT);
   swift_declare_aligned_ptr(float, vzj, cj_cache->vz, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, rhoj, cj_cache->rho, SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, grad_hj, cj_cache->grad_h,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, pOrho2j, cj_cache->pOrho2,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, balsaraj, cj_cache->balsara,
-                            SWIFT_CACHE_ALIGNMENT);
-  swift_declare_aligned_ptr(float, soundspeedj, cj_cache->soundspeed,
-                            SWIFT_CACHE_ALIGNMENT);
+  HYDRO_CACHE_FIELDS(CACHE_FIELD_POINTER_J)
+  HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_POINTER_J)
 
   const float pos_padded_j[3] = {-(2. * cj->width[0] + max_dx),
                                  -(2. * cj->width[1] + max_dx),
@@ -1011,10 +1014,11 @@ cache_read_two_partial_cells_sorted_force(
   const float h_padded_j = cj->hydro.h_max / 4.;
 
   for (int i = 0; i <= last_pj_align; i++) {
-    const int idx = sort_j[i].i;
+
+    const struct part *restrict p = &parts_j[sort_get_i(sort_j, i)];
 
     /* Put inhibited particles out of range. */
-    if (parts_j[idx].time_bin == time_bin_inhibited) {
+    if (p->time_bin == time_bin_inhibited) {
       xj[i] = pos_padded_j[0];
       yj[i] = pos_padded_j[1];
       zj[i] = pos_padded_j[2];
@@ -1023,30 +1027,22 @@ cache_read_two_partial_cells_sorted_force(
       vxj[i] = 1.f;
       vyj[i] = 1.f;
       vzj[i] = 1.f;
-      rhoj[i] = 1.f;
-      grad_hj[i] = 1.f;
-      pOrho2j[i] = 1.f;
-      balsaraj[i] = 1.f;
-      soundspeedj[i] = 1.f;
+      HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD_J)
+      HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD_J)
 
       continue;
     }
 
-    xj[i] = (float)(parts_j[idx].x[0] - total_cj_shift[0]);
-    yj[i] = (float)(parts_j[idx].x[1] - total_cj_shift[1]);
-    zj[i] = (float)(parts_j[idx].x[2] - total_cj_shift[2]);
-    hj[i] = parts_j[idx].h;
-    vxj[i] = parts_j[idx].v[0];
-    vyj[i] = parts_j[idx].v[1];
-    vzj[i] = parts_j[idx].v[2];
-#ifdef GADGET2_SPH
-    mj[i] = parts_j[idx].mass;
-    rhoj[i] = parts_j[idx].rho;
-    grad_hj[i] = parts_j[idx].force.f;
-    pOrho2j[i] = parts_j[idx].force.P_over_rho2;
-    balsaraj[i] = parts_j[idx].force.balsara;
-    soundspeedj[i] = parts_j[idx].force.soundspeed;
-#endif
+    xj[i] = (float)(p->x[0] - total_cj_shift[0]);
+    yj[i] = (float)(p->x[1] - total_cj_shift[1]);
+    zj[i] = (float)(p->x[2] - total_cj_shift[2]);
+    hj[i] = p->h;
+    mj[i] = p->mass;
+    vxj[i] = p->v[0];
+    vyj[i] = p->v[1];
+    vzj[i] = p->v[2];
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_READ_J)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_READ_J)
   }
 
   /* Pad cache with fake particles that exist outside the cell so will not
@@ -1061,12 +1057,13 @@ cache_read_two_partial_cells_sorted_force(
     vxj[i] = 1.f;
     vyj[i] = 1.f;
     vzj[i] = 1.f;
-    rhoj[i] = 1.f;
-    grad_hj[i] = 1.f;
-    pOrho2j[i] = 1.f;
-    balsaraj[i] = 1.f;
-    soundspeedj[i] = 1.f;
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_PAD_J)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_HALF_FIELD_PAD_J)
   }
+
+#else
+  error("Can't call the cache reading function with this flavour of SPH!");
+#endif
 }
 
 /**
@@ -1085,11 +1082,10 @@ static INLINE void cache_clean(struct cache *c) {
     free(c->vz);
     free(c->h);
     free(c->max_index);
-    free(c->rho);
-    free(c->grad_h);
-    free(c->pOrho2);
-    free(c->balsara);
-    free(c->soundspeed);
+#ifdef HYDRO_CACHE_FIELDS
+    HYDRO_CACHE_FIELDS(CACHE_FIELD_FREE)
+    HYDRO_CACHE_HALF_FIELDS(CACHE_FIELD_FREE)
+#endif
   }
   c->count = 0;
 }
@@ -87,6 +87,22 @@ struct link {
   struct link *next;
 };
 
+/**
+ * @brief The kinds of locks of a cell.
+ *
+ * When the cells are locked by their leaves, each kind has its own bit field
+ * of locked leaves in the top-level cell.
+ */
+enum cell_lock_type {
+  cell_lock_hydro = 0,
+  cell_lock_grav_part,
+  cell_lock_grav_mpole,
+  cell_lock_stars,
+  cell_lock_sinks,
+  cell_lock_black_holes,
+  cell_lock_count
+};
+
 /* Holds the pairs of progeny for each sid. */
 struct cell_split_pair {
   int count;
@@ -341,9 +357,10 @@ enum cell_flags {
   cell_flag_do_hydro_sub_sync = (1UL << 18),
   cell_flag_unskip_self_grav_processed = (1UL << 19),
   cell_flag_unskip_pair_grav_processed = (1UL << 20),
-  cell_flag_skip_rt_sort = (1UL << 21),    /* skip rt_sort after a RT recv? */
-  cell_flag_do_rt_sub_sort = (1UL << 22),  /* same as hydro_sub_sort for RT */
-  cell_flag_rt_requests_sort = (1UL << 23) /* was this sort requested by RT? */
+  cell_flag_skip_rt_sort = (1UL << 21),     /* skip rt_sort after a RT recv? */
+  cell_flag_do_rt_sub_sort = (1UL << 22),   /* same as hydro_sub_sort for RT */
+  cell_flag_rt_requests_sort = (1UL << 23), /* was this sort requested by RT? */
+  cell_flag_hydro_fused = (1UL << 24)       /* hydro loops in the fused task? */
 };
 
 /**
@@ -374,6 +391,11 @@ struct cell {
   /*! Pointer to the top-level cell in a hierarchy */
   struct cell *top;
 
+  /*! Bit fields of the locked leaves of the hierarchy, one per
+   * #cell_lock_type, for top-level cells only and only if the cells are
+   * locked by their leaves rather than by holding their parents. */
+  uint64_t *leaf_locks;
+
   /*! Super cell, i.e. the highest-level parent cell with *any* task */
   struct cell *super;
 
@@ -463,9 +485,19 @@ struct cell {
   /*! ID of the previous owner, e.g. runner. */
   int owner;
 
+  /*! ID of the queue of the runner that last ran a task on this cell, -1 if
+   * none since the last rebuild. */
+  int last_qid;
+
   /*! ID of the node this cell lives on. */
   int nodeID;
 
+  /*! Index of the first leaf of this cell in its hierarchy, depth-first. */
+  int leaf_first;
+
+  /*! Number of leaves of this cell, one if it is not split. */
+  int leaf_count;
+
   /*! Number of tasks that are associated with this cell. */
   short int nr_tasks;
 
@@ -519,6 +551,7 @@ int cell_sink_locktree(struct cell *c);
 void cell_sink_unlocktree(struct cell *c);
 int cell_blocktree(struct cell *c);
 void cell_bunlocktree(struct cell *c);
+int cell_number_leaves(struct cell *c, const int first);
 int cell_pack(struct cell *c, struct pcell *pc, const int with_gravity);
 int cell_unpack(struct pcell *pc, struct cell *c, struct space *s,
                 const int with_gravity);
@@ -563,6 +596,7 @@ void cell_check_spart_drift_point(struct cell *c, void *data);
 void cell_check_sink_drift_point(struct cell *c, void *data);
 void cell_check_multipole_drift_point(struct cell *c, void *data);
 void cell_reset_task_counters(struct cell *c);
+void cell_set_hydro_fused(struct cell *c, const struct engine *e);
 int cell_unskip_hydro_tasks(struct cell *c, struct scheduler *s);
 int cell_unskip_stars_tasks(struct cell *c, struct scheduler *s,
                             const int with_star_formation,
@@ -681,6 +715,18 @@ __attribute__((always_inline)) INLINE static int cell_is_empty(
           c->black_holes.count == 0 && c->sinks.count == 0);
 }
 
+/**
+ * @brief Number of 64-bit words of each bit field of locked leaves of a
+ * top-level #cell, rounded up to whole cache lines.
+ *
+ * @param c The top-level #cell.
+ */
+__attribute__((always_inline)) INLINE static int cell_leaf_locks_size(
+    const struct cell *c) {
+
+  return ((c->leaf_count + 511) / 512) * 8;
+}
+
 /**
  * @brief Compute the square of the minimal distance between any two points in
  * two cells of the same size
@@ -1085,7 +1131,8 @@ __attribute__((always_inline)) INLINE static void cell_ensure_tagged(
 __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
     struct cell *c, const int flags) {
 
-  const int count = c->hydro.count;
+  /* Size of each array: the particles, a sentinel and the header. */
+  const int size = c->hydro.count + 1 + sort_header_size;
 
   /* Have we already allocated something? */
   if (c->hydro.sort != NULL) {
@@ -1103,8 +1150,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
     /* Allocate memory for the new array */
     struct sort_entry *new_array = NULL;
     if ((new_array = (struct sort_entry *)swift_malloc(
-             "hydro.sort", sizeof(struct sort_entry) * num_arrays_wanted *
-                               (count + 1))) == NULL)
+             "hydro.sort",
+             sizeof(struct sort_entry) * num_arrays_wanted * size)) == NULL)
       error("Failed to allocate sort memory.");
 
     /* Now, copy the already existing arrays */
@@ -1112,8 +1159,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
     int to = 0;
     for (int j = 0; j < 13; j++) {
       if (c->hydro.sort_allocated & (1 << j)) {
-        memcpy(&new_array[to * (count + 1)], &c->hydro.sort[from * (count + 1)],
-               sizeof(struct sort_entry) * (count + 1));
+        memcpy(&new_array[to * size], &c->hydro.sort[from * size],
+               sizeof(struct sort_entry) * size);
         ++from;
         ++to;
       } else if (flags & (1 << j)) {
@@ -1136,8 +1183,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_hydro_sorts(
     /* If there is anything, allocate enough memory */
     if (num_arrays) {
       if ((c->hydro.sort = (struct sort_entry *)swift_malloc(
-               "hydro.sort",
-               sizeof(struct sort_entry) * num_arrays * (count + 1))) == NULL)
+               "hydro.sort", sizeof(struct sort_entry) * num_arrays * size)) ==
+          NULL)
         error("Failed to allocate sort memory.");
     }
   }
@@ -1189,8 +1236,9 @@ cell_get_hydro_sorts(const struct cell *c, const int sid) {
      of the correspondin sid in the meta-array */
   const int j = intrinsics_popcount(c->hydro.sort_allocated & ((1 << sid) - 1));
 
-  /* Return the corresponding array */
-  return &c->hydro.sort[j * (c->hydro.count + 1)];
+  /* Return the corresponding array, after its header */
+  return &c->hydro.sort[j * (c->hydro.count + 1 + sort_header_size) +
+                        sort_header_size];
 }
 
 /**
@@ -1202,7 +1250,8 @@ cell_get_hydro_sorts(const struct cell *c, const int sid) {
 __attribute__((always_inline)) INLINE static void cell_malloc_stars_sorts(
     struct cell *c, const int flags) {
 
-  const int count = c->stars.count;
+  /* Size of each array: the particles, a sentinel and the header. */
+  const int size = c->stars.count + 1 + sort_header_size;
 
   /* Have we already allocated something? */
   if (c->stars.sort != NULL) {
@@ -1220,8 +1269,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_stars_sorts(
     /* Allocate memory for the new array */
     struct sort_entry *new_array = NULL;
     if ((new_array = (struct sort_entry *)swift_malloc(
-             "stars.sort", sizeof(struct sort_entry) * num_arrays_wanted *
-                               (count + 1))) == NULL)
+             "stars.sort",
+             sizeof(struct sort_entry) * num_arrays_wanted * size)) == NULL)
       error("Failed to allocate sort memory.");
 
     /* Now, copy the already existing arrays */
@@ -1229,8 +1278,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_stars_sorts(
     int to = 0;
     for (int j = 0; j < 13; j++) {
       if (c->stars.sort_allocated & (1 << j)) {
-        memcpy(&new_array[to * (count + 1)], &c->stars.sort[from * (count + 1)],
-               sizeof(struct sort_entry) * (count + 1));
+        memcpy(&new_array[to * size], &c->stars.sort[from * size],
+               sizeof(struct sort_entry) * size);
         ++from;
         ++to;
       } else if (flags & (1 << j)) {
@@ -1253,8 +1302,8 @@ __attribute__((always_inline)) INLINE static void cell_malloc_stars_sorts(
     /* If there is anything, allocate enough memory */
     if (num_arrays) {
       if ((c->stars.sort = (struct sort_entry *)swift_malloc(
-               "stars.sort",
-               sizeof(struct sort_entry) * num_arrays * (count + 1))) == NULL)
+               "stars.sort", sizeof(struct sort_entry) * num_arrays * size)) ==
+          NULL)
         error("Failed to allocate sort memory.");
     }
   }
@@ -1306,8 +1355,9 @@ cell_get_stars_sorts(const struct cell *c, const int sid) {
      of the correspondin sid in the meta-array */
   const int j = intrinsics_popcount(c->stars.sort_allocated & ((1 << sid) - 1));
 
-  /* Return the corresponding array */
-  return &c->stars.sort[j * (c->stars.count + 1)];
+  /* Return the corresponding array, after its header */
+  return &c->stars.sort[j * (c->stars.count + 1 + sort_header_size) +
+                        sort_header_size];
 }
 
 /**
@@ -215,7 +215,7 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
     c->hydro.h_max = cell_h_max;
     c->hydro.h_max_active = cell_h_max_active;
     c->hydro.dx_max_part = dx_max;
-    c->hydro.dx_max_sort = dx_max_sort;
+    c->hydro.dx_max_sort = dx_max_sort + c->hydro.dx_sort_quant;
 
     /* Update the time of the last drift */
     c->hydro.ti_old_part = ti_current;
@@ -370,7 +370,7 @@ void cell_drift_part(struct cell *c, const struct engine *e, int force,
     c->hydro.h_max = cell_h_max;
     c->hydro.h_max_active = cell_h_max_active;
     c->hydro.dx_max_part = dx_max;
-    c->hydro.dx_max_sort = dx_max_sort;
+    c->hydro.dx_max_sort = dx_max_sort + c->hydro.dx_sort_quant;
 
     /* Update the time of the last drift */
     c->hydro.ti_old_part = ti_current;
@@ -635,7 +635,7 @@ void cell_drift_spart(struct cell *c, const struct engine *e, int force,
     c->stars.h_max = cell_h_max;
     c->stars.h_max_active = cell_h_max_active;
     c->stars.dx_max_part = dx_max;
-    c->stars.dx_max_sort = dx_max_sort;
+    c->stars.dx_max_sort = dx_max_sort + c->stars.dx_sort_quant;
 
     /* Update the time of the last drift */
     c->stars.ti_old_part = ti_current;
@@ -743,7 +743,7 @@ void cell_drift_spart(struct cell *c, const struct engine *e, int force,
     c->stars.h_max = cell_h_max;
     c->stars.h_max_active = cell_h_max_active;
     c->stars.dx_max_part = dx_max;
-    c->stars.dx_max_sort = dx_max_sort;
+    c->stars.dx_max_sort = dx_max_sort + c->stars.dx_sort_quant;
 
     /* Update the time of the last drift */
     c->stars.ti_old_part = ti_current;
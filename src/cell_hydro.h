@@ -85,6 +85,9 @@ struct cell_hydro {
     /*! The extra ghost task for complex hydro schemes */
     struct task *extra_ghost;
 
+    /*! The task running all the hydro loops of the top-level cell at once */
+    struct task *fused;
+
     /*! The task to end the force calculation */
     struct task *end_force;
 
@@ -124,6 +127,10 @@ struct cell_hydro {
     /*! Values of dx_max_sort before the drifts, used for sub-cell tasks. */
     float dx_max_sort_old;
 
+    /*! Maximal error on the distances stored in this cell's own sorts, part
+     * of dx_max_sort (non-zero only with compact sorts). */
+    float dx_sort_quant;
+
     /*! Nr of #part this cell can hold after addition of new #part. */
     int count_total;
 
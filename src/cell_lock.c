@@ -28,6 +28,110 @@
 /* Local headers. */
 #include "timers.h"
 
+/**
+ * @brief Bits of the word w of a field of leaves that are within the range
+ * [first, last).
+ */
+__attribute__((always_inline)) INLINE static uint64_t cell_leaf_locks_mask(
+    const int w, const int first, const int last) {
+
+  const int lo = max(first - 64 * w, 0);
+  const int hi = min(last - 64 * w, 64);
+  const uint64_t below_hi = (hi == 64) ? ~0ULL : (1ULL << hi) - 1ULL;
+  return below_hi & ~((1ULL << lo) - 1ULL);
+}
+
+/**
+ * @brief Lock a cell by setting the bits of its leaves in the field of its
+ * top-level cell, rather than by holding all its parents.
+ *
+ * Two cells of the same hierarchy conflict if and only if one is a parent of
+ * the other, i.e. if their ranges of leaves overlap. The bits are set one
+ * word at a time, and the words already set are cleared again if a later one
+ * has any of our bits set. Only the cell's own lock and the words covering
+ * its leaves are written to.
+ *
+ * @param c The #cell.
+ * @param lock The lock of the cell.
+ * @param type The kind of lock.
+ * @return 0 on success, 1 on failure
+ */
+static int cell_leaf_lock(struct cell *c, swift_lock_type *lock,
+                          const enum cell_lock_type type) {
+
+  /* Lock the cell itself, for those who use that lock directly. */
+  if (lock_trylock(lock) != 0) return 1;
+
+  uint64_t *bits = c->top->leaf_locks + type * cell_leaf_locks_size(c->top);
+  const int first = c->leaf_first;
+  const int last = c->leaf_first + c->leaf_count;
+
+  for (int w = first / 64; w <= (last - 1) / 64; w++) {
+
+    /* Set our bits if none of them is set yet. */
+    const uint64_t mask = cell_leaf_locks_mask(w, first, last);
+    uint64_t old = bits[w], prev;
+    while (!(old & mask) &&
+           (prev = atomic_cas(&bits[w], old, old | mask)) != old)
+      old = prev;
+
+    /* Otherwise, we hit a snag: undo the words set so far. */
+    if (old & mask) {
+      for (int v = first / 64; v < w; v++)
+        atomic_and(&bits[v], ~cell_leaf_locks_mask(v, first, last));
+
+      if (lock_unlock(lock) != 0) error("Failed to unlock cell.");
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Unlock a cell locked with cell_leaf_lock().
+ *
+ * @param c The #cell.
+ * @param lock The lock of the cell.
+ * @param type The kind of lock.
+ */
+static void cell_leaf_unlock(struct cell *c, swift_lock_type *lock,
+                             const enum cell_lock_type type) {
+
+  uint64_t *bits = c->top->leaf_locks + type * cell_leaf_locks_size(c->top);
+  const int first = c->leaf_first;
+  const int last = c->leaf_first + c->leaf_count;
+
+  for (int w = first / 64; w <= (last - 1) / 64; w++)
+    atomic_and(&bits[w], ~cell_leaf_locks_mask(w, first, last));
+
+  if (lock_unlock(lock) != 0) error("Failed to unlock cell.");
+}
+
+/**
+ * @brief Number the leaves of a hierarchy depth-first, so that the leaves of
+ * every cell form a contiguous range.
+ *
+ * @param c The #cell.
+ * @param first Index of the first leaf of the cell.
+ * @return The number of leaves of the cell.
+ */
+int cell_number_leaves(struct cell *c, const int first) {
+
+  int count = 0;
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        count += cell_number_leaves(c->progeny[k], first + count);
+
+  /* A cell without progeny is a leaf. */
+  if (count == 0) count = 1;
+
+  c->leaf_first = first;
+  c->leaf_count = count;
+  return count;
+}
+
 /**
  * @brief Lock a cell for access to its array of #part and hold its parents.
  *
@@ -37,6 +141,13 @@
 int cell_locktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res = cell_leaf_lock(c, &c->hydro.lock, cell_lock_hydro);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->hydro.hold || lock_trylock(&c->hydro.lock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -97,6 +208,13 @@ int cell_locktree(struct cell *c) {
 int cell_glocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res = cell_leaf_lock(c, &c->grav.plock, cell_lock_grav_part);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->grav.phold || lock_trylock(&c->grav.plock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -157,6 +275,13 @@ int cell_glocktree(struct cell *c) {
 int cell_mlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res = cell_leaf_lock(c, &c->grav.mlock, cell_lock_grav_mpole);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->grav.mhold || lock_trylock(&c->grav.mlock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -217,6 +342,13 @@ int cell_mlocktree(struct cell *c) {
 int cell_slocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res = cell_leaf_lock(c, &c->stars.lock, cell_lock_stars);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->stars.hold || lock_trylock(&c->stars.lock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -277,6 +409,13 @@ int cell_slocktree(struct cell *c) {
 int cell_sink_locktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res = cell_leaf_lock(c, &c->sinks.lock, cell_lock_sinks);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->sinks.hold || lock_trylock(&c->sinks.lock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -337,6 +476,14 @@ int cell_sink_locktree(struct cell *c) {
 int cell_blocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Lock our leaves rather than holding the parents? */
+  if (c->top->leaf_locks != NULL) {
+    const int res =
+        cell_leaf_lock(c, &c->black_holes.lock, cell_lock_black_holes);
+    TIMER_TOC(timer_locktree);
+    return res;
+  }
+
   /* First of all, try to lock this cell. */
   if (c->black_holes.hold || lock_trylock(&c->black_holes.lock) != 0) {
     TIMER_TOC(timer_locktree);
@@ -397,6 +544,13 @@ int cell_blocktree(struct cell *c) {
 void cell_unlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->hydro.lock, cell_lock_hydro);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->hydro.lock) != 0) error("Failed to unlock cell.");
 
@@ -415,6 +569,13 @@ void cell_unlocktree(struct cell *c) {
 void cell_gunlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->grav.plock, cell_lock_grav_part);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->grav.plock) != 0) error("Failed to unlock cell.");
 
@@ -433,6 +594,13 @@ void cell_gunlocktree(struct cell *c) {
 void cell_munlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->grav.mlock, cell_lock_grav_mpole);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->grav.mlock) != 0) error("Failed to unlock cell.");
 
@@ -451,6 +619,13 @@ void cell_munlocktree(struct cell *c) {
 void cell_sunlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->stars.lock, cell_lock_stars);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->stars.lock) != 0) error("Failed to unlock cell.");
 
@@ -469,6 +644,13 @@ void cell_sunlocktree(struct cell *c) {
 void cell_sink_unlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->sinks.lock, cell_lock_sinks);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->sinks.lock) != 0) error("Failed to unlock cell.");
 
@@ -487,6 +669,13 @@ void cell_sink_unlocktree(struct cell *c) {
 void cell_bunlocktree(struct cell *c) {
   TIMER_TIC;
 
+  /* Were we locked by our leaves? */
+  if (c->top->leaf_locks != NULL) {
+    cell_leaf_unlock(c, &c->black_holes.lock, cell_lock_black_holes);
+    TIMER_TOC(timer_locktree);
+    return;
+  }
+
   /* First of all, try to unlock this cell. */
   if (lock_unlock(&c->black_holes.lock) != 0) error("Failed to unlock cell.");
 
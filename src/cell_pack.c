@@ -272,8 +272,10 @@ int cell_unpack(struct pcell *restrict pc, struct cell *restrict c,
       temp->split = 0;
       temp->hydro.dx_max_part = 0.f;
       temp->hydro.dx_max_sort = 0.f;
+      temp->hydro.dx_sort_quant = 0.f;
       temp->stars.dx_max_part = 0.f;
       temp->stars.dx_max_sort = 0.f;
+      temp->stars.dx_sort_quant = 0.f;
       temp->black_holes.dx_max_part = 0.f;
       temp->nodeID = c->nodeID;
       temp->parent = c;
@@ -112,6 +112,10 @@ struct cell_stars {
     /*! Values of dx_max_sort before the drifts, used for sub-cell tasks. */
     float dx_max_sort_old;
 
+    /*! Maximal error on the distances stored in this cell's own sorts, part
+     * of dx_max_sort (non-zero only with compact sorts). */
+    float dx_sort_quant;
+
     /*! Bit mask of sort directions that will be needed in the next timestep. */
     uint16_t requires_sorts;
 
@@ -1610,6 +1610,92 @@ void cell_activate_subcell_rt_tasks(struct cell *ci, struct cell *cj,
   }
 }
 
+/**
+ * @brief Counts the active gas particles of a cell hierarchy, stopping once
+ * there are more than a given number of them.
+ *
+ * @param c The #cell.
+ * @param e The #engine.
+ * @param max_count The number of active particles to stop at.
+ */
+static int cell_count_active_hydro(const struct cell *c,
+                                   const struct engine *e,
+                                   const int max_count) {
+
+  if (!cell_is_active_hydro(c, e)) return 0;
+
+  int count = 0;
+  if (c->split) {
+    for (int k = 0; k < 8 && count <= max_count; k++)
+      if (c->progeny[k] != NULL)
+        count += cell_count_active_hydro(c->progeny[k], e, max_count - count);
+  } else {
+    for (int k = 0; k < c->hydro.count && count <= max_count; k++)
+      if (part_is_active(&c->hydro.parts[k], e)) count++;
+  }
+  return count;
+}
+
+/**
+ * @brief Checks that no active cell of a hierarchy interacts with an active
+ * cell of another top-level cell or with a foreign cell.
+ *
+ * @param c The #cell.
+ * @param e The #engine.
+ */
+static int cell_hydro_loops_are_local(const struct cell *c,
+                                      const struct engine *e) {
+
+  /* Inactive cells only take part in the loops of their neighbours. */
+  if (!cell_is_active_hydro(c, e)) return 1;
+
+  for (struct link *l = c->hydro.density; l != NULL; l = l->next) {
+    const struct task *t = l->t;
+    if (t->cj == NULL) continue;
+    const struct cell *other = (t->ci == c) ? t->cj : t->ci;
+    if (other->top == c->top) continue;
+    if (other->nodeID != e->nodeID || cell_is_active_hydro(other, e)) return 0;
+  }
+
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL &&
+          !cell_hydro_loops_are_local(c->progeny[k], e))
+        return 0;
+
+  return 1;
+}
+
+/**
+ * @brief Decides whether the hydro loops of a top-level cell run in its
+ * fused task rather than in their own tasks during this step.
+ *
+ * That is the case when few of its particles are active and none of them
+ * has active neighbours in another top-level cell or on another node, such
+ * that the loops and ghosts of the cell only wait for one another. Must be
+ * called before the hydro tasks of the cell's hierarchy are unskipped.
+ *
+ * This is never the case on the steps with a rebuild, even when their tasks
+ * are activated by engine_unskip(), as engine_marktasks() knows nothing of
+ * the fused tasks and may also walk the tasks of these steps.
+ *
+ * @param c The top-level #cell.
+ * @param e The #engine.
+ */
+void cell_set_hydro_fused(struct cell *c, const struct engine *e) {
+
+  cell_clear_flag(c, cell_flag_hydro_fused);
+  if (c->hydro.fused == NULL || c->nodeID != e->nodeID) return;
+  if (e->step_props & engine_step_prop_rebuild) return;
+
+  const int max_active =
+      e->hydro_properties->fused_loops_max_active_fraction * c->hydro.count;
+  if (cell_count_active_hydro(c, e, max_active) > max_active) return;
+  if (!cell_hydro_loops_are_local(c, e)) return;
+
+  cell_set_flag(c, cell_flag_hydro_fused);
+}
+
 /**
  * @brief Un-skips all the hydro tasks associated with a given cell and checks
  * if the space needs to be rebuilt.
@@ -1632,6 +1718,10 @@ int cell_unskip_hydro_tasks(struct cell *c, struct scheduler *s) {
 #endif
   int rebuild = 0;
 
+  /* Do the loops of this cell run in the fused task of its top-level cell? */
+  const int fused = cell_get_flag(c->top, cell_flag_hydro_fused) &&
+                    cell_is_active_hydro(c, e);
+
   /* Un-skip the density tasks involved with this cell. */
   for (struct link *l = c->hydro.density; l != NULL; l = l->next) {
     struct task *t = l->t;
@@ -1650,7 +1740,7 @@ int cell_unskip_hydro_tasks(struct cell *c, struct scheduler *s) {
     /* Only activate tasks that involve a local active cell. */
     if ((ci_active && ci_nodeID == nodeID) ||
         (cj_active && cj_nodeID == nodeID)) {
-      scheduler_activate(s, t);
+      if (!fused) scheduler_activate(s, t);
 
       /* Activate hydro drift */
       if (t->type == task_type_self) {
@@ -1901,19 +1991,25 @@ int cell_unskip_hydro_tasks(struct cell *c, struct scheduler *s) {
   /* Unskip all the other task types. */
   int c_active = cell_is_active_hydro(c, e);
   if (c->nodeID == nodeID && c_active) {
-    for (struct link *l = c->hydro.gradient; l != NULL; l = l->next) {
-      scheduler_activate(s, l->t);
-    }
-    for (struct link *l = c->hydro.force; l != NULL; l = l->next) {
-      scheduler_activate(s, l->t);
+    if (!fused) {
+      for (struct link *l = c->hydro.gradient; l != NULL; l = l->next) {
+        scheduler_activate(s, l->t);
+      }
+      for (struct link *l = c->hydro.force; l != NULL; l = l->next) {
+        scheduler_activate(s, l->t);
+      }
     }
 
     for (struct link *l = c->hydro.limiter; l != NULL; l = l->next)
       scheduler_activate(s, l->t);
 
-    if (c->hydro.extra_ghost != NULL)
-      scheduler_activate(s, c->hydro.extra_ghost);
-    if (c->hydro.ghost_in != NULL) cell_activate_hydro_ghosts(c, s, e);
+    if (fused) {
+      scheduler_activate(s, c->top->hydro.fused);
+    } else {
+      if (c->hydro.extra_ghost != NULL)
+        scheduler_activate(s, c->hydro.extra_ghost);
+      if (c->hydro.ghost_in != NULL) cell_activate_hydro_ghosts(c, s, e);
+    }
     if (c->kick1 != NULL) scheduler_activate(s, c->kick1);
     if (c->kick2 != NULL) scheduler_activate(s, c->kick2);
     if (c->timestep != NULL) scheduler_activate(s, c->timestep);
@@ -174,6 +174,26 @@ void engine_addlink(struct engine *e, struct link **l, struct task *t) {
   res->next = atomic_swap(l, res);
 }
 
+/**
+ * @brief Display the time each runner spent waiting for tasks since the
+ * last rebuild.
+ *
+ * @param e The #engine.
+ */
+static void engine_report_idle_times(const struct engine *e) {
+
+  const float total_time = clocks_from_ticks(e->sched.total_ticks);
+  if (total_time <= 0.) return;
+
+  message("*** Time spent idle by the runners:");
+  for (int i = 0; i < e->nr_threads; ++i) {
+    const float idle_time = clocks_from_ticks(e->runners[i].idle_time);
+    message("*** runner %4d (queue %4d): %8.2f %s (%.2f %%)", i,
+            e->runners[i].qid, idle_time, clocks_getunit(),
+            idle_time / total_time * 100.);
+  }
+}
+
 /**
  * @brief Repartition the cells amongst the nodes.
  *
@@ -221,7 +241,11 @@ void engine_repartition(struct engine *e) {
   if (e->s->cells_top != NULL) space_free_cells(e->s);
 
   /* Report the time spent in the different task categories */
-  if (e->verbose) scheduler_report_task_times(&e->sched, e->nr_threads);
+  if (e->verbose) {
+    scheduler_report_task_times(&e->sched, e->nr_threads);
+    scheduler_report_lock_stats(&e->sched);
+    engine_report_idle_times(e);
+  }
 
   /* Task arrays. */
   scheduler_free_tasks(&e->sched);
@@ -1187,6 +1211,51 @@ int engine_estimate_nr_tasks(const struct engine *e) {
   return (int)(ncells * tasks_per_cell);
 }
 
+/**
+ * @brief Activate the tasks of the current step after a rebuild.
+ *
+ * By default, engine_marktasks() walks the whole list of tasks. Activating by
+ * cells instead unskips the tasks of the active top-level cells, as on the
+ * steps without a rebuild, at a cost that only grows with the number of active
+ * tasks. With the activation statistics on, the full walk is then done as
+ * well, to time it and to check that it finds nothing more to activate.
+ *
+ * @param e The #engine.
+ */
+static void engine_activate_after_rebuild(struct engine *e) {
+
+  struct scheduler *s = &e->sched;
+
+  if (!(s->flags & scheduler_flag_activate_by_cells)) {
+    const ticks tic = getticks();
+    if (engine_marktasks(e))
+      error("engine_marktasks failed after space_rebuild.");
+    if (s->flags & scheduler_flag_activation_stats)
+      message("activated %d of %d tasks by walking all the tasks in %.3f %s.",
+              s->active_count, s->nr_tasks,
+              clocks_from_ticks(getticks() - tic), clocks_getunit());
+    return;
+  }
+
+  const ticks tic = getticks();
+  engine_unskip(e);
+  const ticks toc = getticks();
+  if (e->forcerebuild) error("engine_unskip failed after space_rebuild.");
+
+  if (s->flags & scheduler_flag_activation_stats) {
+    const int active_count = s->active_count;
+    if (engine_marktasks(e))
+      error("engine_marktasks failed after space_rebuild.");
+    const ticks toc_full = getticks();
+    message(
+        "activated %d of %d tasks from the active cells in %.3f %s, walking "
+        "all the tasks took %.3f %s and activated %d more.",
+        active_count, s->nr_tasks, clocks_from_ticks(toc - tic),
+        clocks_getunit(), clocks_from_ticks(toc_full - toc), clocks_getunit(),
+        s->active_count - active_count);
+  }
+}
+
 /**
  * @brief Rebuild the space and tasks.
  *
@@ -1205,8 +1274,12 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   e->restarting = 0;
 
   /* Report the time spent in the different task categories */
-  if (e->verbose && !repartitioned)
+  if (e->verbose && !repartitioned) {
     scheduler_report_task_times(&e->sched, e->nr_threads);
+    scheduler_report_lock_stats(&e->sched);
+    engine_report_idle_times(e);
+  }
+  for (int i = 0; i < e->nr_threads; ++i) e->runners[i].idle_time = 0;
 
   /* Give some breathing space */
   scheduler_free_tasks(&e->sched);
@@ -1337,6 +1410,9 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   }
 #endif
 
+  /* Number the leaves of the local and foreign trees if we lock by them */
+  space_allocate_leaf_locks(e->s);
+
   /* Re-build the tasks. */
   engine_maketasks(e);
 
@@ -1367,9 +1443,11 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   space_check_unskip_flags(e->s);
 #endif
 
-  /* Run through the tasks and mark as skip or not. */
-  if (engine_marktasks(e))
-    error("engine_marktasks failed after space_rebuild.");
+  /* Flag that a rebuild has taken place */
+  e->step_props |= engine_step_prop_rebuild;
+
+  /* Mark the tasks of this step as skip or not. */
+  engine_activate_after_rebuild(e);
 
   /* Print the status of the system */
   if (e->verbose) engine_print_task_counts(e);
@@ -1381,9 +1459,6 @@ void engine_rebuild(struct engine *e, const int repartitioned,
   e->sink_updates_since_rebuild = 0;
   e->b_updates_since_rebuild = 0;
 
-  /* Flag that a rebuild has taken place */
-  e->step_props |= engine_step_prop_rebuild;
-
   if (e->verbose)
     message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
             clocks_getunit());
@@ -1405,7 +1480,14 @@ int engine_prepare(struct engine *e) {
   int repartitioned = 0;
 
   /* Unskip active tasks and check for rebuild */
-  if (!e->forcerebuild && !e->forcerepart && !e->restarting) engine_unskip(e);
+  if (!e->forcerebuild && !e->forcerepart && !e->restarting) {
+    const ticks tic_unskip = getticks();
+    engine_unskip(e);
+    if (e->sched.flags & scheduler_flag_activation_stats)
+      message("activated %d of %d tasks from the active cells in %.3f %s.",
+              e->sched.active_count, e->sched.nr_tasks,
+              clocks_from_ticks(getticks() - tic_unskip), clocks_getunit());
+  }
 
   const ticks tic3 = getticks();
 
@@ -1491,6 +1573,12 @@ int engine_prepare(struct engine *e) {
   if (e->tasks_age % engine_tasksreweight == 1) {
     scheduler_reweight(&e->sched, e->verbose);
   }
+
+  /* With adaptive weights, re-rank the active tasks along their measured
+   * critical paths every step. */
+  else if (e->sched.flags & scheduler_flag_adaptive_weights) {
+    scheduler_reweight(&e->sched, e->verbose);
+  }
   e->tasks_age += 1;
 
   TIMER_TOC2(timer_prepare);
@@ -1611,6 +1699,7 @@ void engine_skip_force_and_kick(struct engine *e) {
         t->type == task_type_star_formation ||
         t->type == task_type_star_formation_sink ||
         t->type == task_type_stars_resort || t->type == task_type_extra_ghost ||
+        t->type == task_type_hydro_fused ||
         t->type == task_type_stars_ghost ||
         t->type == task_type_stars_ghost_in ||
         t->type == task_type_stars_ghost_out || t->type == task_type_sink_in ||
@@ -1684,6 +1773,43 @@ void engine_skip_drift(struct engine *e) {
   space_map_cells_pre(e->s, 1, cell_clear_drift_flags, NULL);
 }
 
+/**
+ * @brief Report on the fused hydro tasks that ran during the last launch.
+ *
+ * Each fused task replaces the loop and ghost tasks of a top-level cell, so
+ * the time they took per task they replaced, compared to the time taken by
+ * the hydro loop tasks that were not fused, tells how much was saved.
+ *
+ * @param e The #engine.
+ * @param call What kind of tasks were we running?
+ */
+static void engine_report_hydro_fused(const struct engine *e,
+                                      const char *call) {
+
+  int fused_count = 0, fused_replaced = 0, loop_count = 0;
+  ticks fused_ticks = 0, loop_ticks = 0;
+  for (int i = 0; i < e->nr_threads; ++i) {
+    fused_count += e->runners[i].hydro_fused_count;
+    fused_replaced += e->runners[i].hydro_fused_replaced;
+    loop_count += e->runners[i].hydro_loop_count;
+    fused_ticks += e->runners[i].hydro_fused_ticks;
+    loop_ticks += e->runners[i].hydro_loop_ticks;
+  }
+  if (fused_count == 0) return;
+
+  message(
+      "(%s) %d fused hydro tasks replaced %d tasks (%d fewer) and took %.3f "
+      "%s, i.e. %.3f %s per replaced task against %.3f %s per unfused hydro "
+      "loop task.",
+      call, fused_count, fused_replaced, fused_replaced - fused_count,
+      clocks_from_ticks(fused_ticks), clocks_getunit(),
+      fused_replaced > 0 ? clocks_from_ticks(fused_ticks) / fused_replaced
+                         : 0.,
+      clocks_getunit(),
+      loop_count > 0 ? clocks_from_ticks(loop_ticks) / loop_count : 0.,
+      clocks_getunit());
+}
+
 /**
  * @brief Launch the runners.
  *
@@ -1701,6 +1827,13 @@ void engine_launch(struct engine *e, const char *call) {
   /* reset the active time counters for the runners */
   for (int i = 0; i < e->nr_threads; ++i) {
     runner_reset_active_time(&e->runners[i]);
+    e->runners[i].cell_affinity_hits = 0;
+    e->runners[i].cell_affinity_count = 0;
+    e->runners[i].hydro_fused_count = 0;
+    e->runners[i].hydro_fused_replaced = 0;
+    e->runners[i].hydro_loop_count = 0;
+    e->runners[i].hydro_fused_ticks = 0;
+    e->runners[i].hydro_loop_ticks = 0;
   }
 
   /* Prepare the scheduler. */
@@ -1713,10 +1846,8 @@ void engine_launch(struct engine *e, const char *call) {
   scheduler_start(&e->sched);
 
   /* Remove the safeguard. */
-  pthread_mutex_lock(&e->sched.sleep_mutex);
   atomic_dec(&e->sched.waiting);
-  pthread_cond_broadcast(&e->sched.sleep_cond);
-  pthread_mutex_unlock(&e->sched.sleep_mutex);
+  scheduler_wake_all(&e->sched);
 
   /* Sit back and wait for the runners to come home. */
   swift_barrier_wait(&e->wait_barrier);
@@ -1724,6 +1855,9 @@ void engine_launch(struct engine *e, const char *call) {
   /* Store the wallclock time */
   e->sched.total_ticks += getticks() - tic;
 
+  /* Learn the cost of the tasks that just ran. */
+  scheduler_update_cost_model(&e->sched, tic, e->verbose);
+
   /* accumulate active counts for all runners */
   ticks active_time = 0;
   for (int i = 0; i < e->nr_threads; ++i) {
@@ -1732,6 +1866,32 @@ void engine_launch(struct engine *e, const char *call) {
   e->sched.deadtime.active_ticks += active_time;
   e->sched.deadtime.waiting_ticks += getticks() - tic;
 
+  /* Report how often the tasks ran where their data was last used. */
+  if (e->sched.flags & scheduler_flag_cell_affinity_stats) {
+    int hits = 0, count = 0;
+    for (int i = 0; i < e->nr_threads; ++i) {
+      hits += e->runners[i].cell_affinity_hits;
+      count += e->runners[i].cell_affinity_count;
+    }
+    message("(%s) cell affinity hit rate: %.2f %% (%d/%d tasks).", call,
+            count > 0 ? 100. * hits / count : 0., hits, count);
+  }
+
+  /* Report on the tasks saved by fusing the hydro loops. */
+  if (e->verbose && e->hydro_properties->fused_loops_max_active_fraction > 0.f)
+    engine_report_hydro_fused(e, call);
+
+  /* Report on the topology-aware stealing, if any. */
+  if (e->sched.steal_queues != NULL) {
+    if (e->verbose)
+      message("(%s) stole %d llc, %d numa and %d remote tasks.", call,
+              e->sched.steal_counts[scheduler_steal_llc],
+              e->sched.steal_counts[scheduler_steal_numa],
+              e->sched.steal_counts[scheduler_steal_remote]);
+    for (int k = 0; k < scheduler_steal_level_count; k++)
+      e->sched.steal_counts[k] = 0;
+  }
+
   if (e->verbose)
     message("(%s) took %.3f %s.", call, clocks_from_ticks(getticks() - tic),
             clocks_getunit());
@@ -2689,6 +2849,8 @@ int engine_step(struct engine *e) {
 
   /* Time in ticks at the end of this step. */
   e->toc_step = getticks();
+  task_trace_push_step(e->tic_step, e->toc_step, e->step, e->updates,
+                       e->g_updates, e->s_updates);
 
   return force_stop;
 }
@@ -3532,11 +3694,14 @@ void engine_clean(struct engine *e, const int fof, const int restart) {
 #ifdef WITH_VECTORIZATION
     cache_clean(&e->runners[k].ci_cache);
     cache_clean(&e->runners[k].cj_cache);
+    limiter_cache_clean(&e->runners[k].ci_limiter_cache);
+    limiter_cache_clean(&e->runners[k].cj_limiter_cache);
 #endif
     gravity_cache_clean(&e->runners[k].ci_gravity_cache);
     gravity_cache_clean(&e->runners[k].cj_gravity_cache);
   }
   swift_free("runners", e->runners);
+  if (e->trace.buffers != NULL) task_trace_clean(&e->trace);
   free(e->snapshot_units);
 
   output_list_clean(&e->output_list_snapshots);
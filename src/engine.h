@@ -47,6 +47,7 @@
 #include "scheduler.h"
 #include "space.h"
 #include "task.h"
+#include "task_trace.h"
 #include "units.h"
 #include "velociraptor_interface.h"
 
@@ -160,6 +161,9 @@ struct engine {
   /* Common threadpool for all the engine's tasks. */
   struct threadpool threadpool;
 
+  /* Binary trace of the tasks, if we are recording it. */
+  struct task_trace trace;
+
   /* The minimum and maximum allowed dt */
   double dt_min, dt_max;
 
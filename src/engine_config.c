@@ -241,6 +241,20 @@ void engine_config(int restart, int fof, struct engine *e,
     message("Number of task queues set to %d", nr_queues);
   e->s->nr_queues = nr_queues;
 
+  /* Get the type of task queues */
+  char queue_type_name[PARSER_MAX_LINE_SIZE];
+  parser_get_opt_param_string(params, "Scheduler:queue_type", queue_type_name,
+                              queue_type_names[queue_type_heap]);
+  enum queue_types queue_type = queue_type_count;
+  for (int k = 0; k < queue_type_count; k++)
+    if (strcmp(queue_type_name, queue_type_names[k]) == 0)
+      queue_type = (enum queue_types)k;
+  if (queue_type == queue_type_count)
+    error("Invalid Scheduler:queue_type '%s', should be 'heap' or 'deque'.",
+          queue_type_name);
+  if (queue_type != queue_type_heap && nodeID == 0)
+    message("Using '%s' task queues", queue_type_names[queue_type]);
+
   /* Get the frequency of the dependency graph dumping */
   e->sched.frequency_dependency = parser_get_opt_param_int(
       params, "Scheduler:dependency_graph_frequency", 0);
@@ -825,9 +839,50 @@ void engine_config(int restart, int fof, struct engine *e,
   e->links_per_tasks =
       parser_get_opt_param_float(params, "Scheduler:links_per_tasks", 25.);
 
+  /* Do we want to send tasks to the queue that last touched their cells? */
+  unsigned int sched_flags = (e->policy & scheduler_flag_steal);
+  if (parser_get_opt_param_int(params, "Scheduler:cell_affinity", 0))
+    sched_flags |= scheduler_flag_cell_affinity;
+  if (parser_get_opt_param_int(params, "Scheduler:cell_affinity_stats", 0))
+    sched_flags |= scheduler_flag_cell_affinity_stats;
+
+  /* How do we activate the tasks after a rebuild? */
+  if (parser_get_opt_param_int(params, "Scheduler:activate_by_cells", 0))
+    sched_flags |= scheduler_flag_activate_by_cells;
+  if (parser_get_opt_param_int(params, "Scheduler:activation_stats", 0))
+    sched_flags |= scheduler_flag_activation_stats;
+
+  /* Do we count the failures to lock the tasks? */
+  if (parser_get_opt_param_int(params, "Scheduler:lock_stats", 0))
+    sched_flags |= scheduler_flag_lock_stats;
+
+  /* Do we lock the cells by their leaves rather than by holding parents? */
+  e->s->with_leaf_locks =
+      parser_get_opt_param_int(params, "Scheduler:cell_leaf_locks", 0);
+
+  /* Do we weight the tasks by their measured costs? */
+  if (parser_get_opt_param_int(params, "Scheduler:adaptive_weights", 0))
+    sched_flags |= scheduler_flag_adaptive_weights;
+
+  /* How do idle runners wait for new tasks? */
+  char idle_strategy[PARSER_MAX_LINE_SIZE];
+  parser_get_opt_param_string(params, "Scheduler:idle_strategy", idle_strategy,
+                              "condvar");
+  if (strcmp(idle_strategy, "futex") == 0) {
+#ifdef HAVE_LINUX_FUTEX_H
+    sched_flags |= scheduler_flag_idle_futex;
+#else
+    error("Futex idle strategy requested but SWIFT was compiled without "
+          "futex support.");
+#endif
+  } else if (strcmp(idle_strategy, "condvar") != 0) {
+    error("Invalid Scheduler:idle_strategy '%s', must be 'condvar' or 'futex'.",
+          idle_strategy);
+  }
+
   /* Init the scheduler. */
-  scheduler_init(&e->sched, e->s, maxtasks, nr_queues,
-                 (e->policy & scheduler_flag_steal), e->nodeID, &e->threadpool);
+  scheduler_init(&e->sched, e->s, maxtasks, nr_queues, queue_type, sched_flags,
+                 e->nodeID, &e->threadpool);
 
   /* Maximum size of MPI task messages, in KB, that should not be buffered,
    * that is sent using MPI_Issend, not MPI_Isend. 4Mb by default. Can be
@@ -889,6 +944,18 @@ void engine_config(int restart, int fof, struct engine *e,
         engine_max_parts_per_cooling);
   }
 
+  /* Record a binary trace of the tasks? The runners each get a buffer, and
+   * the last one is for this thread. */
+  e->trace.buffers = NULL;
+  if (parser_get_opt_param_int(params, "Scheduler:task_trace", 0)) {
+    const int trace_size = parser_get_opt_param_int(
+        params, "Scheduler:task_trace_buffer_size", task_trace_default_size);
+    if (trace_size <= 0)
+      error("Scheduler:task_trace_buffer_size should be > 0");
+    task_trace_init(&e->trace, e->nr_threads + 1, trace_size, e->nodeID);
+    task_trace_attach(&e->trace, e->nr_threads);
+  }
+
   /* Allocate and init the threads. */
   if (swift_memalign("runners", (void **)&e->runners, SWIFT_CACHE_ALIGNMENT,
                      e->nr_threads * sizeof(struct runner)) != 0)
@@ -897,6 +964,7 @@ void engine_config(int restart, int fof, struct engine *e,
   for (int k = 0; k < e->nr_threads; k++) {
     e->runners[k].id = k;
     e->runners[k].e = e;
+    e->runners[k].idle_time = 0;
     if (pthread_create(&e->runners[k].thread, NULL, &runner_main,
                        &e->runners[k]) != 0)
       error("Failed to create runner thread.");
@@ -942,6 +1010,10 @@ void engine_config(int restart, int fof, struct engine *e,
     e->runners[k].cj_cache.count = 0;
     cache_init(&e->runners[k].ci_cache, CACHE_SIZE);
     cache_init(&e->runners[k].cj_cache, CACHE_SIZE);
+    e->runners[k].ci_limiter_cache.count = 0;
+    e->runners[k].cj_limiter_cache.count = 0;
+    limiter_cache_init(&e->runners[k].ci_limiter_cache, CACHE_SIZE);
+    limiter_cache_init(&e->runners[k].cj_limiter_cache, CACHE_SIZE);
 #endif
 
     if (verbose) {
@@ -954,6 +1026,26 @@ void engine_config(int restart, int fof, struct engine *e,
     }
   }
 
+  /* Tell the scheduler where its queues live, if we want to steal tasks from
+   * the closest ones first. */
+  if (parser_get_opt_param_int(params, "Scheduler:steal_by_topology", 0)) {
+    if (with_aff && (e->policy & engine_policy_setaffinity) ==
+                        engine_policy_setaffinity) {
+      int *queue_cpuid = (int *)malloc(nr_queues * sizeof(int));
+      if (queue_cpuid == NULL) error("Failed to allocate queue cpuids.");
+      for (int k = 0; k < nr_queues; k++) queue_cpuid[k] = -1;
+      for (int k = 0; k < e->nr_threads; k++)
+        if (queue_cpuid[e->runners[k].qid] < 0)
+          queue_cpuid[e->runners[k].qid] = e->runners[k].cpuid;
+      scheduler_init_topology(&e->sched, queue_cpuid, verbose);
+      free(queue_cpuid);
+    } else if (nodeID == 0) {
+      message(
+          "Scheduler:steal_by_topology requires processor affinity, "
+          "stealing at random.");
+    }
+  }
+
 #ifdef WITH_CSDS
   if ((e->policy & engine_policy_csds) && !restart) {
     /* Write the particle csds header */
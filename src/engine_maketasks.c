@@ -1454,6 +1454,17 @@ void engine_make_hierarchical_tasks_hydro(struct engine *e, struct cell *c,
   const int with_csds = (e->policy & engine_policy_csds);
 #endif
 
+  /* Generate the task running all the loops and ghosts of a top-level cell
+   * at once, used instead of them on the steps where few of its particles
+   * are active. Only for pure hydro runs, as nothing else waits for the
+   * ghosts then. */
+  if (c->top == c && c->nodeID == e->nodeID && c->hydro.count > 0 &&
+      e->hydro_properties->fused_loops_max_active_fraction > 0.f &&
+      !with_stars && !with_sinks && !with_black_holes && !with_rt) {
+    c->hydro.fused = scheduler_addtask(s, task_type_hydro_fused,
+                                       task_subtype_none, 0, 0, c, NULL);
+  }
+
   /* Are we are the level where we create the stars' resort tasks?
    * If the tree is shallow, we need to do this at the super-level if the
    * super-level is above the level we want */
@@ -1532,6 +1543,14 @@ void engine_make_hierarchical_tasks_hydro(struct engine *e, struct cell *c,
           s, task_type_extra_ghost, task_subtype_none, 0, 0, c, NULL);
 #endif
 
+      /* The fused task of the top-level cell runs the loops and ghosts of
+       * this super-cell on the steps where they are not unskipped. */
+      if (c->top->hydro.fused != NULL) {
+        scheduler_addunlock(s, c->hydro.drift, c->top->hydro.fused);
+        scheduler_addunlock(s, c->hydro.sorts, c->top->hydro.fused);
+        scheduler_addunlock(s, c->top->hydro.fused, c->hydro.end_force);
+      }
+
       /* Stars */
       if (with_stars) {
         c->stars.drift = scheduler_addtask(s, task_type_drift_spart,
@@ -2010,6 +2029,77 @@ void engine_make_external_gravity_tasks(struct engine *e) {
   }
 }
 
+/**
+ * @brief Constructs the offsets of the top-level cells that a top-level cell
+ * can interact with in its long-range gravity task.
+ *
+ * All the top-level cells have the same size, so the cells within the mesh
+ * cut-off radius of any of them are at the same offsets. Each cell of the
+ * box is reached by at most one offset and the cell itself is left out.
+ * Without a periodic mesh the long-range tasks go over all the cells and no
+ * offsets are constructed.
+ *
+ * @param e The #engine.
+ */
+void engine_make_grav_long_range_offsets(struct engine *e) {
+
+  struct space *s = e->s;
+  const int cdim[3] = {s->cdim[0], s->cdim[1], s->cdim[2]};
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const struct cell *cells = s->cells_top;
+  const double max_distance = e->mesh->r_cut_max;
+  const double max_distance2 = max_distance * max_distance;
+
+  if (s->grav_long_range_offsets != NULL)
+    swift_free("grav_long_range_offsets", s->grav_long_range_offsets);
+  s->grav_long_range_offsets = NULL;
+  s->nr_grav_long_range_offsets = 0;
+
+  if (!e->mesh->periodic) return;
+
+  /* Range of offsets along each axis, beyond which the cells are further
+   * apart than the cut-off, and without going round the box twice */
+  int d_min[3], d_max[3];
+  for (int k = 0; k < 3; k++) {
+    const int delta = (int)(max_distance / cells[0].width[k]) + 1;
+    d_min[k] = max(-delta, -cdim[k] / 2);
+    d_max[k] = min(delta, cdim[k] - 1 - cdim[k] / 2);
+  }
+
+  const int size = (d_max[0] - d_min[0] + 1) * (d_max[1] - d_min[1] + 1) *
+                   (d_max[2] - d_min[2] + 1);
+  if ((s->grav_long_range_offsets = (int *)swift_malloc(
+           "grav_long_range_offsets", 3 * size * sizeof(int))) == NULL)
+    error("Failed to allocate the long-range gravity offsets.");
+
+  for (int i = d_min[0]; i <= d_max[0]; i++) {
+    for (int j = d_min[1]; j <= d_max[1]; j++) {
+      for (int k = d_min[2]; k <= d_max[2]; k++) {
+
+        if (i == 0 && j == 0 && k == 0) continue;
+
+        const int cjd = cell_getid(cdim, (i + cdim[0]) % cdim[0],
+                                   (j + cdim[1]) % cdim[1],
+                                   (k + cdim[2]) % cdim[2]);
+
+        /* Are we beyond the distance where the truncated forces are 0 ?*/
+        if (cell_min_dist2_same_size(&cells[0], &cells[cjd], /*periodic=*/1,
+                                     dim) > max_distance2)
+          continue;
+
+        const int n = s->nr_grav_long_range_offsets++;
+        s->grav_long_range_offsets[3 * n + 0] = i;
+        s->grav_long_range_offsets[3 * n + 1] = j;
+        s->grav_long_range_offsets[3 * n + 2] = k;
+      }
+    }
+  }
+
+  if (e->verbose)
+    message("Have %d top-level cells within the mesh cut-off (total=%d)",
+            s->nr_grav_long_range_offsets, s->nr_cells);
+}
+
 /**
  * @brief Counts the tasks associated with one cell and constructs the links
  *
@@ -2336,6 +2426,34 @@ static inline void engine_make_hydro_loops_dependencies(
 
 #endif
 
+/**
+ * @brief Makes the fused hydro tasks of the top-level cells of a pair of
+ * local cells depend on the drift and sorts of the other super-cell.
+ *
+ * @param sched The #scheduler.
+ * @param ci The first #cell of the pair.
+ * @param cj The second #cell of the pair.
+ * @param nodeID The rank of this node.
+ */
+static inline void engine_make_hydro_fused_dependencies(
+    struct scheduler *sched, const struct cell *ci, const struct cell *cj,
+    const int nodeID) {
+
+  struct cell *super_i = ci->hydro.super;
+  struct cell *super_j = cj->hydro.super;
+  if (ci->top == cj->top || ci->nodeID != nodeID || cj->nodeID != nodeID)
+    return;
+
+  if (ci->top->hydro.fused != NULL) {
+    scheduler_addunlock(sched, super_j->hydro.drift, ci->top->hydro.fused);
+    scheduler_addunlock(sched, super_j->hydro.sorts, ci->top->hydro.fused);
+  }
+  if (cj->top->hydro.fused != NULL) {
+    scheduler_addunlock(sched, super_i->hydro.drift, cj->top->hydro.fused);
+    scheduler_addunlock(sched, super_i->hydro.sorts, cj->top->hydro.fused);
+  }
+}
+
 /**
  * @brief Duplicates the first hydro loop and construct all the
  * dependencies for the hydro part
@@ -2685,6 +2803,7 @@ void engine_make_extra_hydroloop_tasks_mapper(void *map_data, int num_elements,
       if (ci->hydro.super != cj->hydro.super) {
         scheduler_addunlock(sched, cj->hydro.super->hydro.sorts, t);
       }
+      engine_make_hydro_fused_dependencies(sched, ci, cj, nodeID);
 
       /* New task for the force */
       t_force = scheduler_addtask(sched, task_type_pair, task_subtype_force,
@@ -3504,6 +3623,7 @@ void engine_make_extra_hydroloop_tasks_mapper(void *map_data, int num_elements,
       if (ci->hydro.super != cj->hydro.super) {
         scheduler_addunlock(sched, cj->hydro.super->hydro.sorts, t);
       }
+      engine_make_hydro_fused_dependencies(sched, ci, cj, nodeID);
 
       /* New task for the force */
       t_force = scheduler_addtask(sched, task_type_sub_pair, task_subtype_force,
@@ -4496,6 +4616,7 @@ void engine_maketasks(struct engine *e) {
   if (e->policy & engine_policy_self_gravity) {
     threadpool_map(&e->threadpool, engine_make_self_gravity_tasks_mapper, NULL,
                    s->nr_cells, 1, threadpool_auto_chunk_size, e);
+    engine_make_grav_long_range_offsets(e);
   }
 
   if (e->verbose)
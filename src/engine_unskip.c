@@ -90,6 +90,9 @@ static void engine_do_unskip_hydro(struct cell *c, struct engine *e) {
   if (!cell_is_active_hydro(c, e)) return;
 #endif
 
+  /* Choose how to run the hydro loops before unskipping any of them. */
+  if (c->top == c) cell_set_hydro_fused(c, e);
+
   /* Recurse */
   if (c->split) {
     for (int k = 0; k < 8; k++) {
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_GHOST_NGB_LIST_H
+#define SWIFT_GHOST_NGB_LIST_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <stdlib.h>
+
+/* Local includes. */
+#include "error.h"
+#include "inline.h"
+
+/* Forward declarations. */
+struct part;
+
+/**
+ * @brief Candidate neighbours of the particles of a cell whose smoothing
+ * lengths have not converged in the ghost.
+ *
+ * The particles do not move while the ghost iterates, so the candidates are
+ * gathered once, over a radius a bit larger than the kernel support, and
+ * their separations are stored along with them.
+ */
+struct ghost_ngb_list {
+
+  /*! First candidate and number of candidates of each particle of the cell */
+  int *first, *num;
+
+  /*! Largest smoothing length for which the candidates of each particle of
+   * the cell are complete, 0 if it has none */
+  float *h_max;
+
+  /*! The candidates */
+  struct part **parts;
+
+  /*! Separations between the particles and their candidates, 3 per
+   * candidate */
+  float *dx;
+
+  /*! Number of candidates stored, and room for */
+  int size, size_alloc;
+
+  /*! Maximal number of candidates */
+  int max_size;
+};
+
+/**
+ * @brief Allocates the candidate lists of the particles of a cell.
+ *
+ * @param l The #ghost_ngb_list.
+ * @param count The number of particles in the cell.
+ * @param max_size The maximal number of candidates.
+ */
+__attribute__((always_inline)) INLINE static void ghost_ngb_list_init(
+    struct ghost_ngb_list *l, const int count, const int max_size) {
+
+  if ((l->first = (int *)malloc(sizeof(int) * count)) == NULL ||
+      (l->num = (int *)calloc(count, sizeof(int))) == NULL ||
+      (l->h_max = (float *)calloc(count, sizeof(float))) == NULL)
+    error("Can't allocate memory for the ghost neighbour lists.");
+  l->parts = NULL;
+  l->dx = NULL;
+  l->size = 0;
+  l->size_alloc = 0;
+  l->max_size = max_size;
+}
+
+/**
+ * @brief Adds a candidate to the lists, growing them up to their maximal
+ * size.
+ *
+ * @param l The #ghost_ngb_list.
+ * @param pj The candidate.
+ * @param dx The separation between the particle and the candidate.
+ *
+ * @return 0 if the lists are full, 1 otherwise.
+ */
+__attribute__((always_inline)) INLINE static int ghost_ngb_list_add(
+    struct ghost_ngb_list *l, struct part *pj, const float dx[3]) {
+
+  if (l->size == l->size_alloc) {
+    if (l->size_alloc == l->max_size) return 0;
+    int size_new = l->size_alloc > 0 ? 2 * l->size_alloc : 1024;
+    if (size_new > l->max_size) size_new = l->max_size;
+    if ((l->parts = (struct part **)realloc(
+             l->parts, sizeof(struct part *) * size_new)) == NULL ||
+        (l->dx = (float *)realloc(l->dx, sizeof(float) * 3 * size_new)) ==
+            NULL)
+      error("Can't allocate memory for the ghost neighbour lists.");
+    l->size_alloc = size_new;
+  }
+
+  l->parts[l->size] = pj;
+  l->dx[3 * l->size + 0] = dx[0];
+  l->dx[3 * l->size + 1] = dx[1];
+  l->dx[3 * l->size + 2] = dx[2];
+  l->size++;
+  return 1;
+}
+
+/**
+ * @brief Frees the candidate lists.
+ *
+ * @param l The #ghost_ngb_list.
+ */
+__attribute__((always_inline)) INLINE static void ghost_ngb_list_clean(
+    struct ghost_ngb_list *l) {
+
+  free(l->first);
+  free(l->num);
+  free(l->h_max);
+  free(l->parts);
+  free(l->dx);
+}
+
+#endif /* SWIFT_GHOST_NGB_LIST_H */
@@ -201,7 +201,12 @@ potential_derivatives_flip_signs(struct potential_derivatives_M2L *pot) {
 
 /**
  * @brief Compute all the relevent derivatives of the softened and truncated
- * gravitational potential for the M2L kernel.
+ * gravitational potential for the M2L kernel, given the derivatives of the
+ * long-range truncation function.
+ *
+ * These are only needed in the periodic un-softened case, but can be computed
+ * for all the cases beforehand, e.g. to keep function calls out of
+ * vectorized loops.
  *
  * @param r_x x-component of distance vector
  * @param r_y y-component of distance vector
@@ -210,15 +215,15 @@ potential_derivatives_flip_signs(struct potential_derivatives_M2L *pot) {
  * @param r_inv Inverse norm of distance vector
  * @param eps Softening length.
  * @param periodic Is the calculation periodic ?
- * @param r_s_inv Inverse of the long-range gravity mesh smoothing length.
+ * @param derivs The derivatives of the truncation function at r.
  * @param pot (return) The structure containing all the derivatives.
  */
 __attribute__((always_inline, nonnull)) INLINE static void
-potential_derivatives_compute_M2L(const float r_x, const float r_y,
-                                  const float r_z, const float r2,
-                                  const float r_inv, const float eps,
-                                  const int periodic, const float r_s_inv,
-                                  struct potential_derivatives_M2L *pot) {
+potential_derivatives_compute_M2L_chi(
+    const float r_x, const float r_y, const float r_z, const float r2,
+    const float r_inv, const float eps, const int periodic,
+    const struct chi_derivatives *derivs,
+    struct potential_derivatives_M2L *pot) {
 
   float Dt_1;
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 0
@@ -295,36 +300,31 @@ potential_derivatives_compute_M2L(const float r_x, const float r_y,
     /* Truncated case (long-range) */
   } else {
 
-    /* Get the derivatives of the truncated potential */
-    const float r = r2 * r_inv;
-    struct chi_derivatives derivs;
-    kernel_long_grav_derivatives(r, r_s_inv, &derivs);
-
-    Dt_1 = derivs.chi_0 * r_inv;
+    Dt_1 = derivs->chi_0 * r_inv;
 
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 0
 
     /* -chi^0 r_i^2 + chi^1 r_i^1 */
-    Dt_2 = derivs.chi_1 - derivs.chi_0 * r_inv;
+    Dt_2 = derivs->chi_1 - derivs->chi_0 * r_inv;
     Dt_2 = Dt_2 * r_inv;
 
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 1
 
     /* 3chi^0 r_i^3 - 3 chi^1 r_i^2 + chi^2 r_i^1 */
-    Dt_3 = derivs.chi_0 * r_inv - derivs.chi_1;
+    Dt_3 = derivs->chi_0 * r_inv - derivs->chi_1;
     Dt_3 = Dt_3 * 3.f;
-    Dt_3 = Dt_3 * r_inv + derivs.chi_2;
+    Dt_3 = Dt_3 * r_inv + derivs->chi_2;
     Dt_3 = Dt_3 * r_inv;
 
 #endif
 #if SELF_GRAVITY_MULTIPOLE_ORDER > 2
 
     /* -15chi^0 r_i^4 + 15 chi^1 r_i^3 - 6 chi^2 r_i^2  + chi^3 r_i^1 */
-    Dt_4 = -derivs.chi_0 * r_inv + derivs.chi_1;
+    Dt_4 = -derivs->chi_0 * r_inv + derivs->chi_1;
     Dt_4 = Dt_4 * 15.f;
-    Dt_4 = Dt_4 * r_inv - 6.f * derivs.chi_2;
-    Dt_4 = Dt_4 * r_inv + derivs.chi_3;
+    Dt_4 = Dt_4 * r_inv - 6.f * derivs->chi_2;
+    Dt_4 = Dt_4 * r_inv + derivs->chi_3;
     Dt_4 = Dt_4 * r_inv;
 
 #endif
@@ -332,11 +332,11 @@ potential_derivatives_compute_M2L(const float r_x, const float r_y,
 
     /* 105chi^0 r_i^5 - 105 chi^1 r_i^4 + 45 chi^2 r_i^3 - 10 chi^3 r_i^2 +
      * chi^4 r_i^1 */
-    Dt_5 = derivs.chi_0 * r_inv - derivs.chi_1;
+    Dt_5 = derivs->chi_0 * r_inv - derivs->chi_1;
     Dt_5 = Dt_5 * 105.f;
-    Dt_5 = Dt_5 * r_inv + 45.f * derivs.chi_2;
-    Dt_5 = Dt_5 * r_inv - 10.f * derivs.chi_3;
-    Dt_5 = Dt_5 * r_inv + derivs.chi_4;
+    Dt_5 = Dt_5 * r_inv + 45.f * derivs->chi_2;
+    Dt_5 = Dt_5 * r_inv - 10.f * derivs->chi_3;
+    Dt_5 = Dt_5 * r_inv + derivs->chi_4;
     Dt_5 = Dt_5 * r_inv;
 
 #endif
@@ -344,12 +344,12 @@ potential_derivatives_compute_M2L(const float r_x, const float r_y,
 
     /* -945chi^0 r_i^6 + 945 chi^1 r_i^5 - 420 chi^2 r_i^4 + 105 chi^3 r_i^3 -
      * 15 chi^4 r_i^2 + chi^5 r_i^1 */
-    Dt_6 = -derivs.chi_0 * r_inv + derivs.chi_1;
+    Dt_6 = -derivs->chi_0 * r_inv + derivs->chi_1;
     Dt_6 = Dt_6 * 945.f;
-    Dt_6 = Dt_6 * r_inv - 420.f * derivs.chi_2;
-    Dt_6 = Dt_6 * r_inv + 105.f * derivs.chi_3;
-    Dt_6 = Dt_6 * r_inv - 15.f * derivs.chi_4;
-    Dt_6 = Dt_6 * r_inv + derivs.chi_5;
+    Dt_6 = Dt_6 * r_inv - 420.f * derivs->chi_2;
+    Dt_6 = Dt_6 * r_inv + 105.f * derivs->chi_3;
+    Dt_6 = Dt_6 * r_inv - 15.f * derivs->chi_4;
+    Dt_6 = Dt_6 * r_inv + derivs->chi_5;
     Dt_6 = Dt_6 * r_inv;
 
 #endif
@@ -495,6 +495,38 @@ potential_derivatives_compute_M2L(const float r_x, const float r_y,
 #endif
 }
 
+/**
+ * @brief Compute all the relevent derivatives of the softened and truncated
+ * gravitational potential for the M2L kernel.
+ *
+ * @param r_x x-component of distance vector
+ * @param r_y y-component of distance vector
+ * @param r_z z-component of distance vector
+ * @param r2 Square norm of distance vector
+ * @param r_inv Inverse norm of distance vector
+ * @param eps Softening length.
+ * @param periodic Is the calculation periodic ?
+ * @param r_s_inv Inverse of the long-range gravity mesh smoothing length.
+ * @param pot (return) The structure containing all the derivatives.
+ */
+__attribute__((always_inline, nonnull)) INLINE static void
+potential_derivatives_compute_M2L(const float r_x, const float r_y,
+                                  const float r_z, const float r2,
+                                  const float r_inv, const float eps,
+                                  const int periodic, const float r_s_inv,
+                                  struct potential_derivatives_M2L *pot) {
+
+  /* Get the derivatives of the truncated potential, if needed */
+  struct chi_derivatives derivs;
+  if (periodic && r2 >= eps * eps) {
+    const float r = r2 * r_inv;
+    kernel_long_grav_derivatives(r, r_s_inv, &derivs);
+  }
+
+  potential_derivatives_compute_M2L_chi(r_x, r_y, r_z, r2, r_inv, eps,
+                                        periodic, &derivs, pot);
+}
+
 /**
  * @brief Compute all the relevent derivatives of the softened and truncated
  * gravitational potential for the M2P kernel.
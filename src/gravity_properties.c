@@ -41,6 +41,7 @@
 #define gravity_props_default_rebuild_frequency 0.01f
 #define gravity_props_default_rebuild_active_fraction 1.01f  // > 1 means never
 #define gravity_props_default_distributed_mesh 0
+#define gravity_props_default_mesh_window_order 2
 
 void gravity_props_init(struct gravity_props *p, struct swift_params *params,
                         const struct phys_const *phys_const,
@@ -69,8 +70,19 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
     p->distributed_mesh =
         parser_get_opt_param_int(params, "Gravity:distributed_mesh",
                                  gravity_props_default_distributed_mesh);
+    p->distributed_mesh_uses_pencils = parser_get_opt_param_int(
+        params, "Gravity:distributed_mesh_uses_pencils", 0);
+    p->distributed_mesh_single_precision = parser_get_opt_param_int(
+        params, "Gravity:distributed_mesh_single_precision", 0);
     p->mesh_uses_local_patches =
         parser_get_opt_param_int(params, "Gravity:mesh_uses_local_patches", 1);
+    p->mesh_uses_slabs =
+        parser_get_opt_param_int(params, "Gravity:mesh_uses_slabs", 0);
+    p->mesh_window_order =
+        parser_get_opt_param_int(params, "Gravity:mesh_window_order",
+                                 gravity_props_default_mesh_window_order);
+    p->mesh_uses_interlacing =
+        parser_get_opt_param_int(params, "Gravity:mesh_uses_interlacing", 0);
     p->a_smooth = parser_get_opt_param_float(params, "Gravity:a_smooth",
                                              gravity_props_default_a_smooth);
     p->r_cut_max_ratio = parser_get_opt_param_float(
@@ -88,13 +100,43 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
     if (p->a_smooth <= 0.)
       error("The mesh smoothing scale 'a_smooth' must be > 0.");
 
+    if (p->mesh_window_order < 2 || p->mesh_window_order > 4)
+      error(
+          "The mesh window order must be 2 (CIC), 3 (TSC) or 4 (PCS), not %d.",
+          p->mesh_window_order);
+
+    if (p->distributed_mesh &&
+        (p->mesh_window_order != 2 || p->mesh_uses_interlacing))
+      error(
+          "The distributed mesh only supports CIC assignment without "
+          "interlacing.");
+
+    if (p->distributed_mesh_single_precision &&
+        !p->distributed_mesh_uses_pencils)
+      error(
+          "The distributed mesh can only use single precision with pencils.");
+
 #if !defined(WITH_MPI) || !defined(HAVE_MPI_FFTW)
-    if (p->distributed_mesh)
+    if (p->distributed_mesh && !p->distributed_mesh_uses_pencils)
       error(
           "Need to use MPI and FFTW MPI library to run with "
           "distributed_mesh=1.");
 #endif
 
+#if !defined(WITH_MPI) || !defined(HAVE_FFTW)
+    if (p->distributed_mesh)
+      error(
+          "Need to use MPI and FFTW library to run with "
+          "distributed_mesh=1 and distributed_mesh_uses_pencils=1.");
+#endif
+
+#ifndef HAVE_FLOAT_FFTW
+    if (p->distributed_mesh && p->distributed_mesh_single_precision)
+      error(
+          "Need the single precision FFTW library to run with "
+          "distributed_mesh_single_precision=1.");
+#endif
+
     if (2. * p->a_smooth * p->r_cut_max_ratio > p->mesh_size)
       error("Mesh too small given r_cut_max. Should be at least %d cells wide.",
             (int)(2. * p->a_smooth * p->r_cut_max_ratio) + 1);
@@ -108,6 +150,11 @@ void gravity_props_init(struct gravity_props *p, struct swift_params *params,
   } else {
     p->mesh_size = 0;
     p->distributed_mesh = 0;
+    p->distributed_mesh_uses_pencils = 0;
+    p->distributed_mesh_single_precision = 0;
+    p->mesh_uses_slabs = 0;
+    p->mesh_window_order = 0;
+    p->mesh_uses_interlacing = 0;
     p->a_smooth = 0.f;
     p->r_s = FLT_MAX;
     p->r_s_inv = 0.f;
@@ -348,6 +395,12 @@ void gravity_props_print(const struct gravity_props *p) {
   message("Self-gravity mesh side-length: N=%d", p->mesh_size);
   message("Self-gravity mesh smoothing-scale: a_smooth=%f", p->a_smooth);
   message("Self-gravity distributed mesh enabled: %d", p->distributed_mesh);
+  if (p->distributed_mesh)
+    message("Self-gravity distributed mesh pencils: %d, single precision: %d",
+            p->distributed_mesh_uses_pencils,
+            p->distributed_mesh_single_precision);
+  message("Self-gravity mesh window order: %d, interlacing: %d",
+          p->mesh_window_order, p->mesh_uses_interlacing);
 
   message("Self-gravity tree cut-off ratio: r_cut_max=%f", p->r_cut_max_ratio);
   message("Self-gravity truncation cut-off ratio: r_cut_min=%f",
@@ -124,10 +124,30 @@ struct gravity_props {
   /*! Whether mesh is distributed between MPI ranks when we use MPI  */
   int distributed_mesh;
 
+  /*! Whether the distributed mesh is decomposed in pencils rather than in
+   * slabs, which needs FFTW but not its MPI library */
+  int distributed_mesh_uses_pencils;
+
+  /*! Whether the FFTs of the distributed mesh pencils are done in single
+   * precision */
+  int distributed_mesh_single_precision;
+
   /*! Whether or not to use local patches rather than
    * direct atomic writes to the mesh when running without MPI */
   int mesh_uses_local_patches;
 
+  /*! Whether or not to assign the particles to the mesh slab by slab rather
+   * than with atomic writes or local patches when running without MPI */
+  int mesh_uses_slabs;
+
+  /*! Order of the mass assignment window of the mesh: 2 (CIC), 3 (TSC) or
+   * 4 (PCS) */
+  int mesh_window_order;
+
+  /*! Whether or not to also assign the particles to a mesh shifted by half a
+   * cell to reduce the aliasing */
+  int mesh_uses_interlacing;
+
   /*! Mesh smoothing scale in units of top-level cell size */
   float a_smooth;
 
@@ -728,10 +728,10 @@ runner_iact_nonsym_1_vec_force(
     vector *r2, vector *dx, vector *dy, vector *dz, vector vix, vector viy,
     vector viz, vector pirho, vector grad_hi, vector piPOrho2, vector balsara_i,
     vector ci, float *Vjx, float *Vjy, float *Vjz, float *Pjrho, float *Grad_hj,
-    float *PjPOrho2, float *Balsara_j, float *Cj, float *Mj, vector hi_inv,
-    vector hj_inv, const float a, const float H, vector *a_hydro_xSum,
-    vector *a_hydro_ySum, vector *a_hydro_zSum, vector *h_dtSum,
-    vector *v_sigSum, vector *entropy_dtSum, mask_t mask) {
+    float *PjPOrho2, half_float *Balsara_j, float *Cj, float *Mj,
+    vector hi_inv, vector hj_inv, const float a, const float H,
+    vector *a_hydro_xSum, vector *a_hydro_ySum, vector *a_hydro_zSum,
+    vector *h_dtSum, vector *v_sigSum, vector *entropy_dtSum, mask_t mask) {
 
 #ifdef WITH_VECTORIZATION
 
@@ -754,7 +754,7 @@ runner_iact_nonsym_1_vec_force(
   const vector pjrho = vector_load(Pjrho);
   const vector grad_hj = vector_load(Grad_hj);
   const vector pjPOrho2 = vector_load(PjPOrho2);
-  const vector balsara_j = vector_load(Balsara_j);
+  const vector balsara_j = vector_load_half(Balsara_j);
   const vector cj = vector_load(Cj);
 
   /* Cosmological terms */
@@ -863,11 +863,11 @@ runner_iact_nonsym_2_vec_force(
     float *R2, float *Dx, float *Dy, float *Dz, vector vix, vector viy,
     vector viz, vector pirho, vector grad_hi, vector piPOrho2, vector balsara_i,
     vector ci, float *Vjx, float *Vjy, float *Vjz, float *Pjrho, float *Grad_hj,
-    float *PjPOrho2, float *Balsara_j, float *Cj, float *Mj, vector hi_inv,
-    float *Hj_inv, const float a, const float H, vector *a_hydro_xSum,
-    vector *a_hydro_ySum, vector *a_hydro_zSum, vector *h_dtSum,
-    vector *v_sigSum, vector *entropy_dtSum, mask_t mask, mask_t mask_2,
-    short mask_cond) {
+    float *PjPOrho2, half_float *Balsara_j, float *Cj, float *Mj,
+    vector hi_inv, float *Hj_inv, const float a, const float H,
+    vector *a_hydro_xSum, vector *a_hydro_ySum, vector *a_hydro_zSum,
+    vector *h_dtSum, vector *v_sigSum, vector *entropy_dtSum, mask_t mask,
+    mask_t mask_2, short mask_cond) {
 
 #ifdef WITH_VECTORIZATION
 
@@ -924,8 +924,8 @@ runner_iact_nonsym_2_vec_force(
   const vector grad_hj_2 = vector_load(&Grad_hj[VEC_SIZE]);
   const vector pjPOrho2 = vector_load(PjPOrho2);
   const vector pjPOrho2_2 = vector_load(&PjPOrho2[VEC_SIZE]);
-  const vector balsara_j = vector_load(Balsara_j);
-  const vector balsara_j_2 = vector_load(&Balsara_j[VEC_SIZE]);
+  const vector balsara_j = vector_load_half(Balsara_j);
+  const vector balsara_j_2 = vector_load_half(&Balsara_j[VEC_SIZE]);
   const vector cj = vector_load(Cj);
   const vector cj_2 = vector_load(&Cj[VEC_SIZE]);
   const vector hj_inv = vector_load(Hj_inv);
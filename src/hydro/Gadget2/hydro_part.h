@@ -224,4 +224,24 @@ struct part {
 
 } SWIFT_STRUCT_ALIGN;
 
+/**
+ * @brief The fields of a #part copied to the #cache of the vectorized
+ * interaction loops, on top of the positions, smoothing lengths, masses and
+ * velocities.
+ *
+ * Each entry is FIELD(name of the cache array, member of the #part).
+ */
+#define HYDRO_CACHE_FIELDS(FIELD)     \
+  FIELD(rho, rho)                     \
+  FIELD(grad_h, force.f)              \
+  FIELD(pOrho2, force.P_over_rho2)    \
+  FIELD(soundspeed, force.soundspeed)
+
+/**
+ * @brief The fields of a #part copied to the #cache that only feed the
+ * viscosity switch, stored as #half_float when configured with
+ * --enable-half-precision-caches.
+ */
+#define HYDRO_CACHE_HALF_FIELDS(FIELD) FIELD(balsara, force.balsara)
+
 #endif /* SWIFT_GADGET2_HYDRO_PART_H */
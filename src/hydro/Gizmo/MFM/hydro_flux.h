@@ -83,6 +83,22 @@ __attribute__((always_inline)) INLINE static void hydro_compute_flux(
   fluxes[4] *= Anorm;
 }
 
+/**
+ * @brief Compute the fluxes for all the Riemann problems of a #riemann_batch,
+ * as hydro_compute_flux() does for a single one.
+ *
+ * @param b The #riemann_batch.
+ * @param Anorm Surface areas of the interfaces.
+ */
+__attribute__((always_inline)) INLINE static void hydro_compute_flux_batch(
+    struct riemann_batch* restrict b, const float* restrict Anorm) {
+
+  riemann_solve_batch_for_middle_state_flux(b);
+
+  for (int k = 1; k < 5; k++)
+    for (int i = 0; i < b->count; i++) b->totflux[k][i] *= Anorm[i];
+}
+
 /**
  * @brief Update the fluxes for the particle with the given contributions,
  * assuming the particle is to the left of the interparticle interface.
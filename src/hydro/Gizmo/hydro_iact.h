@@ -188,19 +188,12 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_gradient(
 }
 
 /**
- * @brief Common part of the flux calculation between particle i and j
- *
- * Since the only difference between the symmetric and non-symmetric version
- * of the flux calculation  is in the update of the conserved variables at the
- * very end (which is not done for particle j if mode is 0), both
- * runner_iact_force and runner_iact_nonsym_force call this method, with an
- * appropriate mode.
+ * @brief Set up the Riemann problem at the interface between particle i and j
  *
  * This method calculates the surface area of the interface between particle i
  * and particle j, as well as the interface position and velocity. These are
- * then used to reconstruct and predict the primitive variables, which are then
- * fed to a Riemann solver that calculates a flux. This flux is used to update
- * the conserved variables of particle i or both particles.
+ * then used to reconstruct and predict the primitive variables, which are the
+ * input of the Riemann problem.
  *
  * This method also calculates the maximal velocity used to calculate the time
  * step.
@@ -212,13 +205,21 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_gradient(
  * @param hj Comoving smoothing-length of particle j.
  * @param pi Particle i.
  * @param pj Particle j.
+ * @param mode 1 to also update particle j, 0 otherwise.
  * @param a Current scale factor.
  * @param H Current Hubble parameter.
+ * @param Wi (return) Left state of the Riemann problem.
+ * @param Wj (return) Right state of the Riemann problem.
+ * @param n_unit (return) Unit vector of the interface.
+ * @param vij (return) Velocity of the interface.
+ * @param area (return) Surface area of the interface.
+ * @return 0 if the interface has no area, so that there is no flux.
  */
-__attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
+__attribute__((always_inline)) INLINE static int runner_iact_fluxes_interface(
     const float r2, const float dx[3], const float hi, const float hj,
     struct part *restrict pi, struct part *restrict pj, int mode, const float a,
-    const float H) {
+    const float H, float Wi[5], float Wj[5], float n_unit[3], float vij[3],
+    float *area) {
 
   /* Get r and 1/r. */
   const float r = sqrtf(r2);
@@ -238,7 +239,6 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
   }
   const float Vi = pi->geometry.volume;
   const float Vj = pj->geometry.volume;
-  float Wi[5], Wj[5];
   hydro_part_get_primitive_variables(pi, Wi);
   hydro_part_get_primitive_variables(pj, Wj);
 
@@ -341,12 +341,12 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
   /* if the interface has no area, nothing happens and we return */
   /* continuing results in dividing by zero and NaN's... */
   if (Anorm2 == 0.0f) {
-    return;
+    return 0;
   }
 
   /* Compute the area */
   const float Anorm_inv = 1.0f / sqrtf(Anorm2);
-  const float Anorm = Anorm2 * Anorm_inv;
+  *area = Anorm2 * Anorm_inv;
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* For stability reasons, we do require A and dx to have opposite
@@ -360,13 +360,14 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
   const float rdim = pow_dimension(r);
   if (dA_dot_dx > 1.e-6f * rdim) {
     message("Ill conditioned gradient matrix (%g %g %g %g %g)!", dA_dot_dx,
-            Anorm, Vi, Vj, r);
+            *area, Vi, Vj, r);
   }
 #endif
 
   /* compute the normal vector of the interface */
-  const float n_unit[3] = {A[0] * Anorm_inv, A[1] * Anorm_inv,
-                           A[2] * Anorm_inv};
+  n_unit[0] = A[0] * Anorm_inv;
+  n_unit[1] = A[1] * Anorm_inv;
+  n_unit[2] = A[2] * Anorm_inv;
 
   /* Compute interface position (relative to pi, since we don't need the actual
    * position) eqn. (8) */
@@ -375,9 +376,9 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
 
   /* Compute interface velocity */
   /* eqn. (9) */
-  const float vij[3] = {vi[0] + (vi[0] - vj[0]) * xfac,
-                        vi[1] + (vi[1] - vj[1]) * xfac,
-                        vi[2] + (vi[2] - vj[2]) * xfac};
+  vij[0] = vi[0] + (vi[0] - vj[0]) * xfac;
+  vij[1] = vi[1] + (vi[1] - vj[1]) * xfac;
+  vij[2] = vi[2] + (vi[2] - vj[2]) * xfac;
 
   /* complete calculation of position of interface */
   /* NOTE: dx is not necessarily just pi->x - pj->x but can also contain
@@ -403,8 +404,25 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
   /* we don't need to rotate, we can use the unit vector in the Riemann problem
    * itself (see GIZMO) */
 
-  float totflux[5];
-  hydro_compute_flux(Wi, Wj, n_unit, vij, Anorm, totflux);
+  return 1;
+}
+
+/**
+ * @brief Exchange the flux through the interface between particle i and j
+ *
+ * The flux is used to update the conserved variables of particle i or both
+ * particles.
+ *
+ * @param dx Comoving distance vector between the particles (dx = pi->x -
+ * pj->x).
+ * @param pi Particle i.
+ * @param pj Particle j.
+ * @param mode 1 to also update particle j, 0 otherwise.
+ * @param totflux Flux through the interface.
+ */
+__attribute__((always_inline)) INLINE static void runner_iact_fluxes_exchange(
+    const float dx[3], struct part *restrict pi, struct part *restrict pj,
+    int mode, const float totflux[5]) {
 
   /* get the time step for the flux exchange. This is always the smallest time
      step among the two particles */
@@ -426,6 +444,45 @@ __attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
   rt_part_update_mass_fluxes(pi, pj, totflux[0], mode);
 }
 
+/**
+ * @brief Common part of the flux calculation between particle i and j
+ *
+ * Since the only difference between the symmetric and non-symmetric version
+ * of the flux calculation  is in the update of the conserved variables at the
+ * very end (which is not done for particle j if mode is 0), both
+ * runner_iact_force and runner_iact_nonsym_force call this method, with an
+ * appropriate mode.
+ *
+ * The Riemann problem at the interface is set up, fed to a Riemann solver that
+ * calculates a flux, and the flux is exchanged between the particles.
+ *
+ * @param r2 Comoving squared distance between particle i and particle j.
+ * @param dx Comoving distance vector between the particles (dx = pi->x -
+ * pj->x).
+ * @param hi Comoving smoothing-length of particle i.
+ * @param hj Comoving smoothing-length of particle j.
+ * @param pi Particle i.
+ * @param pj Particle j.
+ * @param mode 1 to also update particle j, 0 otherwise.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void runner_iact_fluxes_common(
+    const float r2, const float dx[3], const float hi, const float hj,
+    struct part *restrict pi, struct part *restrict pj, int mode, const float a,
+    const float H) {
+
+  float Wi[5], Wj[5], n_unit[3], vij[3], Anorm;
+  if (!runner_iact_fluxes_interface(r2, dx, hi, hj, pi, pj, mode, a, H, Wi, Wj,
+                                    n_unit, vij, &Anorm))
+    return;
+
+  float totflux[5];
+  hydro_compute_flux(Wi, Wj, n_unit, vij, Anorm, totflux);
+
+  runner_iact_fluxes_exchange(dx, pi, pj, mode, totflux);
+}
+
 /**
  * @brief Flux calculation between particle i and particle j
  *
@@ -473,4 +530,162 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_force(
   runner_iact_fluxes_common(r2, dx, hi, hj, pi, pj, 0, a, H);
 }
 
+/**
+ * @brief The interfaces of a force loop whose Riemann problems are solved
+ * together.
+ *
+ * The problems are queued by runner_iact_force_batch() and
+ * runner_iact_nonsym_force_batch(). Their fluxes are exchanged by
+ * hydro_flux_batch_flush() once the batch is full, and at the end of the
+ * loop.
+ */
+struct hydro_flux_batch {
+
+  /*! The Riemann problems at the interfaces */
+  struct riemann_batch riemann;
+
+  /*! Surface areas of the interfaces */
+  float Anorm[RIEMANN_BATCH_SIZE];
+
+  /*! Distance vectors between the particles */
+  float dx[RIEMANN_BATCH_SIZE][3];
+
+  /*! Particles on either side of the interfaces */
+  struct part *pi[RIEMANN_BATCH_SIZE];
+  struct part *pj[RIEMANN_BATCH_SIZE];
+
+  /*! Is particle j updated as well? */
+  int mode[RIEMANN_BATCH_SIZE];
+};
+
+/* The force loops of this scheme can use a #hydro_flux_batch. */
+#define HYDRO_FLUX_BATCH
+
+/**
+ * @brief Empty a #hydro_flux_batch.
+ *
+ * @param b The #hydro_flux_batch.
+ */
+__attribute__((always_inline)) INLINE static void hydro_flux_batch_init(
+    struct hydro_flux_batch *restrict b) {
+
+  riemann_batch_init(&b->riemann);
+}
+
+/**
+ * @brief Solve all the Riemann problems of a #hydro_flux_batch, exchange
+ * their fluxes between the particles and empty the batch.
+ *
+ * The fluxes are exchanged in the order in which the interfaces were queued,
+ * as runner_iact_fluxes_common() would have.
+ *
+ * @param b The #hydro_flux_batch.
+ */
+INLINE static void hydro_flux_batch_flush(struct hydro_flux_batch *restrict b) {
+
+  if (b->riemann.count == 0) return;
+
+  hydro_compute_flux_batch(&b->riemann, b->Anorm);
+
+  for (int i = 0; i < b->riemann.count; i++) {
+    float totflux[5];
+    riemann_batch_get_flux(&b->riemann, i, totflux);
+    runner_iact_fluxes_exchange(b->dx[i], b->pi[i], b->pj[i], b->mode[i],
+                                totflux);
+  }
+
+  riemann_batch_init(&b->riemann);
+}
+
+/**
+ * @brief Queue the Riemann problem between particle i and j in a
+ * #hydro_flux_batch, flushing the batch when it is full.
+ *
+ * @param b The #hydro_flux_batch.
+ * @param r2 Comoving squared distance between particle i and particle j.
+ * @param dx Comoving distance vector between the particles (dx = pi->x -
+ * pj->x).
+ * @param hi Comoving smoothing-length of particle i.
+ * @param hj Comoving smoothing-length of particle j.
+ * @param pi Particle i.
+ * @param pj Particle j.
+ * @param mode 1 to also update particle j, 0 otherwise.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void runner_iact_fluxes_batch(
+    struct hydro_flux_batch *restrict b, const float r2, const float dx[3],
+    const float hi, const float hj, struct part *restrict pi,
+    struct part *restrict pj, int mode, const float a, const float H) {
+
+  float Wi[5], Wj[5], n_unit[3], vij[3], Anorm;
+  if (!runner_iact_fluxes_interface(r2, dx, hi, hj, pi, pj, mode, a, H, Wi, Wj,
+                                    n_unit, vij, &Anorm))
+    return;
+
+  const int i = riemann_batch_add(&b->riemann, Wi, Wj, n_unit, vij);
+  b->Anorm[i] = Anorm;
+  b->dx[i][0] = dx[0];
+  b->dx[i][1] = dx[1];
+  b->dx[i][2] = dx[2];
+  b->pi[i] = pi;
+  b->pj[i] = pj;
+  b->mode[i] = mode;
+
+  if (b->riemann.count == RIEMANN_BATCH_SIZE) hydro_flux_batch_flush(b);
+}
+
+/**
+ * @brief Flux calculation between particle i and particle j, queued in a
+ * #hydro_flux_batch
+ *
+ * This method calls runner_iact_fluxes_batch with mode 1.
+ *
+ * @param b The #hydro_flux_batch.
+ * @param r2 Comoving squared distance between particle i and particle j.
+ * @param dx Comoving distance vector between the particles (dx = pi->x -
+ * pj->x).
+ * @param hi Comoving smoothing-length of particle i.
+ * @param hj Comoving smoothing-length of particle j.
+ * @param pi Particle i.
+ * @param pj Particle j.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void runner_iact_force_batch(
+    struct hydro_flux_batch *restrict b, const float r2, const float dx[3],
+    const float hi, const float hj, struct part *restrict pi,
+    struct part *restrict pj, const float a, const float H) {
+
+  runner_iact_fluxes_batch(b, r2, dx, hi, hj, pi, pj, 1, a, H);
+}
+
+/**
+ * @brief Flux calculation between particle i and particle j, queued in a
+ * #hydro_flux_batch: non-symmetric version
+ *
+ * This method calls runner_iact_fluxes_batch with mode 0.
+ *
+ * @param b The #hydro_flux_batch.
+ * @param r2 Comoving squared distance between particle i and particle j.
+ * @param dx Comoving distance vector between the particles (dx = pi->x -
+ * pj->x).
+ * @param hi Comoving smoothing-length of particle i.
+ * @param hj Comoving smoothing-length of particle j.
+ * @param pi Particle i.
+ * @param pj Particle j.
+ * @param a Current scale factor.
+ * @param H Current Hubble parameter.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_force_batch(struct hydro_flux_batch *restrict b,
+                               const float r2, const float dx[3],
+                               const float hi, const float hj,
+                               struct part *restrict pi,
+                               struct part *restrict pj, const float a,
+                               const float H) {
+
+  runner_iact_fluxes_batch(b, r2, dx, hi, hj, pi, pj, 0, a, H);
+}
+
 #endif /* SWIFT_GIZMO_HYDRO_IACT_H */
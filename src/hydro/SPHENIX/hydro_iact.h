@@ -27,6 +27,7 @@
  */
 
 #include "adiabatic_index.h"
+#include "cache.h"
 #include "hydro_parameters.h"
 #include "minmax.h"
 #include "signal_velocity.h"
@@ -177,6 +178,233 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_density(
 #endif
 }
 
+#ifdef WITH_VECTORIZATION
+
+/**
+ * @brief Density interaction computed using 1 vector
+ * (non-symmetric vectorized version).
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_1_vec_density(vector *r2, vector *dx, vector *dy, vector *dz,
+                                 vector hi_inv, vector vix, vector viy,
+                                 vector viz, float *Vjx, float *Vjy, float *Vjz,
+                                 float *Mj, vector *rhoSum, vector *rho_dhSum,
+                                 vector *wcountSum, vector *wcount_dhSum,
+                                 vector *div_vSum, vector *curlvxSum,
+                                 vector *curlvySum, vector *curlvzSum,
+                                 mask_t mask) {
+
+  vector r, ri, ui, wi, wi_dx;
+  vector dvx, dvy, dvz;
+  vector dvdr;
+  vector curlvrx, curlvry, curlvrz;
+
+  /* Fill the vectors. */
+  const vector mj = vector_load(Mj);
+  const vector vjx = vector_load(Vjx);
+  const vector vjy = vector_load(Vjy);
+  const vector vjz = vector_load(Vjz);
+
+  /* Get the radius and inverse radius. */
+  ri = vec_reciprocal_sqrt(*r2);
+  r.v = vec_mul(r2->v, ri.v);
+
+  ui.v = vec_mul(r.v, hi_inv.v);
+
+  /* Calculate the kernel for two particles. */
+  kernel_deval_1_vec(&ui, &wi, &wi_dx);
+
+  /* Compute dv. */
+  dvx.v = vec_sub(vix.v, vjx.v);
+  dvy.v = vec_sub(viy.v, vjy.v);
+  dvz.v = vec_sub(viz.v, vjz.v);
+
+  /* Compute dv dot r */
+  dvdr.v = vec_fma(dvx.v, dx->v, vec_fma(dvy.v, dy->v, vec_mul(dvz.v, dz->v)));
+  dvdr.v = vec_mul(dvdr.v, ri.v);
+
+  /* Compute dv cross r */
+  curlvrx.v =
+      vec_fma(dvy.v, dz->v, vec_mul(vec_set1(-1.0f), vec_mul(dvz.v, dy->v)));
+  curlvry.v =
+      vec_fma(dvz.v, dx->v, vec_mul(vec_set1(-1.0f), vec_mul(dvx.v, dz->v)));
+  curlvrz.v =
+      vec_fma(dvx.v, dy->v, vec_mul(vec_set1(-1.0f), vec_mul(dvy.v, dx->v)));
+  curlvrx.v = vec_mul(curlvrx.v, ri.v);
+  curlvry.v = vec_mul(curlvry.v, ri.v);
+  curlvrz.v = vec_mul(curlvrz.v, ri.v);
+
+  vector wcount_dh_update;
+  wcount_dh_update.v =
+      vec_fma(vec_set1(hydro_dimension), wi.v, vec_mul(ui.v, wi_dx.v));
+
+  /* Mask updates to intermediate vector sums for particle pi. */
+  rhoSum->v = vec_mask_add(rhoSum->v, vec_mul(mj.v, wi.v), mask);
+  rho_dhSum->v =
+      vec_mask_sub(rho_dhSum->v, vec_mul(mj.v, wcount_dh_update.v), mask);
+  wcountSum->v = vec_mask_add(wcountSum->v, wi.v, mask);
+  wcount_dhSum->v = vec_mask_sub(wcount_dhSum->v, wcount_dh_update.v, mask);
+  div_vSum->v =
+      vec_mask_sub(div_vSum->v, vec_mul(mj.v, vec_mul(dvdr.v, wi_dx.v)), mask);
+  curlvxSum->v = vec_mask_add(curlvxSum->v,
+                              vec_mul(mj.v, vec_mul(curlvrx.v, wi_dx.v)), mask);
+  curlvySum->v = vec_mask_add(curlvySum->v,
+                              vec_mul(mj.v, vec_mul(curlvry.v, wi_dx.v)), mask);
+  curlvzSum->v = vec_mask_add(curlvzSum->v,
+                              vec_mul(mj.v, vec_mul(curlvrz.v, wi_dx.v)), mask);
+}
+
+/**
+ * @brief Density interaction computed using 2 interleaved vectors
+ * (non-symmetric vectorized version).
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_2_vec_density(float *R2, float *Dx, float *Dy, float *Dz,
+                                 vector hi_inv, vector vix, vector viy,
+                                 vector viz, float *Vjx, float *Vjy, float *Vjz,
+                                 float *Mj, vector *rhoSum, vector *rho_dhSum,
+                                 vector *wcountSum, vector *wcount_dhSum,
+                                 vector *div_vSum, vector *curlvxSum,
+                                 vector *curlvySum, vector *curlvzSum,
+                                 mask_t mask, mask_t mask2, int mask_cond) {
+
+  vector r, ri, ui, wi, wi_dx;
+  vector dvx, dvy, dvz;
+  vector dvdr;
+  vector curlvrx, curlvry, curlvrz;
+  vector r_2, ri2, ui2, wi2, wi_dx2;
+  vector dvx2, dvy2, dvz2;
+  vector dvdr2;
+  vector curlvrx2, curlvry2, curlvrz2;
+
+  /* Fill the vectors. */
+  const vector mj = vector_load(Mj);
+  const vector mj2 = vector_load(&Mj[VEC_SIZE]);
+  const vector vjx = vector_load(Vjx);
+  const vector vjx2 = vector_load(&Vjx[VEC_SIZE]);
+  const vector vjy = vector_load(Vjy);
+  const vector vjy2 = vector_load(&Vjy[VEC_SIZE]);
+  const vector vjz = vector_load(Vjz);
+  const vector vjz2 = vector_load(&Vjz[VEC_SIZE]);
+  const vector dx = vector_load(Dx);
+  const vector dx2 = vector_load(&Dx[VEC_SIZE]);
+  const vector dy = vector_load(Dy);
+  const vector dy2 = vector_load(&Dy[VEC_SIZE]);
+  const vector dz = vector_load(Dz);
+  const vector dz2 = vector_load(&Dz[VEC_SIZE]);
+
+  /* Get the radius and inverse radius. */
+  const vector r2 = vector_load(R2);
+  const vector r2_2 = vector_load(&R2[VEC_SIZE]);
+  ri = vec_reciprocal_sqrt(r2);
+  ri2 = vec_reciprocal_sqrt(r2_2);
+  r.v = vec_mul(r2.v, ri.v);
+  r_2.v = vec_mul(r2_2.v, ri2.v);
+
+  ui.v = vec_mul(r.v, hi_inv.v);
+  ui2.v = vec_mul(r_2.v, hi_inv.v);
+
+  /* Calculate the kernel for two particles. */
+  kernel_deval_2_vec(&ui, &wi, &wi_dx, &ui2, &wi2, &wi_dx2);
+
+  /* Compute dv. */
+  dvx.v = vec_sub(vix.v, vjx.v);
+  dvx2.v = vec_sub(vix.v, vjx2.v);
+  dvy.v = vec_sub(viy.v, vjy.v);
+  dvy2.v = vec_sub(viy.v, vjy2.v);
+  dvz.v = vec_sub(viz.v, vjz.v);
+  dvz2.v = vec_sub(viz.v, vjz2.v);
+
+  /* Compute dv dot r */
+  dvdr.v = vec_fma(dvx.v, dx.v, vec_fma(dvy.v, dy.v, vec_mul(dvz.v, dz.v)));
+  dvdr2.v =
+      vec_fma(dvx2.v, dx2.v, vec_fma(dvy2.v, dy2.v, vec_mul(dvz2.v, dz2.v)));
+  dvdr.v = vec_mul(dvdr.v, ri.v);
+  dvdr2.v = vec_mul(dvdr2.v, ri2.v);
+
+  /* Compute dv cross r */
+  curlvrx.v =
+      vec_fma(dvy.v, dz.v, vec_mul(vec_set1(-1.0f), vec_mul(dvz.v, dy.v)));
+  curlvrx2.v =
+      vec_fma(dvy2.v, dz2.v, vec_mul(vec_set1(-1.0f), vec_mul(dvz2.v, dy2.v)));
+  curlvry.v =
+      vec_fma(dvz.v, dx.v, vec_mul(vec_set1(-1.0f), vec_mul(dvx.v, dz.v)));
+  curlvry2.v =
+      vec_fma(dvz2.v, dx2.v, vec_mul(vec_set1(-1.0f), vec_mul(dvx2.v, dz2.v)));
+  curlvrz.v =
+      vec_fma(dvx.v, dy.v, vec_mul(vec_set1(-1.0f), vec_mul(dvy.v, dx.v)));
+  curlvrz2.v =
+      vec_fma(dvx2.v, dy2.v, vec_mul(vec_set1(-1.0f), vec_mul(dvy2.v, dx2.v)));
+  curlvrx.v = vec_mul(curlvrx.v, ri.v);
+  curlvrx2.v = vec_mul(curlvrx2.v, ri2.v);
+  curlvry.v = vec_mul(curlvry.v, ri.v);
+  curlvry2.v = vec_mul(curlvry2.v, ri2.v);
+  curlvrz.v = vec_mul(curlvrz.v, ri.v);
+  curlvrz2.v = vec_mul(curlvrz2.v, ri2.v);
+
+  vector wcount_dh_update, wcount_dh_update2;
+  wcount_dh_update.v =
+      vec_fma(vec_set1(hydro_dimension), wi.v, vec_mul(ui.v, wi_dx.v));
+  wcount_dh_update2.v =
+      vec_fma(vec_set1(hydro_dimension), wi2.v, vec_mul(ui2.v, wi_dx2.v));
+
+  /* Mask updates to intermediate vector sums for particle pi. */
+  /* Mask only when needed. */
+  if (mask_cond) {
+    rhoSum->v = vec_mask_add(rhoSum->v, vec_mul(mj.v, wi.v), mask);
+    rhoSum->v = vec_mask_add(rhoSum->v, vec_mul(mj2.v, wi2.v), mask2);
+    rho_dhSum->v =
+        vec_mask_sub(rho_dhSum->v, vec_mul(mj.v, wcount_dh_update.v), mask);
+    rho_dhSum->v =
+        vec_mask_sub(rho_dhSum->v, vec_mul(mj2.v, wcount_dh_update2.v), mask2);
+    wcountSum->v = vec_mask_add(wcountSum->v, wi.v, mask);
+    wcountSum->v = vec_mask_add(wcountSum->v, wi2.v, mask2);
+    wcount_dhSum->v = vec_mask_sub(wcount_dhSum->v, wcount_dh_update.v, mask);
+    wcount_dhSum->v = vec_mask_sub(wcount_dhSum->v, wcount_dh_update2.v, mask2);
+    div_vSum->v = vec_mask_sub(div_vSum->v,
+                               vec_mul(mj.v, vec_mul(dvdr.v, wi_dx.v)), mask);
+    div_vSum->v = vec_mask_sub(
+        div_vSum->v, vec_mul(mj2.v, vec_mul(dvdr2.v, wi_dx2.v)), mask2);
+    curlvxSum->v = vec_mask_add(
+        curlvxSum->v, vec_mul(mj.v, vec_mul(curlvrx.v, wi_dx.v)), mask);
+    curlvxSum->v = vec_mask_add(
+        curlvxSum->v, vec_mul(mj2.v, vec_mul(curlvrx2.v, wi_dx2.v)), mask2);
+    curlvySum->v = vec_mask_add(
+        curlvySum->v, vec_mul(mj.v, vec_mul(curlvry.v, wi_dx.v)), mask);
+    curlvySum->v = vec_mask_add(
+        curlvySum->v, vec_mul(mj2.v, vec_mul(curlvry2.v, wi_dx2.v)), mask2);
+    curlvzSum->v = vec_mask_add(
+        curlvzSum->v, vec_mul(mj.v, vec_mul(curlvrz.v, wi_dx.v)), mask);
+    curlvzSum->v = vec_mask_add(
+        curlvzSum->v, vec_mul(mj2.v, vec_mul(curlvrz2.v, wi_dx2.v)), mask2);
+  } else {
+    rhoSum->v = vec_add(rhoSum->v, vec_mul(mj.v, wi.v));
+    rhoSum->v = vec_add(rhoSum->v, vec_mul(mj2.v, wi2.v));
+    rho_dhSum->v = vec_sub(rho_dhSum->v, vec_mul(mj.v, wcount_dh_update.v));
+    rho_dhSum->v = vec_sub(rho_dhSum->v, vec_mul(mj2.v, wcount_dh_update2.v));
+    wcountSum->v = vec_add(wcountSum->v, wi.v);
+    wcountSum->v = vec_add(wcountSum->v, wi2.v);
+    wcount_dhSum->v = vec_sub(wcount_dhSum->v, wcount_dh_update.v);
+    wcount_dhSum->v = vec_sub(wcount_dhSum->v, wcount_dh_update2.v);
+    div_vSum->v = vec_sub(div_vSum->v, vec_mul(mj.v, vec_mul(dvdr.v, wi_dx.v)));
+    div_vSum->v =
+        vec_sub(div_vSum->v, vec_mul(mj2.v, vec_mul(dvdr2.v, wi_dx2.v)));
+    curlvxSum->v =
+        vec_add(curlvxSum->v, vec_mul(mj.v, vec_mul(curlvrx.v, wi_dx.v)));
+    curlvxSum->v =
+        vec_add(curlvxSum->v, vec_mul(mj2.v, vec_mul(curlvrx2.v, wi_dx2.v)));
+    curlvySum->v =
+        vec_add(curlvySum->v, vec_mul(mj.v, vec_mul(curlvry.v, wi_dx.v)));
+    curlvySum->v =
+        vec_add(curlvySum->v, vec_mul(mj2.v, vec_mul(curlvry2.v, wi_dx2.v)));
+    curlvzSum->v =
+        vec_add(curlvzSum->v, vec_mul(mj.v, vec_mul(curlvrz.v, wi_dx.v)));
+    curlvzSum->v =
+        vec_add(curlvzSum->v, vec_mul(mj2.v, vec_mul(curlvrz2.v, wi_dx2.v)));
+  }
+}
+#endif
+
 /**
  * @brief Calculate the gradient interaction between particle i and particle j
  *
@@ -328,6 +556,85 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_gradient(
 #endif
 }
 
+#ifdef WITH_VECTORIZATION
+
+/**
+ * @brief Gradient interaction computed using 1 vector
+ * (non-symmetric vectorized version).
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_1_vec_gradient(
+    vector *r2, vector *dx, vector *dy, vector *dz, vector vix, vector viy,
+    vector viz, vector ui, vector ci, float *Vjx, float *Vjy, float *Vjz,
+    float *Uj, float *Pjrho, float *Cj, half_float *Alpha_j, float *Mj,
+    vector hi_inv, const float a, const float H, vector *v_sigSum,
+    vector *laplace_uSum, vector *alpha_visc_max_ngbSum, mask_t mask) {
+
+  vector r, ri, xi, wi, wi_dx;
+  vector dvx, dvy, dvz, dvdr, dvdr_Hubble;
+  vector omega_ij, mu_ij, v_sig, laplace_u;
+
+  /* Fill the vectors. */
+  const vector vjx = vector_load(Vjx);
+  const vector vjy = vector_load(Vjy);
+  const vector vjz = vector_load(Vjz);
+  const vector uj = vector_load(Uj);
+  const vector cj = vector_load(Cj);
+  const vector alpha_j = vector_load_half(Alpha_j);
+  const vector mj = vector_load(Mj);
+
+  /* The padded and inhibited neighbours may have a zero density. Divide by 1
+   * in the lanes that are masked out to avoid raising an FPE. */
+  vector pjrho;
+  pjrho.v = vec_blend(mask, vec_set1(1.f), vector_load(Pjrho).v);
+
+  /* Cosmological terms */
+  const float fac_mu = pow_three_gamma_minus_five_over_two(a);
+  const float a2_Hubble = a * a * H;
+  const vector v_fac_mu = vector_set1(fac_mu);
+  const vector v_a2_Hubble = vector_set1(a2_Hubble);
+
+  /* Get the radius and inverse radius. */
+  ri = vec_reciprocal_sqrt(*r2);
+  r.v = vec_mul(r2->v, ri.v);
+
+  /* Calculate the kernel. */
+  xi.v = vec_mul(r.v, hi_inv.v);
+  kernel_deval_1_vec(&xi, &wi, &wi_dx);
+
+  /* Compute dv. */
+  dvx.v = vec_sub(vix.v, vjx.v);
+  dvy.v = vec_sub(viy.v, vjy.v);
+  dvz.v = vec_sub(viz.v, vjz.v);
+
+  /* Compute dv dot r. */
+  dvdr.v = vec_fma(dvx.v, dx->v, vec_fma(dvy.v, dy->v, vec_mul(dvz.v, dz->v)));
+
+  /* Add Hubble flow */
+  dvdr_Hubble.v = vec_add(dvdr.v, vec_mul(v_a2_Hubble.v, r2->v));
+
+  /* Are the particles moving towards each others ? */
+  omega_ij.v = vec_fmin(dvdr_Hubble.v, vec_setzero());
+  mu_ij.v = vec_mul(v_fac_mu.v,
+                    vec_mul(ri.v, omega_ij.v)); /* This is 0 or negative */
+
+  /* Signal velocity */
+  v_sig.v =
+      vec_fnma(vec_set1(const_viscosity_beta), mu_ij.v, vec_add(ci.v, cj.v));
+
+  /* Del^2 u for the thermal diffusion coefficient. */
+  laplace_u.v = vec_div(
+      vec_mul(mj.v, vec_mul(vec_mul(vec_sub(ui.v, uj.v), ri.v), wi_dx.v)),
+      pjrho.v);
+
+  /* Mask updates to intermediate vector sums for particle pi. */
+  v_sigSum->v = vec_fmax(v_sigSum->v, vec_and_mask(v_sig.v, mask));
+  laplace_uSum->v = vec_mask_add(laplace_uSum->v, laplace_u.v, mask);
+  alpha_visc_max_ngbSum->v =
+      vec_fmax(alpha_visc_max_ngbSum->v, vec_and_mask(alpha_j.v, mask));
+}
+#endif
+
 /**
  * @brief Force interaction between two particles.
  *
@@ -608,4 +915,184 @@ __attribute__((always_inline)) INLINE static void runner_iact_nonsym_force(
 #endif
 }
 
+#ifdef WITH_VECTORIZATION
+
+/**
+ * @brief Force interaction computed using 1 vector
+ * (non-symmetric vectorized version).
+ *
+ * Also collects the minimal time-bin of the neighbours for the time-step
+ * limiter.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_iact_nonsym_1_vec_force(
+    vector *r2, vector *dx, vector *dy, vector *dz, vector vix, vector viy,
+    vector viz, vector pirho, vector grad_hi, vector pressure_i,
+    vector balsara_i, vector ci, vector alpha_visc_i, vector alpha_diff_i,
+    vector ui, vector mi, float *Vjx, float *Vjy, float *Vjz, float *Pjrho,
+    float *Grad_hj, float *Pressure_j, half_float *Balsara_j, float *Cj,
+    half_float *Alpha_visc_j, half_float *Alpha_diff_j, float *Uj, float *Mj,
+    float *Time_bin_j, vector hi_inv, vector hj_inv, const float a,
+    const float H, vector *a_hydro_xSum, vector *a_hydro_ySum,
+    vector *a_hydro_zSum, vector *h_dtSum, vector *u_dtSum,
+    vector *min_ngb_time_binSum, mask_t mask) {
+
+  vector r, ri;
+  vector dvx, dvy, dvz;
+  vector xi, xj;
+  vector hid_inv, hjd_inv;
+  vector wi_dx, wj_dx, wi_dr, wj_dr, dvdr, dvdr_Hubble;
+  vector omega_ij, mu_ij, v_sig, f_ij, f_ji, rho_ij, alpha, visc;
+  vector visc_acc_term;
+  vector P_over_rho2_i, P_over_rho2_j, sph_acc_term, acc;
+  vector sph_du_term_i, visc_du_term, alpha_diff, v_diff, diff_du_term;
+  vector du_dt_i, pih_dt;
+
+  /* Fill vectors. */
+  const vector vjx = vector_load(Vjx);
+  const vector vjy = vector_load(Vjy);
+  const vector vjz = vector_load(Vjz);
+  const vector grad_hj = vector_load(Grad_hj);
+  const vector pressure_j = vector_load(Pressure_j);
+  const vector balsara_j = vector_load_half(Balsara_j);
+  const vector cj = vector_load(Cj);
+  const vector alpha_visc_j = vector_load_half(Alpha_visc_j);
+  const vector alpha_diff_j = vector_load_half(Alpha_diff_j);
+  const vector uj = vector_load(Uj);
+  const vector time_bin_j = vector_load(Time_bin_j);
+
+  /* The padded and inhibited neighbours may have a zero mass and density.
+   * Divide by 1 in the lanes that are masked out to avoid raising an FPE. */
+  vector mj, pjrho;
+  mj.v = vec_blend(mask, vec_set1(1.f), vector_load(Mj).v);
+  pjrho.v = vec_blend(mask, vec_set1(1.f), vector_load(Pjrho).v);
+
+  /* Cosmological terms */
+  const float fac_mu = pow_three_gamma_minus_five_over_two(a);
+  const float a2_Hubble = a * a * H;
+  const vector v_fac_mu = vector_set1(fac_mu);
+  const vector v_a2_Hubble = vector_set1(a2_Hubble);
+
+  /* Get the radius and inverse radius. */
+  ri = vec_reciprocal_sqrt(*r2);
+  r.v = vec_mul(r2->v, ri.v);
+
+  /* Get the kernel for hi. */
+  hid_inv = pow_dimension_plus_one_vec(hi_inv);
+  xi.v = vec_mul(r.v, hi_inv.v);
+  kernel_eval_dWdx_force_vec(&xi, &wi_dx);
+  wi_dr.v = vec_mul(hid_inv.v, wi_dx.v);
+
+  /* Get the kernel for hj. */
+  hjd_inv = pow_dimension_plus_one_vec(hj_inv);
+  xj.v = vec_mul(r.v, hj_inv.v);
+  kernel_eval_dWdx_force_vec(&xj, &wj_dx);
+  wj_dr.v = vec_mul(hjd_inv.v, wj_dx.v);
+
+  /* Compute dv. */
+  dvx.v = vec_sub(vix.v, vjx.v);
+  dvy.v = vec_sub(viy.v, vjy.v);
+  dvz.v = vec_sub(viz.v, vjz.v);
+
+  /* Compute dv dot r. */
+  dvdr.v = vec_fma(dvx.v, dx->v, vec_fma(dvy.v, dy->v, vec_mul(dvz.v, dz->v)));
+
+  /* Includes the hubble flow term; not used for du/dt */
+  dvdr_Hubble.v = vec_add(dvdr.v, vec_mul(v_a2_Hubble.v, r2->v));
+
+  /* Are the particles moving towards each others ? */
+  omega_ij.v = vec_fmin(dvdr_Hubble.v, vec_setzero());
+  mu_ij.v = vec_mul(v_fac_mu.v,
+                    vec_mul(ri.v, omega_ij.v)); /* This is 0 or negative */
+
+  /* Compute signal velocity */
+  v_sig.v =
+      vec_fnma(vec_set1(const_viscosity_beta), mu_ij.v, vec_add(ci.v, cj.v));
+
+  /* Variable smoothing length term */
+  f_ij.v = vec_fnma(grad_hi.v, vec_reciprocal(mj).v, vec_set1(1.f));
+  f_ji.v = vec_fnma(grad_hj.v, vec_reciprocal(mi).v, vec_set1(1.f));
+
+  /* Construct the full viscosity term */
+  rho_ij.v = vec_add(pirho.v, pjrho.v);
+  alpha.v = vec_add(alpha_visc_i.v, alpha_visc_j.v);
+  visc.v = vec_div(vec_mul(vec_mul(vec_set1(-0.25f), alpha.v),
+                           vec_mul(vec_mul(v_sig.v, mu_ij.v),
+                                   vec_add(balsara_i.v, balsara_j.v))),
+                   rho_ij.v);
+
+  /* Convolve with the kernel */
+  visc_acc_term.v =
+      vec_mul(vec_set1(0.5f),
+              vec_mul(visc.v, vec_mul(vec_fma(wi_dr.v, f_ij.v,
+                                              vec_mul(wj_dr.v, f_ji.v)),
+                                      ri.v)));
+
+  /* Compute gradient terms */
+  P_over_rho2_i.v =
+      vec_mul(vec_div(pressure_i.v, vec_mul(pirho.v, pirho.v)), f_ij.v);
+  P_over_rho2_j.v =
+      vec_mul(vec_div(pressure_j.v, vec_mul(pjrho.v, pjrho.v)), f_ji.v);
+
+  /* SPH acceleration term */
+  sph_acc_term.v = vec_mul(
+      vec_fma(P_over_rho2_i.v, wi_dr.v, vec_mul(P_over_rho2_j.v, wj_dr.v)),
+      ri.v);
+
+  /* Assemble the acceleration */
+  acc.v = vec_add(sph_acc_term.v, visc_acc_term.v);
+
+  /* Get the time derivative for u. */
+  sph_du_term_i.v =
+      vec_mul(P_over_rho2_i.v, vec_mul(dvdr.v, vec_mul(ri.v, wi_dr.v)));
+
+  /* Viscosity term */
+  visc_du_term.v =
+      vec_mul(vec_set1(0.5f), vec_mul(visc_acc_term.v, dvdr_Hubble.v));
+
+  /* Diffusion term, with the pressure-based alpha_diff switch */
+  alpha_diff.v = vec_div(
+      vec_fma(pressure_i.v, alpha_diff_i.v,
+              vec_mul(pressure_j.v, alpha_diff_j.v)),
+      vec_blend(mask, vec_set1(1.f), vec_add(pressure_i.v, pressure_j.v)));
+  v_diff.v = vec_mul(
+      vec_mul(alpha_diff.v, vec_set1(0.5f)),
+      vec_add(vec_sqrt(vec_div(
+                  vec_mul(vec_set1(2.f),
+                          vec_fabs(vec_sub(pressure_i.v, pressure_j.v))),
+                  rho_ij.v)),
+              vec_fabs(vec_mul(v_fac_mu.v, vec_mul(ri.v, dvdr_Hubble.v)))));
+  diff_du_term.v = vec_mul(
+      vec_mul(v_diff.v, vec_sub(ui.v, uj.v)),
+      vec_add(vec_div(vec_mul(f_ij.v, wi_dr.v), pirho.v),
+              vec_div(vec_mul(f_ji.v, wj_dr.v), pjrho.v)));
+
+  /* Assemble the energy equation term */
+  du_dt_i.v =
+      vec_add(vec_add(sph_du_term_i.v, visc_du_term.v), diff_du_term.v);
+
+  /* Get the time derivative for h. */
+  pih_dt.v =
+      vec_div(vec_mul(mj.v, vec_mul(dvdr.v, vec_mul(ri.v, wi_dr.v))), pjrho.v);
+
+  /* Only the neighbours with a valid time-bin count for the limiter. */
+  mask_t time_bin_mask;
+  vec_create_mask(time_bin_mask, vec_cmp_gt(time_bin_j.v, vec_setzero()));
+  vec_combine_masks(time_bin_mask, mask);
+
+  /* Store the forces back on the particles. */
+  a_hydro_xSum->v =
+      vec_mask_sub(a_hydro_xSum->v, vec_mul(mj.v, vec_mul(dx->v, acc.v)), mask);
+  a_hydro_ySum->v =
+      vec_mask_sub(a_hydro_ySum->v, vec_mul(mj.v, vec_mul(dy->v, acc.v)), mask);
+  a_hydro_zSum->v =
+      vec_mask_sub(a_hydro_zSum->v, vec_mul(mj.v, vec_mul(dz->v, acc.v)), mask);
+  h_dtSum->v = vec_mask_sub(h_dtSum->v, pih_dt.v, mask);
+  u_dtSum->v = vec_mask_add(u_dtSum->v, vec_mul(du_dt_i.v, mj.v), mask);
+  min_ngb_time_binSum->v =
+      vec_fmin(min_ngb_time_binSum->v,
+               vec_blend(time_bin_mask, min_ngb_time_binSum->v, time_bin_j.v));
+}
+#endif
+
 #endif /* SWIFT_SPHENIX_HYDRO_IACT_H */
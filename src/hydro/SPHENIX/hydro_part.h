@@ -308,4 +308,29 @@ struct part {
 
 } SWIFT_STRUCT_ALIGN;
 
+/**
+ * @brief The fields of a #part copied to the #cache of the vectorized
+ * interaction loops, on top of the positions, smoothing lengths, masses and
+ * velocities.
+ *
+ * Each entry is FIELD(name of the cache array, member of the #part).
+ */
+#define HYDRO_CACHE_FIELDS(FIELD)     \
+  FIELD(rho, rho)                     \
+  FIELD(grad_h, force.f)              \
+  FIELD(soundspeed, force.soundspeed) \
+  FIELD(pressure, force.pressure)     \
+  FIELD(u, u)                         \
+  FIELD(time_bin, time_bin)
+
+/**
+ * @brief The fields of a #part copied to the #cache that only feed the
+ * viscosity and diffusion switches, stored as #half_float when configured
+ * with --enable-half-precision-caches.
+ */
+#define HYDRO_CACHE_HALF_FIELDS(FIELD) \
+  FIELD(balsara, force.balsara)        \
+  FIELD(alpha_visc, viscosity.alpha)   \
+  FIELD(alpha_diff, diffusion.alpha)
+
 #endif /* SWIFT_SPHENIX_HYDRO_PART_H */
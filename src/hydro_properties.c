@@ -39,6 +39,9 @@
 #include "units.h"
 
 #define hydro_props_default_max_iterations 30
+#define hydro_props_default_ghost_ngb_list_margin 0.f
+#define hydro_props_default_ghost_ngb_list_max_size 262144
+#define hydro_props_default_fused_loops_max_active_fraction 0.f
 #define hydro_props_default_volume_change 1.4f
 #define hydro_props_default_h_max FLT_MAX
 #define hydro_props_default_h_min_ratio 0.f
@@ -101,6 +104,31 @@ void hydro_props_init(struct hydro_props *p,
   if (p->max_smoothing_iterations <= 10)
     error("The number of smoothing length iterations should be > 10");
 
+  /* Candidate neighbour lists of the ghost iterations */
+  p->ghost_ngb_list_margin =
+      parser_get_opt_param_float(params, "SPH:ghost_ngb_list_margin",
+                                 hydro_props_default_ghost_ngb_list_margin);
+  p->ghost_ngb_list_max_size =
+      parser_get_opt_param_int(params, "SPH:ghost_ngb_list_max_size",
+                               hydro_props_default_ghost_ngb_list_max_size);
+
+  if (p->ghost_ngb_list_margin != 0.f && p->ghost_ngb_list_margin < 1.f)
+    error("The margin of the ghost neighbour lists should be >= 1");
+
+  /* Fused hydro loops of the super-cells with few active particles */
+  p->fused_loops_max_active_fraction = parser_get_opt_param_float(
+      params, "SPH:fused_loops_max_active_fraction",
+      hydro_props_default_fused_loops_max_active_fraction);
+
+  if (p->fused_loops_max_active_fraction < 0.f ||
+      p->fused_loops_max_active_fraction > 1.f)
+    error("The maximal active fraction of the fused loops should be in [0, 1]");
+
+#ifdef MPI_SYMMETRIC_FORCE_INTERACTION
+  if (p->fused_loops_max_active_fraction > 0.f)
+    error("Can't fuse the hydro loops with this scheme!");
+#endif
+
   /* ------ Neighbour number definition ------------ */
 
   /* Non-conventional neighbour number definition */
@@ -252,6 +280,18 @@ void hydro_props_print(const struct hydro_props *p) {
     message("Maximal iterations in ghost task set to %d (default is %d)",
             p->max_smoothing_iterations, hydro_props_default_max_iterations);
 
+  if (p->ghost_ngb_list_margin > 0.f)
+    message(
+        "Ghost iterations use neighbour lists with a margin of %.3f (at most "
+        "%d entries per cell)",
+        p->ghost_ngb_list_margin, p->ghost_ngb_list_max_size);
+
+  if (p->fused_loops_max_active_fraction > 0.f)
+    message(
+        "Hydro loops fused for top-level cells with at most %.3f %% of active "
+        "particles",
+        100.f * p->fused_loops_max_active_fraction);
+
   if (p->initial_temperature != hydro_props_default_init_temp)
     message("Initial gas temperature set to %f", p->initial_temperature);
 
@@ -360,6 +400,10 @@ void hydro_props_init_no_hydro(struct hydro_props *p) {
   p->h_min = 0.f;
   p->h_min_ratio = hydro_props_default_h_min_ratio;
   p->max_smoothing_iterations = hydro_props_default_max_iterations;
+  p->ghost_ngb_list_margin = hydro_props_default_ghost_ngb_list_margin;
+  p->ghost_ngb_list_max_size = hydro_props_default_ghost_ngb_list_max_size;
+  p->fused_loops_max_active_fraction =
+      hydro_props_default_fused_loops_max_active_fraction;
   p->CFL_condition = 0.1;
   p->log_max_h_change = logf(powf(1.4, hydro_dimension_inv));
 
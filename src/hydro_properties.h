@@ -73,6 +73,17 @@ struct hydro_props {
   /*! Maximal number of iterations to converge h */
   int max_smoothing_iterations;
 
+  /*! Margin on the radius of the candidate neighbour lists re-used by the
+   * ghost iterations (0 to always search the neighbouring cells) */
+  float ghost_ngb_list_margin;
+
+  /*! Maximal number of candidate neighbours stored for a cell */
+  int ghost_ngb_list_max_size;
+
+  /*! Maximal fraction of active particles of a top-level cell for its hydro
+   * loops to run in a single fused task (0 to never fuse them) */
+  float fused_loops_max_active_fraction;
+
   /* ------ Neighbour number definition ------------ */
 
   /*! Are we using the mass-weighted definition of neighbour number? */
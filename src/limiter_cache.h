@@ -0,0 +1,198 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_LIMITER_CACHE_H
+#define SWIFT_LIMITER_CACHE_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Local headers */
+#include "align.h"
+#include "cell.h"
+#include "error.h"
+#include "memuse.h"
+#include "part.h"
+#include "sort_part.h"
+#include "vector.h"
+
+#ifdef WITH_VECTORIZATION
+
+/**
+ * @brief A SoA object for the #part of a cell used by the time-step limiter.
+ *
+ * The limiter only needs the positions, smoothing lengths and time-bins of
+ * the particles, which every hydro scheme has, so this does not depend on
+ * the #cache of the vectorized hydro loops.
+ */
+struct limiter_cache {
+
+  /*! #part x position. */
+  float *restrict x SWIFT_CACHE_ALIGN;
+
+  /*! #part y position. */
+  float *restrict y SWIFT_CACHE_ALIGN;
+
+  /*! #part z position. */
+  float *restrict z SWIFT_CACHE_ALIGN;
+
+  /*! #part smoothing length. */
+  float *restrict h SWIFT_CACHE_ALIGN;
+
+  /*! #part time-bin. */
+  float *restrict time_bin SWIFT_CACHE_ALIGN;
+
+  /*! Cache size */
+  int count;
+};
+
+/**
+ * @brief Frees the memory allocated in a #limiter_cache
+ *
+ * @param c The #limiter_cache to free.
+ */
+static INLINE void limiter_cache_clean(struct limiter_cache *c) {
+
+  if (c->count > 0) {
+    swift_free("limiter_cache", c->x);
+    swift_free("limiter_cache", c->y);
+    swift_free("limiter_cache", c->z);
+    swift_free("limiter_cache", c->h);
+    swift_free("limiter_cache", c->time_bin);
+  }
+  c->count = 0;
+}
+
+/**
+ * @brief Allocates memory for the #part caches used in the time-step limiter
+ * loops.
+ *
+ * The cache is padded for the vector size and aligned properly
+ *
+ * @param c The #limiter_cache to allocate.
+ * @param count The number of #part to allocated for.
+ */
+static INLINE void limiter_cache_init(struct limiter_cache *c,
+                                      const int count) {
+
+  /* Size of the limiter cache */
+  const int padded_count = count - (count % VEC_SIZE) + VEC_SIZE;
+  const size_t sizeBytes = padded_count * sizeof(float);
+
+  /* Delete old stuff if any */
+  limiter_cache_clean(c);
+
+  int e = 0;
+  e += swift_memalign("limiter_cache", (void **)&c->x, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytes);
+  e += swift_memalign("limiter_cache", (void **)&c->y, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytes);
+  e += swift_memalign("limiter_cache", (void **)&c->z, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytes);
+  e += swift_memalign("limiter_cache", (void **)&c->h, SWIFT_CACHE_ALIGNMENT,
+                      sizeBytes);
+  e += swift_memalign("limiter_cache", (void **)&c->time_bin,
+                      SWIFT_CACHE_ALIGNMENT, sizeBytes);
+
+  if (e != 0) error("Couldn't allocate limiter cache, size: %d", padded_count);
+
+  c->count = padded_count;
+}
+
+/**
+ * @brief Fill a #limiter_cache with the positions, smoothing lengths and
+ * time-bins of a range of the particles of a cell.
+ *
+ * Inhibited particles and the padding are put out of range of any particle,
+ * on time-bin 0, so that they never need waking up.
+ *
+ * @param ci The #cell.
+ * @param c The #limiter_cache.
+ * @param sort The sorted list of the particles to read them in that order, or
+ * NULL to read them in the order of the cell.
+ * @param first The first particle to read.
+ * @param last The particle after the last one to read.
+ * @param loc The location to remove from the particle positions.
+ * @return The end of the range in the cache, padded to a multiple of the
+ * vector size.
+ */
+__attribute__((always_inline)) INLINE static int limiter_cache_read_particles(
+    const struct cell *restrict const ci, struct limiter_cache *restrict c,
+    const struct sort_entry *restrict sort, const int first, const int last,
+    const double *loc) {
+
+  /* Let the compiler know that the data is aligned and create pointers to the
+   * arrays inside the cache. */
+  swift_declare_aligned_ptr(float, x, c->x, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, y, c->y, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, z, c->z, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, h, c->h, SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(float, time_bin, c->time_bin,
+                            SWIFT_CACHE_ALIGNMENT);
+
+  const struct part *restrict parts = ci->hydro.parts;
+  const double max_dx = ci->hydro.dx_max_part;
+  const float pos_padded[3] = {-(2. * ci->width[0] + max_dx),
+                               -(2. * ci->width[1] + max_dx),
+                               -(2. * ci->width[2] + max_dx)};
+  const float h_padded = ci->hydro.h_max / 4.;
+
+  for (int i = first; i < last; i++) {
+
+    const struct part *restrict p =
+        &parts[sort != NULL ? sort_get_i(sort, i) : i];
+
+    /* Put inhibited particles out of range. */
+    if (p->time_bin >= time_bin_inhibited) {
+      x[i] = pos_padded[0];
+      y[i] = pos_padded[1];
+      z[i] = pos_padded[2];
+      h[i] = h_padded;
+      time_bin[i] = 0.f;
+
+      continue;
+    }
+
+    x[i] = (float)(p->x[0] - loc[0]);
+    y[i] = (float)(p->x[1] - loc[1]);
+    z[i] = (float)(p->x[2] - loc[2]);
+    h[i] = p->h;
+    time_bin[i] = p->time_bin;
+  }
+
+  /* Pad cache if there is a serial remainder. */
+  int last_align = last;
+  const int rem = last % VEC_SIZE;
+  if (rem != 0) {
+    last_align += VEC_SIZE - rem;
+
+    for (int i = last; i < last_align; i++) {
+      x[i] = pos_padded[0];
+      y[i] = pos_padded[1];
+      z[i] = pos_padded[2];
+      h[i] = h_padded;
+      time_bin[i] = 0.f;
+    }
+  }
+
+  return last_align;
+}
+
+#endif /* WITH_VECTORIZATION */
+
+#endif /* SWIFT_LIMITER_CACHE_H */
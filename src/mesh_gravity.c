@@ -36,9 +36,11 @@
 #include "engine.h"
 #include "error.h"
 #include "gravity_properties.h"
+#include "integer_power.h"
 #include "kernel_long_gravity.h"
 #include "mesh_gravity_mpi.h"
 #include "mesh_gravity_patch.h"
+#include "mesh_gravity_pencils.h"
 #include "neutrino.h"
 #include "part.h"
 #include "restart.h"
@@ -124,6 +126,41 @@ __attribute__((always_inline)) INLINE static void CIC_set(
                value * dx * dy * dz);
 }
 
+/**
+ * @brief Interpolate a value to a mesh using CIC, without atomics.
+ *
+ * The caller must make sure that no other thread writes to the planes i and
+ * i + 1 of the mesh at the same time.
+ *
+ * @param mesh The mesh to write to
+ * @param N The side-length of the mesh
+ * @param i The index of the cell along x
+ * @param j The index of the cell along y
+ * @param k The index of the cell along z
+ * @param tx First CIC coefficient along x
+ * @param ty First CIC coefficient along y
+ * @param tz First CIC coefficient along z
+ * @param dx Second CIC coefficient along x
+ * @param dy Second CIC coefficient along y
+ * @param dz Second CIC coefficient along z
+ * @param value The value to interpolate.
+ */
+__attribute__((always_inline)) INLINE static void CIC_add(
+    double* mesh, const int N, const int i, const int j, const int k,
+    const double tx, const double ty, const double tz, const double dx,
+    const double dy, const double dz, const double value) {
+
+  /* Classic CIC interpolation */
+  mesh[row_major_id_periodic(i + 0, j + 0, k + 0, N)] += value * tx * ty * tz;
+  mesh[row_major_id_periodic(i + 0, j + 0, k + 1, N)] += value * tx * ty * dz;
+  mesh[row_major_id_periodic(i + 0, j + 1, k + 0, N)] += value * tx * dy * tz;
+  mesh[row_major_id_periodic(i + 0, j + 1, k + 1, N)] += value * tx * dy * dz;
+  mesh[row_major_id_periodic(i + 1, j + 0, k + 0, N)] += value * dx * ty * tz;
+  mesh[row_major_id_periodic(i + 1, j + 0, k + 1, N)] += value * dx * ty * dz;
+  mesh[row_major_id_periodic(i + 1, j + 1, k + 0, N)] += value * dx * dy * tz;
+  mesh[row_major_id_periodic(i + 1, j + 1, k + 1, N)] += value * dx * dy * dz;
+}
+
 /**
  * @brief Assigns a given #gpart to a density mesh using the CIC method.
  *
@@ -181,6 +218,172 @@ INLINE static void gpart_to_mesh_CIC(const struct gpart* gp, double* rho,
   CIC_set(rho, N, i, j, k, tx, ty, tz, dx, dy, dz, value);
 }
 
+/**
+ * @brief Assigns a given #gpart to a density mesh using the CIC method if it
+ * falls in a given slab of the mesh, without atomics.
+ *
+ * The #gpart is assigned to the planes i and i + 1 of the mesh, with i in
+ * [i_min, i_max[, which the calling thread must be the only one to write to.
+ *
+ * @param gp The #gpart.
+ * @param rho The density mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac The width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param nu_model Struct with neutrino constants
+ * @param i_min The first plane of the slab along x.
+ * @param i_max The plane after the last of the slab along x.
+ */
+INLINE static void gpart_to_mesh_CIC_slab(
+    const struct gpart* gp, double* rho, const int N, const double fac,
+    const double dim[3], const struct neutrino_model* nu_model,
+    const int i_min, const int i_max) {
+
+  /* Box wrap the gpart's position along x */
+  const double pos_x = box_wrap(gp->x[0], 0., dim[0]);
+
+  /* Workout the CIC coefficients, starting with the slab */
+  int i = (int)(fac * pos_x);
+  if (i >= N) i = N - 1;
+  if (i < i_min || i >= i_max) return;
+  const double dx = fac * pos_x - i;
+  const double tx = 1. - dx;
+
+  const double pos_y = box_wrap(gp->x[1], 0., dim[1]);
+  const double pos_z = box_wrap(gp->x[2], 0., dim[2]);
+
+  int j = (int)(fac * pos_y);
+  if (j >= N) j = N - 1;
+  const double dy = fac * pos_y - j;
+  const double ty = 1. - dy;
+
+  int k = (int)(fac * pos_z);
+  if (k >= N) k = N - 1;
+  const double dz = fac * pos_z - k;
+  const double tz = 1. - dz;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gp->time_bin == time_bin_not_created)
+    error("Found an extra particle in mesh CIC.");
+
+  if (i < 0 || i >= N) error("Invalid gpart position in x");
+  if (j < 0 || j >= N) error("Invalid gpart position in y");
+  if (k < 0 || k >= N) error("Invalid gpart position in z");
+#endif
+
+  /* Compute weight (for neutrino delta-f weighting) */
+  double weight = 1.0;
+  if (gp->type == swift_type_neutrino)
+    gpart_neutrino_weight_mesh_only(gp, nu_model, &weight);
+
+  const double mass = gp->mass;
+  const double value = mass * weight;
+
+  /* CIC ! */
+  CIC_add(rho, N, i, j, k, tx, ty, tz, dx, dy, dz, value);
+}
+
+/**
+ * @brief Computes the weights of a mass assignment window along one axis.
+ *
+ * These are the CIC, TSC and PCS windows, with the mesh cells at the integer
+ * positions as in the CIC functions above. The TSC weights are the ones of
+ * the power spectra.
+ *
+ * @param order The order of the window: 2 (CIC), 3 (TSC) or 4 (PCS).
+ * @param u The position along the axis in units of mesh cells.
+ * @param w (return) The weights of the order mesh cells covered by the
+ * window.
+ * @return The index of the first of these mesh cells, which can be outside
+ * [0, N[.
+ */
+__attribute__((always_inline)) INLINE static int mesh_window_weights(
+    const int order, const double u, double w[4]) {
+
+  switch (order) {
+    case 2: {
+      const int i = (int)floor(u);
+      const double d = u - i;
+      w[0] = 1. - d;
+      w[1] = d;
+      return i;
+    }
+    case 3: {
+      /* Centred on the nearest mesh cell */
+      const int i = (int)floor(u + 0.5);
+      const double d = u - i;
+      w[0] = 0.5 * (0.5 - d) * (0.5 - d);
+      w[1] = 0.75 - d * d;
+      w[2] = 0.5 * (0.5 + d) * (0.5 + d);
+      return i - 1;
+    }
+    case 4: {
+      const int i = (int)floor(u);
+      const double d = u - i;
+      const double t = 1. - d;
+      w[0] = (1. / 6.) * t * t * t;
+      w[1] = (1. / 6.) * (4. - 6. * d * d + 3. * d * d * d);
+      w[2] = (1. / 6.) * (4. - 6. * t * t + 3. * t * t * t);
+      w[3] = (1. / 6.) * d * d * d;
+      return i - 1;
+    }
+    default:
+      error("Invalid mesh window order %d.", order);
+      return 0;
+  }
+}
+
+/**
+ * @brief Assigns a given #gpart to a density mesh using a window of any
+ * order.
+ *
+ * @param gp The #gpart.
+ * @param rho The density mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac The width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param nu_model Struct with neutrino constants
+ * @param order The order of the window.
+ * @param shift The shift of the positions, in units of mesh cells.
+ */
+INLINE static void gpart_to_mesh_window(const struct gpart* gp, double* rho,
+                                        const int N, const double fac,
+                                        const double dim[3],
+                                        const struct neutrino_model* nu_model,
+                                        const int order, const double shift) {
+
+  /* Box wrap the gpart's position and work out the weights */
+  int first[3];
+  double w[3][4];
+  for (int d = 0; d < 3; ++d)
+    first[d] = mesh_window_weights(
+        order, fac * box_wrap(gp->x[d], 0., dim[d]) + shift, w[d]);
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (gp->time_bin == time_bin_not_created)
+    error("Found an extra particle in mesh assignment.");
+#endif
+
+  /* Compute weight (for neutrino delta-f weighting) */
+  double weight = 1.0;
+  if (gp->type == swift_type_neutrino)
+    gpart_neutrino_weight_mesh_only(gp, nu_model, &weight);
+
+  const double mass = gp->mass;
+  const double value = mass * weight;
+
+  for (int ii = 0; ii < order; ++ii) {
+    for (int jj = 0; jj < order; ++jj) {
+      const double w_ij = value * w[0][ii] * w[1][jj];
+      for (int kk = 0; kk < order; ++kk) {
+        atomic_add_d(&rho[row_major_id_periodic(first[0] + ii, first[1] + jj,
+                                                first[2] + kk, N)],
+                     w_ij * w[2][kk]);
+      }
+    }
+  }
+}
+
 /**
  * @brief Assigns all the #gpart of a #cell to a density mesh using the CIC
  * method.
@@ -220,6 +423,21 @@ struct cic_mapper_data {
   double dim[3];
   float const_G;
   struct neutrino_model* nu_model;
+
+  /* Slab by slab assignment: the local cells, the range of planes along x
+   * covered by their particles, and the slabs to work on */
+  const int* local_cells;
+  int nr_local_cells;
+  int* cell_ranges;
+  int nr_slabs;
+  int slab_parity;
+
+  /* Higher order windows and interlacing: the order of the window, the
+   * shift of the positions for the assignment and the potential on the
+   * mesh shifted by half a cell for the interpolation (NULL if unused) */
+  int window_order;
+  double shift;
+  double* potential_shifted;
 };
 
 void gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
@@ -293,6 +511,213 @@ void cell_gpart_to_mesh_CIC_mapper(void* map_data, int num, void* extra) {
   }
 }
 
+/**
+ * @brief Threadpool mapper function computing the range of planes along x
+ * that the #gpart of the local cells are assigned to.
+ *
+ * The ranges are measured from the plane of the corner of each cell, so that
+ * they are contiguous but can extend beyond [0, N[ when the particles
+ * straddle the edge of the box.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The information about the mesh and cells.
+ */
+void cell_gpart_to_mesh_CIC_range_mapper(void* map_data, int num,
+                                         void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+  const int N = data->N;
+  const double fac = data->fac;
+  const double dim_x = data->dim[0];
+
+  /* Pointer to the chunk to be processed */
+  const int* local_cells = (int*)map_data;
+  int* cell_ranges = &data->cell_ranges[2 * (local_cells - data->local_cells)];
+
+  for (int n = 0; n < num; ++n) {
+
+    const struct cell* c = &cells[local_cells[n]];
+    const struct gpart* gparts = c->grav.parts;
+
+    int i_cell = (int)(fac * box_wrap(c->loc[0], 0., dim_x));
+    if (i_cell >= N) i_cell = N - 1;
+
+    int di_min = N, di_max = -N;
+    for (int k = 0; k < c->grav.count; ++k) {
+
+      if (gparts[k].time_bin == time_bin_inhibited) continue;
+
+      int i = (int)(fac * box_wrap(gparts[k].x[0], 0., dim_x));
+      if (i >= N) i = N - 1;
+
+      /* Distance to the cell's plane, across the box edge if shorter */
+      int di = i - i_cell;
+      if (di > N / 2)
+        di -= N;
+      else if (di < -N / 2)
+        di += N;
+
+      di_min = min(di_min, di);
+      di_max = max(di_max, di);
+    }
+
+    /* Empty ranges for cells without particles */
+    cell_ranges[2 * n + 0] = i_cell + di_min;
+    cell_ranges[2 * n + 1] = i_cell + di_max;
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the mesh CIC assignment of slabs of
+ * the mesh.
+ *
+ * Each slab is a range of planes along x, whose particles are assigned to
+ * the planes of the slab and the first plane of the next one. The slabs of
+ * the same parity hence never write to the same planes and are assigned
+ * concurrently without atomics.
+ *
+ * @param map_data The offset from NULL of the first slab of the chunk among
+ * the slabs of the current parity.
+ * @param num The number of slabs in the chunk.
+ * @param extra The information about the mesh and cells.
+ */
+void cell_gpart_to_mesh_CIC_slab_mapper(void* map_data, int num, void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+  const int* local_cells = data->local_cells;
+  const int nr_local_cells = data->nr_local_cells;
+  const int* cell_ranges = data->cell_ranges;
+  const int nr_slabs = data->nr_slabs;
+  double* rho = data->rho;
+  const int N = data->N;
+  const double fac = data->fac;
+  const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
+  const struct neutrino_model* nu_model = data->nu_model;
+
+  for (int ind = 0; ind < num; ++ind) {
+
+    /* Get the slab and its planes */
+    const int slab = 2 * ((size_t)map_data + ind) + data->slab_parity;
+    const int i_min = slab * N / nr_slabs;
+    const int i_max = (slab + 1) * N / nr_slabs;
+
+    for (int n = 0; n < nr_local_cells; ++n) {
+
+      /* Does this cell have particles in the slab, possibly across the
+       * box edge? */
+      const int range_min = cell_ranges[2 * n + 0];
+      const int range_max = cell_ranges[2 * n + 1];
+      int overlap = 0;
+      for (int shift = -N; shift <= N; shift += N)
+        overlap |= (range_min + shift < i_max && range_max + shift >= i_min);
+      if (!overlap) continue;
+
+      /* Assign the particles of this cell that fall in the slab */
+      const struct cell* c = &cells[local_cells[n]];
+      const struct gpart* gparts = c->grav.parts;
+      for (int k = 0; k < c->grav.count; ++k) {
+        if (gparts[k].time_bin == time_bin_inhibited) continue;
+        gpart_to_mesh_CIC_slab(&gparts[k], rho, N, fac, dim, nu_model, i_min,
+                               i_max);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Assigns the #gpart of the local cells to a density mesh slab by
+ * slab, without atomics.
+ *
+ * @param tp The #threadpool object used for parallelisation.
+ * @param data The information about the mesh and cells.
+ * @param local_cells The list of local cells.
+ * @param nr_local_cells The number of local cells.
+ */
+void cell_gpart_to_mesh_CIC_slabs(struct threadpool* tp,
+                                  struct cic_mapper_data* data,
+                                  const int* local_cells,
+                                  const int nr_local_cells) {
+
+  /* Enough slabs for the threads to share the work out, at least one plane
+   * wide each. The mesh size is even, and so is the number of slabs. */
+  data->nr_slabs = min(data->N, 8 * tp->num_threads);
+  data->local_cells = local_cells;
+  data->nr_local_cells = nr_local_cells;
+  data->cell_ranges = (int*)malloc(2 * nr_local_cells * sizeof(int));
+  if (data->cell_ranges == NULL)
+    error("Error allocating memory for the mesh slab ranges of the cells.");
+
+  /* Find the planes the particles of every cell are assigned to */
+  threadpool_map(tp, cell_gpart_to_mesh_CIC_range_mapper, (void*)local_cells,
+                 nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                 (void*)data);
+
+  /* Assign the even slabs, then the odd ones */
+  for (int parity = 0; parity < 2; ++parity) {
+    data->slab_parity = parity;
+    threadpool_map(tp, cell_gpart_to_mesh_CIC_slab_mapper, NULL,
+                   data->nr_slabs / 2, 1, /*chunk=*/1, (void*)data);
+  }
+
+  free(data->cell_ranges);
+  data->cell_ranges = NULL;
+}
+
+/**
+ * @brief Threadpool mapper function for the mesh assignment of #gpart with a
+ * window of any order.
+ *
+ * @param map_data A chunk of the list of #gpart.
+ * @param num The number of #gpart in the chunk.
+ * @param extra The information about the mesh.
+ */
+void gpart_to_mesh_window_mapper(void* map_data, int num, void* extra) {
+
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  double* rho = data->rho;
+  const int N = data->N;
+  const double fac = data->fac;
+  const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
+  const struct neutrino_model* nu_model = data->nu_model;
+  const int order = data->window_order;
+  const double shift = data->shift;
+
+  /* Pointer to the chunk to be processed */
+  const struct gpart* gparts = (const struct gpart*)map_data;
+
+  for (int i = 0; i < num; ++i) {
+    if (gparts[i].time_bin == time_bin_inhibited) continue;
+    gpart_to_mesh_window(&gparts[i], rho, N, fac, dim, nu_model, order, shift);
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the mesh assignment of the #gpart of
+ * a cell with a window of any order.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The information about the mesh and cells.
+ */
+void cell_gpart_to_mesh_window_mapper(void* map_data, int num, void* extra) {
+
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+
+  /* Pointer to the chunk to be processed */
+  const int* local_cells = (int*)map_data;
+
+  for (int i = 0; i < num; ++i) {
+    const struct cell* c = &cells[local_cells[i]];
+    gpart_to_mesh_window_mapper(c->grav.parts, c->grav.count, extra);
+  }
+}
+
 /**
  * @brief Computes the potential on a gpart from a given mesh using the CIC
  * method.
@@ -494,6 +919,154 @@ void cell_mesh_to_gpart_CIC_mapper(void* map_data, int num, void* extra) {
   }
 }
 
+/**
+ * @brief Interpolates the potential and its gradient at the position of a
+ * #gpart from a given mesh with a window of any order.
+ *
+ * @param gp The #gpart.
+ * @param pot The potential mesh.
+ * @param N the size of the mesh along one axis.
+ * @param fac width of a mesh cell.
+ * @param dim The dimensions of the simulation box.
+ * @param order The order of the window.
+ * @param shift The shift of the positions, in units of mesh cells.
+ * @param p (return) The potential.
+ * @param a (return) The gradient of the potential, in units of mesh cells.
+ */
+INLINE static void mesh_to_gpart_window(const struct gpart* gp,
+                                        const double* pot, const int N,
+                                        const double fac, const double dim[3],
+                                        const int order, const double shift,
+                                        double* p, double a[3]) {
+
+  /* Box wrap the gpart's position and work out the weights */
+  int first[3];
+  double w[3][4];
+  for (int d = 0; d < 3; ++d)
+    first[d] = mesh_window_weights(
+        order, fac * box_wrap(gp->x[d], 0., dim[d]) + shift, w[d]);
+
+  /* First, copy the necessary part of the mesh for stencil operations */
+  /* This includes box-wrapping in all 3 dimensions. */
+  double phi[8][8][8];
+  for (int iii = -2; iii < order + 2; ++iii) {
+    for (int jjj = -2; jjj < order + 2; ++jjj) {
+      for (int kkk = -2; kkk < order + 2; ++kkk) {
+        phi[iii + 2][jjj + 2][kkk + 2] = pot[row_major_id_periodic(
+            first[0] + iii, first[1] + jjj, first[2] + kkk, N)];
+      }
+    }
+  }
+
+  *p = 0.;
+  a[0] = 0.;
+  a[1] = 0.;
+  a[2] = 0.;
+
+  /* Interpolate the potential and its 5-point stencil gradient */
+  for (int ii = 2; ii < order + 2; ++ii) {
+    for (int jj = 2; jj < order + 2; ++jj) {
+      for (int kk = 2; kk < order + 2; ++kk) {
+
+        const double w_ijk = w[0][ii - 2] * w[1][jj - 2] * w[2][kk - 2];
+
+        *p += w_ijk * phi[ii][jj][kk];
+
+        a[0] += w_ijk * ((1. / 12.) * phi[ii + 2][jj][kk] -
+                         (2. / 3.) * phi[ii + 1][jj][kk] +
+                         (2. / 3.) * phi[ii - 1][jj][kk] -
+                         (1. / 12.) * phi[ii - 2][jj][kk]);
+        a[1] += w_ijk * ((1. / 12.) * phi[ii][jj + 2][kk] -
+                         (2. / 3.) * phi[ii][jj + 1][kk] +
+                         (2. / 3.) * phi[ii][jj - 1][kk] -
+                         (1. / 12.) * phi[ii][jj - 2][kk]);
+        a[2] += w_ijk * ((1. / 12.) * phi[ii][jj][kk + 2] -
+                         (2. / 3.) * phi[ii][jj][kk + 1] +
+                         (2. / 3.) * phi[ii][jj][kk - 1] -
+                         (1. / 12.) * phi[ii][jj][kk - 2]);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the interpolation of the mesh
+ * potential and accelerations to #gpart with a window of any order.
+ *
+ * With interlacing, the results of the mesh and of the mesh shifted by half
+ * a cell are averaged.
+ *
+ * @param map_data A chunk of the list of #gpart.
+ * @param num The number of #gpart in the chunk.
+ * @param extra The information about the mesh.
+ */
+void mesh_to_gpart_window_mapper(void* map_data, int num, void* extra) {
+
+  /* Unpack the shared information */
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const double* const potential = data->potential;
+  const double* const potential_shifted = data->potential_shifted;
+  const int N = data->N;
+  const double fac = data->fac;
+  const double dim[3] = {data->dim[0], data->dim[1], data->dim[2]};
+  const float const_G = data->const_G;
+  const int order = data->window_order;
+
+  /* Pointer to the chunk to be processed */
+  struct gpart* gparts = (struct gpart*)map_data;
+
+  /* Loop over the elements assigned to this thread */
+  for (int i = 0; i < num; ++i) {
+
+    struct gpart* gp = &gparts[i];
+    if (gp->time_bin == time_bin_inhibited) continue;
+
+    double p, a[3];
+    mesh_to_gpart_window(gp, potential, N, fac, dim, order, /*shift=*/0., &p,
+                         a);
+
+    if (potential_shifted != NULL) {
+      double p_shifted, a_shifted[3];
+      mesh_to_gpart_window(gp, potential_shifted, N, fac, dim, order,
+                           /*shift=*/0.5, &p_shifted, a_shifted);
+      p = 0.5 * (p + p_shifted);
+      for (int d = 0; d < 3; ++d) a[d] = 0.5 * (a[d] + a_shifted[d]);
+    }
+
+    /* Store things back */
+    gp->a_grav_mesh[0] = const_G * fac * a[0];
+    gp->a_grav_mesh[1] = const_G * fac * a[1];
+    gp->a_grav_mesh[2] = const_G * fac * a[2];
+#ifndef SWIFT_GRAVITY_NO_POTENTIAL
+    gp->potential_mesh = 0.f;
+#endif
+    gravity_add_comoving_mesh_potential(gp, const_G * p);
+  }
+}
+
+/**
+ * @brief Threadpool mapper function for the interpolation of the mesh
+ * potential and accelerations to the #gpart of a cell with a window of any
+ * order.
+ *
+ * @param map_data A chunk of the list of local cells.
+ * @param num The number of cells in the chunk.
+ * @param extra The information about the mesh and cells.
+ */
+void cell_mesh_to_gpart_window_mapper(void* map_data, int num, void* extra) {
+
+  const struct cic_mapper_data* data = (struct cic_mapper_data*)extra;
+  const struct cell* cells = data->cells;
+
+  /* Pointer to the chunk to be processed */
+  const int* local_cells = (int*)map_data;
+
+  for (int i = 0; i < num; ++i) {
+    const struct cell* c = &cells[local_cells[i]];
+    mesh_to_gpart_window_mapper(c->grav.parts, c->grav.count, extra);
+  }
+}
+
 /**
  * @brief Shared information about the Green function to be used by all the
  * threads in the pool.
@@ -502,11 +1075,13 @@ struct Green_function_data {
 
   int N;
   fftw_complex* frho;
+  fftw_complex* frho_shifted;
   double green_fac;
   double a_smooth2;
   double k_fac;
   int slice_offset;
   int slice_width;
+  int window_order;
 };
 
 /**
@@ -521,8 +1096,9 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
 
   struct Green_function_data* data = (struct Green_function_data*)extra;
 
-  /* Unpack the array */
+  /* Unpack the arrays */
   fftw_complex* const frho = data->frho;
+  fftw_complex* const frho_shifted = data->frho_shifted;
   const int N = data->N;
   const int N_half = N / 2;
 
@@ -530,6 +1106,7 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
   const double green_fac = data->green_fac;
   const double a_smooth2 = data->a_smooth2;
   const double k_fac = data->k_fac;
+  const int window_order = data->window_order;
 
   /* Find what slice of the full mesh is stored on this MPI rank */
   const int slice_offset = data->slice_offset;
@@ -547,6 +1124,9 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
     const double fx = k_fac * kx_d;
     const double sinc_kx_inv = (kx != 0) ? fx / sin(fx) : 1.;
 
+    /* Phase of the mesh shifted by half a cell along x */
+    const double cos_x = cos(fx), sin_x = sin(fx);
+
     for (int j = 0; j < N; ++j) {
 
       /* ky component of vector in Fourier space and 1/sinc(ky) */
@@ -555,6 +1135,10 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
       const double fy = k_fac * ky_d;
       const double sinc_ky_inv = (ky != 0) ? fy / sin(fy) : 1.;
 
+      /* Phase of the mesh shifted by half a cell along x and y */
+      const double cos_xy = cos_x * cos(fy) - sin_x * sin(fy);
+      const double sin_xy = sin_x * cos(fy) + cos_x * sin(fy);
+
       for (int k = 0; k < N_half + 1; ++k) {
 
         /* kz component of vector in Fourier space and 1/sinc(kz) */
@@ -574,19 +1158,43 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
         fourier_kernel_long_grav_eval(k2 * a_smooth2, &W);
         const double green_cor = green_fac * W / (k2 + FLT_MIN);
 
-        /* Deconvolution of CIC */
-        const double CIC_cor = sinc_kx_inv * sinc_ky_inv * sinc_kz_inv;
-        const double CIC_cor2 = CIC_cor * CIC_cor;
-        const double CIC_cor4 = CIC_cor2 * CIC_cor2;
+        /* Deconvolution of the window, once for the assignment and once
+         * for the interpolation */
+        const double window_cor = integer_pow(
+            sinc_kx_inv * sinc_ky_inv * sinc_kz_inv, 2 * window_order);
 
         /* Combined correction */
-        const double total_cor = green_cor * CIC_cor4;
+        const double total_cor = green_cor * window_cor;
 
         /* Apply to the mesh */
         const int index =
             N * (N_half + 1) * (i - slice_offset) + (N_half + 1) * j + k;
-        frho[index][0] *= total_cor;
-        frho[index][1] *= total_cor;
+
+        if (frho_shifted != NULL) {
+
+          /* Phase of the mesh shifted by half a cell */
+          const double cos_xyz = cos_xy * cos(fz) - sin_xy * sin(fz);
+          const double sin_xyz = sin_xy * cos(fz) + cos_xy * sin(fz);
+
+          /* Average the two meshes, moving the shifted one back in place */
+          const double re =
+              0.5 * (frho[index][0] + cos_xyz * frho_shifted[index][0] -
+                     sin_xyz * frho_shifted[index][1]);
+          const double im =
+              0.5 * (frho[index][1] + sin_xyz * frho_shifted[index][0] +
+                     cos_xyz * frho_shifted[index][1]);
+
+          frho[index][0] = re * total_cor;
+          frho[index][1] = im * total_cor;
+
+          /* And the potential on the shifted mesh */
+          frho_shifted[index][0] = (re * cos_xyz + im * sin_xyz) * total_cor;
+          frho_shifted[index][1] = (im * cos_xyz - re * sin_xyz) * total_cor;
+
+        } else {
+          frho[index][0] *= total_cor;
+          frho[index][1] *= total_cor;
+        }
       }
     }
   }
@@ -596,104 +1204,300 @@ void mesh_apply_Green_function_mapper(void* map_data, const int num,
  * @brief Apply the Green function in Fourier space to the density
  * array to get the potential.
  *
- * Also deconvolves the CIC kernel.
+ * Also deconvolves the mass assignment window and, with interlacing,
+ * averages the density field with the one of the mesh shifted by half a cell.
  *
  * @param tp The threadpool.
  * @param frho The NxNx(N/2) complex array of the Fourier transform of the
  * density field.
+ * @param frho_shifted The same for the mesh shifted by half a cell, which
+ * then also receives the potential on that mesh. NULL without interlacing.
  * @param slice_offset The x coordinate of the start of the slice on this MPI
  * rank
  * @param slice_width The width of the local slice on this MPI rank
  * @param N The dimension of the array.
  * @param r_s The Green function smoothing scale.
  * @param box_size The physical size of the simulation box.
+ * @param window_order The order of the mass assignment window.
  */
 void mesh_apply_Green_function(struct threadpool* tp, fftw_complex* frho,
+                               fftw_complex* frho_shifted,
                                const int slice_offset, const int slice_width,
                                const int N, const double r_s,
-                               const double box_size) {
+                               const double box_size, const int window_order) {
+
+  /* Some common factors */
+  struct Green_function_data data;
+  data.frho = frho;
+  data.frho_shifted = frho_shifted;
+  data.N = N;
+  data.green_fac = -1. / (M_PI * box_size);
+  data.a_smooth2 = 4. * M_PI * M_PI * r_s * r_s / (box_size * box_size);
+  data.k_fac = M_PI / (double)N;
+  data.slice_offset = slice_offset;
+  data.slice_width = slice_width;
+  data.window_order = window_order;
+
+  /* Parallelize the Green function application using the threadpool
+     to split the x-axis loop over the threads.
+     The array is N x N x (N/2). We use the thread to each deal with
+     a range [i_min, i_max[ x N x (N/2) */
+  threadpool_map(tp, mesh_apply_Green_function_mapper, frho, slice_width,
+                 sizeof(fftw_complex), threadpool_auto_chunk_size, &data);
+
+  /* Correct singularity at (0,0,0) */
+  if (slice_offset == 0 && slice_width > 0) {
+    frho[0][0] = 0.;
+    frho[0][1] = 0.;
+    if (frho_shifted != NULL) {
+      frho_shifted[0][0] = 0.;
+      frho_shifted[0][1] = 0.;
+    }
+  }
+}
+
+/**
+ * @brief Shared information about the Green function to be applied to the
+ * pencils by all the threads in the pool.
+ */
+struct Green_function_pencils_data {
+
+  const struct mesh_pencils* pencils;
+  double green_fac;
+  double a_smooth2;
+  double k_fac;
+};
+
+/**
+ * @brief Mapper function for the application of the Green function to the
+ * pencils along kx.
+ *
+ * @param map_data The index of the first pencil (NULL offset).
+ * @param num The number of pencils to iterate on.
+ * @param extra The properties of the Green function.
+ */
+void mesh_apply_Green_function_pencils_mapper(void* map_data, const int num,
+                                              void* extra) {
+
+  const struct Green_function_pencils_data* data =
+      (const struct Green_function_pencils_data*)extra;
+  const struct mesh_pencils* p = data->pencils;
+  const int N = p->N;
+  const int N_half = N / 2;
+  const double green_fac = data->green_fac;
+  const double a_smooth2 = data->a_smooth2;
+  const double k_fac = data->k_fac;
+
+  /* Fourier space range stored on this MPI rank */
+  const int nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t first = (size_t)map_data;
+
+  for (size_t l = first; l < first + num; l++) {
+
+    /* ky and kz components of the vectors in Fourier space and their 1/sinc */
+    const int j = p->ky_offset[p->px] + l % nky;
+    const int ky = (j > N_half ? j - N : j);
+    const int kz = p->kz_offset[p->py] + l / nky;
+    const double ky_d = (double)ky;
+    const double kz_d = (double)kz;
+    const double fy = k_fac * ky_d;
+    const double fz = k_fac * kz_d;
+    const double sinc_ky_inv = (ky != 0) ? fy / sin(fy) : 1.;
+    const double sinc_kz_inv = (kz != 0) ? fz / (sin(fz) + FLT_MIN) : 1.;
+
+    for (int i = 0; i < N; ++i) {
+
+      /* kx component of vector in Fourier space and 1/sinc(kx) */
+      const int kx = (i > N_half ? i - N : i);
+      const double kx_d = (double)kx;
+      const double fx = k_fac * kx_d;
+      const double sinc_kx_inv = (kx != 0) ? fx / sin(fx) : 1.;
+
+      /* Norm of vector in Fourier space */
+      const double k2 = (kx_d * kx_d + ky_d * ky_d + kz_d * kz_d);
+
+      /* Green function, zero at the singularity at (0,0,0) */
+      double total_cor = 0.;
+      if (k2 != 0.) {
+        double W = 1.;
+        fourier_kernel_long_grav_eval(k2 * a_smooth2, &W);
+        const double green_cor = green_fac * W / (k2 + FLT_MIN);
+
+        /* Deconvolution of the CIC window, once for the assignment and once
+         * for the interpolation */
+        const double window_cor =
+            integer_pow(sinc_kx_inv * sinc_ky_inv * sinc_kz_inv, 4);
+
+        total_cor = green_cor * window_cor;
+      }
+
+      /* Apply to the pencil */
+      const size_t index = l * N + i;
+      if (p->single_precision) {
+        float* frho = (float*)p->data;
+        frho[2 * index + 0] *= total_cor;
+        frho[2 * index + 1] *= total_cor;
+      } else {
+        double* frho = (double*)p->data;
+        frho[2 * index + 0] *= total_cor;
+        frho[2 * index + 1] *= total_cor;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Apply the Green function in Fourier space to the density stored in
+ * pencils along kx to get the potential.
+ *
+ * Also deconvolves the CIC mass assignment window.
+ *
+ * @param tp The threadpool.
+ * @param p The #mesh_pencils, whose work array contains the Fourier transform
+ * of the density field.
+ * @param r_s The Green function smoothing scale.
+ * @param box_size The physical size of the simulation box.
+ */
+void mesh_apply_Green_function_pencils(struct threadpool* tp,
+                                       const struct mesh_pencils* p,
+                                       const double r_s,
+                                       const double box_size) {
+
+  const int N = p->N;
+
+  /* Some common factors */
+  struct Green_function_pencils_data data;
+  data.pencils = p;
+  data.green_fac = -1. / (M_PI * box_size);
+  data.a_smooth2 = 4. * M_PI * M_PI * r_s * r_s / (box_size * box_size);
+  data.k_fac = M_PI / (double)N;
+
+  /* Number of pencils along kx on this rank */
+  const size_t nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+
+  threadpool_map(tp, mesh_apply_Green_function_pencils_mapper,
+                 /*map_data=*/NULL, nky * nkz, /*stride=*/1,
+                 threadpool_auto_chunk_size, &data);
+}
+
+#endif
+
+/**
+ * @brief Assigns the #gpart of the local cells to a density mesh using the
+ * window of the #pm_mesh.
+ *
+ * Without cells, all the #gpart of the space are assigned.
+ *
+ * @param mesh The #pm_mesh, whose settings select how to write to the mesh.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param rho The N*N*N density mesh to fill.
+ * @param shifted Are we assigning to the mesh shifted by half a cell used
+ * for interlacing?
+ */
+void pm_mesh_compute_density(const struct pm_mesh* mesh, const struct space* s,
+                             struct threadpool* tp, double* rho,
+                             const int shifted) {
+
+#ifdef HAVE_FFTW
+
+  const int N = mesh->N;
+  const int* local_cells = s->local_cells_top;
+  const int nr_local_cells = s->nr_local_cells;
 
-  /* Some common factors */
-  struct Green_function_data data;
-  data.frho = frho;
+  /* Zero everything */
+  bzero(rho, (size_t)N * N * N * sizeof(double));
+
+  /* Gather some neutrino constants if using delta-f weighting on the mesh */
+  struct neutrino_model nu_model;
+  bzero(&nu_model, sizeof(struct neutrino_model));
+  if (s->e->neutrino_properties->use_delta_f_mesh_only)
+    gather_neutrino_consts(s, &nu_model);
+
+  /* Gather the mesh shared information to be used by the threads */
+  struct cic_mapper_data data;
+  bzero(&data, sizeof(struct cic_mapper_data));
+  data.cells = s->cells_top;
+  data.rho = rho;
+  data.potential = NULL;
   data.N = N;
-  data.green_fac = -1. / (M_PI * box_size);
-  data.a_smooth2 = 4. * M_PI * M_PI * r_s * r_s / (box_size * box_size);
-  data.k_fac = M_PI / (double)N;
-  data.slice_offset = slice_offset;
-  data.slice_width = slice_width;
+  data.use_local_patches = mesh->use_local_patches;
+  data.fac = N / s->dim[0];
+  data.dim[0] = s->dim[0];
+  data.dim[1] = s->dim[1];
+  data.dim[2] = s->dim[2];
+  data.const_G = 0.f;
+  data.nu_model = &nu_model;
+  data.window_order = mesh->window_order;
+  data.shift = shifted ? 0.5 : 0.;
 
-  /* Parallelize the Green function application using the threadpool
-     to split the x-axis loop over the threads.
-     The array is N x N x (N/2). We use the thread to each deal with
-     a range [i_min, i_max[ x N x (N/2) */
-  threadpool_map(tp, mesh_apply_Green_function_mapper, frho, slice_width,
-                 sizeof(fftw_complex), threadpool_auto_chunk_size, &data);
+  if (mesh->window_order != 2 || shifted) {
 
-  /* Correct singularity at (0,0,0) */
-  if (slice_offset == 0 && slice_width > 0) {
-    frho[0][0] = 0.;
-    frho[0][1] = 0.;
+    /* Atomic writes with the general window, with or without cells */
+    if (nr_local_cells == 0)
+      threadpool_map(tp, gpart_to_mesh_window_mapper, s->gparts, s->nr_gparts,
+                     sizeof(struct gpart), threadpool_auto_chunk_size,
+                     (void*)&data);
+    else
+      threadpool_map(tp, cell_gpart_to_mesh_window_mapper, (void*)local_cells,
+                     nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                     (void*)&data);
+
+  } else if (nr_local_cells == 0) {
+
+    /* We don't have a cell infrastructure in place so we need to
+     * directly loop over the particles */
+    threadpool_map(tp, gpart_to_mesh_CIC_mapper, s->gparts, s->nr_gparts,
+                   sizeof(struct gpart), threadpool_auto_chunk_size,
+                   (void*)&data);
+
+  } else if (mesh->use_slabs) {
+
+    /* Assign the gparts of the local top-level cells slab by slab */
+    cell_gpart_to_mesh_CIC_slabs(tp, &data, local_cells, nr_local_cells);
+
+  } else { /* Normal case */
+
+    /* Do a parallel CIC mesh assignment of the gparts but only using
+     * the local top-level cells */
+    threadpool_map(tp, cell_gpart_to_mesh_CIC_mapper, (void*)local_cells,
+                   nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                   (void*)&data);
   }
-}
 
+#else
+  error("No FFTW library found. Cannot compute periodic long-range forces.");
 #endif
+}
+
+#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
 
 /**
- * @brief Compute the mesh forces and potential, including periodic correction
- *
- * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
- * compute the potential including short-range correction and move back
- * to real space. We use CIC for the interpolation.
- *
- * The potential is stored as a hashmap containing the potential mesh cells
- * which will be needed on this MPI rank. This is stored in
- * mesh->potential_local. The FFTW MPI library is used to do the FFTs.
- *
- * The particles mesh accelerations and potentials are also updated.
+ * @brief Compute the potential on the slab of the distributed mesh stored on
+ * this MPI rank, using the FFTW MPI library.
  *
  * @param mesh The #pm_mesh used to store the potential.
  * @param s The #space containing the particles.
  * @param tp The #threadpool object used for parallelisation.
+ * @param local_patches The density in the patches of the local top-level
+ * cells, cleaned on return.
+ * @param pencils (return) The decomposition of the mesh in slabs.
  * @param verbose Are we talkative?
+ * @return The potential on the local slab, to be freed with fftw_free().
  */
-void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
-                                   struct threadpool* tp, const int verbose) {
-
-#if defined(WITH_MPI) && defined(HAVE_MPI_FFTW)
+double* compute_potential_distributed_slabs(
+    struct pm_mesh* mesh, const struct space* s, struct threadpool* tp,
+    struct pm_mesh_patch* local_patches, struct mesh_pencils* pencils,
+    const int verbose) {
 
   const double r_s = mesh->r_s;
   const double box_size = s->dim[0];
-  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
   const int nr_local_cells = s->nr_local_cells;
-
-  if (r_s <= 0.) error("Invalid value of a_smooth");
-  if (mesh->dim[0] != dim[0] || mesh->dim[1] != dim[1] ||
-      mesh->dim[2] != dim[2])
-    error("Domain size does not match the value stored in the space.");
-
-  /* Some useful constants */
   const int N = mesh->N;
-  const double cell_fac = N / box_size;
 
   ticks tic = getticks();
 
-  /* Create an array of mesh patches. One per local top-level cell. */
-  struct pm_mesh_patch* local_patches = (struct pm_mesh_patch*)malloc(
-      nr_local_cells * sizeof(struct pm_mesh_patch));
-  if (local_patches == NULL)
-    error("Could not allocate array of local mesh patches!");
-  memset(local_patches, 0, nr_local_cells * sizeof(struct pm_mesh_patch));
-
-  /* Calculate contributions to density field on this MPI rank */
-  mpi_mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s,
-                                              local_patches);
-  if (verbose)
-    message("Accumulating mass to local patches took %.3f %s.",
-            clocks_from_ticks(getticks() - tic), clocks_getunit());
-
-  tic = getticks();
-
   /* Ask FFTW what slice of the density field we need to store on this task.
      Note that fftw_mpi_local_size_3d works in terms of the size of the complex
      output. The last dimension of the real input is padded to 2*(N/2+1). */
@@ -710,6 +1514,9 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
     message("Planning the FFT took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
 
+  /* Which slab every rank holds */
+  mesh_pencils_init_slabs(pencils, N, (int)local_n0);
+
   /* Allocate storage for mesh slices.
    *
    * Note: nalloc is the number of *complex* values.
@@ -722,8 +1529,8 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
   /* Construct density field slices from contributions stored in the local
    * patches.
    * Note: This cleans up the local_patches entries. */
-  mpi_mesh_local_patches_to_slices(N, (int)local_n0, local_patches,
-                                   nr_local_cells, rho_slice, tp, verbose);
+  mpi_mesh_local_patches_to_slices(pencils, local_patches, nr_local_cells,
+                                   rho_slice, tp, verbose);
   if (verbose)
     message("Assembling mesh slices took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
@@ -758,8 +1565,9 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
   tic = getticks();
 
   /* Apply Green function to local slice of the MPI mesh */
-  mesh_apply_Green_function(tp, frho_slice, local_0_start, local_n0, N, r_s,
-                            box_size);
+  mesh_apply_Green_function(tp, frho_slice, /*frho_shifted=*/NULL,
+                            local_0_start, local_n0, N, r_s, box_size,
+                            /*window_order=*/2);
   if (verbose)
     message("Applying Green function took %.3f %s.",
             clocks_from_ticks(getticks() - tic), clocks_getunit());
@@ -792,11 +1600,179 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
   /* We can now free the Fourier-space data */
   fftw_free(frho_slice);
 
+  return rho_slice;
+}
+
+#endif /* WITH_MPI && HAVE_MPI_FFTW */
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+/**
+ * @brief Compute the potential on the pencil of the distributed mesh stored
+ * on this MPI rank, using our own pencil FFTs.
+ *
+ * Unlike the slabs, whose number is capped at N, the pencils let up to
+ * N*(N/2+1) ranks take part in the FFTs. Their transposes are also only
+ * between the ranks of the same row or column of pencils.
+ *
+ * @param mesh The #pm_mesh used to store the potential.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param local_patches The density in the patches of the local top-level
+ * cells, cleaned on return.
+ * @param pencils (return) The decomposition of the mesh in pencils.
+ * @param verbose Are we talkative?
+ * @return The potential on the local pencil, to be freed with fftw_free().
+ */
+double* compute_potential_distributed_pencils(
+    struct pm_mesh* mesh, const struct space* s, struct threadpool* tp,
+    struct pm_mesh_patch* local_patches, struct mesh_pencils* pencils,
+    const int verbose) {
+
+  const double r_s = mesh->r_s;
+  const double box_size = s->dim[0];
+  const int nr_local_cells = s->nr_local_cells;
+  const int N = mesh->N;
+
+  if (s->e->neutrino_properties->use_linear_response)
+    error("Linear response neutrinos need the slabs of the distributed mesh.");
+
+  ticks tic = getticks();
+
+  /* Decompose the mesh in pencils */
+  mesh_pencils_init(pencils, N, mesh->distributed_mesh_single_precision);
+  const size_t local_size = mesh_pencils_local_size(pencils);
+  if (verbose)
+    message("Local density field pencil is %d x %d, in a %d x %d grid.",
+            pencils->x_offset[pencils->px + 1] - pencils->x_offset[pencils->px],
+            pencils->y_offset[pencils->py + 1] - pencils->y_offset[pencils->py],
+            pencils->nr_x, pencils->nr_y);
+
+  /* Allocate storage for the local pencil, padded as the slabs */
+  double* rho_pencil =
+      (double*)fftw_malloc((local_size > 0 ? local_size : 1) * sizeof(double));
+  if (rho_pencil == NULL) error("Error allocating memory for the mesh pencil.");
+  memset(rho_pencil, 0, local_size * sizeof(double));
+
+  if (verbose)
+    message("Allocating the pencils took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Construct density field pencils from contributions stored in the local
+   * patches.
+   * Note: This cleans up the local_patches entries. */
+  mpi_mesh_local_patches_to_slices(pencils, local_patches, nr_local_cells,
+                                   rho_pencil, tp, verbose);
+  if (verbose)
+    message("Assembling mesh pencils took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Carry out the Fourier transform, leaving pencils along kx */
+  mesh_pencils_forward_FFT(pencils, rho_pencil, tp, verbose);
+  if (verbose)
+    message("Pencil forward Fourier transform took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* Apply Green function to the local pencils in Fourier space */
+  mesh_apply_Green_function_pencils(tp, pencils, r_s, box_size);
+  if (verbose)
+    message("Applying Green function took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  /* And go back to the local pencil in real space */
+  mesh_pencils_backward_FFT(pencils, rho_pencil, tp, verbose);
+  if (verbose)
+    message("Pencil reverse Fourier transform took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  return rho_pencil;
+}
+
+#endif /* WITH_MPI && HAVE_FFTW */
+
+/**
+ * @brief Compute the mesh forces and potential, including periodic correction
+ *
+ * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
+ * compute the potential including short-range correction and move back
+ * to real space. We use CIC for the interpolation.
+ *
+ * The potential is stored as a hashmap containing the potential mesh cells
+ * which will be needed on this MPI rank. This is stored in
+ * mesh->potential_local. The FFTs are done on slabs of the mesh with the
+ * FFTW MPI library, or on pencils with our own transposes around the
+ * non-MPI FFTW library.
+ *
+ * The particles mesh accelerations and potentials are also updated.
+ *
+ * @param mesh The #pm_mesh used to store the potential.
+ * @param s The #space containing the particles.
+ * @param tp The #threadpool object used for parallelisation.
+ * @param verbose Are we talkative?
+ */
+void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
+                                   struct threadpool* tp, const int verbose) {
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+  const double r_s = mesh->r_s;
+  const double box_size = s->dim[0];
+  const double dim[3] = {s->dim[0], s->dim[1], s->dim[2]};
+  const int nr_local_cells = s->nr_local_cells;
+
+  if (r_s <= 0.) error("Invalid value of a_smooth");
+  if (mesh->dim[0] != dim[0] || mesh->dim[1] != dim[1] ||
+      mesh->dim[2] != dim[2])
+    error("Domain size does not match the value stored in the space.");
+
+  /* Some useful constants */
+  const int N = mesh->N;
+  const double cell_fac = N / box_size;
+
+  ticks tic = getticks();
+
+  /* Create an array of mesh patches. One per local top-level cell. */
+  struct pm_mesh_patch* local_patches = (struct pm_mesh_patch*)malloc(
+      nr_local_cells * sizeof(struct pm_mesh_patch));
+  if (local_patches == NULL)
+    error("Could not allocate array of local mesh patches!");
+  memset(local_patches, 0, nr_local_cells * sizeof(struct pm_mesh_patch));
+
+  /* Calculate contributions to density field on this MPI rank */
+  mpi_mesh_accumulate_gparts_to_local_patches(tp, N, cell_fac, s,
+                                              local_patches);
+  if (verbose)
+    message("Accumulating mass to local patches took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  /* Get the potential on the part of the mesh stored on this rank */
+  struct mesh_pencils pencils;
+  double* rho_slice = NULL;
+  if (mesh->distributed_mesh_uses_pencils) {
+    rho_slice = compute_potential_distributed_pencils(
+        mesh, s, tp, local_patches, &pencils, verbose);
+  } else {
+#ifdef HAVE_MPI_FFTW
+    rho_slice = compute_potential_distributed_slabs(
+        mesh, s, tp, local_patches, &pencils, verbose);
+#else
+    error("No FFTW MPI library available. Cannot compute distributed mesh.");
+#endif
+  }
+
   tic = getticks();
 
   /* Fetch MPI mesh entries we need on this rank from other ranks */
-  mpi_mesh_fetch_potential(N, cell_fac, s, local_0_start, local_n0, rho_slice,
-                           local_patches, tp, verbose);
+  mpi_mesh_fetch_potential(N, cell_fac, s, &pencils, rho_slice, local_patches,
+                           tp, verbose);
 
   if (verbose)
     message("Fetching local potential took %.3f %s.",
@@ -804,6 +1780,7 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
 
   /* Free the local slice of the potential */
   fftw_free(rho_slice);
+  mesh_pencils_clean(&pencils);
 
   tic = getticks();
 
@@ -820,7 +1797,7 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
             clocks_from_ticks(getticks() - tic), clocks_getunit());
 
 #else
-  error("No FFTW MPI library available. Cannot compute distributed mesh.");
+  error("No MPI or FFTW library available. Cannot compute distributed mesh.");
 #endif
 }
 
@@ -829,7 +1806,8 @@ void compute_potential_distributed(struct pm_mesh* mesh, const struct space* s,
  *
  * Interpolates the top-level multipoles on-to a mesh, move to Fourier space,
  * compute the potential including short-range correction and move back
- * to real space. We use CIC for the interpolation.
+ * to real space. We use CIC, TSC or PCS for the interpolation, possibly
+ * with a second mesh shifted by half a cell (interlacing).
  *
  * This version stores the full N*N*N mesh on each MPI rank and uses the
  * non-MPI version of FFTW.
@@ -880,47 +1858,31 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   fftw_plan inverse_plan = fftw_plan_dft_c2r_3d(
       N, N, N, frho, rho, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
 
-  ticks tic = getticks();
-
-  /* Zero everything */
-  bzero(rho, N * N * N * sizeof(double));
-
-  /* Gather some neutrino constants if using delta-f weighting on the mesh */
-  struct neutrino_model nu_model;
-  bzero(&nu_model, sizeof(struct neutrino_model));
-  if (s->e->neutrino_properties->use_delta_f_mesh_only)
-    gather_neutrino_consts(s, &nu_model);
-
-  /* Gather the mesh shared information to be used by the threads */
-  struct cic_mapper_data data;
-  data.cells = s->cells_top;
-  data.rho = rho;
-  data.potential = NULL;
-  data.N = N;
-  data.use_local_patches = mesh->use_local_patches;
-  data.fac = cell_fac;
-  data.dim[0] = dim[0];
-  data.dim[1] = dim[1];
-  data.dim[2] = dim[2];
-  data.const_G = 0.f;
-  data.nu_model = &nu_model;
-
-  if (nr_local_cells == 0) {
-
-    /* We don't have a cell infrastructure in place so we need to
-     * directly loop over the particles */
-    threadpool_map(tp, gpart_to_mesh_CIC_mapper, s->gparts, s->nr_gparts,
-                   sizeof(struct gpart), threadpool_auto_chunk_size,
-                   (void*)&data);
+  /* Same again for the mesh shifted by half a cell if interlacing */
+  double* restrict rho_shifted = mesh->potential_global_shifted;
+  fftw_complex* restrict frho_shifted = NULL;
+  fftw_plan forward_plan_shifted = NULL, inverse_plan_shifted = NULL;
+  if (mesh->use_interlacing) {
+    if (rho_shifted == NULL)
+      error("Error allocating memory for shifted density mesh");
+    frho_shifted = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * N * N *
+                                              (N_half + 1));
+    if (frho_shifted == NULL)
+      error("Error allocating memory for transform of shifted density mesh");
+    memuse_log_allocation("fftw_frho_shifted", frho_shifted, 1,
+                          sizeof(fftw_complex) * N * N * (N_half + 1));
+    forward_plan_shifted = fftw_plan_dft_r2c_3d(
+        N, N, N, rho_shifted, frho_shifted, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+    inverse_plan_shifted = fftw_plan_dft_c2r_3d(
+        N, N, N, frho_shifted, rho_shifted, FFTW_ESTIMATE | FFTW_DESTROY_INPUT);
+  }
 
-  } else { /* Normal case */
+  ticks tic = getticks();
 
-    /* Do a parallel CIC mesh assignment of the gparts but only using
-     * the local top-level cells */
-    threadpool_map(tp, cell_gpart_to_mesh_CIC_mapper, (void*)local_cells,
-                   nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
-                   (void*)&data);
-  }
+  /* Assign the particles to the density mesh(es) */
+  pm_mesh_compute_density(mesh, s, tp, rho, /*shifted=*/0);
+  if (mesh->use_interlacing)
+    pm_mesh_compute_density(mesh, s, tp, rho_shifted, /*shifted=*/1);
 
   if (verbose)
     message("Gpart assignment took %.3f %s.",
@@ -934,6 +1896,9 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   /* Merge everybody's share of the density mesh */
   MPI_Allreduce(MPI_IN_PLACE, rho, N * N * N, MPI_DOUBLE, MPI_SUM,
                 MPI_COMM_WORLD);
+  if (mesh->use_interlacing)
+    MPI_Allreduce(MPI_IN_PLACE, rho_shifted, N * N * N, MPI_DOUBLE, MPI_SUM,
+                  MPI_COMM_WORLD);
 
   if (verbose)
     message("Mesh MPI-reduction took %.3f %s.",
@@ -947,6 +1912,7 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
 
   /* Fourier transform to go to magic-land */
   fftw_execute(forward_plan);
+  if (mesh->use_interlacing) fftw_execute(forward_plan_shifted);
 
   if (verbose)
     message("Forward Fourier transform took %.3f %s.",
@@ -957,9 +1923,11 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
 
   tic = getticks();
 
-  /* Now de-convolve the CIC kernel and apply the Green function */
-  mesh_apply_Green_function(tp, frho, /*slice_offset=*/0, /*slice_width=*/N,
-                            /* mesh_size=*/N, r_s, box_size);
+  /* Now de-convolve the window, combine the interlaced meshes and apply the
+   * Green function */
+  mesh_apply_Green_function(tp, frho, frho_shifted, /*slice_offset=*/0,
+                            /*slice_width=*/N, /* mesh_size=*/N, r_s, box_size,
+                            mesh->window_order);
 
   if (verbose)
     message("Applying Green function took %.3f %s.",
@@ -971,6 +1939,9 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   if (s->e->neutrino_properties->use_linear_response) {
     neutrino_response_compute(s, mesh, tp, frho, /*slice_offset=*/0,
                               /*slice_width=*/N, verbose);
+    if (mesh->use_interlacing)
+      neutrino_response_compute(s, mesh, tp, frho_shifted, /*slice_offset=*/0,
+                                /*slice_width=*/N, verbose);
 
     if (verbose)
       message("Applying neutrino response took %.3f %s.",
@@ -981,6 +1952,7 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
 
   /* Fourier transform to come back from magic-land */
   fftw_execute(inverse_plan);
+  if (mesh->use_interlacing) fftw_execute(inverse_plan_shifted);
 
   if (verbose)
     message("Reverse Fourier transform took %.3f %s.",
@@ -991,6 +1963,7 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
 
   /* Let's store it in the structure */
   mesh->potential_global = rho;
+  mesh->potential_global_shifted = rho_shifted;
 
   /* message("\n\n\n POTENTIAL"); */
   /* print_array(mesh->potential_global, N); */
@@ -998,6 +1971,8 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   tic = getticks();
 
   /* Gather the mesh shared information to be used by the threads */
+  struct cic_mapper_data data;
+  bzero(&data, sizeof(struct cic_mapper_data));
   data.cells = s->cells_top;
   data.rho = NULL;
   data.potential = mesh->potential_global;
@@ -1007,8 +1982,22 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   data.dim[1] = dim[1];
   data.dim[2] = dim[2];
   data.const_G = s->e->physical_constants->const_newton_G;
+  data.window_order = mesh->window_order;
+  data.potential_shifted = mesh->potential_global_shifted;
+
+  if (mesh->window_order != 2 || mesh->use_interlacing) {
 
-  if (nr_local_cells == 0) {
+    /* Interpolation with the general window, with or without cells */
+    if (nr_local_cells == 0)
+      threadpool_map(tp, mesh_to_gpart_window_mapper, s->gparts, s->nr_gparts,
+                     sizeof(struct gpart), threadpool_auto_chunk_size,
+                     (void*)&data);
+    else
+      threadpool_map(tp, cell_mesh_to_gpart_window_mapper, (void*)local_cells,
+                     nr_local_cells, sizeof(int), threadpool_auto_chunk_size,
+                     (void*)&data);
+
+  } else if (nr_local_cells == 0) {
 
     /* We don't have a cell infrastructure in place so we need to
      * directly loop over the particles */
@@ -1034,6 +2023,12 @@ void compute_potential_global(struct pm_mesh* mesh, const struct space* s,
   fftw_destroy_plan(inverse_plan);
   memuse_log_allocation("fftw_frho", frho, 0, 0);
   fftw_free(frho);
+  if (mesh->use_interlacing) {
+    fftw_destroy_plan(forward_plan_shifted);
+    fftw_destroy_plan(inverse_plan_shifted);
+    memuse_log_allocation("fftw_frho_shifted", frho_shifted, 0, 0);
+    fftw_free(frho_shifted);
+  }
 
 #else
   error("No FFTW library found. Cannot compute periodic long-range forces.");
@@ -1084,6 +2079,17 @@ void pm_mesh_allocate(struct pm_mesh* mesh) {
       error("Error allocating memory for the long-range gravity mesh.");
     memuse_log_allocation("fftw_mesh.potential", mesh->potential_global, 1,
                           sizeof(double) * N * N * N);
+
+    /* And for the shifted one if interlacing */
+    if (mesh->use_interlacing) {
+      mesh->potential_global_shifted =
+          (double*)fftw_malloc(sizeof(double) * N * N * N);
+      if (mesh->potential_global_shifted == NULL)
+        error("Error allocating memory for the shifted gravity mesh.");
+      memuse_log_allocation("fftw_mesh.potential_shifted",
+                            mesh->potential_global_shifted, 1,
+                            sizeof(double) * N * N * N);
+    }
   }
 #else
   error("No FFTW library found. Cannot compute periodic long-range forces.");
@@ -1105,6 +2111,13 @@ void pm_mesh_free(struct pm_mesh* mesh) {
     mesh->potential_global = NULL;
   }
 
+  if (!mesh->distributed_mesh && mesh->potential_global_shifted) {
+    memuse_log_allocation("fftw_mesh.potential_shifted",
+                          mesh->potential_global_shifted, 0, 0);
+    free(mesh->potential_global_shifted);
+    mesh->potential_global_shifted = NULL;
+  }
+
 #else
   error("No FFTW library found. Cannot compute periodic long-range forces.");
 #endif
@@ -1154,7 +2167,13 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
   mesh->periodic = 1;
   mesh->N = N;
   mesh->distributed_mesh = props->distributed_mesh;
+  mesh->distributed_mesh_uses_pencils = props->distributed_mesh_uses_pencils;
+  mesh->distributed_mesh_single_precision =
+      props->distributed_mesh_single_precision;
   mesh->use_local_patches = props->mesh_uses_local_patches;
+  mesh->use_slabs = props->mesh_uses_slabs;
+  mesh->window_order = props->mesh_window_order;
+  mesh->use_interlacing = props->mesh_uses_interlacing;
   mesh->dim[0] = dim[0];
   mesh->dim[1] = dim[1];
   mesh->dim[2] = dim[2];
@@ -1164,6 +2183,7 @@ void pm_mesh_init(struct pm_mesh* mesh, const struct gravity_props* props,
   mesh->r_cut_max = mesh->r_s * props->r_cut_max_ratio;
   mesh->r_cut_min = mesh->r_s * props->r_cut_min_ratio;
   mesh->potential_global = NULL;
+  mesh->potential_global_shifted = NULL;
   mesh->ti_beg_mesh_last = -1;
   mesh->ti_end_mesh_last = -1;
   mesh->ti_beg_mesh_next = -1;
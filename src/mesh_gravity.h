@@ -50,10 +50,27 @@ struct pm_mesh {
   /*! Whether mesh is distributed between MPI ranks */
   int distributed_mesh;
 
+  /*! Whether the distributed mesh is decomposed in pencils rather than in
+   * the slabs of the FFTW MPI library */
+  int distributed_mesh_uses_pencils;
+
+  /*! Whether the FFTs of the pencils are done in single precision */
+  int distributed_mesh_single_precision;
+
   /*! Whether or not to use local patches rather than
    * direct atomic writes to the mesh when running without MPI */
   int use_local_patches;
 
+  /*! Whether or not to assign the particles slab by slab rather than with
+   * atomic writes or local patches when running without MPI */
+  int use_slabs;
+
+  /*! Order of the mass assignment window: 2 (CIC), 3 (TSC) or 4 (PCS) */
+  int window_order;
+
+  /*! Whether or not to also use a mesh shifted by half a cell */
+  int use_interlacing;
+
   /*! Integer time-step end of the mesh force for the last step */
   integertime_t ti_end_mesh_last;
 
@@ -86,6 +103,9 @@ struct pm_mesh {
 
   /*! Full N*N*N potential field */
   double *potential_global;
+
+  /*! Full N*N*N potential field on the mesh shifted by half a cell */
+  double *potential_global_shifted;
 };
 
 void pm_mesh_init(struct pm_mesh *mesh, const struct gravity_props *props,
@@ -93,6 +113,9 @@ void pm_mesh_init(struct pm_mesh *mesh, const struct gravity_props *props,
 void pm_mesh_init_no_mesh(struct pm_mesh *mesh, double dim[3]);
 void pm_mesh_compute_potential(struct pm_mesh *mesh, const struct space *s,
                                struct threadpool *tp, int verbose);
+void pm_mesh_compute_density(const struct pm_mesh *mesh, const struct space *s,
+                             struct threadpool *tp, double *rho,
+                             int shifted);
 void pm_mesh_clean(struct pm_mesh *mesh);
 
 void pm_mesh_allocate(struct pm_mesh *mesh);
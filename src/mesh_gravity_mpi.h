@@ -28,6 +28,7 @@ struct cell;
 struct threadpool;
 struct pm_mesh;
 struct pm_mesh_patch;
+struct mesh_pencils;
 struct neutrino_model;
 
 void accumulate_cell_to_local_patch(const int N, const double fac,
@@ -39,14 +40,15 @@ void mpi_mesh_accumulate_gparts_to_local_patches(
     struct threadpool *tp, const int N, const double fac, const struct space *s,
     struct pm_mesh_patch *local_patches);
 
-void mpi_mesh_local_patches_to_slices(const int N, const int local_n0,
+void mpi_mesh_local_patches_to_slices(const struct mesh_pencils *pencils,
                                       struct pm_mesh_patch *local_patches,
                                       const int nr_patches, double *mesh,
                                       struct threadpool *tp, const int verbose);
 
 void mpi_mesh_fetch_potential(const int N, const double fac,
-                              const struct space *s, int local_0_start,
-                              int local_n0, double *potential_slice,
+                              const struct space *s,
+                              const struct mesh_pencils *pencils,
+                              double *potential_slice,
                               struct pm_mesh_patch *local_patches,
                               struct threadpool *tp, const int verbose);
 
@@ -0,0 +1,748 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+/* Standard includes */
+#include <limits.h>
+#include <string.h>
+
+/* This object's header. */
+#include "mesh_gravity_pencils.h"
+
+/* Local includes. */
+#include "clocks.h"
+#include "error.h"
+#include "threadpool.h"
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+/**
+ * @brief The kinds of 1D FFTs done on the pencils.
+ */
+enum mesh_pencils_fft_type {
+  mesh_pencils_fft_r2c,
+  mesh_pencils_fft_c2c_forward,
+  mesh_pencils_fft_c2c_backward,
+  mesh_pencils_fft_c2r
+};
+
+/**
+ * @brief Shared information about a batch of 1D FFTs to be used by all the
+ * threads in the pool.
+ */
+struct mesh_pencils_fft_data {
+
+  /*! The first line and the number of bytes between lines */
+  char *lines;
+  size_t line_size;
+
+  /*! The kind of FFT */
+  enum mesh_pencils_fft_type type;
+
+  /*! The plan, in the precision of the pencils */
+  int single_precision;
+  fftw_plan plan;
+#ifdef HAVE_FLOAT_FFTW
+  fftwf_plan plan_f;
+#endif
+};
+
+/**
+ * @brief Mapper function for the 1D FFTs of a batch of lines.
+ *
+ * @param map_data The index of the first line (NULL offset).
+ * @param num The number of lines to transform.
+ * @param extra The #mesh_pencils_fft_data.
+ */
+void mesh_pencils_fft_mapper(void *map_data, int num, void *extra) {
+
+  const struct mesh_pencils_fft_data *data =
+      (const struct mesh_pencils_fft_data *)extra;
+  const size_t first = (size_t)map_data;
+
+  for (size_t l = first; l < first + num; l++) {
+
+    /* Transforms are done in place */
+    char *line = data->lines + l * data->line_size;
+
+    if (data->single_precision) {
+#ifdef HAVE_FLOAT_FFTW
+      switch (data->type) {
+        case mesh_pencils_fft_r2c:
+          fftwf_execute_dft_r2c(data->plan_f, (float *)line,
+                                (fftwf_complex *)line);
+          break;
+        case mesh_pencils_fft_c2r:
+          fftwf_execute_dft_c2r(data->plan_f, (fftwf_complex *)line,
+                                (float *)line);
+          break;
+        default:
+          fftwf_execute_dft(data->plan_f, (fftwf_complex *)line,
+                            (fftwf_complex *)line);
+      }
+#endif
+    } else {
+      switch (data->type) {
+        case mesh_pencils_fft_r2c:
+          fftw_execute_dft_r2c(data->plan, (double *)line,
+                               (fftw_complex *)line);
+          break;
+        case mesh_pencils_fft_c2r:
+          fftw_execute_dft_c2r(data->plan, (fftw_complex *)line,
+                               (double *)line);
+          break;
+        default:
+          fftw_execute_dft(data->plan, (fftw_complex *)line,
+                           (fftw_complex *)line);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Does 1D FFTs in place on the lines stored contiguously in the work
+ * array of the pencils.
+ *
+ * The r2c and c2r lines are N/2+1 complex numbers long, the c2c ones N.
+ *
+ * @param p The #mesh_pencils.
+ * @param type The kind of FFT.
+ * @param nr_lines The number of lines.
+ * @param tp The #threadpool object.
+ */
+void mesh_pencils_fft(struct mesh_pencils *p,
+                      const enum mesh_pencils_fft_type type,
+                      const size_t nr_lines, struct threadpool *tp) {
+
+  if (nr_lines == 0) return;
+
+  const int N = p->N;
+  const int is_c2c = (type == mesh_pencils_fft_c2c_forward ||
+                      type == mesh_pencils_fft_c2c_backward);
+  const int sign =
+      (type == mesh_pencils_fft_c2c_backward) ? FFTW_BACKWARD : FFTW_FORWARD;
+  const size_t csize = p->single_precision ? 2 * sizeof(float)
+                                           : 2 * sizeof(double);
+
+  /* The plans are only executed on new arrays, so planning must not touch
+   * the data */
+  const unsigned flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+
+  struct mesh_pencils_fft_data data;
+  data.lines = (char *)p->data;
+  data.line_size = (is_c2c ? N : N / 2 + 1) * csize;
+  data.type = type;
+  data.single_precision = p->single_precision;
+  data.plan = NULL;
+
+  if (p->single_precision) {
+#ifdef HAVE_FLOAT_FFTW
+    fftwf_complex *line = (fftwf_complex *)p->data;
+    if (type == mesh_pencils_fft_r2c)
+      data.plan_f = fftwf_plan_dft_r2c_1d(N, (float *)line, line, flags);
+    else if (type == mesh_pencils_fft_c2r)
+      data.plan_f = fftwf_plan_dft_c2r_1d(N, line, (float *)line, flags);
+    else
+      data.plan_f = fftwf_plan_dft_1d(N, line, line, sign, flags);
+#else
+    error("No single precision FFTW library found.");
+#endif
+  } else {
+    fftw_complex *line = (fftw_complex *)p->data;
+    if (type == mesh_pencils_fft_r2c)
+      data.plan = fftw_plan_dft_r2c_1d(N, (double *)line, line, flags);
+    else if (type == mesh_pencils_fft_c2r)
+      data.plan = fftw_plan_dft_c2r_1d(N, line, (double *)line, flags);
+    else
+      data.plan = fftw_plan_dft_1d(N, line, line, sign, flags);
+  }
+
+  threadpool_map(tp, mesh_pencils_fft_mapper, /*map_data=*/NULL, nr_lines,
+                 /*stride=*/1, threadpool_auto_chunk_size, &data);
+
+  if (p->single_precision) {
+#ifdef HAVE_FLOAT_FFTW
+    fftwf_destroy_plan(data.plan_f);
+#endif
+  } else {
+    fftw_destroy_plan(data.plan);
+  }
+}
+
+/**
+ * @brief Copies n complex numbers of either precision between two strided
+ * arrays.
+ *
+ * @param dest The first number to write.
+ * @param dest_stride The stride of the output, in complex numbers.
+ * @param src The first number to read.
+ * @param src_stride The stride of the input, in complex numbers.
+ * @param n The number of complex numbers.
+ * @param csize The size of a complex number.
+ */
+static void mesh_pencils_copy(char *restrict dest, const size_t dest_stride,
+                              const char *restrict src,
+                              const size_t src_stride, const size_t n,
+                              const size_t csize) {
+
+  if (dest_stride == 1 && src_stride == 1) {
+    memcpy(dest, src, n * csize);
+  } else if (csize == 2 * sizeof(double)) {
+    for (size_t i = 0; i < n; i++)
+      memcpy(dest + i * dest_stride * 2 * sizeof(double),
+             src + i * src_stride * 2 * sizeof(double), 2 * sizeof(double));
+  } else {
+    for (size_t i = 0; i < n; i++)
+      memcpy(dest + i * dest_stride * 2 * sizeof(float),
+             src + i * src_stride * 2 * sizeof(float), 2 * sizeof(float));
+  }
+}
+
+/**
+ * @brief Converts the block sizes of a transpose to MPI counts and
+ * displacements.
+ *
+ * @param sizes The number of complex numbers in each block.
+ * @param n The number of blocks.
+ * @param counts (return) The MPI counts.
+ * @param displs (return) The MPI displacements.
+ */
+static void mesh_pencils_counts(const size_t *sizes, const int n, int *counts,
+                                int *displs) {
+
+  size_t offset = 0;
+  for (int q = 0; q < n; q++) {
+    if (sizes[q] > INT_MAX || offset > INT_MAX)
+      error("Mesh pencils too large for the MPI transposes.");
+    counts[q] = (int)sizes[q];
+    displs[q] = (int)offset;
+    offset += sizes[q];
+  }
+}
+
+/**
+ * @brief Transposes the pencils between the ranks of a row, i.e. between
+ * [x][y][kz] pencils along kz and [x][kz][y] pencils along y.
+ *
+ * @param p The #mesh_pencils.
+ * @param forward Whether to go from the kz to the y pencils or back.
+ */
+void mesh_pencils_transpose_row(struct mesh_pencils *p, const int forward) {
+
+  const int N = p->N;
+  const size_t Nc = N / 2 + 1;
+  const int nr_q = p->nr_y;
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+  const size_t csize = p->single_precision ? 2 * sizeof(float)
+                                           : 2 * sizeof(double);
+  char *data = (char *)p->data;
+  char *sendbuf = (char *)p->sendbuf;
+  char *recvbuf = (char *)p->recvbuf;
+
+  size_t *send_sizes = (size_t *)calloc(nr_q, sizeof(size_t));
+  size_t *recv_sizes = (size_t *)calloc(nr_q, sizeof(size_t));
+  int *counts = (int *)malloc(4 * nr_q * sizeof(int));
+  if (send_sizes == NULL || recv_sizes == NULL || counts == NULL)
+    error("Failed to allocate the transpose counts.");
+
+  /* Pack the blocks for the other ranks, [x][kz][y] in both directions */
+  size_t offset = 0;
+  for (int q = 0; q < nr_q; q++) {
+    const size_t y0_q = p->y_offset[q];
+    const size_t ny_q = p->y_offset[q + 1] - y0_q;
+    const size_t kz0_q = p->kz_offset[q];
+    const size_t nkz_q = p->kz_offset[q + 1] - kz0_q;
+
+    if (forward) {
+      for (size_t i = 0; i < nx; i++)
+        for (size_t kz = 0; kz < nkz_q; kz++)
+          mesh_pencils_copy(sendbuf + (offset + (i * nkz_q + kz) * ny) * csize,
+                            1, data + (i * ny * Nc + kz0_q + kz) * csize, Nc,
+                            ny, csize);
+      send_sizes[q] = nx * nkz_q * ny;
+      recv_sizes[q] = nx * nkz * ny_q;
+    } else {
+      for (size_t i = 0; i < nx; i++)
+        for (size_t kz = 0; kz < nkz; kz++)
+          mesh_pencils_copy(
+              sendbuf + (offset + (i * nkz + kz) * ny_q) * csize, 1,
+              data + ((i * nkz + kz) * N + y0_q) * csize, 1, ny_q, csize);
+      send_sizes[q] = nx * nkz * ny_q;
+      recv_sizes[q] = nx * nkz_q * ny;
+    }
+    offset += send_sizes[q];
+  }
+
+  /* Exchange the blocks */
+  mesh_pencils_counts(send_sizes, nr_q, &counts[0], &counts[nr_q]);
+  mesh_pencils_counts(recv_sizes, nr_q, &counts[2 * nr_q], &counts[3 * nr_q]);
+  const MPI_Datatype type =
+      p->single_precision ? MPI_C_FLOAT_COMPLEX : MPI_C_DOUBLE_COMPLEX;
+  MPI_Alltoallv(sendbuf, &counts[0], &counts[nr_q], type, recvbuf,
+                &counts[2 * nr_q], &counts[3 * nr_q], type, p->comm_row);
+
+  /* Unpack the blocks from the other ranks */
+  offset = 0;
+  for (int q = 0; q < nr_q; q++) {
+    const size_t y0_q = p->y_offset[q];
+    const size_t ny_q = p->y_offset[q + 1] - y0_q;
+    const size_t kz0_q = p->kz_offset[q];
+    const size_t nkz_q = p->kz_offset[q + 1] - kz0_q;
+
+    if (forward) {
+      for (size_t i = 0; i < nx; i++)
+        for (size_t kz = 0; kz < nkz; kz++)
+          mesh_pencils_copy(
+              data + ((i * nkz + kz) * N + y0_q) * csize, 1,
+              recvbuf + (offset + (i * nkz + kz) * ny_q) * csize, 1, ny_q,
+              csize);
+    } else {
+      for (size_t i = 0; i < nx; i++)
+        for (size_t kz = 0; kz < nkz_q; kz++)
+          mesh_pencils_copy(data + (i * ny * Nc + kz0_q + kz) * csize, Nc,
+                            recvbuf + (offset + (i * nkz_q + kz) * ny) * csize,
+                            1, ny, csize);
+    }
+    offset += recv_sizes[q];
+  }
+
+  free(send_sizes);
+  free(recv_sizes);
+  free(counts);
+}
+
+/**
+ * @brief Transposes the pencils between the ranks of a column, i.e. between
+ * [x][kz][ky] pencils along ky and [kz][ky][kx] pencils along kx.
+ *
+ * @param p The #mesh_pencils.
+ * @param forward Whether to go from the ky to the kx pencils or back.
+ */
+void mesh_pencils_transpose_col(struct mesh_pencils *p, const int forward) {
+
+  const int N = p->N;
+  const int nr_q = p->nr_x;
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+  const size_t csize = p->single_precision ? 2 * sizeof(float)
+                                           : 2 * sizeof(double);
+  char *data = (char *)p->data;
+  char *sendbuf = (char *)p->sendbuf;
+  char *recvbuf = (char *)p->recvbuf;
+
+  size_t *send_sizes = (size_t *)calloc(nr_q, sizeof(size_t));
+  size_t *recv_sizes = (size_t *)calloc(nr_q, sizeof(size_t));
+  int *counts = (int *)malloc(4 * nr_q * sizeof(int));
+  if (send_sizes == NULL || recv_sizes == NULL || counts == NULL)
+    error("Failed to allocate the transpose counts.");
+
+  /* Pack the blocks for the other ranks, [kz][ky][x] in both directions */
+  size_t offset = 0;
+  for (int q = 0; q < nr_q; q++) {
+    const size_t x0_q = p->x_offset[q];
+    const size_t nx_q = p->x_offset[q + 1] - x0_q;
+    const size_t ky0_q = p->ky_offset[q];
+    const size_t nky_q = p->ky_offset[q + 1] - ky0_q;
+
+    if (forward) {
+      for (size_t kz = 0; kz < nkz; kz++)
+        for (size_t ky = 0; ky < nky_q; ky++)
+          mesh_pencils_copy(
+              sendbuf + (offset + (kz * nky_q + ky) * nx) * csize, 1,
+              data + (kz * N + ky0_q + ky) * csize, nkz * N, nx, csize);
+      send_sizes[q] = nkz * nky_q * nx;
+      recv_sizes[q] = nkz * nky * nx_q;
+    } else {
+      for (size_t kz = 0; kz < nkz; kz++)
+        for (size_t ky = 0; ky < nky; ky++)
+          mesh_pencils_copy(
+              sendbuf + (offset + (kz * nky + ky) * nx_q) * csize, 1,
+              data + ((kz * nky + ky) * N + x0_q) * csize, 1, nx_q, csize);
+      send_sizes[q] = nkz * nky * nx_q;
+      recv_sizes[q] = nkz * nky_q * nx;
+    }
+    offset += send_sizes[q];
+  }
+
+  /* Exchange the blocks */
+  mesh_pencils_counts(send_sizes, nr_q, &counts[0], &counts[nr_q]);
+  mesh_pencils_counts(recv_sizes, nr_q, &counts[2 * nr_q], &counts[3 * nr_q]);
+  const MPI_Datatype type =
+      p->single_precision ? MPI_C_FLOAT_COMPLEX : MPI_C_DOUBLE_COMPLEX;
+  MPI_Alltoallv(sendbuf, &counts[0], &counts[nr_q], type, recvbuf,
+                &counts[2 * nr_q], &counts[3 * nr_q], type, p->comm_col);
+
+  /* Unpack the blocks from the other ranks */
+  offset = 0;
+  for (int q = 0; q < nr_q; q++) {
+    const size_t x0_q = p->x_offset[q];
+    const size_t nx_q = p->x_offset[q + 1] - x0_q;
+    const size_t ky0_q = p->ky_offset[q];
+    const size_t nky_q = p->ky_offset[q + 1] - ky0_q;
+
+    if (forward) {
+      for (size_t kz = 0; kz < nkz; kz++)
+        for (size_t ky = 0; ky < nky; ky++)
+          mesh_pencils_copy(
+              data + ((kz * nky + ky) * N + x0_q) * csize, 1,
+              recvbuf + (offset + (kz * nky + ky) * nx_q) * csize, 1, nx_q,
+              csize);
+    } else {
+      for (size_t kz = 0; kz < nkz; kz++)
+        for (size_t ky = 0; ky < nky_q; ky++)
+          mesh_pencils_copy(
+              data + (kz * N + ky0_q + ky) * csize, nkz * N,
+              recvbuf + (offset + (kz * nky_q + ky) * nx) * csize, 1, nx,
+              csize);
+    }
+    offset += recv_sizes[q];
+  }
+
+  free(send_sizes);
+  free(recv_sizes);
+  free(counts);
+}
+
+/**
+ * @brief Splits n mesh coordinates as evenly as possible between nr_parts
+ * ranks.
+ *
+ * @param n The number of coordinates.
+ * @param nr_parts The number of ranks.
+ * @param offset (return) The first coordinate of each rank, plus n.
+ */
+static void mesh_pencils_split(const int n, const int nr_parts, int *offset) {
+
+  for (int i = 0; i <= nr_parts; i++)
+    offset[i] = (int)(((size_t)i * n) / nr_parts);
+}
+
+#endif /* WITH_MPI && HAVE_FFTW */
+
+#ifdef WITH_MPI
+
+/**
+ * @brief Fills the look-up tables from the mesh coordinates to the rows and
+ * columns of pencils.
+ *
+ * @param p The #mesh_pencils, with its offsets set.
+ */
+static void mesh_pencils_init_ranks(struct mesh_pencils *p) {
+
+  const int N = p->N;
+  p->x_rank = (int *)malloc(N * sizeof(int));
+  p->y_rank = (int *)malloc(N * sizeof(int));
+  if (p->x_rank == NULL || p->y_rank == NULL)
+    error("Failed to allocate the mesh pencils look-up tables.");
+
+  for (int i = 0; i < p->nr_x; i++)
+    for (int x = p->x_offset[i]; x < p->x_offset[i + 1]; x++) p->x_rank[x] = i;
+  for (int j = 0; j < p->nr_y; j++)
+    for (int y = p->y_offset[j]; y < p->y_offset[j + 1]; y++) p->y_rank[y] = j;
+}
+
+#endif /* WITH_MPI */
+
+/**
+ * @brief Decomposes the distributed mesh in pencils, one per MPI rank, in a
+ * grid as square as possible, and allocates what the pencil FFTs need.
+ *
+ * @param p The #mesh_pencils to initialise.
+ * @param N The side-length of the mesh.
+ * @param single_precision Whether to do the FFTs in single precision.
+ */
+void mesh_pencils_init(struct mesh_pencils *p, const int N,
+                       const int single_precision) {
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+#ifndef HAVE_FLOAT_FFTW
+  if (single_precision) error("No single precision FFTW library found.");
+#endif
+
+  int nr_nodes, nodeID;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &nodeID);
+
+  /* Arrange the ranks in a grid, nr_x >= nr_y */
+  int dims[2] = {0, 0};
+  MPI_Dims_create(nr_nodes, 2, dims);
+  p->N = N;
+  p->nr_x = dims[0];
+  p->nr_y = dims[1];
+  p->px = nodeID / p->nr_y;
+  p->py = nodeID % p->nr_y;
+  p->single_precision = single_precision;
+
+  /* Split the mesh in real and Fourier space */
+  p->x_offset = (int *)malloc((p->nr_x + 1) * sizeof(int));
+  p->y_offset = (int *)malloc((p->nr_y + 1) * sizeof(int));
+  p->ky_offset = (int *)malloc((p->nr_x + 1) * sizeof(int));
+  p->kz_offset = (int *)malloc((p->nr_y + 1) * sizeof(int));
+  if (p->x_offset == NULL || p->y_offset == NULL || p->ky_offset == NULL ||
+      p->kz_offset == NULL)
+    error("Failed to allocate the mesh pencils offsets.");
+  mesh_pencils_split(N, p->nr_x, p->x_offset);
+  mesh_pencils_split(N, p->nr_y, p->y_offset);
+  mesh_pencils_split(N, p->nr_x, p->ky_offset);
+  mesh_pencils_split(N / 2 + 1, p->nr_y, p->kz_offset);
+  mesh_pencils_init_ranks(p);
+
+  /* Communicators for the transposes */
+  MPI_Comm_split(MPI_COMM_WORLD, p->px, p->py, &p->comm_row);
+  MPI_Comm_split(MPI_COMM_WORLD, p->py, p->px, &p->comm_col);
+
+  /* Work arrays large enough for the pencils along kz, y and kx */
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  const size_t nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+  size_t work_size = nx * ny * (N / 2 + 1);
+  if (nx * nkz * N > work_size) work_size = nx * nkz * N;
+  if (nkz * nky * N > work_size) work_size = nkz * nky * N;
+  if (work_size == 0) work_size = 1;
+  p->work_size = work_size;
+
+  const size_t csize =
+      single_precision ? 2 * sizeof(float) : 2 * sizeof(double);
+  p->data = fftw_malloc(work_size * csize);
+  p->sendbuf = fftw_malloc(work_size * csize);
+  p->recvbuf = fftw_malloc(work_size * csize);
+  if (p->data == NULL || p->sendbuf == NULL || p->recvbuf == NULL)
+    error("Failed to allocate the mesh pencils work arrays.");
+
+#else
+  error("No MPI or FFTW library found. Cannot decompose the mesh in pencils.");
+#endif
+}
+
+/**
+ * @brief Describes the slabs of the FFTW MPI library as pencils spanning the
+ * whole mesh along y.
+ *
+ * @param p The #mesh_pencils to initialise.
+ * @param N The side-length of the mesh.
+ * @param local_n0 The thickness of the slab on this rank.
+ */
+void mesh_pencils_init_slabs(struct mesh_pencils *p, const int N,
+                             const int local_n0) {
+
+#ifdef WITH_MPI
+
+  int nr_nodes, nodeID;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &nodeID);
+
+  p->N = N;
+  p->nr_x = nr_nodes;
+  p->nr_y = 1;
+  p->px = nodeID;
+  p->py = 0;
+  p->single_precision = 0;
+
+  /* Get the width of the slab on each rank */
+  int *slice_width = (int *)malloc(sizeof(int) * nr_nodes);
+  p->x_offset = (int *)malloc((nr_nodes + 1) * sizeof(int));
+  p->y_offset = (int *)malloc(2 * sizeof(int));
+  if (slice_width == NULL || p->x_offset == NULL || p->y_offset == NULL)
+    error("Failed to allocate the mesh slabs offsets.");
+  MPI_Allgather(&local_n0, 1, MPI_INT, slice_width, 1, MPI_INT, MPI_COMM_WORLD);
+
+  /* Determine the offset to the slab on each rank */
+  p->x_offset[0] = 0;
+  for (int i = 0; i < nr_nodes; i++)
+    p->x_offset[i + 1] = p->x_offset[i] + slice_width[i];
+  p->y_offset[0] = 0;
+  p->y_offset[1] = N;
+  free(slice_width);
+  mesh_pencils_init_ranks(p);
+
+  /* The FFTs are left to FFTW */
+  p->ky_offset = NULL;
+  p->kz_offset = NULL;
+  p->comm_row = MPI_COMM_NULL;
+  p->comm_col = MPI_COMM_NULL;
+  p->data = NULL;
+  p->sendbuf = NULL;
+  p->recvbuf = NULL;
+  p->work_size = 0;
+
+#else
+  error("No MPI library found. Cannot decompose the mesh in slabs.");
+#endif
+}
+
+/**
+ * @brief Frees the memory of a #mesh_pencils.
+ *
+ * @param p The #mesh_pencils.
+ */
+void mesh_pencils_clean(struct mesh_pencils *p) {
+
+#ifdef WITH_MPI
+  free(p->x_offset);
+  free(p->y_offset);
+  free(p->x_rank);
+  free(p->y_rank);
+  free(p->ky_offset);
+  free(p->kz_offset);
+  if (p->comm_row != MPI_COMM_NULL) MPI_Comm_free(&p->comm_row);
+  if (p->comm_col != MPI_COMM_NULL) MPI_Comm_free(&p->comm_col);
+#endif
+#ifdef HAVE_FFTW
+  if (p->data != NULL) fftw_free(p->data);
+  if (p->sendbuf != NULL) fftw_free(p->sendbuf);
+  if (p->recvbuf != NULL) fftw_free(p->recvbuf);
+#endif
+  bzero(p, sizeof(struct mesh_pencils));
+}
+
+/**
+ * @brief Fourier transforms the density stored in pencils along z.
+ *
+ * Does the real to complex FFTs along z, the complex ones along y and then
+ * along x, with a transpose between the ranks of the same row and one
+ * between the ranks of the same column in between. The result is left in
+ * the work array, in pencils along kx.
+ *
+ * @param p The #mesh_pencils.
+ * @param rho The (padded) density in the local pencil.
+ * @param tp The #threadpool object.
+ * @param verbose Are we talkative?
+ */
+void mesh_pencils_forward_FFT(struct mesh_pencils *p, const double *rho,
+                              struct threadpool *tp, const int verbose) {
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  const size_t nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+  const size_t local_size = mesh_pencils_local_size(p);
+
+  ticks tic = getticks();
+
+  /* Copy the density to the work array, in the precision of the FFTs */
+  if (p->single_precision) {
+    float *data = (float *)p->data;
+    for (size_t i = 0; i < local_size; i++) data[i] = (float)rho[i];
+  } else {
+    memcpy(p->data, rho, local_size * sizeof(double));
+  }
+
+  mesh_pencils_fft(p, mesh_pencils_fft_r2c, nx * ny, tp);
+
+  if (verbose)
+    message(" - FFTs along z took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  mesh_pencils_transpose_row(p, /*forward=*/1);
+  mesh_pencils_fft(p, mesh_pencils_fft_c2c_forward, nx * nkz, tp);
+
+  if (verbose)
+    message(" - Transpose and FFTs along y took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  mesh_pencils_transpose_col(p, /*forward=*/1);
+  mesh_pencils_fft(p, mesh_pencils_fft_c2c_forward, nkz * nky, tp);
+
+  if (verbose)
+    message(" - Transpose and FFTs along x took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+#else
+  error("No MPI or FFTW library found. Cannot do the pencil FFTs.");
+#endif
+}
+
+/**
+ * @brief Transforms the potential stored in the work array in pencils along
+ * kx back to real space, in pencils along z.
+ *
+ * Undoes the steps of mesh_pencils_forward_FFT() in reverse order. As with
+ * FFTW, the result is not normalised.
+ *
+ * @param p The #mesh_pencils.
+ * @param pot (return) The (padded) potential in the local pencil.
+ * @param tp The #threadpool object.
+ * @param verbose Are we talkative?
+ */
+void mesh_pencils_backward_FFT(struct mesh_pencils *p, double *pot,
+                               struct threadpool *tp, const int verbose) {
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  const size_t nky = p->ky_offset[p->px + 1] - p->ky_offset[p->px];
+  const size_t nkz = p->kz_offset[p->py + 1] - p->kz_offset[p->py];
+  const size_t local_size = mesh_pencils_local_size(p);
+
+  ticks tic = getticks();
+
+  mesh_pencils_fft(p, mesh_pencils_fft_c2c_backward, nkz * nky, tp);
+  mesh_pencils_transpose_col(p, /*forward=*/0);
+
+  if (verbose)
+    message(" - FFTs along x and transpose took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  mesh_pencils_fft(p, mesh_pencils_fft_c2c_backward, nx * nkz, tp);
+  mesh_pencils_transpose_row(p, /*forward=*/0);
+
+  if (verbose)
+    message(" - FFTs along y and transpose took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+  tic = getticks();
+
+  mesh_pencils_fft(p, mesh_pencils_fft_c2r, nx * ny, tp);
+
+  /* Copy the potential back in double precision */
+  if (p->single_precision) {
+    const float *data = (const float *)p->data;
+    for (size_t i = 0; i < local_size; i++) pot[i] = data[i];
+  } else {
+    memcpy(pot, p->data, local_size * sizeof(double));
+  }
+
+  if (verbose)
+    message(" - FFTs along z took %.3f %s.",
+            clocks_from_ticks(getticks() - tic), clocks_getunit());
+
+#else
+  error("No MPI or FFTW library found. Cannot do the pencil FFTs.");
+#endif
+}
@@ -0,0 +1,162 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MESH_GRAVITY_PENCILS_H
+#define SWIFT_MESH_GRAVITY_PENCILS_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* MPI headers. */
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* Standard includes */
+#include <stdlib.h>
+
+/* Local includes. */
+#include "inline.h"
+#include "row_major_id.h"
+
+/* Forward declarations */
+struct threadpool;
+
+/**
+ * @brief Decomposition of the distributed mesh between the MPI ranks.
+ *
+ * The ranks form a grid of nr_x by nr_y pencils, rank px * nr_y + py holding
+ * the mesh cells with x in [x_offset[px], x_offset[px + 1]), y in
+ * [y_offset[py], y_offset[py + 1]) and all the z, padded to 2 * (N / 2 + 1)
+ * as in the FFTW MPI slabs. The slabs are the special case nr_y = 1.
+ *
+ * In Fourier space, the pencils run along kx instead, rank px * nr_y + py
+ * holding the ky in [ky_offset[px], ky_offset[px + 1]) and the kz in
+ * [kz_offset[py], kz_offset[py + 1]), stored as [kz][ky][kx].
+ */
+struct mesh_pencils {
+
+  /*! Side-length of the mesh */
+  int N;
+
+  /*! Number of pencils along x and y */
+  int nr_x, nr_y;
+
+  /*! Position of the pencil of this rank in the grid of pencils */
+  int px, py;
+
+  /*! First x (y) coordinate of each row (column) of pencils, plus the end
+   * of the mesh */
+  int *x_offset, *y_offset;
+
+  /*! Row (column) of pencils each x (y) coordinate of the mesh is in */
+  int *x_rank, *y_rank;
+
+  /*! First ky (kz) of each row (column) of pencils in Fourier space, plus the
+   * end of the mesh. Only used by the pencil FFTs */
+  int *ky_offset, *kz_offset;
+
+  /*! Whether the pencil FFTs are done in single precision */
+  int single_precision;
+
+#ifdef WITH_MPI
+  /*! Communicators between the ranks of the same row (px) and of the same
+   * column (py) of pencils */
+  MPI_Comm comm_row, comm_col;
+#endif
+
+  /*! Work arrays of the pencil FFTs, and their size in complex numbers */
+  void *data, *sendbuf, *recvbuf;
+  size_t work_size;
+};
+
+void mesh_pencils_init(struct mesh_pencils *p, const int N,
+                       const int single_precision);
+
+void mesh_pencils_init_slabs(struct mesh_pencils *p, const int N,
+                             const int local_n0);
+
+void mesh_pencils_clean(struct mesh_pencils *p);
+
+void mesh_pencils_forward_FFT(struct mesh_pencils *p, const double *rho,
+                              struct threadpool *tp, const int verbose);
+
+void mesh_pencils_backward_FFT(struct mesh_pencils *p, double *pot,
+                               struct threadpool *tp, const int verbose);
+
+/**
+ * @brief Returns the number of MPI ranks the mesh is decomposed over.
+ *
+ * @param p The #mesh_pencils.
+ */
+__attribute__((always_inline)) INLINE static int mesh_pencils_nr_ranks(
+    const struct mesh_pencils *p) {
+
+  return p->nr_x * p->nr_y;
+}
+
+/**
+ * @brief Returns the number of doubles in the (padded) real space pencil
+ * stored on this rank.
+ *
+ * @param p The #mesh_pencils.
+ */
+__attribute__((always_inline)) INLINE static size_t mesh_pencils_local_size(
+    const struct mesh_pencils *p) {
+
+  const size_t nx = p->x_offset[p->px + 1] - p->x_offset[p->px];
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  return nx * ny * (2 * (p->N / 2 + 1));
+}
+
+/**
+ * @brief Returns the MPI rank storing a mesh cell.
+ *
+ * @param p The #mesh_pencils.
+ * @param key The padded row major ID of the mesh cell.
+ */
+__attribute__((always_inline)) INLINE static int mesh_pencils_get_rank(
+    const struct mesh_pencils *p, const size_t key) {
+
+  const int x = get_xcoord_from_padded_row_major_id(key, p->N);
+  const int y = get_ycoord_from_padded_row_major_id(key, p->N);
+  return p->x_rank[x] * p->nr_y + p->y_rank[y];
+}
+
+/**
+ * @brief Returns the index of a mesh cell in the (padded) real space pencil
+ * stored on this rank.
+ *
+ * @param p The #mesh_pencils.
+ * @param key The padded row major ID of the mesh cell, which must be in the
+ * local pencil.
+ */
+__attribute__((always_inline)) INLINE static size_t mesh_pencils_local_index(
+    const struct mesh_pencils *p, const size_t key) {
+
+  const size_t Nk = 2 * (p->N / 2 + 1);
+  const size_t ny = p->y_offset[p->py + 1] - p->y_offset[p->py];
+  const size_t i =
+      get_xcoord_from_padded_row_major_id(key, p->N) - p->x_offset[p->px];
+  const size_t j =
+      get_ycoord_from_padded_row_major_id(key, p->N) - p->y_offset[p->py];
+  const size_t k = get_zcoord_from_padded_row_major_id(key, p->N);
+  return (i * ny + j) * Nk + k;
+}
+
+#endif /* SWIFT_MESH_GRAVITY_PENCILS_H */
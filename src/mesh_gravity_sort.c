@@ -27,20 +27,24 @@
 #include "align.h"
 #include "atomic.h"
 #include "error.h"
+#include "mesh_gravity_pencils.h"
 #include "row_major_id.h"
 #include "threadpool.h"
 
 struct mapper_extra_data {
 
-  /* Mesh size */
+  /* Number of buckets */
   int N;
 
+  /* Decomposition of the mesh between the ranks */
+  const struct mesh_pencils *pencils;
+
   /* Buckets */
   size_t *bucket_counts;
 };
 
 /**
- * @param Count how may mesh cells will end up in each x-coord bucket.
+ * @param Count how may mesh cells will end up in each MPI rank bucket.
  */
 void bucket_sort_mesh_key_value_rho_count_mapper(void *map_data, int nr_parts,
                                                  void *extra_data) {
@@ -50,6 +54,7 @@ void bucket_sort_mesh_key_value_rho_count_mapper(void *map_data, int nr_parts,
       (const struct mesh_key_value_rho *)map_data;
   struct mapper_extra_data *data = (struct mapper_extra_data *)extra_data;
   const int N = data->N;
+  const struct mesh_pencils *pencils = data->pencils;
   size_t *global_bucket_counts = data->bucket_counts;
 
   /* Local buckets */
@@ -60,18 +65,17 @@ void bucket_sort_mesh_key_value_rho_count_mapper(void *map_data, int nr_parts,
 
     const size_t key = array_in[i].key;
 
-    /* Get the x coordinate of this mesh cell in the global mesh
-     * Note: we don't need to sort more precisely than just
-     * the x coordinate */
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    /* Get the rank storing this mesh cell
+     * Note: we don't need to sort more precisely than that */
+    const int rank = mesh_pencils_get_rank(pencils, key);
 
 #ifdef SWIFT_DEBUG_CHECKS
-    if (mesh_x < 0) error("Invalid mesh cell x-coordinate (too small)");
-    if (mesh_x >= N) error("Invalid mesh cell x-coordinate (too large)");
+    if (rank < 0) error("Invalid mesh cell rank (too small)");
+    if (rank >= N) error("Invalid mesh cell rank (too large)");
 #endif
 
     /* Add a contribution to the bucket count */
-    local_bucket_counts[mesh_x]++;
+    local_bucket_counts[rank]++;
   }
 
   /* Now write back to memory */
@@ -84,7 +88,7 @@ void bucket_sort_mesh_key_value_rho_count_mapper(void *map_data, int nr_parts,
 }
 
 /**
- * @param Count how may mesh cells will end up in each x-coord bucket.
+ * @param Count how may mesh cells will end up in each MPI rank bucket.
  */
 void bucket_sort_mesh_key_value_pot_count_mapper(void *map_data, int nr_parts,
                                                  void *extra_data) {
@@ -94,6 +98,7 @@ void bucket_sort_mesh_key_value_pot_count_mapper(void *map_data, int nr_parts,
       (const struct mesh_key_value_pot *)map_data;
   struct mapper_extra_data *data = (struct mapper_extra_data *)extra_data;
   const int N = data->N;
+  const struct mesh_pencils *pencils = data->pencils;
   size_t *global_bucket_counts = data->bucket_counts;
 
   /* Local buckets */
@@ -104,18 +109,17 @@ void bucket_sort_mesh_key_value_pot_count_mapper(void *map_data, int nr_parts,
 
     const size_t key = array_in[i].key;
 
-    /* Get the x coordinate of this mesh cell in the global mesh
-     * Note: we don't need to sort more precisely than just
-     * the x coordinate */
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    /* Get the rank storing this mesh cell
+     * Note: we don't need to sort more precisely than that */
+    const int rank = mesh_pencils_get_rank(pencils, key);
 
 #ifdef SWIFT_DEBUG_CHECKS
-    if (mesh_x < 0) error("Invalid mesh cell x-coordinate (too small)");
-    if (mesh_x >= N) error("Invalid mesh cell x-coordinate (too large)");
+    if (rank < 0) error("Invalid mesh cell rank (too small)");
+    if (rank >= N) error("Invalid mesh cell rank (too large)");
 #endif
 
     /* Add a contribution to the bucket count */
-    local_bucket_counts[mesh_x]++;
+    local_bucket_counts[rank]++;
   }
 
   /* Now write back to memory */
@@ -171,31 +175,37 @@ void bucket_sort_mesh_key_value_pot_index_count_mapper(void *map_data,
 }
 
 /**
- * @brief Bucket sort of the array of mesh cells based on their x-coord.
+ * @brief Bucket sort of the array of mesh cells based on the MPI rank
+ * storing them.
  *
  * Note the two mesh_key_value_rho arrays must be aligned on
  * SWIFT_CACHE_ALIGNMENT.
  *
  * @param array_in The unsorted array of mesh-key value pairs.
  * @param count The number of elements in the mesh-key value pair arrays.
- * @param N The size of the mesh. (i.e. the number of possible x-axis values)
+ * @param pencils The decomposition of the mesh between the ranks.
  * @param tp The #threadpool object.
  * @param array_out The sorted array of mesh-key value pairs (to be filled).
- * @param bucket_offsets The offsets in the sorted array where we change x-coord
+ * @param bucket_offsets The offsets in the sorted array where we change rank
  * (to be filled).
  */
 void bucket_sort_mesh_key_value_rho(const struct mesh_key_value_rho *array_in,
-                                    const size_t count, const int N,
+                                    const size_t count,
+                                    const struct mesh_pencils *pencils,
                                     struct threadpool *tp,
                                     struct mesh_key_value_rho *array_out,
                                     size_t *bucket_offsets) {
 
+  /* Number of buckets */
+  const int N = mesh_pencils_nr_ranks(pencils);
+
   /* Create an array of bucket counts and one of offsets */
   size_t *bucket_counts = (size_t *)malloc(N * sizeof(size_t));
   memset(bucket_counts, 0, N * sizeof(size_t));
 
   struct mapper_extra_data extra_data;
   extra_data.N = N;
+  extra_data.pencils = pencils;
   extra_data.bucket_counts = bucket_counts;
 
   /* Collect the number of items that will end up in each bucket */
@@ -225,29 +235,25 @@ void bucket_sort_mesh_key_value_rho(const struct mesh_key_value_rho *array_in,
   for (size_t i = 0; i < count; ++i) {
 
     const size_t key = array_in_aligned[i].key;
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    const int rank = mesh_pencils_get_rank(pencils, key);
 
     /* Where does this element land? */
-    const size_t index = bucket_offsets[mesh_x];
+    const size_t index = bucket_offsets[rank];
 
     /* Copy the element to its correct position */
     memcpy(&array_out_aligned[index], &array_in_aligned[i],
            sizeof(struct mesh_key_value_rho));
 
     /* Move the start of this bucket by one */
-    bucket_offsets[mesh_x]++;
+    bucket_offsets[rank]++;
   }
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that things have indeed been sorted */
-  int last_mesh_x =
-      get_xcoord_from_padded_row_major_id(array_out_aligned[0].key, N);
-  ;
   for (size_t i = 1; i < count; ++i) {
-    const size_t key = array_out_aligned[i].key;
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
-    if (mesh_x < last_mesh_x) error("Unsorted array!");
-    last_mesh_x = mesh_x;
+    if (mesh_pencils_get_rank(pencils, array_out_aligned[i].key) <
+        mesh_pencils_get_rank(pencils, array_out_aligned[i - 1].key))
+      error("Unsorted array!");
   }
 #endif
 
@@ -261,31 +267,37 @@ void bucket_sort_mesh_key_value_rho(const struct mesh_key_value_rho *array_in,
 }
 
 /**
- * @brief Bucket sort of the array of mesh cells based on their x-coord.
+ * @brief Bucket sort of the array of mesh cells based on the MPI rank
+ * storing them.
  *
  * Note the two mesh_key_value_pot arrays must be aligned on
  * SWIFT_CACHE_ALIGNMENT.
  *
  * @param array_in The unsorted array of mesh-key value pairs.
  * @param count The number of elements in the mesh-key value pair arrays.
- * @param N The size of the mesh. (i.e. the number of possible x-axis values)
+ * @param pencils The decomposition of the mesh between the ranks.
  * @param tp The #threadpool object.
  * @param array_out The sorted array of mesh-key value pairs (to be filled).
- * @param bucket_offsets The offsets in the sorted array where we change x-coord
+ * @param bucket_offsets The offsets in the sorted array where we change rank
  * (to be filled).
  */
 void bucket_sort_mesh_key_value_pot(const struct mesh_key_value_pot *array_in,
-                                    const size_t count, const int N,
+                                    const size_t count,
+                                    const struct mesh_pencils *pencils,
                                     struct threadpool *tp,
                                     struct mesh_key_value_pot *array_out,
                                     size_t *bucket_offsets) {
 
+  /* Number of buckets */
+  const int N = mesh_pencils_nr_ranks(pencils);
+
   /* Create an array of bucket counts and one of offsets */
   size_t *bucket_counts = (size_t *)malloc(N * sizeof(size_t));
   memset(bucket_counts, 0, N * sizeof(size_t));
 
   struct mapper_extra_data extra_data;
   extra_data.N = N;
+  extra_data.pencils = pencils;
   extra_data.bucket_counts = bucket_counts;
 
   /* Collect the number of items that will end up in each bucket */
@@ -315,29 +327,25 @@ void bucket_sort_mesh_key_value_pot(const struct mesh_key_value_pot *array_in,
   for (size_t i = 0; i < count; ++i) {
 
     const size_t key = array_in_aligned[i].key;
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
+    const int rank = mesh_pencils_get_rank(pencils, key);
 
     /* Where does this element land? */
-    const size_t index = bucket_offsets[mesh_x];
+    const size_t index = bucket_offsets[rank];
 
     /* Copy the element to its correct position */
     memcpy(&array_out_aligned[index], &array_in_aligned[i],
            sizeof(struct mesh_key_value_pot));
 
     /* Move the start of this bucket by one */
-    bucket_offsets[mesh_x]++;
+    bucket_offsets[rank]++;
   }
 
 #ifdef SWIFT_DEBUG_CHECKS
   /* Verify that things have indeed been sorted */
-  int last_mesh_x =
-      get_xcoord_from_padded_row_major_id(array_out_aligned[0].key, N);
-
   for (size_t i = 1; i < count; ++i) {
-    const size_t key = array_out_aligned[i].key;
-    const int mesh_x = get_xcoord_from_padded_row_major_id(key, N);
-    if (mesh_x < last_mesh_x) error("Unsorted array!");
-    last_mesh_x = mesh_x;
+    if (mesh_pencils_get_rank(pencils, array_out_aligned[i].key) <
+        mesh_pencils_get_rank(pencils, array_out_aligned[i - 1].key))
+      error("Unsorted array!");
   }
 #endif
 
@@ -27,6 +27,7 @@
 #include <string.h>
 
 struct threadpool;
+struct mesh_pencils;
 
 /**
  * @brief Store contributions to the mesh as (index, mass) pairs
@@ -46,13 +47,15 @@ struct mesh_key_value_pot {
 };
 
 void bucket_sort_mesh_key_value_rho(const struct mesh_key_value_rho *array_in,
-                                    const size_t count, const int N,
+                                    const size_t count,
+                                    const struct mesh_pencils *pencils,
                                     struct threadpool *tp,
                                     struct mesh_key_value_rho *array_out,
                                     size_t *bucket_offsets);
 
 void bucket_sort_mesh_key_value_pot(const struct mesh_key_value_pot *array_in,
-                                    const size_t count, const int N,
+                                    const size_t count,
+                                    const struct mesh_pencils *pencils,
                                     struct threadpool *tp,
                                     struct mesh_key_value_pot *array_out,
                                     size_t *bucket_offsets);
@@ -1597,7 +1597,7 @@ __attribute__((nonnull)) INLINE static void gravity_M2M(
  * @param m_a The multipole creating the field.
  * @param pot The derivatives of the potential.
  */
-__attribute__((nonnull)) INLINE static void gravity_M2L_apply(
+__attribute__((nonnull, always_inline)) INLINE static void gravity_M2L_apply(
     struct grav_tensor *restrict l_b, const struct multipole *restrict m_a,
     const struct potential_derivatives_M2L *pot) {
 
@@ -0,0 +1,630 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_MULTIPOLE_BATCH_H
+#define SWIFT_MULTIPOLE_BATCH_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Includes. */
+#include "accumulate.h"
+#include "align.h"
+#include "error.h"
+#include "inline.h"
+#include "multipole.h"
+#include "periodic.h"
+
+/*! Number of multipoles in a #multipole_batch */
+#define multipole_batch_size 64
+
+/**
+ * @brief Multipoles interacting with the same field tensor, stored as
+ * structure of arrays so that the M2L kernel can work on several of them at
+ * once.
+ *
+ * The multipoles are added one by one with multipole_batch_add() and their
+ * field tensors computed and summed with gravity_M2L_batch().
+ */
+struct multipole_batch {
+
+  /*! Distance vectors between the field tensor and the multipoles */
+  float dx[multipole_batch_size] SWIFT_CACHE_ALIGN;
+  float dy[multipole_batch_size] SWIFT_CACHE_ALIGN;
+  float dz[multipole_batch_size] SWIFT_CACHE_ALIGN;
+
+  /*! Maximal softening of the multipoles */
+  float eps[multipole_batch_size] SWIFT_CACHE_ALIGN;
+
+  /* All the arrays below are a multiple of the cache line long, hence
+   * aligned as well. */
+
+  /*! Derivatives of the long-range truncation function at the distances of
+   * the multipoles */
+  float chi_0[multipole_batch_size], chi_1[multipole_batch_size];
+  float chi_2[multipole_batch_size], chi_3[multipole_batch_size];
+  float chi_4[multipole_batch_size], chi_5[multipole_batch_size];
+
+  /*! 0th order terms of the multipoles */
+  float M_000[multipole_batch_size];
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+
+  /*! 2nd order terms of the multipoles */
+  float M_200[multipole_batch_size], M_020[multipole_batch_size];
+  float M_002[multipole_batch_size], M_110[multipole_batch_size];
+  float M_101[multipole_batch_size], M_011[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+
+  /*! 3rd order terms of the multipoles */
+  float M_300[multipole_batch_size], M_030[multipole_batch_size];
+  float M_003[multipole_batch_size], M_210[multipole_batch_size];
+  float M_201[multipole_batch_size], M_120[multipole_batch_size];
+  float M_021[multipole_batch_size], M_102[multipole_batch_size];
+  float M_012[multipole_batch_size], M_111[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+
+  /*! 4th order terms of the multipoles */
+  float M_400[multipole_batch_size], M_040[multipole_batch_size];
+  float M_004[multipole_batch_size], M_310[multipole_batch_size];
+  float M_301[multipole_batch_size], M_130[multipole_batch_size];
+  float M_031[multipole_batch_size], M_103[multipole_batch_size];
+  float M_013[multipole_batch_size], M_220[multipole_batch_size];
+  float M_202[multipole_batch_size], M_022[multipole_batch_size];
+  float M_211[multipole_batch_size], M_121[multipole_batch_size];
+  float M_112[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+
+  /*! 5th order terms of the multipoles */
+  float M_005[multipole_batch_size], M_014[multipole_batch_size];
+  float M_023[multipole_batch_size], M_032[multipole_batch_size];
+  float M_041[multipole_batch_size], M_050[multipole_batch_size];
+  float M_104[multipole_batch_size], M_113[multipole_batch_size];
+  float M_122[multipole_batch_size], M_131[multipole_batch_size];
+  float M_140[multipole_batch_size], M_203[multipole_batch_size];
+  float M_212[multipole_batch_size], M_221[multipole_batch_size];
+  float M_230[multipole_batch_size], M_302[multipole_batch_size];
+  float M_311[multipole_batch_size], M_320[multipole_batch_size];
+  float M_401[multipole_batch_size], M_410[multipole_batch_size];
+  float M_500[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+
+  /*! Field tensors due to each multipole, before they are summed */
+  float F_000[multipole_batch_size];
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 0
+
+  /* 1st order terms of the field tensors */
+  float F_100[multipole_batch_size], F_010[multipole_batch_size];
+  float F_001[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+
+  /* 2nd order terms of the field tensors */
+  float F_200[multipole_batch_size], F_020[multipole_batch_size];
+  float F_002[multipole_batch_size], F_110[multipole_batch_size];
+  float F_101[multipole_batch_size], F_011[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+
+  /* 3rd order terms of the field tensors */
+  float F_300[multipole_batch_size], F_030[multipole_batch_size];
+  float F_003[multipole_batch_size], F_210[multipole_batch_size];
+  float F_201[multipole_batch_size], F_120[multipole_batch_size];
+  float F_021[multipole_batch_size], F_102[multipole_batch_size];
+  float F_012[multipole_batch_size], F_111[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+
+  /* 4th order terms of the field tensors */
+  float F_400[multipole_batch_size], F_040[multipole_batch_size];
+  float F_004[multipole_batch_size], F_310[multipole_batch_size];
+  float F_301[multipole_batch_size], F_130[multipole_batch_size];
+  float F_031[multipole_batch_size], F_103[multipole_batch_size];
+  float F_013[multipole_batch_size], F_220[multipole_batch_size];
+  float F_202[multipole_batch_size], F_022[multipole_batch_size];
+  float F_211[multipole_batch_size], F_121[multipole_batch_size];
+  float F_112[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+
+  /* 5th order terms of the field tensors */
+  float F_005[multipole_batch_size], F_014[multipole_batch_size];
+  float F_023[multipole_batch_size], F_032[multipole_batch_size];
+  float F_041[multipole_batch_size], F_050[multipole_batch_size];
+  float F_104[multipole_batch_size], F_113[multipole_batch_size];
+  float F_122[multipole_batch_size], F_131[multipole_batch_size];
+  float F_140[multipole_batch_size], F_203[multipole_batch_size];
+  float F_212[multipole_batch_size], F_221[multipole_batch_size];
+  float F_230[multipole_batch_size], F_302[multipole_batch_size];
+  float F_311[multipole_batch_size], F_320[multipole_batch_size];
+  float F_401[multipole_batch_size], F_410[multipole_batch_size];
+  float F_500[multipole_batch_size];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+
+  /*! Total number of gpart in each multipole */
+  long long num_gpart[multipole_batch_size];
+#endif
+
+  /*! Number of multipoles in the batch */
+  int count;
+};
+
+/**
+ * @brief Empty a #multipole_batch.
+ *
+ * @param b The #multipole_batch.
+ */
+__attribute__((always_inline, nonnull)) INLINE static void
+multipole_batch_init(struct multipole_batch *b) {
+
+  b->count = 0;
+}
+
+/**
+ * @brief Add a multipole to a #multipole_batch.
+ *
+ * @param b The #multipole_batch, must not be full.
+ * @param m_a The multipole.
+ * @param pos_b The position of the field tensor.
+ * @param pos_a The position of the multipole.
+ * @param periodic Is the calculation periodic ?
+ * @param dim The size of the simulation box.
+ */
+__attribute__((always_inline, nonnull)) INLINE static void
+multipole_batch_add(struct multipole_batch *b, const struct multipole *m_a,
+                    const double pos_b[3], const double pos_a[3],
+                    const int periodic, const double dim[3]) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (b->count >= multipole_batch_size) error("Multipole batch is full.");
+#endif
+
+  const int i = b->count++;
+
+  /* Compute distance vector */
+  float dx = (float)(pos_b[0] - pos_a[0]);
+  float dy = (float)(pos_b[1] - pos_a[1]);
+  float dz = (float)(pos_b[2] - pos_a[2]);
+
+  /* Apply BC */
+  if (periodic) {
+    dx = nearest(dx, dim[0]);
+    dy = nearest(dy, dim[1]);
+    dz = nearest(dz, dim[2]);
+  }
+
+  b->dx[i] = dx;
+  b->dy[i] = dy;
+  b->dz[i] = dz;
+  b->eps[i] = m_a->max_softening;
+
+  b->M_000[i] = m_a->M_000;
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  b->M_200[i] = m_a->M_200;
+  b->M_020[i] = m_a->M_020;
+  b->M_002[i] = m_a->M_002;
+  b->M_110[i] = m_a->M_110;
+  b->M_101[i] = m_a->M_101;
+  b->M_011[i] = m_a->M_011;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+  b->M_300[i] = m_a->M_300;
+  b->M_030[i] = m_a->M_030;
+  b->M_003[i] = m_a->M_003;
+  b->M_210[i] = m_a->M_210;
+  b->M_201[i] = m_a->M_201;
+  b->M_120[i] = m_a->M_120;
+  b->M_021[i] = m_a->M_021;
+  b->M_102[i] = m_a->M_102;
+  b->M_012[i] = m_a->M_012;
+  b->M_111[i] = m_a->M_111;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+  b->M_400[i] = m_a->M_400;
+  b->M_040[i] = m_a->M_040;
+  b->M_004[i] = m_a->M_004;
+  b->M_310[i] = m_a->M_310;
+  b->M_301[i] = m_a->M_301;
+  b->M_130[i] = m_a->M_130;
+  b->M_031[i] = m_a->M_031;
+  b->M_103[i] = m_a->M_103;
+  b->M_013[i] = m_a->M_013;
+  b->M_220[i] = m_a->M_220;
+  b->M_202[i] = m_a->M_202;
+  b->M_022[i] = m_a->M_022;
+  b->M_211[i] = m_a->M_211;
+  b->M_121[i] = m_a->M_121;
+  b->M_112[i] = m_a->M_112;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+  b->M_005[i] = m_a->M_005;
+  b->M_014[i] = m_a->M_014;
+  b->M_023[i] = m_a->M_023;
+  b->M_032[i] = m_a->M_032;
+  b->M_041[i] = m_a->M_041;
+  b->M_050[i] = m_a->M_050;
+  b->M_104[i] = m_a->M_104;
+  b->M_113[i] = m_a->M_113;
+  b->M_122[i] = m_a->M_122;
+  b->M_131[i] = m_a->M_131;
+  b->M_140[i] = m_a->M_140;
+  b->M_203[i] = m_a->M_203;
+  b->M_212[i] = m_a->M_212;
+  b->M_221[i] = m_a->M_221;
+  b->M_230[i] = m_a->M_230;
+  b->M_302[i] = m_a->M_302;
+  b->M_311[i] = m_a->M_311;
+  b->M_320[i] = m_a->M_320;
+  b->M_401[i] = m_a->M_401;
+  b->M_410[i] = m_a->M_410;
+  b->M_500[i] = m_a->M_500;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+  b->num_gpart[i] = m_a->num_gpart;
+#endif
+}
+
+/**
+ * @brief Sum the first entries of an array of a #multipole_batch.
+ *
+ * @param F The array.
+ * @param count The number of entries to sum.
+ */
+__attribute__((always_inline, nonnull)) INLINE static float
+multipole_batch_sum(const float *F, const int count) {
+
+  float sum = 0.f;
+#pragma omp simd reduction(+ : sum)
+  for (int i = 0; i < count; i++) sum += F[i];
+  return sum;
+}
+
+/**
+ * @brief Compute the field tensor due to all the multipoles of a
+ * #multipole_batch.
+ *
+ * This is gravity_M2L_nonsym() applied to every multipole of the batch. The
+ * derivatives of the potential and the tensor products of each multipole are
+ * computed in a single loop over the batch, one multipole per SIMD lane, and
+ * the resulting field tensors are summed once at the end.
+ *
+ * The derivatives of the truncation function are computed for all the
+ * multipoles in a loop of their own beforehand, as the calls to expf() would
+ * otherwise prevent the vectorization of the main loop. Without periodic
+ * BCs, they are set to those of the un-truncated potential so that the main
+ * loop is the same in both cases. All the branches of that loop are
+ * evaluated for every multipole, which hence all need a non-zero softening.
+ *
+ * @param l_b The field tensor to compute.
+ * @param b The #multipole_batch.
+ * @param periodic Is the calculation periodic ?
+ * @param rs_inv The inverse of the gravity mesh-smoothing scale.
+ */
+__attribute__((nonnull)) INLINE static void gravity_M2L_batch(
+    struct grav_tensor *l_b, struct multipole_batch *b, const int periodic,
+    const float rs_inv) {
+
+  const int count = b->count;
+  if (count == 0) return;
+
+  if (periodic) {
+#pragma omp simd
+    for (int i = 0; i < count; i++) {
+
+      const float dx = b->dx[i];
+      const float dy = b->dy[i];
+      const float dz = b->dz[i];
+      const float r = sqrtf(dx * dx + dy * dy + dz * dz);
+
+      /* Get the derivatives of the truncated potential */
+      struct chi_derivatives derivs;
+      kernel_long_grav_derivatives(r, rs_inv, &derivs);
+      b->chi_0[i] = derivs.chi_0;
+      b->chi_1[i] = derivs.chi_1;
+      b->chi_2[i] = derivs.chi_2;
+      b->chi_3[i] = derivs.chi_3;
+      b->chi_4[i] = derivs.chi_4;
+      b->chi_5[i] = derivs.chi_5;
+    }
+  } else {
+
+    /* No truncation */
+    for (int i = 0; i < count; i++) {
+      b->chi_0[i] = 1.f;
+      b->chi_1[i] = 0.f;
+      b->chi_2[i] = 0.f;
+      b->chi_3[i] = 0.f;
+      b->chi_4[i] = 0.f;
+      b->chi_5[i] = 0.f;
+    }
+  }
+
+#pragma omp simd
+  for (int i = 0; i < count; i++) {
+
+    /* Compute distance */
+    const float dx = b->dx[i];
+    const float dy = b->dy[i];
+    const float dz = b->dz[i];
+    const float r2 = dx * dx + dy * dy + dz * dz;
+    const float r_inv = 1.f / sqrtf(r2);
+
+    /* Recover the derivatives of the truncated potential */
+    struct chi_derivatives derivs;
+    derivs.chi_0 = b->chi_0[i];
+    derivs.chi_1 = b->chi_1[i];
+    derivs.chi_2 = b->chi_2[i];
+    derivs.chi_3 = b->chi_3[i];
+    derivs.chi_4 = b->chi_4[i];
+    derivs.chi_5 = b->chi_5[i];
+
+    /* Compute all derivatives */
+    struct potential_derivatives_M2L pot;
+    potential_derivatives_compute_M2L_chi(dx, dy, dz, r2, r_inv, b->eps[i],
+                                          /*periodic=*/1, &derivs, &pot);
+
+    /* Recover the multipole */
+    struct multipole m;
+    m.M_000 = b->M_000[i];
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+    m.M_200 = b->M_200[i];
+    m.M_020 = b->M_020[i];
+    m.M_002 = b->M_002[i];
+    m.M_110 = b->M_110[i];
+    m.M_101 = b->M_101[i];
+    m.M_011 = b->M_011[i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+    m.M_300 = b->M_300[i];
+    m.M_030 = b->M_030[i];
+    m.M_003 = b->M_003[i];
+    m.M_210 = b->M_210[i];
+    m.M_201 = b->M_201[i];
+    m.M_120 = b->M_120[i];
+    m.M_021 = b->M_021[i];
+    m.M_102 = b->M_102[i];
+    m.M_012 = b->M_012[i];
+    m.M_111 = b->M_111[i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+    m.M_400 = b->M_400[i];
+    m.M_040 = b->M_040[i];
+    m.M_004 = b->M_004[i];
+    m.M_310 = b->M_310[i];
+    m.M_301 = b->M_301[i];
+    m.M_130 = b->M_130[i];
+    m.M_031 = b->M_031[i];
+    m.M_103 = b->M_103[i];
+    m.M_013 = b->M_013[i];
+    m.M_220 = b->M_220[i];
+    m.M_202 = b->M_202[i];
+    m.M_022 = b->M_022[i];
+    m.M_211 = b->M_211[i];
+    m.M_121 = b->M_121[i];
+    m.M_112 = b->M_112[i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+    m.M_005 = b->M_005[i];
+    m.M_014 = b->M_014[i];
+    m.M_023 = b->M_023[i];
+    m.M_032 = b->M_032[i];
+    m.M_041 = b->M_041[i];
+    m.M_050 = b->M_050[i];
+    m.M_104 = b->M_104[i];
+    m.M_113 = b->M_113[i];
+    m.M_122 = b->M_122[i];
+    m.M_131 = b->M_131[i];
+    m.M_140 = b->M_140[i];
+    m.M_203 = b->M_203[i];
+    m.M_212 = b->M_212[i];
+    m.M_221 = b->M_221[i];
+    m.M_230 = b->M_230[i];
+    m.M_302 = b->M_302[i];
+    m.M_311 = b->M_311[i];
+    m.M_320 = b->M_320[i];
+    m.M_401 = b->M_401[i];
+    m.M_410 = b->M_410[i];
+    m.M_500 = b->M_500[i];
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+    m.num_gpart = b->num_gpart[i];
+#endif
+
+    /* Do the M2L tensor multiplication */
+    struct grav_tensor l = {0};
+    gravity_M2L_apply(&l, &m, &pot);
+
+    b->F_000[i] = l.F_000;
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 0
+    b->F_100[i] = l.F_100;
+    b->F_010[i] = l.F_010;
+    b->F_001[i] = l.F_001;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+    b->F_200[i] = l.F_200;
+    b->F_020[i] = l.F_020;
+    b->F_002[i] = l.F_002;
+    b->F_110[i] = l.F_110;
+    b->F_101[i] = l.F_101;
+    b->F_011[i] = l.F_011;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+    b->F_300[i] = l.F_300;
+    b->F_030[i] = l.F_030;
+    b->F_003[i] = l.F_003;
+    b->F_210[i] = l.F_210;
+    b->F_201[i] = l.F_201;
+    b->F_120[i] = l.F_120;
+    b->F_021[i] = l.F_021;
+    b->F_102[i] = l.F_102;
+    b->F_012[i] = l.F_012;
+    b->F_111[i] = l.F_111;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+    b->F_400[i] = l.F_400;
+    b->F_040[i] = l.F_040;
+    b->F_004[i] = l.F_004;
+    b->F_310[i] = l.F_310;
+    b->F_301[i] = l.F_301;
+    b->F_130[i] = l.F_130;
+    b->F_031[i] = l.F_031;
+    b->F_103[i] = l.F_103;
+    b->F_013[i] = l.F_013;
+    b->F_220[i] = l.F_220;
+    b->F_202[i] = l.F_202;
+    b->F_022[i] = l.F_022;
+    b->F_211[i] = l.F_211;
+    b->F_121[i] = l.F_121;
+    b->F_112[i] = l.F_112;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+    b->F_005[i] = l.F_005;
+    b->F_014[i] = l.F_014;
+    b->F_023[i] = l.F_023;
+    b->F_032[i] = l.F_032;
+    b->F_041[i] = l.F_041;
+    b->F_050[i] = l.F_050;
+    b->F_104[i] = l.F_104;
+    b->F_113[i] = l.F_113;
+    b->F_122[i] = l.F_122;
+    b->F_131[i] = l.F_131;
+    b->F_140[i] = l.F_140;
+    b->F_203[i] = l.F_203;
+    b->F_212[i] = l.F_212;
+    b->F_221[i] = l.F_221;
+    b->F_230[i] = l.F_230;
+    b->F_302[i] = l.F_302;
+    b->F_311[i] = l.F_311;
+    b->F_320[i] = l.F_320;
+    b->F_401[i] = l.F_401;
+    b->F_410[i] = l.F_410;
+    b->F_500[i] = l.F_500;
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+  }
+
+  /* Sum the field tensors */
+  l_b->F_000 += multipole_batch_sum(b->F_000, count);
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 0
+  l_b->F_100 += multipole_batch_sum(b->F_100, count);
+  l_b->F_010 += multipole_batch_sum(b->F_010, count);
+  l_b->F_001 += multipole_batch_sum(b->F_001, count);
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 1
+  l_b->F_200 += multipole_batch_sum(b->F_200, count);
+  l_b->F_020 += multipole_batch_sum(b->F_020, count);
+  l_b->F_002 += multipole_batch_sum(b->F_002, count);
+  l_b->F_110 += multipole_batch_sum(b->F_110, count);
+  l_b->F_101 += multipole_batch_sum(b->F_101, count);
+  l_b->F_011 += multipole_batch_sum(b->F_011, count);
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 2
+  l_b->F_300 += multipole_batch_sum(b->F_300, count);
+  l_b->F_030 += multipole_batch_sum(b->F_030, count);
+  l_b->F_003 += multipole_batch_sum(b->F_003, count);
+  l_b->F_210 += multipole_batch_sum(b->F_210, count);
+  l_b->F_201 += multipole_batch_sum(b->F_201, count);
+  l_b->F_120 += multipole_batch_sum(b->F_120, count);
+  l_b->F_021 += multipole_batch_sum(b->F_021, count);
+  l_b->F_102 += multipole_batch_sum(b->F_102, count);
+  l_b->F_012 += multipole_batch_sum(b->F_012, count);
+  l_b->F_111 += multipole_batch_sum(b->F_111, count);
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 3
+  l_b->F_400 += multipole_batch_sum(b->F_400, count);
+  l_b->F_040 += multipole_batch_sum(b->F_040, count);
+  l_b->F_004 += multipole_batch_sum(b->F_004, count);
+  l_b->F_310 += multipole_batch_sum(b->F_310, count);
+  l_b->F_301 += multipole_batch_sum(b->F_301, count);
+  l_b->F_130 += multipole_batch_sum(b->F_130, count);
+  l_b->F_031 += multipole_batch_sum(b->F_031, count);
+  l_b->F_103 += multipole_batch_sum(b->F_103, count);
+  l_b->F_013 += multipole_batch_sum(b->F_013, count);
+  l_b->F_220 += multipole_batch_sum(b->F_220, count);
+  l_b->F_202 += multipole_batch_sum(b->F_202, count);
+  l_b->F_022 += multipole_batch_sum(b->F_022, count);
+  l_b->F_211 += multipole_batch_sum(b->F_211, count);
+  l_b->F_121 += multipole_batch_sum(b->F_121, count);
+  l_b->F_112 += multipole_batch_sum(b->F_112, count);
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 4
+  l_b->F_005 += multipole_batch_sum(b->F_005, count);
+  l_b->F_014 += multipole_batch_sum(b->F_014, count);
+  l_b->F_023 += multipole_batch_sum(b->F_023, count);
+  l_b->F_032 += multipole_batch_sum(b->F_032, count);
+  l_b->F_041 += multipole_batch_sum(b->F_041, count);
+  l_b->F_050 += multipole_batch_sum(b->F_050, count);
+  l_b->F_104 += multipole_batch_sum(b->F_104, count);
+  l_b->F_113 += multipole_batch_sum(b->F_113, count);
+  l_b->F_122 += multipole_batch_sum(b->F_122, count);
+  l_b->F_131 += multipole_batch_sum(b->F_131, count);
+  l_b->F_140 += multipole_batch_sum(b->F_140, count);
+  l_b->F_203 += multipole_batch_sum(b->F_203, count);
+  l_b->F_212 += multipole_batch_sum(b->F_212, count);
+  l_b->F_221 += multipole_batch_sum(b->F_221, count);
+  l_b->F_230 += multipole_batch_sum(b->F_230, count);
+  l_b->F_302 += multipole_batch_sum(b->F_302, count);
+  l_b->F_311 += multipole_batch_sum(b->F_311, count);
+  l_b->F_320 += multipole_batch_sum(b->F_320, count);
+  l_b->F_401 += multipole_batch_sum(b->F_401, count);
+  l_b->F_410 += multipole_batch_sum(b->F_410, count);
+  l_b->F_500 += multipole_batch_sum(b->F_500, count);
+#endif
+#if SELF_GRAVITY_MULTIPOLE_ORDER > 5
+#error "Missing implementation for order >5"
+#endif
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+  long long num_gpart = 0;
+  for (int i = 0; i < count; i++) num_gpart += b->num_gpart[i];
+#endif
+
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Count all interactions */
+  accumulate_add_ll(&l_b->num_interacted, num_gpart);
+#endif
+
+#ifdef SWIFT_GRAVITY_FORCE_CHECKS
+  /* Count tree interactions */
+  accumulate_add_ll(&l_b->num_interacted_tree, num_gpart);
+#endif
+
+  /* Record that this tensor has received contributions */
+  l_b->interacted = 1;
+}
+
+#endif /* SWIFT_MULTIPOLE_BATCH_H */
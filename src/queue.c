@@ -21,6 +21,7 @@
 #include <config.h>
 
 /* Some standard headers. */
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -35,8 +36,46 @@
 
 /* Local headers. */
 #include "atomic.h"
+#include "cycle.h"
 #include "error.h"
+#include "inline.h"
 #include "memswap.h"
+#include "memuse.h"
+#include "minmax.h"
+
+/* Return values of queue_deque_steal() when no task was obtained. */
+#define queue_deque_empty -1
+#define queue_deque_abort -2
+
+/* Names of the queue types. */
+const char *queue_type_names[queue_type_count] = {"heap", "deque"};
+
+/**
+ * @brief Record a failed attempt to lock a task of a #queue.
+ *
+ * @param q The task #queue.
+ * @param t The #task that could not be locked.
+ * @param reweighted Was the task moved down the queue?
+ */
+__attribute__((always_inline)) INLINE static void queue_record_lock_fail(
+    struct queue *q, const struct task *t, const int reweighted) {
+  if (q->stats == NULL) return;
+  atomic_inc(&q->stats->lock_fails[t->type]);
+  if (reweighted) atomic_inc(&q->stats->reweights[t->type]);
+}
+
+/**
+ * @brief Record the time spent in a call that failed to lock some tasks.
+ *
+ * @param q The task #queue.
+ * @param tic The start of the call.
+ * @param nr_fails The number of tasks that could not be locked.
+ */
+__attribute__((always_inline)) INLINE static void queue_record_spin(
+    struct queue *q, const ticks tic, const int nr_fails) {
+  if (q->stats != NULL && nr_fails > 0)
+    atomic_add(&q->stats->spin, getticks() - tic);
+}
 
 /**
  * @brief Push the task at the given index up the heap until it is either at the
@@ -102,6 +141,140 @@ int queue_sift_down(struct queue *q, int ind) {
   return ind;
 }
 
+/**
+ * @brief Allocate a new #queue_deque_buffer.
+ *
+ * @param size The number of slots, must be a power of two.
+ */
+static struct queue_deque_buffer *queue_deque_buffer_new(long long size) {
+
+  struct queue_deque_buffer *buff = (struct queue_deque_buffer *)malloc(
+      sizeof(struct queue_deque_buffer) + sizeof(int) * size);
+  if (buff == NULL) error("Failed to allocate deque buffer.");
+  buff->size = size;
+  buff->prev = NULL;
+  return buff;
+}
+
+/**
+ * @brief Get the priority bucket of a task given its weight.
+ *
+ * The buckets are logarithmic in weight, each one spanning
+ * #queue_deque_bucket_width powers of two.
+ *
+ * @param weight The weight of the #task.
+ */
+__attribute__((always_inline)) INLINE static int queue_deque_bucket(
+    const float weight) {
+
+  if (!(weight >= 1.f)) return 0;
+  const int b = ilogbf(weight) / queue_deque_bucket_width;
+  return min(b, queue_deque_nr_buckets - 1);
+}
+
+/**
+ * @brief Push a task offset at the bottom of a #queue_deque.
+ *
+ * Must only be called by the owner of the #queue, i.e. with the queue lock
+ * held.
+ *
+ * @param d The #queue_deque.
+ * @param tid The offset of the task.
+ */
+static void queue_deque_push(struct queue_deque *d, const int tid) {
+
+  const long long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+  const long long t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+  struct queue_deque_buffer *buff =
+      __atomic_load_n(&d->buffer, __ATOMIC_RELAXED);
+
+  /* Does the buffer need to be grown? The old one is kept alive since
+   * thieves may still be reading from it. */
+  if (b - t > buff->size - 1) {
+    struct queue_deque_buffer *temp =
+        queue_deque_buffer_new(buff->size * queue_sizegrow);
+    for (long long k = t; k < b; k++)
+      temp->tids[k & (temp->size - 1)] = buff->tids[k & (buff->size - 1)];
+    temp->prev = buff;
+    __atomic_store_n(&d->buffer, temp, __ATOMIC_RELEASE);
+    buff = temp;
+  }
+
+  /* Store the task and make it visible to the thieves. */
+  __atomic_store_n(&buff->tids[b & (buff->size - 1)], tid, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Pop a task offset from the bottom of a #queue_deque.
+ *
+ * Must only be called by the owner of the #queue, i.e. with the queue lock
+ * held.
+ *
+ * @param d The #queue_deque.
+ *
+ * @return The offset of the task or #queue_deque_empty.
+ */
+static int queue_deque_take(struct queue_deque *d) {
+
+  const long long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+  struct queue_deque_buffer *buff =
+      __atomic_load_n(&d->buffer, __ATOMIC_RELAXED);
+  __atomic_store_n(&d->bottom, b, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  long long t = __atomic_load_n(&d->top, __ATOMIC_RELAXED);
+
+  /* Empty deque? */
+  if (t > b) {
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    return queue_deque_empty;
+  }
+
+  int tid =
+      __atomic_load_n(&buff->tids[b & (buff->size - 1)], __ATOMIC_RELAXED);
+
+  /* Last element? Then we race against the thieves for it. */
+  if (t == b) {
+    if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, /*weak=*/0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+      tid = queue_deque_empty;
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+  }
+
+  return tid;
+}
+
+/**
+ * @brief Steal a task offset from the top of a #queue_deque.
+ *
+ * Can be called by any thread without holding any lock.
+ *
+ * @param d The #queue_deque.
+ *
+ * @return The offset of the task, #queue_deque_empty if there was nothing to
+ * steal or #queue_deque_abort if we lost a race with another thread.
+ */
+static int queue_deque_steal(struct queue_deque *d) {
+
+  long long t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  const long long b = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE);
+
+  if (t >= b) return queue_deque_empty;
+
+  struct queue_deque_buffer *buff =
+      __atomic_load_n(&d->buffer, __ATOMIC_ACQUIRE);
+  const int tid =
+      __atomic_load_n(&buff->tids[t & (buff->size - 1)], __ATOMIC_RELAXED);
+
+  if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, /*weak=*/0,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+    return queue_deque_abort;
+
+  return tid;
+}
+
 /**
  * @brief Enqueue all tasks in the incoming DEQ.
  *
@@ -122,6 +295,15 @@ void queue_get_incoming(struct queue *q) {
     const int offset = atomic_swap(&q->tid_incoming[ind], -1);
     atomic_inc(&q->first_incoming);
 
+    /* Work-stealing deques? Just drop it in the right bucket. */
+    if (q->type == queue_type_deque) {
+      queue_deque_push(&q->buckets[queue_deque_bucket(q->tasks[offset].weight)],
+                       offset);
+      atomic_inc(&q->count);
+      atomic_dec(&q->count_incoming);
+      continue;
+    }
+
     /* Does the queue need to be grown? */
     if (q->count == q->size) {
       struct queue_entry *temp;
@@ -188,14 +370,37 @@ void queue_insert(struct queue *q, struct task *t) {
  *
  * @param q The #queue.
  * @param tasks List of tasks to which the queue indices refer to.
+ * @param type The #queue_types backend to use.
  */
-void queue_init(struct queue *q, struct task *tasks) {
+void queue_init(struct queue *q, struct task *tasks, enum queue_types type) {
+
+  q->type = type;
+  q->entries = NULL;
+  q->buckets = NULL;
+
+  if (type == queue_type_heap) {
 
-  /* Allocate the task list if needed. */
-  q->size = queue_sizeinit;
-  if ((q->entries = (struct queue_entry *)malloc(sizeof(struct queue_entry) *
-                                                 q->size)) == NULL)
-    error("Failed to allocate queue entries.");
+    /* Allocate the task list if needed. */
+    q->size = queue_sizeinit;
+    if ((q->entries = (struct queue_entry *)malloc(
+             sizeof(struct queue_entry) * q->size)) == NULL)
+      error("Failed to allocate queue entries.");
+
+  } else {
+
+    /* Allocate the priority buckets. */
+    q->size = 0;
+    if (swift_memalign("queue_buckets", (void **)&q->buckets,
+                       queue_struct_align,
+                       sizeof(struct queue_deque) * queue_deque_nr_buckets) !=
+        0)
+      error("Failed to allocate queue buckets.");
+    for (int k = 0; k < queue_deque_nr_buckets; k++) {
+      q->buckets[k].top = 0;
+      q->buckets[k].bottom = 0;
+      q->buckets[k].buffer = queue_deque_buffer_new(queue_deque_sizeinit);
+    }
+  }
 
   /* Set the tasks pointer. */
   q->tasks = tasks;
@@ -216,6 +421,107 @@ void queue_init(struct queue *q, struct task *tasks) {
   q->first_incoming = 0;
   q->last_incoming = 0;
   q->count_incoming = 0;
+
+  /* Nobody is asleep yet. */
+  q->sleepers = 0;
+  q->wake_seq = 0;
+
+  /* No statistics unless asked for. */
+  q->stats = NULL;
+}
+
+/**
+ * @brief Get a task free of conflicts from the deques of a #queue we own.
+ *
+ * The buckets are searched from the highest to the lowest weight. Tasks that
+ * cannot be locked are put back, one bucket lower, once we are done.
+ *
+ * @param q The task #queue, assumed to be locked.
+ */
+static struct task *queue_gettask_deque(struct queue *q) {
+
+  struct task *qtasks = q->tasks;
+  struct task *res = NULL;
+  int failed_tid[queue_deque_max_retries];
+  int failed_bucket[queue_deque_max_retries];
+  int nr_failed = 0;
+  const ticks tic = q->stats != NULL ? getticks() : 0;
+
+  /* Fill any tasks from the incoming DEQ. */
+  queue_get_incoming(q);
+
+  for (int b = queue_deque_nr_buckets - 1;
+       b >= 0 && res == NULL && nr_failed < queue_deque_max_retries; b--) {
+    while (nr_failed < queue_deque_max_retries) {
+
+      const int tid = queue_deque_take(&q->buckets[b]);
+      if (tid == queue_deque_empty) break;
+
+      /* Try to lock the task. */
+      if (task_lock(&qtasks[tid])) {
+        res = &qtasks[tid];
+        atomic_dec(&q->count);
+        break;
+      }
+
+      /* De-prioritize it. */
+      queue_record_lock_fail(q, &qtasks[tid], /*reweighted=*/b > 0);
+      failed_tid[nr_failed] = tid;
+      failed_bucket[nr_failed] = max(b - 1, 0);
+      nr_failed++;
+    }
+  }
+
+  /* Put back the tasks we could not lock. */
+  for (int k = 0; k < nr_failed; k++)
+    queue_deque_push(&q->buckets[failed_bucket[k]], failed_tid[k]);
+
+  queue_record_spin(q, tic, nr_failed);
+  return res;
+}
+
+/**
+ * @brief Steal a task free of conflicts from the deques of a #queue, without
+ * taking its lock.
+ *
+ * Tasks that cannot be locked are handed back to the owner through the
+ * incoming DEQ.
+ *
+ * @param q The task #queue.
+ */
+static struct task *queue_steal_deque(struct queue *q) {
+
+  struct task *qtasks = q->tasks;
+  int nr_tries = 0;
+  int nr_failed = 0;
+  const ticks tic = q->stats != NULL ? getticks() : 0;
+
+  for (int b = queue_deque_nr_buckets - 1;
+       b >= 0 && nr_tries < queue_deque_max_retries; b--) {
+    while (nr_tries < queue_deque_max_retries) {
+
+      const int tid = queue_deque_steal(&q->buckets[b]);
+      if (tid == queue_deque_empty) break;
+      nr_tries++;
+      if (tid == queue_deque_abort) continue;
+
+      /* Try to lock the task. */
+      if (task_lock(&qtasks[tid])) {
+        atomic_dec(&q->count);
+        queue_record_spin(q, tic, nr_failed);
+        return &qtasks[tid];
+      }
+
+      /* Give it back to the owner. */
+      queue_record_lock_fail(q, &qtasks[tid], /*reweighted=*/0);
+      nr_failed++;
+      queue_insert(q, &qtasks[tid]);
+      atomic_dec(&q->count);
+    }
+  }
+
+  queue_record_spin(q, tic, nr_failed);
+  return NULL;
 }
 
 /**
@@ -234,8 +540,18 @@ struct task *queue_gettask(struct queue *q, const struct task *prev,
   /* Grab the task lock. */
   if (blocking) {
     if (lock_lock(qlock) != 0) error("Locking the qlock failed.\n");
-  } else {
-    if (lock_trylock(qlock) != 0) return NULL;
+  } else if (lock_trylock(qlock) != 0) {
+
+    /* Somebody else owns the deques, but we can still steal from them. */
+    if (q->type == queue_type_deque) return queue_steal_deque(q);
+    return NULL;
+  }
+
+  /* Work-stealing deques? */
+  if (q->type == queue_type_deque) {
+    res = queue_gettask_deque(q);
+    if (lock_unlock(qlock) != 0) error("Unlocking the qlock failed.\n");
+    return res;
   }
 
   /* Fill any tasks from the incoming DEQ. */
@@ -251,6 +567,8 @@ struct task *queue_gettask(struct queue *q, const struct task *prev,
   struct queue_entry *entries = q->entries;
   struct task *qtasks = q->tasks;
   const int old_qcount = q->count;
+  const ticks tic = q->stats != NULL ? getticks() : 0;
+  int nr_failed = 0;
 
   /* Loop over the queue entries. */
   int ind;
@@ -258,6 +576,8 @@ struct task *queue_gettask(struct queue *q, const struct task *prev,
 
     /* Try to lock the next task. */
     if (task_lock(&qtasks[entries[ind].tid])) break;
+    queue_record_lock_fail(q, &qtasks[entries[ind].tid], /*reweighted=*/1);
+    nr_failed++;
 
     /* Should we de-prioritize this task? */
 
@@ -303,13 +623,60 @@ struct task *queue_gettask(struct queue *q, const struct task *prev,
 
   /* Release the task lock. */
   if (lock_unlock(qlock) != 0) error("Unlocking the qlock failed.\n");
+  queue_record_spin(q, tic, nr_failed);
 
   /* Take the money and run. */
   return res;
 }
 
+/**
+ * @brief Steal a task free of dependencies and conflicts from a #queue we do
+ * not own.
+ *
+ * For #queue_type_heap queues, this is a non-blocking queue_gettask(). For
+ * #queue_type_deque queues, the tasks are taken from the top of the deques
+ * without locking the queue, and we only try to grab the lock to collect
+ * tasks from the incoming DEQ when the deques are empty.
+ *
+ * @param q The task #queue.
+ * @param prev The previous #task extracted from this #queue.
+ */
+struct task *queue_steal(struct queue *q, const struct task *prev) {
+
+  struct task *res = NULL;
+
+  if (q->type == queue_type_heap) {
+    res = queue_gettask(q, prev, 0);
+  } else {
+    res = queue_steal_deque(q);
+
+    /* Nobody may be looking after the incoming DEQ, do it ourselves. */
+    if (res == NULL && q->count_incoming > 0 && lock_trylock(&q->lock) == 0) {
+      res = queue_gettask_deque(q);
+      if (lock_unlock(&q->lock) != 0) error("Unlocking the qlock failed.\n");
+    }
+  }
+
+  if (q->stats != NULL) {
+    atomic_inc(&q->stats->steal_attempts);
+    if (res != NULL) atomic_inc(&q->stats->steals[res->type]);
+  }
+  return res;
+}
+
 void queue_clean(struct queue *q) {
 
+  if (q->type == queue_type_deque) {
+    for (int k = 0; k < queue_deque_nr_buckets; k++) {
+      struct queue_deque_buffer *buff = q->buckets[k].buffer;
+      while (buff != NULL) {
+        struct queue_deque_buffer *prev = buff->prev;
+        free(buff);
+        buff = prev;
+      }
+    }
+    swift_free("queue_buckets", q->buckets);
+  }
   free(q->entries);
   free(q->tid_incoming);
 }
@@ -332,12 +699,30 @@ void queue_dump(int nodeID, int index, FILE *file, struct queue *q) {
   /* Fill any tasks from the incoming DEQ. */
   queue_get_incoming(q);
 
-  /* Loop over the queue entries. */
-  for (int k = 0; k < q->count; k++) {
-    struct task *t = &q->tasks[q->entries[k].tid];
+  if (q->type == queue_type_deque) {
 
-    fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
-            taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+    /* Loop over the buckets, from the highest weight down. */
+    int k = 0;
+    for (int b = queue_deque_nr_buckets - 1; b >= 0; b--) {
+      const struct queue_deque *d = &q->buckets[b];
+      const struct queue_deque_buffer *buff = d->buffer;
+      for (long long i = d->bottom - 1; i >= d->top; i--, k++) {
+        struct task *t = &q->tasks[buff->tids[i & (buff->size - 1)]];
+
+        fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
+                taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+      }
+    }
+
+  } else {
+
+    /* Loop over the queue entries. */
+    for (int k = 0; k < q->count; k++) {
+      struct task *t = &q->tasks[q->entries[k].tid];
+
+      fprintf(file, "%d %d %d %s %s %.2f\n", nodeID, index, k,
+              taskID_names[t->type], subtaskID_names[t->subtype], t->weight);
+    }
   }
 
   /* Release the task lock. */
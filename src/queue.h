@@ -32,6 +32,12 @@
 #define queue_incoming_size 10240
 #define queue_struct_align 64
 
+/* Constants for the work-stealing deque backend. */
+#define queue_deque_nr_buckets 16
+#define queue_deque_bucket_width 4
+#define queue_deque_sizeinit 64
+#define queue_deque_max_retries 32
+
 /* Constants dealing with task de-priorization. */
 #define queue_lock_fail_reweight_factor 0.5
 /* #define queue_lock_fail_reweight_mask \
@@ -45,6 +51,14 @@ enum {
 };
 extern int queue_counter[queue_counter_count];
 
+/** The different ways of storing the tasks inside a #queue. */
+enum queue_types {
+  queue_type_heap = 0, /* Spin-locked binary heap ordered by weight. */
+  queue_type_deque,    /* Lock-free work-stealing deques, bucketed by weight. */
+  queue_type_count
+};
+extern const char *queue_type_names[queue_type_count];
+
 /** Struct containing a task offset and a weight, used to build the binary heap
  * of tasks in the queue. */
 struct queue_entry {
@@ -56,31 +70,100 @@ struct queue_entry {
   float weight;
 };
 
+/** Circular buffer of task offsets backing a #queue_deque. */
+struct queue_deque_buffer {
+
+  /* Number of slots in the buffer, always a power of two. */
+  long long size;
+
+  /* The previous (smaller) buffer, kept alive as thieves may still read it. */
+  struct queue_deque_buffer *prev;
+
+  /* The task offsets. */
+  int tids[];
+};
+
+/**
+ * @brief A Chase-Lev work-stealing deque of task offsets.
+ *
+ * The owner of the queue (i.e. whoever holds the queue lock) pushes and
+ * pops at the bottom, any other thread can steal from the top without
+ * taking any lock.
+ */
+struct queue_deque {
+
+  /* Index of the oldest element, only ever increases. */
+  volatile long long top;
+
+  /* Index one past the newest element, only modified by the owner. */
+  volatile long long bottom;
+
+  /* The current buffer. */
+  struct queue_deque_buffer *volatile buffer;
+
+} __attribute__((aligned(queue_struct_align)));
+
+/** Lock contention statistics of a queue. */
+struct queue_lock_stats {
+
+  /* Number of failed attempts to lock a task, per task type. */
+  long long lock_fails[task_type_count];
+
+  /* Number of tasks moved down the queue after such a failure, per type. */
+  long long reweights[task_type_count];
+
+  /* Number of tasks stolen from this queue, per type. */
+  long long steals[task_type_count];
+
+  /* Number of attempts to steal from this queue. */
+  long long steal_attempts;
+
+  /* Time spent looking through this queue in calls where a lock failed. */
+  ticks spin;
+
+} __attribute__((aligned(queue_struct_align)));
+
 /** The queue struct. */
 struct queue {
 
-  /* The lock to access this queue. */
+  /* The lock to access this queue. In #queue_type_deque mode, this only
+   * designates the current owner of the deques. */
   swift_lock_type lock;
 
+  /* How are the tasks stored? */
+  enum queue_types type;
+
   /* Size, count and next element. */
   int size, count;
 
   /* The actual tasks to which the indices refer. */
   struct task *tasks;
 
-  /* The task indices and weights. */
+  /* The task indices and weights (#queue_type_heap). */
   struct queue_entry *entries;
 
+  /* The priority buckets, from lowest to highest weight (#queue_type_deque).
+   */
+  struct queue_deque *buckets;
+
   /* DEQ for incoming tasks. */
   int *tid_incoming;
   volatile unsigned int first_incoming, last_incoming, count_incoming;
 
+  /* Number of runners parked on this queue and the futex they wait on. */
+  volatile int sleepers;
+  volatile int wake_seq;
+
+  /* Lock contention statistics, if we collect them. */
+  struct queue_lock_stats *stats;
+
 } __attribute__((aligned(queue_struct_align)));
 
 /* Function prototypes. */
 struct task *queue_gettask(struct queue *q, const struct task *prev,
                            int blocking);
-void queue_init(struct queue *q, struct task *tasks);
+struct task *queue_steal(struct queue *q, const struct task *prev);
+void queue_init(struct queue *q, struct task *tasks, enum queue_types type);
 void queue_insert(struct queue *q, struct task *t);
 void queue_clean(struct queue *q);
 
@@ -0,0 +1,190 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_RIEMANN_BATCH_H
+#define SWIFT_RIEMANN_BATCH_H
+
+/* Local headers. */
+#include "align.h"
+#include "error.h"
+#include "inline.h"
+#include "riemann_checks.h"
+
+/*! Number of Riemann problems in a #riemann_batch */
+#define RIEMANN_BATCH_SIZE 64
+
+/**
+ * @brief A batch of Riemann problems, stored as structure of arrays so that
+ * the solvers can work on several interfaces at once.
+ *
+ * The problems are added one by one with riemann_batch_add(), solved
+ * together with riemann_solve_batch_for_flux() or
+ * riemann_solve_batch_for_middle_state_flux() and their fluxes read back
+ * with riemann_batch_get_flux().
+ */
+struct riemann_batch {
+
+  /*! Left and right state vectors */
+  float WL[5][RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+  float WR[5][RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+
+  /*! Normal vectors and velocities of the interfaces */
+  float n_unit[3][RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+  float vij[3][RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+
+  /*! Fluxes through the interfaces */
+  float totflux[5][RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+
+  /*! Problems that have to be solved one at a time, e.g. vacuum */
+  int special[RIEMANN_BATCH_SIZE] SWIFT_CACHE_ALIGN;
+
+  /*! Number of problems in the batch */
+  int count;
+};
+
+/**
+ * @brief Empty a #riemann_batch.
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void riemann_batch_init(
+    struct riemann_batch *b) {
+
+  b->count = 0;
+}
+
+/**
+ * @brief Add a Riemann problem to a #riemann_batch.
+ *
+ * @param b The #riemann_batch, must not be full.
+ * @param WL The left state vector.
+ * @param WR The right state vector.
+ * @param n_unit Normal vector of the interface.
+ * @param vij Velocity of the interface.
+ * @return The index of the problem in the batch.
+ */
+__attribute__((always_inline)) INLINE static int riemann_batch_add(
+    struct riemann_batch *b, const float *WL, const float *WR,
+    const float *n_unit, const float *vij) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+  if (b->count >= RIEMANN_BATCH_SIZE) error("Riemann batch is full.");
+  riemann_check_input(WL, WR, n_unit, vij);
+#endif
+
+  const int i = b->count++;
+  for (int k = 0; k < 5; k++) {
+    b->WL[k][i] = WL[k];
+    b->WR[k][i] = WR[k];
+  }
+  for (int k = 0; k < 3; k++) {
+    b->n_unit[k][i] = n_unit[k];
+    b->vij[k][i] = vij[k];
+  }
+  return i;
+}
+
+/**
+ * @brief Read a Riemann problem back from a #riemann_batch.
+ *
+ * @param b The #riemann_batch.
+ * @param i The index of the problem.
+ * @param WL (return) The left state vector.
+ * @param WR (return) The right state vector.
+ * @param n_unit (return) Normal vector of the interface.
+ * @param vij (return) Velocity of the interface.
+ */
+__attribute__((always_inline)) INLINE static void riemann_batch_get_problem(
+    const struct riemann_batch *b, const int i, float *WL, float *WR,
+    float *n_unit, float *vij) {
+
+  for (int k = 0; k < 5; k++) {
+    WL[k] = b->WL[k][i];
+    WR[k] = b->WR[k][i];
+  }
+  for (int k = 0; k < 3; k++) {
+    n_unit[k] = b->n_unit[k][i];
+    vij[k] = b->vij[k][i];
+  }
+}
+
+/**
+ * @brief Store the flux of a problem of a #riemann_batch.
+ *
+ * @param b The #riemann_batch.
+ * @param i The index of the problem.
+ * @param totflux The flux.
+ */
+__attribute__((always_inline)) INLINE static void riemann_batch_set_flux(
+    struct riemann_batch *b, const int i, const float *totflux) {
+
+  for (int k = 0; k < 5; k++) b->totflux[k][i] = totflux[k];
+}
+
+/**
+ * @brief Get the flux of a solved problem of a #riemann_batch.
+ *
+ * @param b The #riemann_batch.
+ * @param i The index of the problem.
+ * @param totflux (return) The flux.
+ */
+__attribute__((always_inline)) INLINE static void riemann_batch_get_flux(
+    const struct riemann_batch *b, const int i, float *totflux) {
+
+  for (int k = 0; k < 5; k++) totflux[k] = b->totflux[k][i];
+}
+
+/**
+ * @brief List the problems of a #riemann_batch marked as special.
+ *
+ * The solvers loop over this list rather than testing the marks, as the
+ * compiler could otherwise vectorize that loop with masks and compute the
+ * special cases on the zeros of the masked-out lanes.
+ *
+ * @param b The #riemann_batch.
+ * @param special (return) The indices of the special problems.
+ * @return The number of special problems.
+ */
+__attribute__((always_inline)) INLINE static int riemann_batch_get_special(
+    const struct riemann_batch *b, int *special) {
+
+  int count = 0;
+  for (int i = 0; i < b->count; i++)
+    if (b->special[i]) special[count++] = i;
+  return count;
+}
+
+#ifdef SWIFT_DEBUG_CHECKS
+/**
+ * @brief Check the fluxes of all the problems of a #riemann_batch.
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void riemann_batch_check_output(
+    const struct riemann_batch *b) {
+
+  for (int i = 0; i < b->count; i++) {
+    float WL[5], WR[5], n_unit[3], vij[3], totflux[5];
+    riemann_batch_get_problem(b, i, WL, WR, n_unit, vij);
+    riemann_batch_get_flux(b, i, totflux);
+    riemann_check_output(WL, WR, n_unit, vij, totflux);
+  }
+}
+#endif
+
+#endif /* SWIFT_RIEMANN_BATCH_H */
@@ -39,6 +39,7 @@
 #include "adiabatic_index.h"
 #include "error.h"
 #include "minmax.h"
+#include "riemann_batch.h"
 #include "riemann_checks.h"
 #include "riemann_vacuum.h"
 
@@ -661,4 +662,43 @@ riemann_solve_for_middle_state_flux(const float* Wi, const float* Wj,
 #endif
 }
 
+/**
+ * @brief Solve a #riemann_batch of Riemann problems for the flux.
+ *
+ * The exact solver iterates a different number of times for every problem,
+ * so these are solved one at a time.
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void riemann_solve_batch_for_flux(
+    struct riemann_batch *restrict b) {
+
+  for (int i = 0; i < b->count; i++) {
+    float WL[5], WR[5], n_unit[3], vij[3], totflux[5];
+    riemann_batch_get_problem(b, i, WL, WR, n_unit, vij);
+    riemann_solve_for_flux(WL, WR, n_unit, vij, totflux);
+    riemann_batch_set_flux(b, i, totflux);
+  }
+}
+
+/**
+ * @brief Solve a #riemann_batch of Riemann problems for the middle state
+ * flux.
+ *
+ * As for riemann_solve_batch_for_flux(), the problems are solved one at a
+ * time.
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void
+riemann_solve_batch_for_middle_state_flux(struct riemann_batch *restrict b) {
+
+  for (int i = 0; i < b->count; i++) {
+    float WL[5], WR[5], n_unit[3], vij[3], totflux[5];
+    riemann_batch_get_problem(b, i, WL, WR, n_unit, vij);
+    riemann_solve_for_middle_state_flux(WL, WR, n_unit, vij, totflux);
+    riemann_batch_set_flux(b, i, totflux);
+  }
+}
+
 #endif /* SWIFT_RIEMANN_EXACT_H */
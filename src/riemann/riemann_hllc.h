@@ -30,6 +30,7 @@
 #include "adiabatic_index.h"
 #include "error.h"
 #include "minmax.h"
+#include "riemann_batch.h"
 #include "riemann_checks.h"
 #include "riemann_vacuum.h"
 
@@ -244,4 +245,230 @@ riemann_solve_for_middle_state_flux(const float *WL, const float *WR,
 #endif
 }
 
+/**
+ * @brief Solve a #riemann_batch of Riemann problems for the flux, several
+ * interfaces at a time.
+ *
+ * Both the left and right HLLC fluxes are computed for all the problems and
+ * the right one is selected, so that the loop has no branches. Problems
+ * involving vacuum or a vanishing pressure are marked and solved one at a
+ * time with riemann_solve_for_flux() afterwards.
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void riemann_solve_batch_for_flux(
+    struct riemann_batch *restrict b) {
+
+  const int count = b->count;
+
+#pragma omp simd
+  for (int i = 0; i < count; i++) {
+
+    /* Shift the states of the problems that need special treatment away from
+     * 0, to keep the computation below finite. This is done with an addition
+     * rather than a select, so that the compiler cannot move the divisions
+     * into the branches of the select. */
+    const int regular = b->WL[0][i] > 0.f && b->WR[0][i] > 0.f &&
+                        b->WL[4][i] > 0.f && b->WR[4][i] > 0.f;
+    const float shift = regular ? 0.f : 1.f;
+    const float rhoL = max(b->WL[0][i], 0.f) + shift;
+    const float rhoR = max(b->WR[0][i], 0.f) + shift;
+    const float PL = max(b->WL[4][i], 0.f) + shift;
+    const float PR = max(b->WR[4][i], 0.f) + shift;
+    const float vL[3] = {b->WL[1][i], b->WL[2][i], b->WL[3][i]};
+    const float vR[3] = {b->WR[1][i], b->WR[2][i], b->WR[3][i]};
+    const float n[3] = {b->n_unit[0][i], b->n_unit[1][i], b->n_unit[2][i]};
+    const float vij[3] = {b->vij[0][i], b->vij[1][i], b->vij[2][i]};
+
+    /* STEP 0: obtain velocity in interface frame */
+    const float uL = vL[0] * n[0] + vL[1] * n[1] + vL[2] * n[2];
+    const float uR = vR[0] * n[0] + vR[1] * n[1] + vR[2] * n[2];
+    const float rhoLinv = 1.0f / rhoL;
+    const float rhoRinv = 1.0f / rhoR;
+    const float aL = sqrtf(hydro_gamma * PL * rhoLinv);
+    const float aR = sqrtf(hydro_gamma * PR * rhoRinv);
+
+    /* Vacuum generation, see riemann_is_vacuum() */
+    b->special[i] = !regular || hydro_two_over_gamma_minus_one * aL +
+                                        hydro_two_over_gamma_minus_one * aR <=
+                                    uR - uL;
+
+    /* STEP 1: pressure estimate */
+    const float rhobar = rhoL + rhoR;
+    const float abar = aL + aR;
+    const float pPVRS = 0.5f * ((PL + PR) - 0.25f * (uR - uL) * rhobar * abar);
+    const float pstar = max(0.0f, pPVRS);
+
+    /* STEP 2: wave speed estimates */
+    const float qL =
+        sqrtf(1.0f + 0.5f * hydro_gamma_plus_one * hydro_one_over_gamma *
+                         (max(pstar / PL, 1.0f) - 1.0f));
+    const float qR =
+        sqrtf(1.0f + 0.5f * hydro_gamma_plus_one * hydro_one_over_gamma *
+                         (max(pstar / PR, 1.0f) - 1.0f));
+    const float SLmuL = -aL * qL;
+    const float SRmuR = aR * qR;
+    const float Sstar = (PR - PL + rhoL * uL * SLmuL - rhoR * uR * SRmuR) /
+                        (rhoL * SLmuL - rhoR * SRmuR);
+
+    /* STEP 3: HLLC flux in a frame moving with the interface velocity, on
+     * the left... */
+    const float rhoLuL = rhoL * uL;
+    const float v2L = vL[0] * vL[0] + vL[1] * vL[1] + vL[2] * vL[2];
+    const float eL = PL * rhoLinv * hydro_one_over_gamma_minus_one + 0.5f * v2L;
+    const float SL = SLmuL + uL;
+    const float SLmSstar = SL - Sstar;
+    const float starfacL =
+        (SL < 0.0f) ? SLmuL / (SLmSstar != 0.f ? SLmSstar : 1.f) - 1.0f : 0.f;
+    const float rhoLSL = rhoL * SL;
+    const float rhoLSLstarfac = rhoLSL * starfacL;
+    const float rhoLSLSstarmuL = (SL < 0.0f) ? rhoLSL * (Sstar - uL) : 0.f;
+    const float fluxL[5] = {
+        rhoLuL + rhoLSLstarfac,
+        rhoLuL * vL[0] + PL * n[0] + rhoLSLstarfac * vL[0] +
+            rhoLSLSstarmuL * n[0],
+        rhoLuL * vL[1] + PL * n[1] + rhoLSLstarfac * vL[1] +
+            rhoLSLSstarmuL * n[1],
+        rhoLuL * vL[2] + PL * n[2] + rhoLSLstarfac * vL[2] +
+            rhoLSLSstarmuL * n[2],
+        rhoLuL * eL + PL * uL + rhoLSLstarfac * eL +
+            rhoLSLSstarmuL * (Sstar + PL / (rhoL * SLmuL))};
+
+    /* ... and on the right */
+    const float rhoRuR = rhoR * uR;
+    const float v2R = vR[0] * vR[0] + vR[1] * vR[1] + vR[2] * vR[2];
+    const float eR = PR * rhoRinv * hydro_one_over_gamma_minus_one + 0.5f * v2R;
+    const float SR = SRmuR + uR;
+    const float SRmSstar = SR - Sstar;
+    const float starfacR =
+        (SR > 0.0f) ? SRmuR / (SRmSstar != 0.f ? SRmSstar : 1.f) - 1.0f : 0.f;
+    const float rhoRSR = rhoR * SR;
+    const float rhoRSRstarfac = rhoRSR * starfacR;
+    const float rhoRSRSstarmuR = (SR > 0.0f) ? rhoRSR * (Sstar - uR) : 0.f;
+    const float fluxR[5] = {
+        rhoRuR + rhoRSRstarfac,
+        rhoRuR * vR[0] + PR * n[0] + rhoRSRstarfac * vR[0] +
+            rhoRSRSstarmuR * n[0],
+        rhoRuR * vR[1] + PR * n[1] + rhoRSRstarfac * vR[1] +
+            rhoRSRSstarmuR * n[1],
+        rhoRuR * vR[2] + PR * n[2] + rhoRSRstarfac * vR[2] +
+            rhoRSRSstarmuR * n[2],
+        rhoRuR * eR + PR * uR + rhoRSRstarfac * eR +
+            rhoRSRSstarmuR * (Sstar + PR / (rhoR * SRmuR))};
+
+    float totflux[5];
+    for (int k = 0; k < 5; k++)
+      totflux[k] = (Sstar >= 0.0f) ? fluxL[k] : fluxR[k];
+
+    /* deboost to lab frame, energy flux first */
+    const float v2 = vij[0] * vij[0] + vij[1] * vij[1] + vij[2] * vij[2];
+    b->totflux[4][i] = totflux[4] + vij[0] * totflux[1] +
+                       vij[1] * totflux[2] + vij[2] * totflux[3] +
+                       0.5f * v2 * totflux[0];
+    b->totflux[0][i] = totflux[0];
+    b->totflux[1][i] = totflux[1] + vij[0] * totflux[0];
+    b->totflux[2][i] = totflux[2] + vij[1] * totflux[0];
+    b->totflux[3][i] = totflux[3] + vij[2] * totflux[0];
+  }
+
+  /* Now the special cases. */
+  int special[RIEMANN_BATCH_SIZE];
+  const int nr_special = riemann_batch_get_special(b, special);
+  for (int j = 0; j < nr_special; j++) {
+    float WL[5], WR[5], n_unit[3], vij[3], totflux[5];
+    riemann_batch_get_problem(b, special[j], WL, WR, n_unit, vij);
+    riemann_solve_for_flux(WL, WR, n_unit, vij, totflux);
+    riemann_batch_set_flux(b, special[j], totflux);
+  }
+
+#ifdef SWIFT_DEBUG_CHECKS
+  riemann_batch_check_output(b);
+#endif
+}
+
+/**
+ * @brief Solve a #riemann_batch of Riemann problems for the middle state
+ * flux, several interfaces at a time.
+ *
+ * Problems involving vacuum or a vanishing pressure are solved one at a time
+ * with riemann_solve_for_middle_state_flux().
+ *
+ * @param b The #riemann_batch.
+ */
+__attribute__((always_inline)) INLINE static void
+riemann_solve_batch_for_middle_state_flux(struct riemann_batch *restrict b) {
+
+  const int count = b->count;
+
+#pragma omp simd
+  for (int i = 0; i < count; i++) {
+
+    /* Shift the states of the problems that need special treatment away from
+     * 0, to keep the computation below finite. This is done with an addition
+     * rather than a select, so that the compiler cannot move the divisions
+     * into the branches of the select. */
+    const int regular = b->WL[0][i] > 0.f && b->WR[0][i] > 0.f &&
+                        b->WL[4][i] > 0.f && b->WR[4][i] > 0.f;
+    const float shift = regular ? 0.f : 1.f;
+    const float rhoL = max(b->WL[0][i], 0.f) + shift;
+    const float rhoR = max(b->WR[0][i], 0.f) + shift;
+    const float PL = max(b->WL[4][i], 0.f) + shift;
+    const float PR = max(b->WR[4][i], 0.f) + shift;
+    const float n[3] = {b->n_unit[0][i], b->n_unit[1][i], b->n_unit[2][i]};
+
+    /* STEP 0: obtain velocity in interface frame */
+    const float uL =
+        b->WL[1][i] * n[0] + b->WL[2][i] * n[1] + b->WL[3][i] * n[2];
+    const float uR =
+        b->WR[1][i] * n[0] + b->WR[2][i] * n[1] + b->WR[3][i] * n[2];
+    const float aL = sqrtf(hydro_gamma * PL / rhoL);
+    const float aR = sqrtf(hydro_gamma * PR / rhoR);
+
+    /* Vacuum generation, see riemann_is_vacuum() */
+    b->special[i] = !regular || hydro_two_over_gamma_minus_one * aL +
+                                        hydro_two_over_gamma_minus_one * aR <=
+                                    uR - uL;
+
+    /* STEP 1: pressure estimate */
+    const float rhobar = rhoL + rhoR;
+    const float abar = aL + aR;
+    const float pPVRS = 0.5f * ((PL + PR) - 0.25f * (uR - uL) * rhobar * abar);
+    const float pstar = max(0.f, pPVRS);
+
+    /* STEP 2: wave speed estimates */
+    const float qL =
+        sqrtf(1.0f + 0.5f * hydro_gamma_plus_one * hydro_one_over_gamma *
+                         (max(pstar / PL, 1.0f) - 1.0f));
+    const float qR =
+        sqrtf(1.0f + 0.5f * hydro_gamma_plus_one * hydro_one_over_gamma *
+                         (max(pstar / PR, 1.0f) - 1.0f));
+    const float SLmuL = -aL * qL;
+    const float SRmuR = aR * qR;
+    const float Sstar = (PR - PL + rhoL * uL * SLmuL - rhoR * uR * SRmuR) /
+                        (rhoL * SLmuL - rhoR * SRmuR);
+
+    const float vface = b->vij[0][i] * n[0] + b->vij[1][i] * n[1] +
+                        b->vij[2][i] * n[2];
+    b->totflux[0][i] = 0.0f;
+    b->totflux[1][i] = pstar * n[0];
+    b->totflux[2][i] = pstar * n[1];
+    b->totflux[3][i] = pstar * n[2];
+    b->totflux[4][i] = pstar * (Sstar + vface);
+  }
+
+  /* Now the special cases. */
+  int special[RIEMANN_BATCH_SIZE];
+  const int nr_special = riemann_batch_get_special(b, special);
+  for (int j = 0; j < nr_special; j++) {
+    float WL[5], WR[5], n_unit[3], vij[3], totflux[5];
+    riemann_batch_get_problem(b, special[j], WL, WR, n_unit, vij);
+    riemann_solve_for_middle_state_flux(WL, WR, n_unit, vij, totflux);
+    riemann_batch_set_flux(b, special[j], totflux);
+  }
+
+#ifdef SWIFT_DEBUG_CHECKS
+  riemann_batch_check_output(b);
+#endif
+}
+
 #endif /* SWIFT_RIEMANN_HLLC_H */
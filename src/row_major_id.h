@@ -176,6 +176,33 @@ get_xcoord_from_padded_row_major_id(const size_t id, const int N) {
   return (int)(id / (Nj * Nk));
 }
 
+/**
+ * @brief Return j coordinate from an id returned by
+ * row_major_id_periodic_size_t_padded
+ *
+ * @param id The padded row major ID.
+ * @param N Size of the array along one axis.
+ */
+__attribute__((always_inline, const)) INLINE static int
+get_ycoord_from_padded_row_major_id(const size_t id, const int N) {
+  const size_t Nj = N;
+  const size_t Nk = 2 * (N / 2 + 1);
+  return (int)((id / Nk) % Nj);
+}
+
+/**
+ * @brief Return k coordinate from an id returned by
+ * row_major_id_periodic_size_t_padded
+ *
+ * @param id The padded row major ID.
+ * @param N Size of the array along one axis.
+ */
+__attribute__((always_inline, const)) INLINE static int
+get_zcoord_from_padded_row_major_id(const size_t id, const int N) {
+  const size_t Nk = 2 * (N / 2 + 1);
+  return (int)(id % Nk);
+}
+
 /**
  * @brief Convert a global mesh array index to local slice index
  *
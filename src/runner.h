@@ -29,9 +29,11 @@
 /* Local headers. */
 #include "cache.h"
 #include "gravity_cache.h"
+#include "limiter_cache.h"
 
 struct cell;
 struct engine;
+struct sort_key;
 struct task;
 
 /* Unique identifier of loop types */
@@ -75,6 +77,20 @@ struct runner {
   /*! Time this runner was active during the last engine_launch. */
   ticks active_time;
 
+  /*! Number of tasks whose cell was last touched by this runner's queue, and
+   * number of tasks whose cell had been touched at all, during the last
+   * engine_launch. */
+  int cell_affinity_hits, cell_affinity_count;
+
+  /*! Number of fused hydro tasks run during the last engine_launch, number
+   * of tasks they replaced and time spent in them, and the same for the
+   * unfused hydro loop tasks. */
+  int hydro_fused_count, hydro_fused_replaced, hydro_loop_count;
+  ticks hydro_fused_ticks, hydro_loop_ticks;
+
+  /*! Time this runner spent waiting for tasks since the last rebuild. */
+  ticks idle_time;
+
 #ifdef WITH_VECTORIZATION
 
   /*! The particle cache of cell ci. */
@@ -82,6 +98,12 @@ struct runner {
 
   /*! The particle cache of cell cj. */
   struct cache cj_cache;
+
+  /*! The time-step limiter cache of cell ci. */
+  struct limiter_cache ci_limiter_cache;
+
+  /*! The time-step limiter cache of cell cj. */
+  struct limiter_cache cj_limiter_cache;
 #endif
 
 #ifdef SWIFT_DEBUG_CHECKS
@@ -99,6 +121,11 @@ void runner_do_black_holes_density_ghost(struct runner *r, struct cell *c,
 void runner_do_black_holes_swallow_ghost(struct runner *r, struct cell *c,
                                          int timer);
 void runner_do_init_grav(struct runner *r, struct cell *c, int timer);
+void runner_do_sort_ascending(struct sort_key *sort, int N);
+void runner_do_sort_radix(struct sort_key *restrict sort,
+                          struct sort_key *restrict buff, const int N);
+int runner_do_sort_repair(struct sort_key *sort, const int N,
+                          const int max_moves);
 void runner_do_hydro_sort(struct runner *r, struct cell *c, int flag,
                           int cleanup, int rt_requests_sort, int clock);
 void runner_do_stars_sort(struct runner *r, struct cell *c, int flag,
@@ -739,10 +739,10 @@ void DOPAIR_SUBSET(struct runner *r, struct cell *restrict ci,
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
 
       /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
+        struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -804,10 +804,11 @@ void DOPAIR_SUBSET(struct runner *r, struct cell *restrict ci,
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
 
       /* Loop over the parts in cj. */
-      for (int pjd = count_j - 1; pjd >= 0 && di < sort_j[pjd].d; pjd--) {
+      for (int pjd = count_j - 1; pjd >= 0 && di < sort_get_d(sort_j, pjd);
+           pjd--) {
 
         /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
+        struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -910,7 +911,7 @@ void DOPAIR_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
   if (force_naive || !is_sorted) {
     DOPAIR_SUBSET_NAIVE(r, ci, parts_i, ind, count, cj, shift);
   } else {
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#if defined(WITH_VECTORIZED_HYDRO)
     if (sort_is_face(sid))
       runner_dopair_subset_density_vec(r, ci, parts_i, ind, count, cj, sid,
                                        flipped, shift);
@@ -1034,13 +1035,93 @@ void DOSELF_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
                           struct part *restrict parts, int *restrict ind,
                           int count) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#if defined(WITH_VECTORIZED_HYDRO)
   runner_doself_subset_density_vec(r, ci, parts, ind, count);
 #else
   DOSELF_SUBSET(r, ci, parts, ind, count);
 #endif
 }
 
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+/**
+ * @brief Compute the interactions of the given particles with their
+ * candidate neighbours.
+ *
+ * The particles whose smoothing length outgrew their candidates are not
+ * interacted but returned, to go through the neighbouring cells instead.
+ *
+ * @param r The #runner.
+ * @param parts The #part of the cell.
+ * @param ind The list of indices of particles to interact.
+ * @param count The number of particles in @c ind.
+ * @param l The #ghost_ngb_list of the cell.
+ * @param ind_left (return) The indices of the particles that were not
+ * interacted.
+ *
+ * @return The number of particles in @c ind_left.
+ */
+int DOSUBSET_LIST(struct runner *r, struct part *restrict parts,
+                  const int *restrict ind, int count,
+                  const struct ghost_ngb_list *l, int *restrict ind_left) {
+
+  const struct engine *e = r->e;
+  const struct cosmology *cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Cosmological terms and physical constants */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+  GET_MU0();
+
+  int count_left = 0;
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a hold of the ith part. */
+    struct part *pi = &parts[ind[pid]];
+    const float hi = pi->h;
+    const float hig2 = hi * hi * kernel_gamma2;
+
+    /* Are the candidates still enough? */
+    if (hi > l->h_max[ind[pid]]) {
+      ind_left[count_left++] = ind[pid];
+      continue;
+    }
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (!part_is_active(pi, e)) error("Inactive particle in subset function!");
+#endif
+
+    /* Loop over the candidates. */
+    const int first = l->first[ind[pid]];
+    const int last = first + l->num[ind[pid]];
+    for (int k = first; k < last; k++) {
+
+      struct part *restrict pj = l->parts[k];
+      const float hj = pj->h;
+      float dx[3] = {l->dx[3 * k + 0], l->dx[3 * k + 1], l->dx[3 * k + 2]};
+      const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+
+      /* Hit or miss? */
+      if (r2 < hig2) {
+
+        IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+        IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
+        runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_pressure_floor(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_star_formation(r2, dx, hi, hj, pi, pj, a, H);
+        runner_iact_nonsym_sink(r2, dx, hi, hj, pi, pj, a, H,
+                                e->sink_properties);
+      }
+    } /* loop over the candidates. */
+  }   /* loop over the parts. */
+
+  TIMER_TOC(timer_doself_subset);
+
+  return count_left;
+}
+#endif /* FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY */
+
 /**
  * @brief Compute the interactions between a cell pair (non-symmetric).
  *
@@ -1092,8 +1173,8 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   const int count_j = cj->hydro.count;
   struct part *restrict parts_i = ci->hydro.parts;
   struct part *restrict parts_j = cj->hydro.parts;
-  const double di_max = sort_i[count_i - 1].d - rshift;
-  const double dj_min = sort_j[0].d;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
   const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
 
   /* Cosmological terms and physical constants */
@@ -1105,17 +1186,19 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
     /* Loop over the parts in ci. */
     for (int pid = count_i - 1;
-         pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct part *restrict pi = &parts_i[sort_i[pid].i];
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
       const float hi = pi->h;
 
       /* Skip inactive particles */
       if (!PART_IS_ACTIVE(pi, e)) continue;
 
       /* Is there anything we need to interact with ? */
-      const double di = sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
+      const double di =
+          sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
       if (di < dj_min) continue;
 
       /* Get some additional information about pi */
@@ -1125,10 +1208,10 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
       const float piz = pi->x[2] - (cj->loc[2] + shift[2]);
 
       /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+        struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -1203,18 +1286,20 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   if (CELL_IS_ACTIVE(cj, e)) {
 
     /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
          pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct part *pj = &parts_j[sort_j[pjd].i];
+      struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
       const float hj = pj->h;
 
       /* Skip inactive particles */
       if (!PART_IS_ACTIVE(pj, e)) continue;
 
       /* Is there anything we need to interact with ? */
-      const double dj = sort_j[pjd].d - hj * kernel_gamma - dx_max + rshift;
+      const double dj =
+          sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max + rshift;
       if (dj - rshift > di_max) continue;
 
       /* Get some additional information about pj */
@@ -1224,10 +1309,11 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
       const float pjz = pj->x[2] - cj->loc[2];
 
       /* Loop over the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d > dj; pid--) {
+      for (int pid = count_i - 1; pid >= 0 && sort_get_d(sort_i, pid) > dj;
+           pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+        struct part *pi = &parts_i[sort_get_i(sort_i, pid)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pi, e)) continue;
@@ -1345,51 +1431,57 @@ void DOPAIR1_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
   /* Check that the dx_max_sort values in the cell are indeed an upper
      bound on particle movement. */
   for (int pid = 0; pid < ci->hydro.count; pid++) {
-    const struct part *p = &ci->hydro.parts[sort_i[pid].i];
+    const struct part *p = &ci->hydro.parts[sort_get_i(sort_i, pid)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if (fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+    if (fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             1.0e-4 * max(fabsf(d), ci->hydro.dx_max_sort_old) &&
-        fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+        fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             ci->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell ci. ci->nodeID=%d "
           "cj->nodeID=%d d=%e sort_i[pid].d=%e ci->hydro.dx_max_sort=%e "
           "ci->hydro.dx_max_sort_old=%e",
-          ci->nodeID, cj->nodeID, d, sort_i[pid].d, ci->hydro.dx_max_sort,
-          ci->hydro.dx_max_sort_old);
+          ci->nodeID, cj->nodeID, d, sort_get_d(sort_i, pid),
+          ci->hydro.dx_max_sort, ci->hydro.dx_max_sort_old);
   }
   for (int pjd = 0; pjd < cj->hydro.count; pjd++) {
-    const struct part *p = &cj->hydro.parts[sort_j[pjd].i];
+    const struct part *p = &cj->hydro.parts[sort_get_i(sort_j, pjd)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if ((fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort) >
+    if ((fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort) >
             1.0e-4 * max(fabsf(d), cj->hydro.dx_max_sort_old) &&
-        (fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort) >
+        (fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort) >
             cj->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell cj. cj->nodeID=%d "
           "ci->nodeID=%d d=%e sort_j[pjd].d=%e cj->hydro.dx_max_sort=%e "
           "cj->hydro.dx_max_sort_old=%e",
-          cj->nodeID, ci->nodeID, d, sort_j[pjd].d, cj->hydro.dx_max_sort,
-          cj->hydro.dx_max_sort_old);
+          cj->nodeID, ci->nodeID, d, sort_get_d(sort_j, pjd),
+          cj->hydro.dx_max_sort, cj->hydro.dx_max_sort_old);
   }
 #endif /* SWIFT_DEBUG_CHECKS */
 
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOPAIR1_NAIVE(r, ci, cj);
-#elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
+#elif defined(WITH_VECTORIZED_HYDRO) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
   if (!sort_is_corner(sid))
     runner_dopair1_density_vec(r, ci, cj, sid, shift);
   else
     DOPAIR1(r, ci, cj, sid, shift);
+#elif defined(WITH_VECTORIZED_HYDRO) && defined(SPHENIX_SPH) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT)
+  if (!sort_is_corner(sid))
+    runner_dopair1_gradient_vec(r, ci, cj, sid, shift);
+  else
+    DOPAIR1(r, ci, cj, sid, shift);
 #else
   DOPAIR1(r, ci, cj, sid, shift);
 #endif
@@ -1451,13 +1543,14 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   const float a = cosmo->a;
   const float H = cosmo->H;
   GET_MU0();
+  DECLARE_FLUX_BATCH();
 
   /* Maximal displacement since last rebuild */
   const double dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
 
   /* Position on the axis of the particles closest to the interface */
-  const double di_max = sort_i[count_i - 1].d;
-  const double dj_min = sort_j[0].d;
+  const double di_max = sort_get_d(sort_i, count_i - 1);
+  const double dj_min = sort_get_d(sort_j, 0);
 
   /* Shifts to apply to the particles to be in a good frame */
   const double shift_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
@@ -1474,13 +1567,19 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     sort_active_i = sort_i;
     count_active_i = count_i;
   } else if (CELL_IS_ACTIVE(ci, e)) {
-    if (posix_memalign((void **)&sort_active_i, SWIFT_CACHE_ALIGNMENT,
-                       sizeof(struct sort_entry) * count_i) != 0)
+    if (posix_memalign(
+            (void **)&sort_active_i, SWIFT_CACHE_ALIGNMENT,
+            sizeof(struct sort_entry) * (count_i + sort_header_size)) != 0)
       error("Failed to allocate active sortlists.");
 
+    /* Copy the header of the list, if any. */
+    memcpy(sort_active_i, sort_i - sort_header_size,
+           sizeof(struct sort_entry) * sort_header_size);
+    sort_active_i += sort_header_size;
+
     /* Collect the active particles in ci */
     for (int k = 0; k < count_i; k++) {
-      if (PART_IS_ACTIVE(&parts_i[sort_i[k].i], e)) {
+      if (PART_IS_ACTIVE(&parts_i[sort_get_i(sort_i, k)], e)) {
         sort_active_i[count_active_i] = sort_i[k];
         count_active_i++;
       }
@@ -1493,13 +1592,19 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     sort_active_j = sort_j;
     count_active_j = count_j;
   } else if (CELL_IS_ACTIVE(cj, e)) {
-    if (posix_memalign((void **)&sort_active_j, SWIFT_CACHE_ALIGNMENT,
-                       sizeof(struct sort_entry) * count_j) != 0)
+    if (posix_memalign(
+            (void **)&sort_active_j, SWIFT_CACHE_ALIGNMENT,
+            sizeof(struct sort_entry) * (count_j + sort_header_size)) != 0)
       error("Failed to allocate active sortlists.");
 
+    /* Copy the header of the list, if any. */
+    memcpy(sort_active_j, sort_j - sort_header_size,
+           sizeof(struct sort_entry) * sort_header_size);
+    sort_active_j += sort_header_size;
+
     /* Collect the active particles in cj */
     for (int k = 0; k < count_j; k++) {
-      if (PART_IS_ACTIVE(&parts_j[sort_j[k].i], e)) {
+      if (PART_IS_ACTIVE(&parts_j[sort_get_i(sort_j, k)], e)) {
         sort_active_j[count_active_j] = sort_j[k];
         count_active_j++;
       }
@@ -1509,12 +1614,13 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   /* Loop over *all* the parts in ci starting from the centre until
      we are out of range of anything in cj (using the maximal hi). */
   for (int pid = count_i - 1;
-       pid >= 0 &&
-       sort_i[pid].d + hi_max * kernel_gamma + dx_max - rshift > dj_min;
+       pid >= 0 && sort_get_d(sort_i, pid) + hi_max * kernel_gamma + dx_max -
+                            rshift >
+                        dj_min;
        pid--) {
 
     /* Get a hold of the ith part in ci. */
-    struct part *pi = &parts_i[sort_i[pid].i];
+    struct part *pi = &parts_i[sort_get_i(sort_i, pid)];
 
     /* Skip inhibited particles. */
     if (part_is_inhibited(pi, e)) continue;
@@ -1522,7 +1628,8 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     const float hi = pi->h;
 
     /* Is there anything we need to interact with (for this specific hi) ? */
-    const double di = sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
+    const double di =
+        sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
     if (di < dj_min) continue;
 
     /* Get some additional information about pi */
@@ -1536,11 +1643,12 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     if (!PART_IS_ACTIVE(pi, e)) {
 
       /* Loop over the *active* parts in cj within range of pi */
-      for (int pjd = 0; pjd < count_active_j && sort_active_j[pjd].d < di;
+      for (int pjd = 0;
+           pjd < count_active_j && sort_get_d(sort_active_j, pjd) < di;
            pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_active_j[pjd].i];
+        struct part *pj = &parts_j[sort_get_i(sort_active_j, pjd)];
 
         /* Skip inhibited particles.
          * Note we are looping over active particles but in the case where
@@ -1600,7 +1708,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss?
            (note that we will do the other condition in the reverse loop) */
         if (r2 < hig2) {
-          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+          IACT_NONSYM_BATCH(r2, dx, hj, hi, pj, pi, a, H);
           IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
           runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
@@ -1621,10 +1729,10 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     else { /* pi is active, we may need to update pi and pj */
 
       /* Loop over *all* the parts in cj in range of pi. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+        struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -1682,7 +1790,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
           /* Does pj need to be updated too? */
           if (PART_IS_ACTIVE(pj, e)) {
-            IACT(r2, dx, hi, hj, pi, pj, a, H);
+            IACT_BATCH(r2, dx, hi, hj, pi, pj, a, H);
             IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
@@ -1695,7 +1803,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
                                   t_current, cosmo, with_cosmology);
 #endif
           } else {
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+            IACT_NONSYM_BATCH(r2, dx, hi, hj, pi, pj, a, H);
             IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
@@ -1719,12 +1827,13 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   /* Loop over *all* the parts in cj starting from the centre until
      we are out of range of anything in ci (using the maximal hj). */
   for (int pjd = 0;
-       pjd < count_j &&
-       sort_j[pjd].d - hj_max * kernel_gamma - dx_max < di_max - rshift;
+       pjd < count_j && sort_get_d(sort_j, pjd) - hj_max * kernel_gamma -
+                            dx_max <
+                        di_max - rshift;
        pjd++) {
 
     /* Get a hold of the jth part in cj. */
-    struct part *pj = &parts_j[sort_j[pjd].i];
+    struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
 
     /* Skip inhibited particles. */
     if (part_is_inhibited(pj, e)) continue;
@@ -1732,7 +1841,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     const float hj = pj->h;
 
     /* Is there anything we need to interact with (for this specific hj) ? */
-    const double dj = sort_j[pjd].d - hj * kernel_gamma - dx_max;
+    const double dj = sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max;
     if (dj > di_max - rshift) continue;
 
     /* Get some additional information about pj */
@@ -1747,10 +1856,10 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
       /* Loop over the *active* parts in ci. */
       for (int pid = count_active_i - 1;
-           pid >= 0 && sort_active_i[pid].d - rshift > dj; pid--) {
+           pid >= 0 && sort_get_d(sort_active_i, pid) - rshift > dj; pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_active_i[pid].i];
+        struct part *pi = &parts_i[sort_get_i(sort_active_i, pid)];
 
         /* Skip inhibited particles.
          * Note we are looping over active particles but in the case where
@@ -1810,7 +1919,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
         /* Hit or miss?
            (note that we must avoid the r2 < hig2 cases we already processed) */
         if (r2 < hjg2 && r2 >= hig2) {
-          IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+          IACT_NONSYM_BATCH(r2, dx, hi, hj, pi, pj, a, H);
           IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
           runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
@@ -1831,11 +1940,11 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
     else { /* pj is active, we may need to update pj and pi */
 
       /* Loop over *all* the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d - rshift > dj;
-           pid--) {
+      for (int pid = count_i - 1;
+           pid >= 0 && sort_get_d(sort_i, pid) - rshift > dj; pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+        struct part *pi = &parts_i[sort_get_i(sort_i, pid)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pi, e)) continue;
@@ -1894,7 +2003,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
           /* Does pi need to be updated too? */
           if (PART_IS_ACTIVE(pi, e)) {
-            IACT(r2, dx, hj, hi, pj, pi, a, H);
+            IACT_BATCH(r2, dx, hj, hi, pj, pi, a, H);
             IACT_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_chemistry(r2, dx, hj, hi, pj, pi, a, H);
@@ -1907,7 +2016,7 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
                                   t_current, cosmo, with_cosmology);
 #endif
           } else {
-            IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+            IACT_NONSYM_BATCH(r2, dx, hj, hi, pj, pi, a, H);
             IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
@@ -1930,9 +2039,11 @@ void DOPAIR2(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
   /* Clean-up if necessary */  // MATTHIEU: temporary disable this optimization
   if (CELL_IS_ACTIVE(ci, e))   // && !cell_is_all_active_hydro(ci, e))
-    free(sort_active_i);
+    free(sort_active_i - sort_header_size);
   if (CELL_IS_ACTIVE(cj, e))  // && !cell_is_all_active_hydro(cj, e))
-    free(sort_active_j);
+    free(sort_active_j - sort_header_size);
+
+  FLUSH_FLUX_BATCH();
 
   TIMER_TOC(TIMER_DOPAIR);
 }
@@ -1980,46 +2091,46 @@ void DOPAIR2_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
   /* Check that the dx_max_sort values in the cell are indeed an upper
      bound on particle movement. */
   for (int pid = 0; pid < ci->hydro.count; pid++) {
-    const struct part *p = &ci->hydro.parts[sort_i[pid].i];
+    const struct part *p = &ci->hydro.parts[sort_get_i(sort_i, pid)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if (fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+    if (fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             1.0e-4 * max(fabsf(d), ci->hydro.dx_max_sort_old) &&
-        fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+        fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             ci->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell ci. ci->nodeID=%d "
           "cj->nodeID=%d d=%e sort_i[pid].d=%e ci->hydro.dx_max_sort=%e "
           "ci->hydro.dx_max_sort_old=%e",
-          ci->nodeID, cj->nodeID, d, sort_i[pid].d, ci->hydro.dx_max_sort,
-          ci->hydro.dx_max_sort_old);
+          ci->nodeID, cj->nodeID, d, sort_get_d(sort_i, pid),
+          ci->hydro.dx_max_sort, ci->hydro.dx_max_sort_old);
   }
   for (int pjd = 0; pjd < cj->hydro.count; pjd++) {
-    const struct part *p = &cj->hydro.parts[sort_j[pjd].i];
+    const struct part *p = &cj->hydro.parts[sort_get_i(sort_j, pjd)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if (fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort >
+    if (fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort >
             1.0e-4 * max(fabsf(d), cj->hydro.dx_max_sort_old) &&
-        fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort >
+        fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort >
             cj->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell cj. cj->nodeID=%d "
           "ci->nodeID=%d d=%e sort_j[pjd].d=%e cj->hydro.dx_max_sort=%e "
           "cj->hydro.dx_max_sort_old=%e",
-          cj->nodeID, ci->nodeID, d, sort_j[pjd].d, cj->hydro.dx_max_sort,
-          cj->hydro.dx_max_sort_old);
+          cj->nodeID, ci->nodeID, d, sort_get_d(sort_j, pjd),
+          cj->hydro.dx_max_sort, cj->hydro.dx_max_sort_old);
   }
 #endif /* SWIFT_DEBUG_CHECKS */
 
 #ifdef SWIFT_USE_NAIVE_INTERACTIONS
   DOPAIR2_NAIVE(r, ci, cj);
-#elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
+#elif defined(WITH_VECTORIZED_HYDRO) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
   if (!sort_is_corner(sid))
     runner_dopair2_force_vec(r, ci, cj, sid, shift);
@@ -2260,9 +2371,12 @@ void DOSELF1_BRANCH(struct runner *r, struct cell *c) {
 
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOSELF1_NAIVE(r, c);
-#elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
+#elif defined(WITH_VECTORIZED_HYDRO) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
   runner_doself1_density_vec(r, c);
+#elif defined(WITH_VECTORIZED_HYDRO) && defined(SPHENIX_SPH) && \
+    (FUNCTION_TASK_LOOP == TASK_LOOP_GRADIENT)
+  runner_doself1_gradient_vec(r, c);
 #else
   DOSELF1(r, c);
 #endif
@@ -2305,6 +2419,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
   const float a = cosmo->a;
   const float H = cosmo->H;
   GET_MU0();
+  DECLARE_FLUX_BATCH();
 
   /* Loop over the particles in the cell. */
   for (int pid = 0; pid < count; pid++) {
@@ -2350,7 +2465,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
         /* Hit or miss? */
         if (r2 < hig2 || r2 < hj * hj * kernel_gamma2) {
 
-          IACT_NONSYM(r2, dx, hj, hi, pj, pi, a, H);
+          IACT_NONSYM_BATCH(r2, dx, hj, hi, pj, pi, a, H);
           IACT_NONSYM_MHD(r2, dx, hj, hi, pj, pi, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
           runner_iact_nonsym_chemistry(r2, dx, hj, hi, pj, pi, a, H);
@@ -2406,7 +2521,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
 
           /* Does pj need to be updated too? */
           if (PART_IS_ACTIVE(pj, e)) {
-            IACT(r2, dx, hi, hj, pi, pj, a, H);
+            IACT_BATCH(r2, dx, hi, hj, pi, pj, a, H);
             IACT_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_chemistry(r2, dx, hi, hj, pi, pj, a, H);
@@ -2419,7 +2534,7 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
                                   t_current, cosmo, with_cosmology);
 #endif
           } else {
-            IACT_NONSYM(r2, dx, hi, hj, pi, pj, a, H);
+            IACT_NONSYM_BATCH(r2, dx, hi, hj, pi, pj, a, H);
             IACT_NONSYM_MHD(r2, dx, hi, hj, pi, pj, mu_0, a, H);
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
             runner_iact_nonsym_chemistry(r2, dx, hi, hj, pi, pj, a, H);
@@ -2442,6 +2557,8 @@ void DOSELF2(struct runner *r, struct cell *restrict c) {
 
   free(indt);
 
+  FLUSH_FLUX_BATCH();
+
   TIMER_TOC(TIMER_DOSELF);
 }
 
@@ -2472,7 +2589,7 @@ void DOSELF2_BRANCH(struct runner *r, struct cell *c) {
 
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOSELF2_NAIVE(r, c);
-#elif defined(WITH_VECTORIZATION) && defined(GADGET2_SPH) && \
+#elif defined(WITH_VECTORIZED_HYDRO) && \
     (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE)
   runner_doself2_force_vec(r, c);
 #else
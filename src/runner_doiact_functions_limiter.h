@@ -266,8 +266,8 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   const int count_j = cj->hydro.count;
   struct part *restrict parts_i = ci->hydro.parts;
   struct part *restrict parts_j = cj->hydro.parts;
-  const double di_max = sort_i[count_i - 1].d - rshift;
-  const double dj_min = sort_j[0].d;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
   const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
 
   /* Cosmological terms */
@@ -278,17 +278,19 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
 
     /* Loop over the parts in ci. */
     for (int pid = count_i - 1;
-         pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct part *restrict pi = &parts_i[sort_i[pid].i];
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
       const float hi = pi->h;
 
       /* Skip inactive particles */
       if (!part_is_starting(pi, e)) continue;
 
       /* Is there anything we need to interact with ? */
-      const double di = sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
+      const double di =
+          sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
       if (di < dj_min) continue;
 
       /* Get some additional information about pi */
@@ -298,10 +300,10 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
       const float piz = pi->x[2] - (cj->loc[2] + shift[2]);
 
       /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+        struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -361,18 +363,20 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
   if (cell_is_starting_hydro(cj, e)) {
 
     /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
          pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct part *pj = &parts_j[sort_j[pjd].i];
+      struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
       const float hj = pj->h;
 
       /* Skip inactive particles */
       if (!part_is_starting(pj, e)) continue;
 
       /* Is there anything we need to interact with ? */
-      const double dj = sort_j[pjd].d - hj * kernel_gamma - dx_max + rshift;
+      const double dj =
+          sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max + rshift;
       if (dj - rshift > di_max) continue;
 
       /* Get some additional information about pj */
@@ -382,10 +386,11 @@ void DOPAIR1(struct runner *r, struct cell *ci, struct cell *cj, const int sid,
       const float pjz = pj->x[2] - cj->loc[2];
 
       /* Loop over the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d > dj; pid--) {
+      for (int pid = count_i - 1; pid >= 0 && sort_get_d(sort_i, pid) > dj;
+           pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+        struct part *pi = &parts_i[sort_get_i(sort_i, pid)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pi, e)) continue;
@@ -488,45 +493,47 @@ void DOPAIR1_BRANCH(struct runner *r, struct cell *ci, struct cell *cj) {
   /* Check that the dx_max_sort values in the cell are indeed an upper
      bound on particle movement. */
   for (int pid = 0; pid < ci->hydro.count; pid++) {
-    const struct part *p = &ci->hydro.parts[sort_i[pid].i];
+    const struct part *p = &ci->hydro.parts[sort_get_i(sort_i, pid)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if (fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+    if (fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             1.0e-4 * max(fabsf(d), ci->hydro.dx_max_sort_old) &&
-        fabsf(d - sort_i[pid].d) - ci->hydro.dx_max_sort >
+        fabsf(d - sort_get_d(sort_i, pid)) - ci->hydro.dx_max_sort >
             ci->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell ci. ci->nodeID=%d "
           "cj->nodeID=%d d=%e sort_i[pid].d=%e ci->hydro.dx_max_sort=%e "
           "ci->hydro.dx_max_sort_old=%e",
-          ci->nodeID, cj->nodeID, d, sort_i[pid].d, ci->hydro.dx_max_sort,
-          ci->hydro.dx_max_sort_old);
+          ci->nodeID, cj->nodeID, d, sort_get_d(sort_i, pid),
+          ci->hydro.dx_max_sort, ci->hydro.dx_max_sort_old);
   }
   for (int pjd = 0; pjd < cj->hydro.count; pjd++) {
-    const struct part *p = &cj->hydro.parts[sort_j[pjd].i];
+    const struct part *p = &cj->hydro.parts[sort_get_i(sort_j, pjd)];
     if (part_is_inhibited(p, e)) continue;
 
     const float d = p->x[0] * runner_shift[sid][0] +
                     p->x[1] * runner_shift[sid][1] +
                     p->x[2] * runner_shift[sid][2];
-    if ((fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort) >
+    if ((fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort) >
             1.0e-4 * max(fabsf(d), cj->hydro.dx_max_sort_old) &&
-        (fabsf(d - sort_j[pjd].d) - cj->hydro.dx_max_sort) >
+        (fabsf(d - sort_get_d(sort_j, pjd)) - cj->hydro.dx_max_sort) >
             cj->width[0] * 1.0e-10)
       error(
           "particle shift diff exceeds dx_max_sort in cell cj. cj->nodeID=%d "
           "ci->nodeID=%d d=%e sort_j[pjd].d=%e cj->hydro.dx_max_sort=%e "
           "cj->hydro.dx_max_sort_old=%e",
-          cj->nodeID, ci->nodeID, d, sort_j[pjd].d, cj->hydro.dx_max_sort,
-          cj->hydro.dx_max_sort_old);
+          cj->nodeID, ci->nodeID, d, sort_get_d(sort_j, pjd),
+          cj->hydro.dx_max_sort, cj->hydro.dx_max_sort_old);
   }
 #endif /* SWIFT_DEBUG_CHECKS */
 
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOPAIR1_NAIVE(r, ci, cj);
+#elif defined(WITH_VECTORIZED_LIMITER)
+  runner_dopair1_limiter_vec(r, ci, cj, sid, shift);
 #else
   DOPAIR1(r, ci, cj, sid, shift);
 #endif
@@ -704,6 +711,8 @@ void DOSELF1_BRANCH(struct runner *r, struct cell *c) {
 
 #if defined(SWIFT_USE_NAIVE_INTERACTIONS)
   DOSELF1_NAIVE(r, c);
+#elif defined(WITH_VECTORIZED_LIMITER)
+  runner_doself1_limiter_vec(r, c);
 #else
   DOSELF1(r, c);
 #endif
@@ -352,16 +352,17 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
     struct xpart *restrict xparts_j = cj->hydro.xparts;
 #endif
-    const double dj_min = sort_j[0].d;
+    const double dj_min = sort_get_d(sort_j, 0);
     const float dx_max = (ci->stars.dx_max_sort + cj->hydro.dx_max_sort);
     const float hydro_dx_max_rshift = cj->hydro.dx_max_sort - rshift;
 
     /* Loop over the sparts in ci. */
     for (int pid = count_i - 1;
-         pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct spart *restrict spi = &sparts_i[sort_i[pid].i];
+      struct spart *restrict spi = &sparts_i[sort_get_i(sort_i, pid)];
       const float hi = spi->h;
 
       /* Skip inhibited particles */
@@ -390,12 +391,12 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
       const float piz = spi->x[2] - (cj->loc[2] + shift[2]);
 
       /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Recover pj */
-        struct part *pj = &parts_j[sort_j[pjd].i];
+        struct part *pj = &parts_j[sort_get_i(sort_j, pjd)];
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
-        struct xpart *xpj = &xparts_j[sort_j[pjd].i];
+        struct xpart *xpj = &xparts_j[sort_get_i(sort_j, pjd)];
 #endif
 
         /* Skip inhibited particles. */
@@ -505,16 +506,17 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
     struct xpart *restrict xparts_i = ci->hydro.xparts;
 #endif
-    const double di_max = sort_i[count_i - 1].d - rshift;
+    const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
     const float dx_max = (ci->hydro.dx_max_sort + cj->stars.dx_max_sort);
     const float hydro_dx_max_rshift = ci->hydro.dx_max_sort - rshift;
 
     /* Loop over the parts in cj. */
-    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
          pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct spart *spj = &sparts_j[sort_j[pjd].i];
+      struct spart *spj = &sparts_j[sort_get_i(sort_j, pjd)];
       const float hj = spj->h;
 
       /* Skip inhibited particles */
@@ -543,12 +545,13 @@ void DO_SYM_PAIR1_STARS(struct runner *r, struct cell *ci, struct cell *cj,
       const float pjz = spj->x[2] - cj->loc[2];
 
       /* Loop over the parts in ci. */
-      for (int pid = count_i - 1; pid >= 0 && sort_i[pid].d > dj; pid--) {
+      for (int pid = count_i - 1; pid >= 0 && sort_get_d(sort_i, pid) > dj;
+           pid--) {
 
         /* Recover pi */
-        struct part *pi = &parts_i[sort_i[pid].i];
+        struct part *pi = &parts_i[sort_get_i(sort_i, pid)];
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_FEEDBACK)
-        struct xpart *xpi = &xparts_i[sort_i[pid].i];
+        struct xpart *xpi = &xparts_i[sort_get_i(sort_i, pid)];
 #endif
 
         /* Skip inhibited particles. */
@@ -712,10 +715,10 @@ void DOPAIR1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
 
       /* Loop over the parts in cj. */
-      for (int pjd = 0; pjd < count_j && sort_j[pjd].d < di; pjd++) {
+      for (int pjd = 0; pjd < count_j && sort_get_d(sort_j, pjd) < di; pjd++) {
 
         /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
+        struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -775,10 +778,11 @@ void DOPAIR1_SUBSET_STARS(struct runner *r, struct cell *restrict ci,
                         piy * runner_shift[sid][1] + piz * runner_shift[sid][2];
 
       /* Loop over the parts in cj. */
-      for (int pjd = count_j - 1; pjd >= 0 && di < sort_j[pjd].d; pjd--) {
+      for (int pjd = count_j - 1; pjd >= 0 && di < sort_get_d(sort_j, pjd);
+           pjd--) {
 
         /* Get a pointer to the jth particle. */
-        struct part *restrict pj = &parts_j[sort_j[pjd].i];
+        struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
 
         /* Skip inhibited particles. */
         if (part_is_inhibited(pj, e)) continue;
@@ -1192,15 +1196,16 @@ void DOSELF1_BRANCH_STARS(struct runner *r, struct cell *c) {
         cell_get_##TYPE##_sorts(cj, sid);                                   \
                                                                             \
     for (int pjd = 0; pjd < cj->TYPE.count; pjd++) {                        \
-      const struct PART *p = &cj->TYPE.parts[sort_j[pjd].i];                \
+      const struct PART *p =                                                \
+          &cj->TYPE.parts[sort_get_i(sort_j, pjd)];                         \
       if (PART##_is_inhibited(p, e)) continue;                              \
                                                                             \
       const float d = p->x[0] * runner_shift[sid][0] +                      \
                       p->x[1] * runner_shift[sid][1] +                      \
                       p->x[2] * runner_shift[sid][2];                       \
-      if ((fabsf(d - sort_j[pjd].d) - cj->TYPE.dx_max_sort) >               \
+      if ((fabsf(d - sort_get_d(sort_j, pjd)) - cj->TYPE.dx_max_sort) >     \
               1.0e-4 * max(fabsf(d), cj->TYPE.dx_max_sort_old) &&           \
-          (fabsf(d - sort_j[pjd].d) - cj->TYPE.dx_max_sort) >               \
+          (fabsf(d - sort_get_d(sort_j, pjd)) - cj->TYPE.dx_max_sort) >     \
               cj->width[0] * 1.0e-10)                                       \
         error(                                                              \
             "particle shift diff exceeds dx_max_sort in cell cj. "          \
@@ -1210,9 +1215,9 @@ void DOSELF1_BRANCH_STARS(struct runner *r, struct cell *c) {
             "cj->" #TYPE                                                    \
             ".dx_max_sort_old=%e, cellID=%lld super->cellID=%lld"           \
             "cj->depth=%d cj->maxdepth=%d",                                 \
-            cj->nodeID, ci->nodeID, d, sort_j[pjd].d, cj->TYPE.dx_max_sort, \
-            cj->TYPE.dx_max_sort_old, cj->cellID, cj->hydro.super->cellID,  \
-            cj->depth, cj->maxdepth);                                       \
+            cj->nodeID, ci->nodeID, d, sort_get_d(sort_j, pjd),             \
+            cj->TYPE.dx_max_sort, cj->TYPE.dx_max_sort_old, cj->cellID,     \
+            cj->hydro.super->cellID, cj->depth, cj->maxdepth);              \
     }                                                                       \
   })
 
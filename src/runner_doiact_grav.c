@@ -29,6 +29,7 @@
 #include "gravity_cache.h"
 #include "gravity_iact.h"
 #include "inline.h"
+#include "multipole_batch.h"
 #include "part.h"
 #include "space_getsid.h"
 #include "timers.h"
@@ -2428,10 +2429,103 @@ void runner_doself_recursive_grav(struct runner *r, struct cell *c,
   if (gettimer) TIMER_TOC(timer_dosub_self_grav);
 }
 
+/**
+ * @brief Computes the M-M interactions of a given cell with all the
+ * multipoles of a #multipole_batch and empties it.
+ *
+ * @param r The thread #runner.
+ * @param ci The #cell of interest.
+ * @param b The #multipole_batch.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_do_grav_long_range_flush(struct runner *r, struct cell *ci,
+                                struct multipole_batch *b) {
+
+  const struct engine *e = r->e;
+
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+  lock_lock(&ci->grav.mlock);
+#endif
+
+  gravity_M2L_batch(&ci->grav.multipole->pot, b, e->mesh->periodic,
+                    e->mesh->r_s_inv);
+
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+  if (lock_unlock(&ci->grav.mlock) != 0) error("Failed to unlock multipole");
+#endif
+
+  multipole_batch_init(b);
+}
+
+/**
+ * @brief Performs the M-M interaction between a given cell and another
+ * top-level cell if they are well-separated.
+ *
+ * The multipole of the other cell is added to a #multipole_batch, whose
+ * interactions are computed once it is full.
+ *
+ * @param r The thread #runner.
+ * @param ci The #cell of interest.
+ * @param top The top-level (great-)parent of ci.
+ * @param cj The other top-level #cell.
+ * @param b The #multipole_batch.
+ */
+__attribute__((always_inline)) INLINE static void
+runner_do_grav_long_range_pair(struct runner *r, struct cell *ci,
+                               const struct cell *top, struct cell *cj,
+                               struct multipole_batch *b) {
+
+  const struct engine *e = r->e;
+
+  /* Skip empty cells */
+  if (cj->grav.multipole->m_pole.M_000 == 0.f) return;
+
+  if (cell_can_use_pair_mm(top, cj, e, e->s, /*use_rebuild_data=*/1,
+                           /*is_tree_walk=*/0)) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+    if (cj->grav.multipole->m_pole.num_gpart == 0)
+      error("Multipole does not seem to have been set.");
+
+    if (ci->grav.multipole->pot.ti_init != e->ti_current)
+      error("ci->grav tensor not initialised.");
+
+    if (cj->grav.ti_old_multipole != e->ti_current)
+      error(
+          "Undrifted multipole cj->grav.ti_old_multipole=%lld cj->nodeID=%d "
+          "ci->nodeID=%d e->ti_current=%lld",
+          cj->grav.ti_old_multipole, cj->nodeID, ci->nodeID, e->ti_current);
+#endif
+
+    if (b->count == multipole_batch_size)
+      runner_do_grav_long_range_flush(r, ci, b);
+
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+    lock_lock(&cj->grav.mlock);
+#endif
+
+    /* Queue the PM interaction with the multipole of cj */
+    multipole_batch_add(b, &cj->grav.multipole->m_pole,
+                        ci->grav.multipole->CoM, cj->grav.multipole->CoM,
+                        e->mesh->periodic, e->mesh->dim);
+
+#ifndef SWIFT_TASKS_WITHOUT_ATOMICS
+    if (lock_unlock(&cj->grav.mlock) != 0) error("Failed to unlock multipole");
+#endif
+
+    /* Record that this multipole received a contribution */
+    ci->grav.multipole->pot.interacted = 1;
+
+  } /* We are in charge of this pair */
+}
+
 /**
  * @brief Performs all M-M interactions between a given top-level cell and all
  * the other top-levels that are far enough.
  *
+ * With periodic BCs, only the top-level cells within the mesh cut-off radius
+ * are visited, using the offsets constructed when the tasks were made.
+ *
  * @param r The thread #runner.
  * @param ci The #cell of interest.
  * @param timer Are we timing this ?
@@ -2441,16 +2535,16 @@ void runner_do_grav_long_range(struct runner *r, struct cell *ci,
 
   /* Some constants */
   const struct engine *e = r->e;
+  const struct space *s = e->s;
   const int periodic = e->mesh->periodic;
-  const double dim[3] = {e->mesh->dim[0], e->mesh->dim[1], e->mesh->dim[2]};
-  const double max_distance2 = e->mesh->r_cut_max * e->mesh->r_cut_max;
+  const int cdim[3] = {s->cdim[0], s->cdim[1], s->cdim[2]};
 
   TIMER_TIC;
 
   /* Recover the list of top-level cells */
-  struct cell *cells = e->s->cells_top;
-  int *cells_with_particles = e->s->cells_with_particles_top;
-  const int nr_cells_with_particles = e->s->nr_cells_with_particles;
+  struct cell *cells = s->cells_top;
+  int *cells_with_particles = s->cells_with_particles_top;
+  const int nr_cells_with_particles = s->nr_cells_with_particles;
 
   /* Anything to do here? */
   if (!cell_is_active_gravity(ci, e)) return;
@@ -2461,36 +2555,59 @@ void runner_do_grav_long_range(struct runner *r, struct cell *ci,
   /* Check multipole has been drifted */
   if (ci->grav.ti_old_multipole < e->ti_current) cell_drift_multipole(ci, e);
 
-  /* Get this cell's multipole information */
-  struct gravity_tensors *const multi_i = ci->grav.multipole;
-
   /* Find this cell's top-level (great-)parent */
   struct cell *top = ci;
   while (top->parent != NULL) top = top->parent;
 
-  /* Loop over all the top-level cells and go for a M-M interaction if
-   * well-separated */
-  for (int n = 0; n < nr_cells_with_particles; ++n) {
+  /* The multipoles of the other cells, interacted in batches */
+  struct multipole_batch b;
+  multipole_batch_init(&b);
+
+  if (periodic) {
 
-    /* Handle on the top-level cell and it's gravity business*/
-    struct cell *cj = &cells[cells_with_particles[n]];
-    struct gravity_tensors *const multi_j = cj->grav.multipole;
+#ifdef SWIFT_DEBUG_CHECKS
+    if (s->grav_long_range_offsets == NULL)
+      error("Long-range gravity offsets not constructed!");
+#endif
 
-    /* Avoid self contributions */
-    if (top == cj) continue;
+    /* Integer indices of the top-level cell in the grid */
+    const int cid = top - cells;
+    const int i = cid / (cdim[1] * cdim[2]);
+    const int j = (cid / cdim[2]) % cdim[1];
+    const int k = cid % cdim[2];
 
-    /* Skip empty cells */
-    if (multi_j->m_pole.M_000 == 0.f) continue;
+    /* Loop over the top-level cells within the cut-off radius and go for a
+     * M-M interaction if well-separated */
+    for (int n = 0; n < s->nr_grav_long_range_offsets; ++n) {
 
-    /* Can we escape early in the periodic BC case? */
-    if (periodic) {
+      const int *offset = &s->grav_long_range_offsets[3 * n];
+      const int cjd = cell_getid(cdim, (i + offset[0] + cdim[0]) % cdim[0],
+                                 (j + offset[1] + cdim[1]) % cdim[1],
+                                 (k + offset[2] + cdim[2]) % cdim[2]);
+
+      runner_do_grav_long_range_pair(r, ci, top, &cells[cjd], &b);
+    }
+
+#if defined(SWIFT_DEBUG_CHECKS) || defined(SWIFT_GRAVITY_FORCE_CHECKS)
+
+    /* Get this cell's multipole information */
+    struct gravity_tensors *const multi_i = ci->grav.multipole;
+
+    const double dim[3] = {e->mesh->dim[0], e->mesh->dim[1], e->mesh->dim[2]};
+    const double max_distance2 = e->mesh->r_cut_max * e->mesh->r_cut_max;
 
-      /* Minimal distance between any pair of particles */
-      const double min_radius2 =
-          cell_min_dist2_same_size(top, cj, periodic, dim);
+    /* Loop over all the top-level cells to account for the ones beyond the
+     * cut-off radius */
+    for (int n = 0; n < nr_cells_with_particles; ++n) {
+
+      const struct cell *cj = &cells[cells_with_particles[n]];
+      const struct gravity_tensors *const multi_j = cj->grav.multipole;
+
+      /* Avoid self contributions and empty cells */
+      if (top == cj || multi_j->m_pole.M_000 == 0.f) continue;
 
       /* Are we beyond the distance where the truncated forces are 0 ?*/
-      if (min_radius2 > max_distance2) {
+      if (cell_min_dist2_same_size(top, cj, periodic, dim) > max_distance2) {
 
 #ifdef SWIFT_DEBUG_CHECKS
         /* Need to account for the interactions we missed */
@@ -2506,24 +2623,28 @@ void runner_do_grav_long_range(struct runner *r, struct cell *ci,
 
         /* Record that this multipole received a contribution */
         multi_i->pot.interacted = 1;
-
-        /* We are done here. */
-        continue;
       }
     }
+#endif
 
-    if (cell_can_use_pair_mm(top, cj, e, e->s, /*use_rebuild_data=*/1,
-                             /*is_tree_walk=*/0)) {
+  } else {
+
+    /* Loop over all the top-level cells and go for a M-M interaction if
+     * well-separated */
+    for (int n = 0; n < nr_cells_with_particles; ++n) {
 
-      /* Call the PM interaction fucntion on the active sub-cells of ci */
-      runner_dopair_grav_mm_nonsym(r, ci, cj);
-      // runner_dopair_recursive_grav_pm(r, ci, cj);
+      /* Handle on the top-level cell and it's gravity business*/
+      struct cell *cj = &cells[cells_with_particles[n]];
 
-      /* Record that this multipole received a contribution */
-      multi_i->pot.interacted = 1;
+      /* Avoid self contributions */
+      if (top == cj) continue;
+
+      runner_do_grav_long_range_pair(r, ci, top, cj, &b);
+    } /* Loop over top-level cells */
+  }
 
-    } /* We are in charge of this pair */
-  }   /* Loop over top-level cells */
+  /* Interact with the multipoles left in the batch */
+  runner_do_grav_long_range_flush(r, ci, &b);
 
   if (timer) TIMER_TOC(timer_dograv_long_range);
 }
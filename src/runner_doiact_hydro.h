@@ -95,6 +95,9 @@
 #define _DOSUB_SUBSET(f) PASTE(runner_dosub_subset, f)
 #define DOSUB_SUBSET _DOSUB_SUBSET(FUNCTION)
 
+#define _DOSUBSET_LIST(f) PASTE(runner_dosubset_list, f)
+#define DOSUBSET_LIST _DOSUBSET_LIST(FUNCTION)
+
 #define _IACT_NONSYM(f) PASTE(runner_iact_nonsym, f)
 #define IACT_NONSYM _IACT_NONSYM(FUNCTION)
 
@@ -124,6 +127,27 @@
   {}
 #endif
 
+/* Schemes providing a #hydro_flux_batch (Gizmo) queue the interactions of
+ * the DOSELF2 and DOPAIR2 force loops in one and solve their Riemann problems
+ * together. The batch is flushed at the end of the loop. */
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_FORCE) && defined(HYDRO_FLUX_BATCH)
+#define IACT_BATCH(r2, dx, hi, hj, pi, pj, a, H) \
+  runner_iact_force_batch(&flux_batch, r2, dx, hi, hj, pi, pj, a, H)
+#define IACT_NONSYM_BATCH(r2, dx, hi, hj, pi, pj, a, H) \
+  runner_iact_nonsym_force_batch(&flux_batch, r2, dx, hi, hj, pi, pj, a, H)
+#define DECLARE_FLUX_BATCH()           \
+  struct hydro_flux_batch flux_batch; \
+  hydro_flux_batch_init(&flux_batch)
+#define FLUSH_FLUX_BATCH() hydro_flux_batch_flush(&flux_batch)
+#else
+#define IACT_BATCH IACT
+#define IACT_NONSYM_BATCH IACT_NONSYM
+#define DECLARE_FLUX_BATCH() \
+  {}
+#define FLUSH_FLUX_BATCH() \
+  {}
+#endif
+
 #if (FUNCTION_TASK_LOOP == TASK_LOOP_RT_GRADIENT) || \
     (FUNCTION_TASK_LOOP == TASK_LOOP_RT_TRANSPORT)
 /* RT specific function calls */
@@ -189,3 +213,10 @@ void DOPAIR_SUBSET_BRANCH(struct runner *r, struct cell *restrict ci,
 
 void DOSUB_SUBSET(struct runner *r, struct cell *ci, struct part *parts,
                   int *ind, int count, struct cell *cj, int gettimer);
+
+#if (FUNCTION_TASK_LOOP == TASK_LOOP_DENSITY)
+struct ghost_ngb_list;
+int DOSUBSET_LIST(struct runner *r, struct part *restrict parts,
+                  const int *restrict ind, int count,
+                  const struct ghost_ngb_list *l, int *restrict ind_left);
+#endif
@@ -23,10 +23,127 @@
 /* This object's header. */
 #include "runner_doiact_hydro_vec.h"
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+/* Local headers. */
+#include "chemistry.h"
+#include "pressure_floor_iact.h"
+#include "sink.h"
+#include "star_formation_iact.h"
+
+#ifdef WITH_VECTORIZED_HYDRO
 
 static const vector kernel_gamma2_vec = FILL_VEC(kernel_gamma2);
 
+/* Where the velocity divergence is accumulated. */
+#if defined(SPHENIX_SPH)
+#define hydro_vec_div_v viscosity.div_v
+#else
+#define hydro_vec_div_v density.div_v
+#endif
+
+/* Do the sub-grid modules add their own terms to the density or force loops?
+ * If so, their scalar interactions are called for every lane that interacts. */
+#if !defined(CHEMISTRY_NONE) || !defined(PRESSURE_FLOOR_NONE) || \
+    !defined(STAR_FORMATION_NONE) || !defined(SINK_NONE)
+#define WITH_VECTORIZED_HYDRO_SUBGRID
+#endif
+
+/**
+ * @brief Call the scalar density interactions of the sub-grid modules
+ * (chemistry, pressure floor, star formation and sinks) for the lanes of a
+ * vector of neighbours that interact with pi.
+ *
+ * @param e The #engine.
+ * @param doi_mask The integer mask of the lanes that interact.
+ * @param v_r2 #vector of the distances squared to pi.
+ * @param v_dx #vector of the x separations (pi - pj).
+ * @param v_dy #vector of the y separations (pi - pj).
+ * @param v_dz #vector of the z separations (pi - pj).
+ * @param pi The #part to update.
+ * @param parts_j The #part array of the neighbours.
+ * @param sort_j The sorted list of the neighbours, NULL if the lanes follow
+ * the order of parts_j.
+ * @param first_j The (sorted) index of the neighbour in the first lane.
+ * @param count_j The number of neighbours.
+ */
+__attribute__((always_inline)) INLINE static void runner_vec_density_subgrid(
+    const struct engine *e, const int doi_mask, const vector *v_r2,
+    const vector *v_dx, const vector *v_dy, const vector *v_dz,
+    struct part *restrict pi, struct part *restrict parts_j,
+    const struct sort_entry *restrict sort_j, const int first_j,
+    const int count_j) {
+
+#ifdef WITH_VECTORIZED_HYDRO_SUBGRID
+  const float a = e->cosmology->a;
+  const float H = e->cosmology->H;
+
+  for (int k = 0; k < VEC_SIZE; k++) {
+    if (!(doi_mask & (1 << k)) || first_j + k >= count_j) continue;
+
+    const int j =
+        sort_j != NULL ? sort_get_i(sort_j, first_j + k) : first_j + k;
+    struct part *restrict pj = &parts_j[j];
+    const float r2 = v_r2->f[k];
+    float dx[3] = {v_dx->f[k], v_dy->f[k], v_dz->f[k]};
+
+    runner_iact_nonsym_chemistry(r2, dx, pi->h, pj->h, pi, pj, a, H);
+    runner_iact_nonsym_pressure_floor(r2, dx, pi->h, pj->h, pi, pj, a, H);
+    runner_iact_nonsym_star_formation(r2, dx, pi->h, pj->h, pi, pj, a, H);
+    runner_iact_nonsym_sink(r2, dx, pi->h, pj->h, pi, pj, a, H,
+                            e->sink_properties);
+  }
+#endif
+}
+
+/**
+ * @brief Call the scalar force interactions of the sub-grid modules (the
+ * chemistry diffusion) for the lanes of a vector of neighbours that interact
+ * with pi.
+ *
+ * The time-step limiter is already applied by the vector force kernel.
+ *
+ * @param e The #engine.
+ * @param doi_mask The integer mask of the lanes that interact.
+ * @param v_r2 #vector of the distances squared to pi.
+ * @param v_dx #vector of the x separations (pi - pj).
+ * @param v_dy #vector of the y separations (pi - pj).
+ * @param v_dz #vector of the z separations (pi - pj).
+ * @param pi The #part to update.
+ * @param parts_j The #part array of the neighbours.
+ * @param sort_j The sorted list of the neighbours, NULL if the lanes follow
+ * the order of parts_j.
+ * @param first_j The (sorted) index of the neighbour in the first lane.
+ * @param count_j The number of neighbours.
+ */
+__attribute__((always_inline)) INLINE static void runner_vec_force_subgrid(
+    const struct engine *e, const int doi_mask, const vector *v_r2,
+    const vector *v_dx, const vector *v_dy, const vector *v_dz,
+    struct part *restrict pi, struct part *restrict parts_j,
+    const struct sort_entry *restrict sort_j, const int first_j,
+    const int count_j) {
+
+#ifdef WITH_VECTORIZED_HYDRO_SUBGRID
+  const struct cosmology *cosmo = e->cosmology;
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+  const double time_base = e->time_base;
+  const integertime_t t_current = e->ti_current;
+  const int with_cosmology = (e->policy & engine_policy_cosmology);
+
+  for (int k = 0; k < VEC_SIZE; k++) {
+    if (!(doi_mask & (1 << k)) || first_j + k >= count_j) continue;
+
+    const int j =
+        sort_j != NULL ? sort_get_i(sort_j, first_j + k) : first_j + k;
+    struct part *restrict pj = &parts_j[j];
+    const float r2 = v_r2->f[k];
+    float dx[3] = {v_dx->f[k], v_dy->f[k], v_dz->f[k]};
+
+    runner_iact_nonsym_diffusion(r2, dx, pi->h, pj->h, pi, pj, a, H,
+                                 time_base, t_current, cosmo, with_cosmology);
+  }
+#endif
+}
+
 /**
  * @brief Compute the vector remainder interactions from the secondary cache.
  *
@@ -280,10 +397,12 @@ __attribute__((always_inline)) INLINE static void populate_max_index_density(
      * particle in cell j. */
     first_pi = ci->hydro.count;
     active_id = first_pi - 1;
-    while (first_pi > 0 && sort_i[first_pi - 1].d + dx_max + hi_max > dj_min) {
+    while (first_pi > 0 &&
+           sort_get_d(sort_i, first_pi - 1) + dx_max + hi_max > dj_min) {
       first_pi--;
       /* Store the index of the particle if it is active. */
-      if (part_is_active_no_debug(&parts_i[sort_i[first_pi].i], max_active_bin))
+      if (part_is_active_no_debug(&parts_i[sort_get_i(sort_i, first_pi)],
+                                  max_active_bin))
         active_id = first_pi;
     }
 
@@ -297,25 +416,29 @@ __attribute__((always_inline)) INLINE static void populate_max_index_density(
       /* Start from the first particle in cell j. */
       temp = 0;
 
-      const struct part *pi = &parts_i[sort_i[first_pi].i];
+      const struct part *pi = &parts_i[sort_get_i(sort_i, first_pi)];
       const float first_di =
-          sort_i[first_pi].d + pi->h * kernel_gamma + dx_max - rshift;
+          sort_get_d(sort_i, first_pi) + pi->h * kernel_gamma + dx_max - rshift;
 
       /* Loop through particles in cell j until they are not in range of pi.
        * Make sure that temp stays between 0 and cj->hydro.count - 1.*/
-      while (temp < cj->hydro.count - 1 && first_di > sort_j[temp].d) temp++;
+      while (temp < cj->hydro.count - 1 &&
+             first_di > sort_get_d(sort_j, temp))
+        temp++;
 
       max_index_i[first_pi] = temp;
 
       /* Populate max_index_i for remaining particles that are within range. */
       for (int i = first_pi + 1; i < ci->hydro.count; i++) {
         temp = max_index_i[i - 1];
-        pi = &parts_i[sort_i[i].i];
+        pi = &parts_i[sort_get_i(sort_i, i)];
 
-        const float di = sort_i[i].d + pi->h * kernel_gamma + dx_max - rshift;
+        const float di =
+            sort_get_d(sort_i, i) + pi->h * kernel_gamma + dx_max - rshift;
 
         /* Make sure that temp stays between 0 and cj->hydro.count - 1.*/
-        while (temp < cj->hydro.count - 1 && di > sort_j[temp].d) temp++;
+        while (temp < cj->hydro.count - 1 && di > sort_get_d(sort_j, temp))
+          temp++;
 
         max_index_i[i] = temp;
       }
@@ -338,10 +461,11 @@ __attribute__((always_inline)) INLINE static void populate_max_index_density(
     last_pj = -1;
     active_id = last_pj;
     while (last_pj < cj->hydro.count &&
-           sort_j[last_pj + 1].d - hj_max - dx_max < di_max) {
+           sort_get_d(sort_j, last_pj + 1) - hj_max - dx_max < di_max) {
       last_pj++;
       /* Store the index of the particle if it is active. */
-      if (part_is_active_no_debug(&parts_j[sort_j[last_pj].i], max_active_bin))
+      if (part_is_active_no_debug(&parts_j[sort_get_i(sort_j, last_pj)],
+                                  max_active_bin))
         active_id = last_pj;
     }
 
@@ -355,22 +479,23 @@ __attribute__((always_inline)) INLINE static void populate_max_index_density(
       /* Start from the last particle in cell i. */
       temp = ci->hydro.count - 1;
 
-      const struct part *pj = &parts_j[sort_j[last_pj].i];
+      const struct part *pj = &parts_j[sort_get_i(sort_j, last_pj)];
       const float last_dj =
-          sort_j[last_pj].d - dx_max - pj->h * kernel_gamma + rshift;
+          sort_get_d(sort_j, last_pj) - dx_max - pj->h * kernel_gamma + rshift;
 
       /* Loop through particles in cell i until they are not in range of pj. */
-      while (temp > 0 && last_dj < sort_i[temp].d) temp--;
+      while (temp > 0 && last_dj < sort_get_d(sort_i, temp)) temp--;
 
       max_index_j[last_pj] = temp;
 
       /* Populate max_index_j for remaining particles that are within range. */
       for (int i = last_pj - 1; i >= 0; i--) {
         temp = max_index_j[i + 1];
-        pj = &parts_j[sort_j[i].i];
-        const float dj = sort_j[i].d - dx_max - (pj->h * kernel_gamma) + rshift;
+        pj = &parts_j[sort_get_i(sort_j, i)];
+        const float dj =
+            sort_get_d(sort_j, i) - dx_max - (pj->h * kernel_gamma) + rshift;
 
-        while (temp > 0 && dj < sort_i[temp].d) temp--;
+        while (temp > 0 && dj < sort_get_d(sort_i, temp)) temp--;
 
         max_index_j[i] = temp;
       }
@@ -440,10 +565,12 @@ __attribute__((always_inline)) INLINE static void populate_max_index_force(
      * particle in cell j. */
     first_pi = ci->hydro.count;
     active_id = first_pi - 1;
-    while (first_pi > 0 && sort_i[first_pi - 1].d + dx_max + h_max > dj_min) {
+    while (first_pi > 0 &&
+           sort_get_d(sort_i, first_pi - 1) + dx_max + h_max > dj_min) {
       first_pi--;
       /* Store the index of the particle if it is active. */
-      if (part_is_active_no_debug(&parts_i[sort_i[first_pi].i], max_active_bin))
+      if (part_is_active_no_debug(&parts_i[sort_get_i(sort_i, first_pi)],
+                                  max_active_bin))
         active_id = first_pi;
     }
 
@@ -457,27 +584,31 @@ __attribute__((always_inline)) INLINE static void populate_max_index_force(
       /* Start from the first particle in cell j. */
       temp = 0;
 
-      const struct part *pi = &parts_i[sort_i[first_pi].i];
-      const float first_di = sort_i[first_pi].d +
+      const struct part *pi = &parts_i[sort_get_i(sort_i, first_pi)];
+      const float first_di = sort_get_d(sort_i, first_pi) +
                              max(pi->h, hj_max_raw) * kernel_gamma + dx_max -
                              rshift;
 
       /* Loop through particles in cell j until they are not in range of pi.
        * Make sure that temp stays between 0 and cj->hydro.count - 1.*/
-      while (temp < cj->hydro.count - 1 && first_di > sort_j[temp].d) temp++;
+      while (temp < cj->hydro.count - 1 &&
+             first_di > sort_get_d(sort_j, temp))
+        temp++;
 
       max_index_i[first_pi] = temp;
 
       /* Populate max_index_i for remaining particles that are within range. */
       for (int i = first_pi + 1; i < ci->hydro.count; i++) {
         temp = max_index_i[i - 1];
-        pi = &parts_i[sort_i[i].i];
+        pi = &parts_i[sort_get_i(sort_i, i)];
 
-        const float di = sort_i[i].d + max(pi->h, hj_max_raw) * kernel_gamma +
+        const float di = sort_get_d(sort_i, i) +
+                         max(pi->h, hj_max_raw) * kernel_gamma +
                          dx_max - rshift;
 
         /* Make sure that temp stays between 0 and cj->hydro.count - 1.*/
-        while (temp < cj->hydro.count - 1 && di > sort_j[temp].d) temp++;
+        while (temp < cj->hydro.count - 1 && di > sort_get_d(sort_j, temp))
+          temp++;
 
         max_index_i[i] = temp;
       }
@@ -500,10 +631,11 @@ __attribute__((always_inline)) INLINE static void populate_max_index_force(
     last_pj = -1;
     active_id = last_pj;
     while (last_pj < cj->hydro.count &&
-           sort_j[last_pj + 1].d - h_max - dx_max < di_max) {
+           sort_get_d(sort_j, last_pj + 1) - h_max - dx_max < di_max) {
       last_pj++;
       /* Store the index of the particle if it is active. */
-      if (part_is_active_no_debug(&parts_j[sort_j[last_pj].i], max_active_bin))
+      if (part_is_active_no_debug(&parts_j[sort_get_i(sort_j, last_pj)],
+                                  max_active_bin))
         active_id = last_pj;
     }
 
@@ -517,24 +649,24 @@ __attribute__((always_inline)) INLINE static void populate_max_index_force(
       /* Start from the last particle in cell i. */
       temp = ci->hydro.count - 1;
 
-      const struct part *pj = &parts_j[sort_j[last_pj].i];
-      const float last_dj = sort_j[last_pj].d - dx_max -
+      const struct part *pj = &parts_j[sort_get_i(sort_j, last_pj)];
+      const float last_dj = sort_get_d(sort_j, last_pj) - dx_max -
                             max(pj->h, hi_max_raw) * kernel_gamma + rshift;
 
       /* Loop through particles in cell i until they are not in range of pj. */
-      while (temp > 0 && last_dj < sort_i[temp].d) temp--;
+      while (temp > 0 && last_dj < sort_get_d(sort_i, temp)) temp--;
 
       max_index_j[last_pj] = temp;
 
       /* Populate max_index_j for remaining particles that are within range. */
       for (int i = last_pj - 1; i >= 0; i--) {
         temp = max_index_j[i + 1];
-        pj = &parts_j[sort_j[i].i];
+        pj = &parts_j[sort_get_i(sort_j, i)];
 
-        const float dj = sort_j[i].d - dx_max -
+        const float dj = sort_get_d(sort_j, i) - dx_max -
                          (max(pj->h, hi_max_raw) * kernel_gamma) + rshift;
 
-        while (temp > 0 && dj < sort_i[temp].d) temp--;
+        while (temp > 0 && dj < sort_get_d(sort_i, temp)) temp--;
 
         max_index_j[i] = temp;
       }
@@ -605,7 +737,8 @@ __attribute__((always_inline)) INLINE static int populate_max_index_subset(
                         piy * runner_shift_y + piz * runner_shift_z +
                         di_shift_correction;
 
-      for (int pjd = last_pj; pjd < count_j && sort_j[pjd].d < di; pjd++)
+      for (int pjd = last_pj; pjd < count_j && sort_get_d(sort_j, pjd) < di;
+           pjd++)
         last_pj++;
 
       max_index_i[pid] = last_pj;
@@ -629,7 +762,8 @@ __attribute__((always_inline)) INLINE static int populate_max_index_subset(
                         piy * runner_shift_y + piz * runner_shift_z +
                         di_shift_correction;
 
-      for (int pjd = first_pj; pjd > 0 && di < sort_j[pjd].d; pjd--) first_pj--;
+      for (int pjd = first_pj; pjd > 0 && di < sort_get_d(sort_j, pjd); pjd--)
+        first_pj--;
 
       max_index_i[pid] = first_pj;
     }
@@ -637,7 +771,7 @@ __attribute__((always_inline)) INLINE static int populate_max_index_subset(
   }
 }
 
-#endif /* WITH_VECTORIZATION && GADGET2_SPH */
+#endif /* WITH_VECTORIZED_HYDRO */
 
 /**
  * @brief Compute the cell self-interaction (non-symmetric) using vector
@@ -648,7 +782,7 @@ __attribute__((always_inline)) INLINE static int populate_max_index_subset(
  */
 void runner_doself1_density_vec(struct runner *r, struct cell *restrict c) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#ifdef WITH_VECTORIZED_HYDRO
 
   /* Get some local variables */
   const struct engine *e = r->e;
@@ -807,6 +941,13 @@ void runner_doself1_density_vec(struct runner *r, struct cell *restrict c) {
       }
 #endif
 
+      /* Sub-grid terms for the neighbours found. */
+      runner_vec_density_subgrid(r->e, doi_mask, &v_r2, &v_dx, &v_dy, &v_dz,
+                                 pi, c->hydro.parts, NULL, pjd, count);
+      runner_vec_density_subgrid(r->e, doi_mask2, &v_r2_2, &v_dx_2, &v_dy_2,
+                                 &v_dz_2, pi, c->hydro.parts, NULL,
+                                 pjd + VEC_SIZE, count);
+
       /* If there are any interactions left pack interaction values into c2
        * cache. */
       if (doi_mask) {
@@ -853,7 +994,7 @@ void runner_doself1_density_vec(struct runner *r, struct cell *restrict c) {
     VEC_HADD(v_rho_dhSum, pi->density.rho_dh);
     VEC_HADD(v_wcountSum, pi->density.wcount);
     VEC_HADD(v_wcount_dhSum, pi->density.wcount_dh);
-    VEC_HADD(v_div_vSum, pi->density.div_v);
+    VEC_HADD(v_div_vSum, pi->hydro_vec_div_v);
     VEC_HADD(v_curlvxSum, pi->density.rot_v[0]);
     VEC_HADD(v_curlvySum, pi->density.rot_v[1]);
     VEC_HADD(v_curlvzSum, pi->density.rot_v[2]);
@@ -866,9 +1007,9 @@ void runner_doself1_density_vec(struct runner *r, struct cell *restrict c) {
 
 #else
 
-  error("Incorrectly calling vectorized Gadget-2 functions!");
+  error("Incorrectly calling vectorized hydro functions!");
 
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO */
 }
 
 /**
@@ -885,7 +1026,7 @@ void runner_doself_subset_density_vec(struct runner *r, struct cell *restrict c,
                                       struct part *restrict parts,
                                       int *restrict ind, int pi_count) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#ifdef WITH_VECTORIZED_HYDRO
 
   const int count = c->hydro.count;
 
@@ -1040,6 +1181,13 @@ void runner_doself_subset_density_vec(struct runner *r, struct cell *restrict c,
       }
 #endif
 
+      /* Sub-grid terms for the neighbours found. */
+      runner_vec_density_subgrid(r->e, doi_mask, &v_r2, &v_dx, &v_dy, &v_dz,
+                                 pi, c->hydro.parts, NULL, pjd, count);
+      runner_vec_density_subgrid(r->e, doi_mask2, &v_r2_2, &v_dx_2, &v_dy_2,
+                                 &v_dz_2, pi, c->hydro.parts, NULL,
+                                 pjd + VEC_SIZE, count);
+
       /* If there are any interactions left pack interaction values into c2
        * cache. */
       if (doi_mask) {
@@ -1087,7 +1235,7 @@ void runner_doself_subset_density_vec(struct runner *r, struct cell *restrict c,
     VEC_HADD(v_rho_dhSum, pi->density.rho_dh);
     VEC_HADD(v_wcountSum, pi->density.wcount);
     VEC_HADD(v_wcount_dhSum, pi->density.wcount_dh);
-    VEC_HADD(v_div_vSum, pi->density.div_v);
+    VEC_HADD(v_div_vSum, pi->hydro_vec_div_v);
     VEC_HADD(v_curlvxSum, pi->density.rot_v[0]);
     VEC_HADD(v_curlvySum, pi->density.rot_v[1]);
     VEC_HADD(v_curlvzSum, pi->density.rot_v[2]);
@@ -1100,9 +1248,164 @@ void runner_doself_subset_density_vec(struct runner *r, struct cell *restrict c,
 
 #else
 
-  error("Incorrectly calling vectorized Gadget-2 functions!");
+  error("Incorrectly calling vectorized hydro functions!");
+
+#endif /* WITH_VECTORIZED_HYDRO */
+}
+
+/**
+ * @brief Compute the gradient cell self-interaction (non-symmetric) using
+ * vector intrinsics with one particle pi at a time.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ */
+void runner_doself1_gradient_vec(struct runner *r, struct cell *restrict c) {
+
+#if defined(WITH_VECTORIZED_HYDRO) && defined(SPHENIX_SPH)
+
+  const struct engine *e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+  struct part *restrict parts = c->hydro.parts;
+  const int count = c->hydro.count;
+
+  TIMER_TIC;
+
+  /* Early abort? */
+  if (!cell_is_active_hydro(c, e)) return;
+
+  if (!cell_are_part_drifted(c, e)) error("Interacting undrifted cell.");
+
+#ifdef SWIFT_DEBUG_CHECKS
+  for (int i = 0; i < count; i++) {
+    /* Check that particles have been drifted to the current time */
+    if (parts[i].ti_drift != e->ti_current && !part_is_inhibited(&parts[i], e))
+      error("Particle pi not drifted to current time");
+  }
+#endif
+
+  /* Get the particle cache from the runner and re-allocate
+   * the cache if it is not big enough for the cell. */
+  struct cache *restrict cell_cache = &r->ci_cache;
+
+  if (cell_cache->count < count) cache_init(cell_cache, count);
+
+  /* Read the particles from the cell and store them locally in the cache.
+   * The force cache holds everything the gradient loop needs. */
+  const int count_align = cache_read_force_particles(c, cell_cache);
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Loop over the particles in the cell. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a pointer to the ith particle. */
+    struct part *restrict pi = &parts[pid];
+
+    /* Is the i^th particle active? */
+    if (!part_is_active(pi, e)) continue;
+
+    /* Fill particle pi vectors. */
+    const vector v_pix = vector_set1(cell_cache->x[pid]);
+    const vector v_piy = vector_set1(cell_cache->y[pid]);
+    const vector v_piz = vector_set1(cell_cache->z[pid]);
+    const vector v_hi = vector_set1(cell_cache->h[pid]);
+    const vector v_vix = vector_set1(cell_cache->vx[pid]);
+    const vector v_viy = vector_set1(cell_cache->vy[pid]);
+    const vector v_viz = vector_set1(cell_cache->vz[pid]);
+    const vector v_ui = vector_set1(cell_cache->u[pid]);
+    const vector v_ci = vector_set1(cell_cache->soundspeed[pid]);
+
+    /* Some useful powers of h */
+    const float hi = cell_cache->h[pid];
+    const float hig2 = hi * hi * kernel_gamma2;
+    const vector v_hig2 = vector_set1(hig2);
+    const vector v_hi_inv = vec_reciprocal(v_hi);
+
+    /* Reset cumulative sums of update vectors. */
+    vector v_sigSum = vector_set1(pi->viscosity.v_sig);
+    vector v_laplace_uSum = vector_setzero();
+    vector v_alpha_visc_max_ngbSum =
+        vector_set1(pi->force.alpha_visc_max_ngb);
+
+    /* Find all of particle pi's interacions. */
+    for (int pjd = 0; pjd < count_align; pjd += VEC_SIZE) {
+
+      /* Load 1 set of vectors from the particle cache. */
+      const vector v_pjx = vector_load(&cell_cache->x[pjd]);
+      const vector v_pjy = vector_load(&cell_cache->y[pjd]);
+      const vector v_pjz = vector_load(&cell_cache->z[pjd]);
+
+      /* Compute the pairwise distance. */
+      vector v_dx, v_dy, v_dz, v_r2;
+      v_dx.v = vec_sub(v_pix.v, v_pjx.v);
+      v_dy.v = vec_sub(v_piy.v, v_pjy.v);
+      v_dz.v = vec_sub(v_piz.v, v_pjz.v);
+
+      v_r2.v = vec_mul(v_dx.v, v_dx.v);
+      v_r2.v = vec_fma(v_dy.v, v_dy.v, v_r2.v);
+      v_r2.v = vec_fma(v_dz.v, v_dz.v, v_r2.v);
+
+      /* Form r2 > 0 mask.
+       * This is used to avoid self-interctions */
+      mask_t v_doi_mask_self_check;
+      vec_create_mask(v_doi_mask_self_check, vec_cmp_gt(v_r2.v, vec_setzero()));
+
+      /* Form r2 < hig2 mask. */
+      mask_t v_doi_mask;
+      vec_create_mask(v_doi_mask, vec_cmp_lt(v_r2.v, v_hig2.v));
+
+      /* Combine both masks. */
+      vec_combine_masks(v_doi_mask, v_doi_mask_self_check);
+
+#ifdef SWIFT_DEBUG_CHECKS
+      /* Verify that we have no inhibited particles in the interaction cache */
+      for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
+        if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
+          if ((pjd + bit_index < count) &&
+              (parts[pjd + bit_index].time_bin >= time_bin_inhibited)) {
+            error("Inhibited particle in interaction cache! id=%lld",
+                  parts[pjd + bit_index].id);
+          }
+        }
+      }
+#endif
+
+      /* If there are any interactions perform them. */
+      if (vec_is_mask_true(v_doi_mask)) {
+
+        /* To stop floating point exceptions when particle separations are 0.
+         * Note that the results for r2==0 are masked out but may still raise
+         * an FPE as only the final operaion is masked, not the whole math
+         * operations sequence. */
+        v_r2.v = vec_add(v_r2.v, vec_set1(FLT_MIN));
+
+        runner_iact_nonsym_1_vec_gradient(
+            &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_ui, v_ci,
+            &cell_cache->vx[pjd], &cell_cache->vy[pjd], &cell_cache->vz[pjd],
+            &cell_cache->u[pjd], &cell_cache->rho[pjd],
+            &cell_cache->soundspeed[pjd], &cell_cache->alpha_visc[pjd],
+            &cell_cache->m[pjd], v_hi_inv, a, H, &v_sigSum, &v_laplace_uSum,
+            &v_alpha_visc_max_ngbSum, v_doi_mask);
+      }
+
+    } /* Loop over all other particles. */
+
+    VEC_HMAX(v_sigSum, pi->viscosity.v_sig);
+    VEC_HADD(v_laplace_uSum, pi->diffusion.laplace_u);
+    VEC_HMAX(v_alpha_visc_max_ngbSum, pi->force.alpha_visc_max_ngb);
+
+  } /* loop over all particles. */
+
+  TIMER_TOC(timer_doself_gradient);
+
+#else
+
+  error("Incorrectly calling vectorized hydro functions!");
 
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO && SPHENIX_SPH */
 }
 
 /**
@@ -1114,7 +1417,7 @@ void runner_doself_subset_density_vec(struct runner *r, struct cell *restrict c,
  */
 void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#ifdef WITH_VECTORIZED_HYDRO
 
   const struct engine *e = r->e;
   const struct cosmology *restrict cosmo = e->cosmology;
@@ -1169,9 +1472,20 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
 
     const vector v_rhoi = vector_set1(cell_cache->rho[pid]);
     const vector v_grad_hi = vector_set1(cell_cache->grad_h[pid]);
-    const vector v_pOrhoi2 = vector_set1(cell_cache->pOrho2[pid]);
-    const vector v_balsara_i = vector_set1(cell_cache->balsara[pid]);
+    const vector v_balsara_i =
+        vector_set1(half_float_unpack(cell_cache->balsara[pid]));
     const vector v_ci = vector_set1(cell_cache->soundspeed[pid]);
+#if defined(GADGET2_SPH)
+    const vector v_pOrhoi2 = vector_set1(cell_cache->pOrho2[pid]);
+#elif defined(SPHENIX_SPH)
+    const vector v_pressure_i = vector_set1(cell_cache->pressure[pid]);
+    const vector v_alpha_visc_i =
+        vector_set1(half_float_unpack(cell_cache->alpha_visc[pid]));
+    const vector v_alpha_diff_i =
+        vector_set1(half_float_unpack(cell_cache->alpha_diff[pid]));
+    const vector v_ui = vector_set1(cell_cache->u[pid]);
+    const vector v_mi = vector_set1(cell_cache->m[pid]);
+#endif
 
     /* Some useful powers of h */
     const float hi = cell_cache->h[pid];
@@ -1184,8 +1498,14 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
     vector v_a_hydro_ySum = vector_setzero();
     vector v_a_hydro_zSum = vector_setzero();
     vector v_h_dtSum = vector_setzero();
+#if defined(GADGET2_SPH)
     vector v_sigSum = vector_set1(pi->force.v_sig);
     vector v_entropy_dtSum = vector_setzero();
+#elif defined(SPHENIX_SPH)
+    vector v_u_dtSum = vector_setzero();
+    vector v_min_ngb_time_binSum =
+        vector_set1(pi->limiter_data.min_ngb_time_bin);
+#endif
 
     /* Find all of particle pi's interacions and store needed values in the
      * secondary cache.*/
@@ -1251,6 +1571,10 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
       /* If there are any interactions perform them. */
       if (vec_is_mask_true(v_doi_mask)) {
 
+        /* Sub-grid terms. */
+        runner_vec_force_subgrid(e, vec_is_mask_true(v_doi_mask), &v_r2, &v_dx,
+                                 &v_dy, &v_dz, pi, parts, NULL, pjd, count);
+
         /* 1 / hj */
         const vector v_hj_inv = vec_reciprocal(hj);
 
@@ -1260,6 +1584,7 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
          * operations sequence. */
         v_r2.v = vec_add(v_r2.v, vec_set1(FLT_MIN));
 
+#if defined(GADGET2_SPH)
         runner_iact_nonsym_1_vec_force(
             &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_rhoi, v_grad_hi,
             v_pOrhoi2, v_balsara_i, v_ci, &cell_cache->vx[pjd],
@@ -1269,6 +1594,20 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
             &cell_cache->m[pjd], v_hi_inv, v_hj_inv, a, H, &v_a_hydro_xSum,
             &v_a_hydro_ySum, &v_a_hydro_zSum, &v_h_dtSum, &v_sigSum,
             &v_entropy_dtSum, v_doi_mask);
+#elif defined(SPHENIX_SPH)
+        runner_iact_nonsym_1_vec_force(
+            &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_rhoi, v_grad_hi,
+            v_pressure_i, v_balsara_i, v_ci, v_alpha_visc_i, v_alpha_diff_i,
+            v_ui, v_mi, &cell_cache->vx[pjd], &cell_cache->vy[pjd],
+            &cell_cache->vz[pjd], &cell_cache->rho[pjd],
+            &cell_cache->grad_h[pjd], &cell_cache->pressure[pjd],
+            &cell_cache->balsara[pjd], &cell_cache->soundspeed[pjd],
+            &cell_cache->alpha_visc[pjd], &cell_cache->alpha_diff[pjd],
+            &cell_cache->u[pjd], &cell_cache->m[pjd],
+            &cell_cache->time_bin[pjd], v_hi_inv, v_hj_inv, a, H,
+            &v_a_hydro_xSum, &v_a_hydro_ySum, &v_a_hydro_zSum, &v_h_dtSum,
+            &v_u_dtSum, &v_min_ngb_time_binSum, v_doi_mask);
+#endif
       }
 
     } /* Loop over all other particles. */
@@ -1277,9 +1616,17 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
     VEC_HADD(v_a_hydro_ySum, pi->a_hydro[1]);
     VEC_HADD(v_a_hydro_zSum, pi->a_hydro[2]);
     VEC_HADD(v_h_dtSum, pi->force.h_dt);
+#if defined(GADGET2_SPH)
     VEC_HADD(v_entropy_dtSum, pi->entropy_dt);
 
     VEC_HMAX(v_sigSum, pi->force.v_sig);
+#elif defined(SPHENIX_SPH)
+    VEC_HADD(v_u_dtSum, pi->u_dt);
+
+    float min_ngb_time_bin = pi->limiter_data.min_ngb_time_bin;
+    VEC_HMIN(v_min_ngb_time_binSum, min_ngb_time_bin);
+    pi->limiter_data.min_ngb_time_bin = (timebin_t)min_ngb_time_bin;
+#endif
 
   } /* loop over all particles. */
 
@@ -1287,9 +1634,9 @@ void runner_doself2_force_vec(struct runner *r, struct cell *restrict c) {
 
 #else
 
-  error("Incorrectly calling vectorized Gadget-2 functions!");
+  error("Incorrectly calling vectorized hydro functions!");
 
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO */
 }
 
 /**
@@ -1306,7 +1653,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
                                 struct cell *cj, const int sid,
                                 const double *shift) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#ifdef WITH_VECTORIZED_HYDRO
 
   const struct engine *restrict e = r->e;
   const timebin_t max_active_bin = e->max_active_bin;
@@ -1332,8 +1679,8 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
   const double hj_max = cj->hydro.h_max * kernel_gamma;
   struct part *restrict parts_i = ci->hydro.parts;
   struct part *restrict parts_j = cj->hydro.parts;
-  const double di_max = sort_i[count_i - 1].d - rshift;
-  const double dj_min = sort_j[0].d;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
   const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
   const int active_ci = cell_is_active_hydro(ci, e) && ci_local;
   const int active_cj = cell_is_active_hydro(cj, e) && cj_local;
@@ -1355,8 +1702,9 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
 
   if (active_ci) {
     for (int pid = count_i - 1;
-         pid >= 0 && sort_i[pid].d + hi_max + dx_max > dj_min; pid--) {
-      const struct part *restrict pi = &parts_i[sort_i[pid].i];
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
+      const struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
       if (part_is_active_no_debug(pi, max_active_bin)) {
         numActive++;
         break;
@@ -1365,9 +1713,10 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
   }
 
   if (!numActive && active_cj) {
-    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - hj_max - dx_max < di_max;
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
          pjd++) {
-      const struct part *restrict pj = &parts_j[sort_j[pjd].i];
+      const struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
       if (part_is_active_no_debug(pj, max_active_bin)) {
         numActive++;
         break;
@@ -1422,7 +1771,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
     for (int pid = count_i - 1; pid >= first_pi_loop; pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct part *restrict pi = &parts_i[sort_i[pid].i];
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
       if (!part_is_active_no_debug(pi, max_active_bin)) continue;
 
       /* Set the cache index. */
@@ -1431,7 +1780,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
       /* Skip this particle if no particle in cj is within range of it. */
       const float hi = ci_cache->h[ci_cache_idx];
       const double di_test =
-          sort_i[pid].d + hi * kernel_gamma + dx_max - rshift;
+          sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
       if (di_test < dj_min) continue;
 
       /* Determine the exit iteration of the interaction loop. */
@@ -1505,10 +1854,10 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
         for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if ((pjd + bit_index < count_j) &&
-                (parts_j[sort_j[pjd + bit_index].i].time_bin >=
+                (parts_j[sort_get_i(sort_j, pjd + bit_index)].time_bin >=
                  time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_j[sort_j[pjd + bit_index].i].id);
+                    parts_j[sort_get_i(sort_j, pjd + bit_index)].id);
             }
           }
         }
@@ -1519,13 +1868,18 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if (pi->num_ngb_density < MAX_NUM_OF_NEIGHBOURS)
               pi->ids_ngbs_density[pi->num_ngb_density] =
-                  parts_j[sort_j[pjd + bit_index].i].id;
+                  parts_j[sort_get_i(sort_j, pjd + bit_index)].id;
             ++pi->num_ngb_density;
           }
         }
 #endif
 
         /* If there are any interactions perform them. */
+        /* Sub-grid terms for the neighbours found. */
+        runner_vec_density_subgrid(e, vec_is_mask_true(v_doi_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pi, parts_j, sort_j,
+                                   cj_cache_idx, count_j);
+
         if (vec_is_mask_true(v_doi_mask))
           runner_iact_nonsym_1_vec_density(
               &v_r2, &v_dx, &v_dy, &v_dz, v_hi_inv, v_vix, v_viy, v_viz,
@@ -1542,7 +1896,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
       VEC_HADD(v_rho_dhSum, pi->density.rho_dh);
       VEC_HADD(v_wcountSum, pi->density.wcount);
       VEC_HADD(v_wcount_dhSum, pi->density.wcount_dh);
-      VEC_HADD(v_div_vSum, pi->density.div_v);
+      VEC_HADD(v_div_vSum, pi->hydro_vec_div_v);
       VEC_HADD(v_curlvxSum, pi->density.rot_v[0]);
       VEC_HADD(v_curlvySum, pi->density.rot_v[1]);
       VEC_HADD(v_curlvzSum, pi->density.rot_v[2]);
@@ -1556,7 +1910,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
     for (int pjd = 0; pjd < last_pj_loop_end; pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct part *restrict pj = &parts_j[sort_j[pjd].i];
+      struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
       if (!part_is_active_no_debug(pj, max_active_bin)) continue;
 
       /* Set the cache index. */
@@ -1564,7 +1918,8 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
 
       /* Skip this particle if no particle in ci is within range of it. */
       const float hj = cj_cache->h[cj_cache_idx];
-      const double dj_test = sort_j[pjd].d - hj * kernel_gamma - dx_max;
+      const double dj_test =
+          sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max;
       if (dj_test > di_max) continue;
 
       /* Determine the exit iteration of the interaction loop. */
@@ -1646,10 +2001,13 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
         for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
           if (vec_is_mask_true(v_doj_mask) & (1 << bit_index)) {
             if ((ci_cache_idx + first_pi + bit_index < count_i) &&
-                (parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i]
+                (parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
                      .time_bin >= time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i].id);
+                    parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
+                        .id);
             }
           }
         }
@@ -1660,13 +2018,20 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
           if (vec_is_mask_true(v_doj_mask) & (1 << bit_index)) {
             if (pj->num_ngb_density < MAX_NUM_OF_NEIGHBOURS)
               pj->ids_ngbs_density[pj->num_ngb_density] =
-                  parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i].id;
+                  parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                 bit_index)]
+                      .id;
             ++pj->num_ngb_density;
           }
         }
 #endif
 
         /* If there are any interactions perform them. */
+        /* Sub-grid terms for the neighbours found. */
+        runner_vec_density_subgrid(e, vec_is_mask_true(v_doj_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pj, parts_i, sort_i,
+                                   ci_cache_idx + first_pi, count_i);
+
         if (vec_is_mask_true(v_doj_mask))
           runner_iact_nonsym_1_vec_density(
               &v_r2, &v_dx, &v_dy, &v_dz, v_hj_inv, v_vjx, v_vjy, v_vjz,
@@ -1683,7 +2048,7 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
       VEC_HADD(v_rho_dhSum, pj->density.rho_dh);
       VEC_HADD(v_wcountSum, pj->density.wcount);
       VEC_HADD(v_wcount_dhSum, pj->density.wcount_dh);
-      VEC_HADD(v_div_vSum, pj->density.div_v);
+      VEC_HADD(v_div_vSum, pj->hydro_vec_div_v);
       VEC_HADD(v_curlvxSum, pj->density.rot_v[0]);
       VEC_HADD(v_curlvySum, pj->density.rot_v[1]);
       VEC_HADD(v_curlvzSum, pj->density.rot_v[2]);
@@ -1695,9 +2060,9 @@ void runner_dopair1_density_vec(struct runner *r, struct cell *ci,
 
 #else
 
-  error("Incorrectly calling vectorized Gadget-2 functions!");
+  error("Incorrectly calling vectorized hydro functions!");
 
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO */
 }
 
 /**
@@ -1721,7 +2086,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
                                       struct cell *restrict cj, const int sid,
                                       const int flipped, const double *shift) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#ifdef WITH_VECTORIZED_HYDRO
 
   TIMER_TIC;
 
@@ -1768,7 +2133,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
     cache_read_particles_subset_pair(cj, cj_cache, sort_j, 0, &last_pj, ci->loc,
                                      0);
 
-    const double dj_min = sort_j[0].d;
+    const double dj_min = sort_get_d(sort_j, 0);
 
     /* Loop over the parts_i. */
     for (int pid = 0; pid < count; pid++) {
@@ -1846,10 +2211,10 @@ void runner_dopair_subset_density_vec(struct runner *r,
 
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if ((pjd + bit_index < count_j) &&
-                (parts_j[sort_j[pjd + bit_index].i].time_bin >=
+                (parts_j[sort_get_i(sort_j, pjd + bit_index)].time_bin >=
                  time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_j[sort_j[pjd + bit_index].i].id);
+                    parts_j[sort_get_i(sort_j, pjd + bit_index)].id);
             }
           }
         }
@@ -1862,7 +2227,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if (pi->num_ngb_density < MAX_NUM_OF_NEIGHBOURS) {
               pi->ids_ngbs_density[pi->num_ngb_density] =
-                  parts_j[sort_j[pjd + bit_index].i].id;
+                  parts_j[sort_get_i(sort_j, pjd + bit_index)].id;
             }
             ++pi->num_ngb_density;
           }
@@ -1870,6 +2235,11 @@ void runner_dopair_subset_density_vec(struct runner *r,
 #endif
 
         /* If there are any interactions perform them. */
+        /* Sub-grid terms for the neighbours found. */
+        runner_vec_density_subgrid(r->e, vec_is_mask_true(v_doi_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pi, cj->hydro.parts,
+                                   sort_j, cj_cache_idx, count_j);
+
         if (vec_is_mask_true(v_doi_mask))
           runner_iact_nonsym_1_vec_density(
               &v_r2, &v_dx, &v_dy, &v_dz, v_hi_inv, v_vix, v_viy, v_viz,
@@ -1886,7 +2256,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
       VEC_HADD(v_rho_dhSum, pi->density.rho_dh);
       VEC_HADD(v_wcountSum, pi->density.wcount);
       VEC_HADD(v_wcount_dhSum, pi->density.wcount_dh);
-      VEC_HADD(v_div_vSum, pi->density.div_v);
+      VEC_HADD(v_div_vSum, pi->hydro_vec_div_v);
       VEC_HADD(v_curlvxSum, pi->density.rot_v[0]);
       VEC_HADD(v_curlvySum, pi->density.rot_v[1]);
       VEC_HADD(v_curlvzSum, pi->density.rot_v[2]);
@@ -1908,7 +2278,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
     /* Get the number of particles read into the ci cache. */
     const int cj_cache_count = count_j - first_pj;
 
-    const double dj_max = sort_j[count_j - 1].d;
+    const double dj_max = sort_get_d(sort_j, count_j - 1);
 
     /* Loop over the parts_i. */
     for (int pid = 0; pid < count; pid++) {
@@ -1994,10 +2364,13 @@ void runner_dopair_subset_density_vec(struct runner *r,
 
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if ((cj_cache_idx + bit_index < count_j) &&
-                (parts_j[sort_j[cj_cache_idx + first_pj + bit_index].i]
+                (parts_j[sort_get_i(sort_j, cj_cache_idx + first_pj +
+                                                   bit_index)]
                      .time_bin >= time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_j[sort_j[cj_cache_idx + first_pj + bit_index].i].id);
+                    parts_j[sort_get_i(sort_j, cj_cache_idx + first_pj +
+                                                   bit_index)]
+                        .id);
             }
           }
         }
@@ -2010,7 +2383,9 @@ void runner_dopair_subset_density_vec(struct runner *r,
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if (pi->num_ngb_density < MAX_NUM_OF_NEIGHBOURS) {
               pi->ids_ngbs_density[pi->num_ngb_density] =
-                  parts_j[sort_j[cj_cache_idx + first_pj + bit_index].i].id;
+                  parts_j[sort_get_i(sort_j, cj_cache_idx + first_pj +
+                                                 bit_index)]
+                      .id;
             }
             ++pi->num_ngb_density;
           }
@@ -2018,6 +2393,11 @@ void runner_dopair_subset_density_vec(struct runner *r,
 #endif
 
         /* If there are any interactions perform them. */
+        /* Sub-grid terms for the neighbours found. */
+        runner_vec_density_subgrid(r->e, vec_is_mask_true(v_doi_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pi, cj->hydro.parts,
+                                   sort_j, cj_cache_idx + first_pj, count_j);
+
         if (vec_is_mask_true(v_doi_mask))
           runner_iact_nonsym_1_vec_density(
               &v_r2, &v_dx, &v_dy, &v_dz, v_hi_inv, v_vix, v_viy, v_viz,
@@ -2034,7 +2414,7 @@ void runner_dopair_subset_density_vec(struct runner *r,
       VEC_HADD(v_rho_dhSum, pi->density.rho_dh);
       VEC_HADD(v_wcountSum, pi->density.wcount);
       VEC_HADD(v_wcount_dhSum, pi->density.wcount_dh);
-      VEC_HADD(v_div_vSum, pi->density.div_v);
+      VEC_HADD(v_div_vSum, pi->hydro_vec_div_v);
       VEC_HADD(v_curlvxSum, pi->density.rot_v[0]);
       VEC_HADD(v_curlvySum, pi->density.rot_v[1]);
       VEC_HADD(v_curlvzSum, pi->density.rot_v[2]);
@@ -2043,12 +2423,12 @@ void runner_dopair_subset_density_vec(struct runner *r,
   }
 
   TIMER_TOC(timer_dopair_subset);
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO */
 }
 
 /**
- * @brief Compute the force interactions between a cell pair (non-symmetric)
- * using vector intrinsics.
+ * @brief Compute the gradient interactions between a cell pair
+ * (non-symmetric) using vector intrinsics.
  *
  * @param r The #runner.
  * @param ci The first #cell.
@@ -2056,11 +2436,11 @@ void runner_dopair_subset_density_vec(struct runner *r,
  * @param sid The direction of the pair
  * @param shift The shift vector to apply to the particles in ci.
  */
-void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
-                              struct cell *cj, const int sid,
-                              const double *shift) {
+void runner_dopair1_gradient_vec(struct runner *r, struct cell *ci,
+                                 struct cell *cj, const int sid,
+                                 const double *shift) {
 
-#if defined(WITH_VECTORIZATION) && defined(GADGET2_SPH)
+#if defined(WITH_VECTORIZED_HYDRO) && defined(SPHENIX_SPH)
 
   const struct engine *restrict e = r->e;
   const struct cosmology *restrict cosmo = e->cosmology;
@@ -2083,14 +2463,12 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
   /* Get some other useful values. */
   const int count_i = ci->hydro.count;
   const int count_j = cj->hydro.count;
-  const double hi_max = ci->hydro.h_max * kernel_gamma;
+  const double hi_max = ci->hydro.h_max * kernel_gamma - rshift;
   const double hj_max = cj->hydro.h_max * kernel_gamma;
-  const double hi_max_raw = ci->hydro.h_max;
-  const double hj_max_raw = cj->hydro.h_max;
   struct part *restrict parts_i = ci->hydro.parts;
   struct part *restrict parts_j = cj->hydro.parts;
-  const double di_max = sort_i[count_i - 1].d - rshift;
-  const double dj_min = sort_j[0].d;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
   const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
   const int active_ci = cell_is_active_hydro(ci, e) && ci_local;
   const int active_cj = cell_is_active_hydro(cj, e) && cj_local;
@@ -2111,17 +2489,14 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       error("Particle pj not drifted to current time");
 #endif
 
-  /* Check if any particles are active and in range */
+  /* Count number of particles that are in range and active*/
   int numActive = 0;
 
-  /* Use the largest smoothing length to make sure that no interactions are
-   * missed. */
-  const double h_max = max(hi_max, hj_max);
-
   if (active_ci) {
     for (int pid = count_i - 1;
-         pid >= 0 && sort_i[pid].d + h_max + dx_max > dj_min; pid--) {
-      const struct part *restrict pi = &parts_i[sort_i[pid].i];
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
+      const struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
       if (part_is_active_no_debug(pi, max_active_bin)) {
         numActive++;
         break;
@@ -2130,9 +2505,10 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
   }
 
   if (!numActive && active_cj) {
-    for (int pjd = 0; pjd < count_j && sort_j[pjd].d - h_max - dx_max < di_max;
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
          pjd++) {
-      const struct part *restrict pj = &parts_j[sort_j[pjd].i];
+      const struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
       if (part_is_active_no_debug(pj, max_active_bin)) {
         numActive++;
         break;
@@ -2140,7 +2516,7 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
     }
   }
 
-  /* Return if no active particle in range */
+  /* Return if there are no active particles within range */
   if (numActive == 0) return;
 
   /* Get both particle caches from the runner and re-allocate
@@ -2157,13 +2533,14 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
   swift_declare_aligned_ptr(int, max_index_j, r->cj_cache.max_index,
                             SWIFT_CACHE_ALIGNMENT);
 
-  /* Find particles maximum distance into cj, max_di[] and ci, max_dj[]. */
-  /* Also find the first pi that interacts with any particle in cj and the last
-   * pj that interacts with any particle in ci. */
-  populate_max_index_force(ci, cj, sort_i, sort_j, dx_max, rshift, hi_max_raw,
-                           hj_max_raw, h_max, di_max, dj_min, max_index_i,
-                           max_index_j, &first_pi, &last_pj, max_active_bin,
-                           active_ci, active_cj);
+  /* Find particles maximum index into cj, max_index_i[] and ci, max_index_j[].
+   * Also find the first pi that interacts with any particle in cj and the last
+   * pj that interacts with any particle in ci. The gradient loop only uses the
+   * smoothing length of the active particle, as the density loop does. */
+  populate_max_index_density(ci, cj, sort_i, sort_j, dx_max, rshift, hi_max,
+                             hj_max, di_max, dj_min, max_index_i, max_index_j,
+                             &first_pi, &last_pj, max_active_bin, active_ci,
+                             active_cj);
 
   /* Limits of the outer loops. */
   const int first_pi_loop = first_pi;
@@ -2187,8 +2564,8 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
     for (int pid = count_i - 1; pid >= first_pi_loop; pid--) {
 
       /* Get a hold of the ith part in ci. */
-      struct part *restrict pi = &parts_i[sort_i[pid].i];
-      if (!part_is_active(pi, e)) continue;
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
+      if (!part_is_active_no_debug(pi, max_active_bin)) continue;
 
       /* Set the cache index. */
       const int ci_cache_idx = pid - first_pi;
@@ -2196,7 +2573,7 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       /* Skip this particle if no particle in cj is within range of it. */
       const float hi = ci_cache->h[ci_cache_idx];
       const double di_test =
-          sort_i[pid].d + max(hi, hj_max_raw) * kernel_gamma + dx_max - rshift;
+          sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
       if (di_test < dj_min) continue;
 
       /* Determine the exit iteration of the interaction loop. */
@@ -2210,25 +2587,20 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       const vector v_vix = vector_set1(ci_cache->vx[ci_cache_idx]);
       const vector v_viy = vector_set1(ci_cache->vy[ci_cache_idx]);
       const vector v_viz = vector_set1(ci_cache->vz[ci_cache_idx]);
-      const vector v_rhoi = vector_set1(ci_cache->rho[ci_cache_idx]);
-      const vector v_grad_hi = vector_set1(ci_cache->grad_h[ci_cache_idx]);
-      const vector v_pOrhoi2 = vector_set1(ci_cache->pOrho2[ci_cache_idx]);
-      const vector v_balsara_i = vector_set1(ci_cache->balsara[ci_cache_idx]);
+      const vector v_ui = vector_set1(ci_cache->u[ci_cache_idx]);
       const vector v_ci = vector_set1(ci_cache->soundspeed[ci_cache_idx]);
 
       const float hig2 = hi * hi * kernel_gamma2;
       const vector v_hig2 = vector_set1(hig2);
 
       /* Get the inverse of hi. */
-      vector v_hi_inv = vec_reciprocal(v_hi);
+      const vector v_hi_inv = vec_reciprocal(v_hi);
 
       /* Reset cumulative sums of update vectors. */
-      vector v_a_hydro_xSum = vector_setzero();
-      vector v_a_hydro_ySum = vector_setzero();
-      vector v_a_hydro_zSum = vector_setzero();
-      vector v_h_dtSum = vector_setzero();
-      vector v_sigSum = vector_set1(pi->force.v_sig);
-      vector v_entropy_dtSum = vector_setzero();
+      vector v_sigSum = vector_set1(pi->viscosity.v_sig);
+      vector v_laplace_uSum = vector_setzero();
+      vector v_alpha_visc_max_ngbSum =
+          vector_set1(pi->force.alpha_visc_max_ngb);
 
       /* Loop over the parts in cj. Making sure to perform an iteration of the
        * loop even if exit_iteration_align is zero and there is only one
@@ -2239,7 +2611,6 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
         const int cj_cache_idx = pjd;
 
         vector v_dx, v_dy, v_dz, v_r2;
-        vector v_hjg2;
 
 #ifdef SWIFT_DEBUG_CHECKS
         if (cj_cache_idx % VEC_SIZE != 0 || cj_cache_idx < 0 ||
@@ -2249,12 +2620,10 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
         }
 #endif
 
-        /* Load 2 sets of vectors from the particle cache. */
+        /* Load 1 set of vectors from the particle cache. */
         const vector v_pjx = vector_load(&cj_cache->x[cj_cache_idx]);
         const vector v_pjy = vector_load(&cj_cache->y[cj_cache_idx]);
         const vector v_pjz = vector_load(&cj_cache->z[cj_cache_idx]);
-        const vector v_hj = vector_load(&cj_cache->h[cj_cache_idx]);
-        v_hjg2.v = vec_mul(vec_mul(v_hj.v, v_hj.v), kernel_gamma2_vec.v);
 
         /* Compute the pairwise distance. */
         v_dx.v = vec_sub(v_pix.v, v_pjx.v);
@@ -2267,10 +2636,8 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
 
         mask_t v_doi_mask;
 
-        /* Form a mask from r2 < hig2 mask and r2 < hjg2 mask. */
-        vector v_h2;
-        v_h2.v = vec_fmax(v_hig2.v, v_hjg2.v);
-        vec_create_mask(v_doi_mask, vec_cmp_lt(v_r2.v, v_h2.v));
+        /* Form r2 < hig2 mask. */
+        vec_create_mask(v_doi_mask, vec_cmp_lt(v_r2.v, v_hig2.v));
 
 #ifdef SWIFT_DEBUG_CHECKS
         /* Verify that we have no inhibited particles in the interaction cache
@@ -2278,52 +2645,38 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
         for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
           if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
             if ((pjd + bit_index < count_j) &&
-                (parts_j[sort_j[pjd + bit_index].i].time_bin >=
+                (parts_j[sort_get_i(sort_j, pjd + bit_index)].time_bin >=
                  time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_j[sort_j[pjd + bit_index].i].id);
+                    parts_j[sort_get_i(sort_j, pjd + bit_index)].id);
             }
           }
         }
 #endif
 
-#ifdef DEBUG_INTERACTIONS_SPH
-        for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
-          if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
-            if (pi->num_ngb_force < MAX_NUM_OF_NEIGHBOURS)
-              pi->ids_ngbs_force[pi->num_ngb_force] =
-                  parts_j[sort_j[pjd + bit_index].i].id;
-            ++pi->num_ngb_force;
-          }
-        }
-#endif
-
         /* If there are any interactions perform them. */
         if (vec_is_mask_true(v_doi_mask)) {
-          vector v_hj_inv = vec_reciprocal(v_hj);
 
-          runner_iact_nonsym_1_vec_force(
-              &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_rhoi,
-              v_grad_hi, v_pOrhoi2, v_balsara_i, v_ci,
+          /* To stop floating point exceptions when particle separations are
+           * 0. */
+          v_r2.v = vec_add(v_r2.v, vec_set1(FLT_MIN));
+
+          runner_iact_nonsym_1_vec_gradient(
+              &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_ui, v_ci,
               &cj_cache->vx[cj_cache_idx], &cj_cache->vy[cj_cache_idx],
-              &cj_cache->vz[cj_cache_idx], &cj_cache->rho[cj_cache_idx],
-              &cj_cache->grad_h[cj_cache_idx], &cj_cache->pOrho2[cj_cache_idx],
-              &cj_cache->balsara[cj_cache_idx],
-              &cj_cache->soundspeed[cj_cache_idx], &cj_cache->m[cj_cache_idx],
-              v_hi_inv, v_hj_inv, a, H, &v_a_hydro_xSum, &v_a_hydro_ySum,
-              &v_a_hydro_zSum, &v_h_dtSum, &v_sigSum, &v_entropy_dtSum,
-              v_doi_mask);
+              &cj_cache->vz[cj_cache_idx], &cj_cache->u[cj_cache_idx],
+              &cj_cache->rho[cj_cache_idx], &cj_cache->soundspeed[cj_cache_idx],
+              &cj_cache->alpha_visc[cj_cache_idx], &cj_cache->m[cj_cache_idx],
+              v_hi_inv, a, H, &v_sigSum, &v_laplace_uSum,
+              &v_alpha_visc_max_ngbSum, v_doi_mask);
         }
 
       } /* loop over the parts in cj. */
 
-      /* Perform horizontal adds on vector sums and store result in pi. */
-      VEC_HADD(v_a_hydro_xSum, pi->a_hydro[0]);
-      VEC_HADD(v_a_hydro_ySum, pi->a_hydro[1]);
-      VEC_HADD(v_a_hydro_zSum, pi->a_hydro[2]);
-      VEC_HADD(v_h_dtSum, pi->force.h_dt);
-      VEC_HMAX(v_sigSum, pi->force.v_sig);
-      VEC_HADD(v_entropy_dtSum, pi->entropy_dt);
+      /* Perform horizontal reductions on vector sums and store result in pi. */
+      VEC_HMAX(v_sigSum, pi->viscosity.v_sig);
+      VEC_HADD(v_laplace_uSum, pi->diffusion.laplace_u);
+      VEC_HMAX(v_alpha_visc_max_ngbSum, pi->force.alpha_visc_max_ngb);
 
     } /* loop over the parts in ci. */
   }
@@ -2334,7 +2687,483 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
     for (int pjd = 0; pjd < last_pj_loop_end; pjd++) {
 
       /* Get a hold of the jth part in cj. */
-      struct part *restrict pj = &parts_j[sort_j[pjd].i];
+      struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
+      if (!part_is_active_no_debug(pj, max_active_bin)) continue;
+
+      /* Set the cache index. */
+      const int cj_cache_idx = pjd;
+
+      /* Skip this particle if no particle in ci is within range of it. */
+      const float hj = cj_cache->h[cj_cache_idx];
+      const double dj_test =
+          sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max;
+      if (dj_test > di_max) continue;
+
+      /* Determine the exit iteration of the interaction loop. */
+      const int exit_iteration = max_index_j[pjd];
+
+      /* Fill particle pj vectors. */
+      const vector v_pjx = vector_set1(cj_cache->x[cj_cache_idx]);
+      const vector v_pjy = vector_set1(cj_cache->y[cj_cache_idx]);
+      const vector v_pjz = vector_set1(cj_cache->z[cj_cache_idx]);
+      const vector v_hj = vector_set1(hj);
+      const vector v_vjx = vector_set1(cj_cache->vx[cj_cache_idx]);
+      const vector v_vjy = vector_set1(cj_cache->vy[cj_cache_idx]);
+      const vector v_vjz = vector_set1(cj_cache->vz[cj_cache_idx]);
+      const vector v_uj = vector_set1(cj_cache->u[cj_cache_idx]);
+      const vector v_cj = vector_set1(cj_cache->soundspeed[cj_cache_idx]);
+
+      const float hjg2 = hj * hj * kernel_gamma2;
+      const vector v_hjg2 = vector_set1(hjg2);
+
+      /* Get the inverse of hj. */
+      const vector v_hj_inv = vec_reciprocal(v_hj);
+
+      /* Reset cumulative sums of update vectors. */
+      vector v_sigSum = vector_set1(pj->viscosity.v_sig);
+      vector v_laplace_uSum = vector_setzero();
+      vector v_alpha_visc_max_ngbSum =
+          vector_set1(pj->force.alpha_visc_max_ngb);
+
+      /* Convert exit iteration to cache indices. */
+      int exit_iteration_align = exit_iteration - first_pi;
+
+      /* Pad the exit iteration align so cache reads are aligned. */
+      const int rem = exit_iteration_align % VEC_SIZE;
+      if (exit_iteration_align < VEC_SIZE) {
+        exit_iteration_align = 0;
+      } else
+        exit_iteration_align -= rem;
+
+      /* Loop over the parts in ci. */
+      for (int ci_cache_idx = exit_iteration_align;
+           ci_cache_idx < ci_cache_count; ci_cache_idx += VEC_SIZE) {
+
+#ifdef SWIFT_DEBUG_CHECKS
+        if (ci_cache_idx % VEC_SIZE != 0 || ci_cache_idx < 0 ||
+            ci_cache_idx + (VEC_SIZE - 1) > (count_i - first_pi + VEC_SIZE)) {
+          error(
+              "Unaligned read!!! ci_cache_idx=%d, first_pi=%d, "
+              "count_i=%d",
+              ci_cache_idx, first_pi, count_i);
+        }
+#endif
+
+        vector v_dx, v_dy, v_dz, v_r2;
+
+        /* Load 1 set of vectors from the particle cache. */
+        const vector v_pix = vector_load(&ci_cache->x[ci_cache_idx]);
+        const vector v_piy = vector_load(&ci_cache->y[ci_cache_idx]);
+        const vector v_piz = vector_load(&ci_cache->z[ci_cache_idx]);
+
+        /* Compute the pairwise distance. */
+        v_dx.v = vec_sub(v_pjx.v, v_pix.v);
+        v_dy.v = vec_sub(v_pjy.v, v_piy.v);
+        v_dz.v = vec_sub(v_pjz.v, v_piz.v);
+
+        v_r2.v = vec_mul(v_dx.v, v_dx.v);
+        v_r2.v = vec_fma(v_dy.v, v_dy.v, v_r2.v);
+        v_r2.v = vec_fma(v_dz.v, v_dz.v, v_r2.v);
+
+        mask_t v_doj_mask;
+
+        /* Form r2 < hjg2 mask. */
+        vec_create_mask(v_doj_mask, vec_cmp_lt(v_r2.v, v_hjg2.v));
+
+#ifdef SWIFT_DEBUG_CHECKS
+        /* Verify that we have no inhibited particles in the interaction cache
+         */
+        for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
+          if (vec_is_mask_true(v_doj_mask) & (1 << bit_index)) {
+            if ((ci_cache_idx + first_pi + bit_index < count_i) &&
+                (parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
+                     .time_bin >= time_bin_inhibited)) {
+              error("Inhibited particle in interaction cache! id=%lld",
+                    parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
+                        .id);
+            }
+          }
+        }
+#endif
+
+        /* If there are any interactions perform them. */
+        if (vec_is_mask_true(v_doj_mask)) {
+
+          /* To stop floating point exceptions when particle separations are
+           * 0. */
+          v_r2.v = vec_add(v_r2.v, vec_set1(FLT_MIN));
+
+          runner_iact_nonsym_1_vec_gradient(
+              &v_r2, &v_dx, &v_dy, &v_dz, v_vjx, v_vjy, v_vjz, v_uj, v_cj,
+              &ci_cache->vx[ci_cache_idx], &ci_cache->vy[ci_cache_idx],
+              &ci_cache->vz[ci_cache_idx], &ci_cache->u[ci_cache_idx],
+              &ci_cache->rho[ci_cache_idx], &ci_cache->soundspeed[ci_cache_idx],
+              &ci_cache->alpha_visc[ci_cache_idx], &ci_cache->m[ci_cache_idx],
+              v_hj_inv, a, H, &v_sigSum, &v_laplace_uSum,
+              &v_alpha_visc_max_ngbSum, v_doj_mask);
+        }
+
+      } /* loop over the parts in ci. */
+
+      /* Perform horizontal reductions on vector sums and store result in pj. */
+      VEC_HMAX(v_sigSum, pj->viscosity.v_sig);
+      VEC_HADD(v_laplace_uSum, pj->diffusion.laplace_u);
+      VEC_HMAX(v_alpha_visc_max_ngbSum, pj->force.alpha_visc_max_ngb);
+
+    } /* loop over the parts in cj. */
+  }
+
+  TIMER_TOC(timer_dopair_gradient);
+
+#else
+
+  error("Incorrectly calling vectorized hydro functions!");
+
+#endif /* WITH_VECTORIZED_HYDRO && SPHENIX_SPH */
+}
+
+/**
+ * @brief Compute the force interactions between a cell pair (non-symmetric)
+ * using vector intrinsics.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
+                              struct cell *cj, const int sid,
+                              const double *shift) {
+
+#ifdef WITH_VECTORIZED_HYDRO
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+  const timebin_t max_active_bin = e->max_active_bin;
+
+  TIMER_TIC;
+
+  /* Check whether cells are local to the node. */
+  const int ci_local = (ci->nodeID == e->nodeID);
+  const int cj_local = (cj->nodeID == e->nodeID);
+
+  /* Get the cutoff shift. */
+  double rshift = 0.0;
+  for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *restrict sort_i = cell_get_hydro_sorts(ci, sid);
+  const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
+
+  /* Get some other useful values. */
+  const int count_i = ci->hydro.count;
+  const int count_j = cj->hydro.count;
+  const double hi_max = ci->hydro.h_max * kernel_gamma;
+  const double hj_max = cj->hydro.h_max * kernel_gamma;
+  const double hi_max_raw = ci->hydro.h_max;
+  const double hj_max_raw = cj->hydro.h_max;
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
+  const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
+  const int active_ci = cell_is_active_hydro(ci, e) && ci_local;
+  const int active_cj = cell_is_active_hydro(cj, e) && cj_local;
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Check that particles have been drifted to the current time */
+  for (int pid = 0; pid < count_i; pid++)
+    if (parts_i[pid].ti_drift != e->ti_current &&
+        !part_is_inhibited(&parts_i[pid], e))
+      error("Particle pi not drifted to current time");
+  for (int pjd = 0; pjd < count_j; pjd++)
+    if (parts_j[pjd].ti_drift != e->ti_current &&
+        !part_is_inhibited(&parts_j[pjd], e))
+      error("Particle pj not drifted to current time");
+#endif
+
+  /* Check if any particles are active and in range */
+  int numActive = 0;
+
+  /* Use the largest smoothing length to make sure that no interactions are
+   * missed. */
+  const double h_max = max(hi_max, hj_max);
+
+  if (active_ci) {
+    for (int pid = count_i - 1;
+         pid >= 0 && sort_get_d(sort_i, pid) + h_max + dx_max > dj_min; pid--) {
+      const struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
+      if (part_is_active_no_debug(pi, max_active_bin)) {
+        numActive++;
+        break;
+      }
+    }
+  }
+
+  if (!numActive && active_cj) {
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - h_max - dx_max < di_max;
+         pjd++) {
+      const struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
+      if (part_is_active_no_debug(pj, max_active_bin)) {
+        numActive++;
+        break;
+      }
+    }
+  }
+
+  /* Return if no active particle in range */
+  if (numActive == 0) return;
+
+  /* Get both particle caches from the runner and re-allocate
+   * them if they are not big enough for the cells. */
+  struct cache *restrict ci_cache = &r->ci_cache;
+  struct cache *restrict cj_cache = &r->cj_cache;
+  if (ci_cache->count < count_i) cache_init(ci_cache, count_i);
+  if (cj_cache->count < count_j) cache_init(cj_cache, count_j);
+
+  /* Get a direct pointer to the index arrays */
+  int first_pi, last_pj;
+  swift_declare_aligned_ptr(int, max_index_i, r->ci_cache.max_index,
+                            SWIFT_CACHE_ALIGNMENT);
+  swift_declare_aligned_ptr(int, max_index_j, r->cj_cache.max_index,
+                            SWIFT_CACHE_ALIGNMENT);
+
+  /* Find particles maximum distance into cj, max_di[] and ci, max_dj[]. */
+  /* Also find the first pi that interacts with any particle in cj and the last
+   * pj that interacts with any particle in ci. */
+  populate_max_index_force(ci, cj, sort_i, sort_j, dx_max, rshift, hi_max_raw,
+                           hj_max_raw, h_max, di_max, dj_min, max_index_i,
+                           max_index_j, &first_pi, &last_pj, max_active_bin,
+                           active_ci, active_cj);
+
+  /* Limits of the outer loops. */
+  const int first_pi_loop = first_pi;
+  const int last_pj_loop_end = last_pj + 1;
+
+  /* Take the max/min of both values calculated to work out how many particles
+   * to read into the cache. */
+  last_pj = max(last_pj, max_index_i[count_i - 1]);
+  first_pi = min(first_pi, max_index_j[0]);
+
+  /* Read the required particles into the two caches. */
+  cache_read_two_partial_cells_sorted_force(ci, cj, ci_cache, cj_cache, sort_i,
+                                            sort_j, shift, &first_pi, &last_pj);
+
+  /* Get the number of particles read into the ci cache. */
+  const int ci_cache_count = count_i - first_pi;
+
+  if (active_ci) {
+
+    /* Loop over the parts in ci until nothing is within range in cj. */
+    for (int pid = count_i - 1; pid >= first_pi_loop; pid--) {
+
+      /* Get a hold of the ith part in ci. */
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
+      if (!part_is_active(pi, e)) continue;
+
+      /* Set the cache index. */
+      const int ci_cache_idx = pid - first_pi;
+
+      /* Skip this particle if no particle in cj is within range of it. */
+      const float hi = ci_cache->h[ci_cache_idx];
+      const double di_test = sort_get_d(sort_i, pid) +
+                             max(hi, hj_max_raw) * kernel_gamma + dx_max -
+                             rshift;
+      if (di_test < dj_min) continue;
+
+      /* Determine the exit iteration of the interaction loop. */
+      const int exit_iteration_end = max_index_i[pid] + 1;
+
+      /* Fill particle pi vectors. */
+      const vector v_pix = vector_set1(ci_cache->x[ci_cache_idx]);
+      const vector v_piy = vector_set1(ci_cache->y[ci_cache_idx]);
+      const vector v_piz = vector_set1(ci_cache->z[ci_cache_idx]);
+      const vector v_hi = vector_set1(hi);
+      const vector v_vix = vector_set1(ci_cache->vx[ci_cache_idx]);
+      const vector v_viy = vector_set1(ci_cache->vy[ci_cache_idx]);
+      const vector v_viz = vector_set1(ci_cache->vz[ci_cache_idx]);
+      const vector v_rhoi = vector_set1(ci_cache->rho[ci_cache_idx]);
+      const vector v_grad_hi = vector_set1(ci_cache->grad_h[ci_cache_idx]);
+      const vector v_balsara_i =
+          vector_set1(half_float_unpack(ci_cache->balsara[ci_cache_idx]));
+      const vector v_ci = vector_set1(ci_cache->soundspeed[ci_cache_idx]);
+#if defined(GADGET2_SPH)
+      const vector v_pOrhoi2 = vector_set1(ci_cache->pOrho2[ci_cache_idx]);
+#elif defined(SPHENIX_SPH)
+      const vector v_pressure_i =
+          vector_set1(ci_cache->pressure[ci_cache_idx]);
+      const vector v_alpha_visc_i =
+          vector_set1(half_float_unpack(ci_cache->alpha_visc[ci_cache_idx]));
+      const vector v_alpha_diff_i =
+          vector_set1(half_float_unpack(ci_cache->alpha_diff[ci_cache_idx]));
+      const vector v_ui = vector_set1(ci_cache->u[ci_cache_idx]);
+      const vector v_mi = vector_set1(ci_cache->m[ci_cache_idx]);
+#endif
+
+      const float hig2 = hi * hi * kernel_gamma2;
+      const vector v_hig2 = vector_set1(hig2);
+
+      /* Get the inverse of hi. */
+      vector v_hi_inv = vec_reciprocal(v_hi);
+
+      /* Reset cumulative sums of update vectors. */
+      vector v_a_hydro_xSum = vector_setzero();
+      vector v_a_hydro_ySum = vector_setzero();
+      vector v_a_hydro_zSum = vector_setzero();
+      vector v_h_dtSum = vector_setzero();
+#if defined(GADGET2_SPH)
+      vector v_sigSum = vector_set1(pi->force.v_sig);
+      vector v_entropy_dtSum = vector_setzero();
+#elif defined(SPHENIX_SPH)
+      vector v_u_dtSum = vector_setzero();
+      vector v_min_ngb_time_binSum =
+          vector_set1(pi->limiter_data.min_ngb_time_bin);
+#endif
+
+      /* Loop over the parts in cj. Making sure to perform an iteration of the
+       * loop even if exit_iteration_align is zero and there is only one
+       * particle to interact with.*/
+      for (int pjd = 0; pjd < exit_iteration_end; pjd += VEC_SIZE) {
+
+        /* Get the cache index to the jth particle. */
+        const int cj_cache_idx = pjd;
+
+        vector v_dx, v_dy, v_dz, v_r2;
+        vector v_hjg2;
+
+#ifdef SWIFT_DEBUG_CHECKS
+        if (cj_cache_idx % VEC_SIZE != 0 || cj_cache_idx < 0 ||
+            cj_cache_idx + (VEC_SIZE - 1) > (last_pj + 1 + VEC_SIZE)) {
+          error("Unaligned read!!! cj_cache_idx=%d, last_pj=%d", cj_cache_idx,
+                last_pj);
+        }
+#endif
+
+        /* Load 2 sets of vectors from the particle cache. */
+        const vector v_pjx = vector_load(&cj_cache->x[cj_cache_idx]);
+        const vector v_pjy = vector_load(&cj_cache->y[cj_cache_idx]);
+        const vector v_pjz = vector_load(&cj_cache->z[cj_cache_idx]);
+        const vector v_hj = vector_load(&cj_cache->h[cj_cache_idx]);
+        v_hjg2.v = vec_mul(vec_mul(v_hj.v, v_hj.v), kernel_gamma2_vec.v);
+
+        /* Compute the pairwise distance. */
+        v_dx.v = vec_sub(v_pix.v, v_pjx.v);
+        v_dy.v = vec_sub(v_piy.v, v_pjy.v);
+        v_dz.v = vec_sub(v_piz.v, v_pjz.v);
+
+        v_r2.v = vec_mul(v_dx.v, v_dx.v);
+        v_r2.v = vec_fma(v_dy.v, v_dy.v, v_r2.v);
+        v_r2.v = vec_fma(v_dz.v, v_dz.v, v_r2.v);
+
+        mask_t v_doi_mask;
+
+        /* Form a mask from r2 < hig2 mask and r2 < hjg2 mask. */
+        vector v_h2;
+        v_h2.v = vec_fmax(v_hig2.v, v_hjg2.v);
+        vec_create_mask(v_doi_mask, vec_cmp_lt(v_r2.v, v_h2.v));
+
+#ifdef SWIFT_DEBUG_CHECKS
+        /* Verify that we have no inhibited particles in the interaction cache
+         */
+        for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
+          if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
+            if ((pjd + bit_index < count_j) &&
+                (parts_j[sort_get_i(sort_j, pjd + bit_index)].time_bin >=
+                 time_bin_inhibited)) {
+              error("Inhibited particle in interaction cache! id=%lld",
+                    parts_j[sort_get_i(sort_j, pjd + bit_index)].id);
+            }
+          }
+        }
+#endif
+
+#ifdef DEBUG_INTERACTIONS_SPH
+        for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
+          if (vec_is_mask_true(v_doi_mask) & (1 << bit_index)) {
+            if (pi->num_ngb_force < MAX_NUM_OF_NEIGHBOURS)
+              pi->ids_ngbs_force[pi->num_ngb_force] =
+                  parts_j[sort_get_i(sort_j, pjd + bit_index)].id;
+            ++pi->num_ngb_force;
+          }
+        }
+#endif
+
+        /* If there are any interactions perform them. */
+        if (vec_is_mask_true(v_doi_mask)) {
+          vector v_hj_inv = vec_reciprocal(v_hj);
+
+          /* Sub-grid terms. */
+          runner_vec_force_subgrid(e, vec_is_mask_true(v_doi_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pi, parts_j, sort_j,
+                                   pjd, count_j);
+
+#if defined(GADGET2_SPH)
+          runner_iact_nonsym_1_vec_force(
+              &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_rhoi,
+              v_grad_hi, v_pOrhoi2, v_balsara_i, v_ci,
+              &cj_cache->vx[cj_cache_idx], &cj_cache->vy[cj_cache_idx],
+              &cj_cache->vz[cj_cache_idx], &cj_cache->rho[cj_cache_idx],
+              &cj_cache->grad_h[cj_cache_idx], &cj_cache->pOrho2[cj_cache_idx],
+              &cj_cache->balsara[cj_cache_idx],
+              &cj_cache->soundspeed[cj_cache_idx], &cj_cache->m[cj_cache_idx],
+              v_hi_inv, v_hj_inv, a, H, &v_a_hydro_xSum, &v_a_hydro_ySum,
+              &v_a_hydro_zSum, &v_h_dtSum, &v_sigSum, &v_entropy_dtSum,
+              v_doi_mask);
+#elif defined(SPHENIX_SPH)
+          runner_iact_nonsym_1_vec_force(
+              &v_r2, &v_dx, &v_dy, &v_dz, v_vix, v_viy, v_viz, v_rhoi,
+              v_grad_hi, v_pressure_i, v_balsara_i, v_ci, v_alpha_visc_i,
+              v_alpha_diff_i, v_ui, v_mi, &cj_cache->vx[cj_cache_idx],
+              &cj_cache->vy[cj_cache_idx], &cj_cache->vz[cj_cache_idx],
+              &cj_cache->rho[cj_cache_idx], &cj_cache->grad_h[cj_cache_idx],
+              &cj_cache->pressure[cj_cache_idx],
+              &cj_cache->balsara[cj_cache_idx],
+              &cj_cache->soundspeed[cj_cache_idx],
+              &cj_cache->alpha_visc[cj_cache_idx],
+              &cj_cache->alpha_diff[cj_cache_idx], &cj_cache->u[cj_cache_idx],
+              &cj_cache->m[cj_cache_idx], &cj_cache->time_bin[cj_cache_idx],
+              v_hi_inv, v_hj_inv, a, H, &v_a_hydro_xSum, &v_a_hydro_ySum,
+              &v_a_hydro_zSum, &v_h_dtSum, &v_u_dtSum, &v_min_ngb_time_binSum,
+              v_doi_mask);
+#endif
+        }
+
+      } /* loop over the parts in cj. */
+
+      /* Perform horizontal adds on vector sums and store result in pi. */
+      VEC_HADD(v_a_hydro_xSum, pi->a_hydro[0]);
+      VEC_HADD(v_a_hydro_ySum, pi->a_hydro[1]);
+      VEC_HADD(v_a_hydro_zSum, pi->a_hydro[2]);
+      VEC_HADD(v_h_dtSum, pi->force.h_dt);
+#if defined(GADGET2_SPH)
+      VEC_HMAX(v_sigSum, pi->force.v_sig);
+      VEC_HADD(v_entropy_dtSum, pi->entropy_dt);
+#elif defined(SPHENIX_SPH)
+      VEC_HADD(v_u_dtSum, pi->u_dt);
+
+      float min_ngb_time_bin = pi->limiter_data.min_ngb_time_bin;
+      VEC_HMIN(v_min_ngb_time_binSum, min_ngb_time_bin);
+      pi->limiter_data.min_ngb_time_bin = (timebin_t)min_ngb_time_bin;
+#endif
+
+    } /* loop over the parts in ci. */
+  }
+
+  if (active_cj) {
+
+    /* Loop over the parts in cj until nothing is within range in ci. */
+    for (int pjd = 0; pjd < last_pj_loop_end; pjd++) {
+
+      /* Get a hold of the jth part in cj. */
+      struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
       if (!part_is_active(pj, e)) continue;
 
       /* Set the cache index. */
@@ -2343,7 +3172,7 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       /* Skip this particle if no particle in ci is within range of it. */
       const float hj = cj_cache->h[cj_cache_idx];
       const double dj_test =
-          sort_j[pjd].d - max(hj, hi_max_raw) * kernel_gamma - dx_max;
+          sort_get_d(sort_j, pjd) - max(hj, hi_max_raw) * kernel_gamma - dx_max;
       if (dj_test > di_max) continue;
 
       /* Determine the exit iteration of the interaction loop. */
@@ -2359,9 +3188,21 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       const vector v_vjz = vector_set1(cj_cache->vz[cj_cache_idx]);
       const vector v_rhoj = vector_set1(cj_cache->rho[cj_cache_idx]);
       const vector v_grad_hj = vector_set1(cj_cache->grad_h[cj_cache_idx]);
-      const vector v_pOrhoj2 = vector_set1(cj_cache->pOrho2[cj_cache_idx]);
-      const vector v_balsara_j = vector_set1(cj_cache->balsara[cj_cache_idx]);
+      const vector v_balsara_j =
+          vector_set1(half_float_unpack(cj_cache->balsara[cj_cache_idx]));
       const vector v_cj = vector_set1(cj_cache->soundspeed[cj_cache_idx]);
+#if defined(GADGET2_SPH)
+      const vector v_pOrhoj2 = vector_set1(cj_cache->pOrho2[cj_cache_idx]);
+#elif defined(SPHENIX_SPH)
+      const vector v_pressure_j =
+          vector_set1(cj_cache->pressure[cj_cache_idx]);
+      const vector v_alpha_visc_j =
+          vector_set1(half_float_unpack(cj_cache->alpha_visc[cj_cache_idx]));
+      const vector v_alpha_diff_j =
+          vector_set1(half_float_unpack(cj_cache->alpha_diff[cj_cache_idx]));
+      const vector v_uj = vector_set1(cj_cache->u[cj_cache_idx]);
+      const vector v_mj = vector_set1(cj_cache->m[cj_cache_idx]);
+#endif
 
       const float hjg2 = hj * hj * kernel_gamma2;
       const vector v_hjg2 = vector_set1(hjg2);
@@ -2374,8 +3215,14 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       vector v_a_hydro_ySum = vector_setzero();
       vector v_a_hydro_zSum = vector_setzero();
       vector v_h_dtSum = vector_setzero();
+#if defined(GADGET2_SPH)
       vector v_sigSum = vector_set1(pj->force.v_sig);
       vector v_entropy_dtSum = vector_setzero();
+#elif defined(SPHENIX_SPH)
+      vector v_u_dtSum = vector_setzero();
+      vector v_min_ngb_time_binSum =
+          vector_set1(pj->limiter_data.min_ngb_time_bin);
+#endif
 
       /* Convert exit iteration to cache indices. */
       int exit_iteration_align = exit_iteration - first_pi;
@@ -2429,10 +3276,13 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
         for (int bit_index = 0; bit_index < VEC_SIZE; bit_index++) {
           if (vec_is_mask_true(v_doj_mask) & (1 << bit_index)) {
             if ((ci_cache_idx + first_pi + bit_index < count_i) &&
-                (parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i]
+                (parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
                      .time_bin >= time_bin_inhibited)) {
               error("Inhibited particle in interaction cache! id=%lld",
-                    parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i].id);
+                    parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                   bit_index)]
+                        .id);
             }
           }
         }
@@ -2443,7 +3293,9 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
           if (vec_is_mask_true(v_doj_mask) & (1 << bit_index)) {
             if (pj->num_ngb_force < MAX_NUM_OF_NEIGHBOURS)
               pj->ids_ngbs_force[pj->num_ngb_force] =
-                  parts_i[sort_i[ci_cache_idx + first_pi + bit_index].i].id;
+                  parts_i[sort_get_i(sort_i, ci_cache_idx + first_pi +
+                                                 bit_index)]
+                      .id;
             ++pj->num_ngb_force;
           }
         }
@@ -2453,6 +3305,12 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
         if (vec_is_mask_true(v_doj_mask)) {
           vector v_hi_inv = vec_reciprocal(v_hi);
 
+          /* Sub-grid terms. */
+          runner_vec_force_subgrid(e, vec_is_mask_true(v_doj_mask), &v_r2,
+                                   &v_dx, &v_dy, &v_dz, pj, parts_i, sort_i,
+                                   ci_cache_idx + first_pi, count_i);
+
+#if defined(GADGET2_SPH)
           runner_iact_nonsym_1_vec_force(
               &v_r2, &v_dx, &v_dy, &v_dz, v_vjx, v_vjy, v_vjz, v_rhoj,
               v_grad_hj, v_pOrhoj2, v_balsara_j, v_cj,
@@ -2464,6 +3322,23 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
               v_hj_inv, v_hi_inv, a, H, &v_a_hydro_xSum, &v_a_hydro_ySum,
               &v_a_hydro_zSum, &v_h_dtSum, &v_sigSum, &v_entropy_dtSum,
               v_doj_mask);
+#elif defined(SPHENIX_SPH)
+          runner_iact_nonsym_1_vec_force(
+              &v_r2, &v_dx, &v_dy, &v_dz, v_vjx, v_vjy, v_vjz, v_rhoj,
+              v_grad_hj, v_pressure_j, v_balsara_j, v_cj, v_alpha_visc_j,
+              v_alpha_diff_j, v_uj, v_mj, &ci_cache->vx[ci_cache_idx],
+              &ci_cache->vy[ci_cache_idx], &ci_cache->vz[ci_cache_idx],
+              &ci_cache->rho[ci_cache_idx], &ci_cache->grad_h[ci_cache_idx],
+              &ci_cache->pressure[ci_cache_idx],
+              &ci_cache->balsara[ci_cache_idx],
+              &ci_cache->soundspeed[ci_cache_idx],
+              &ci_cache->alpha_visc[ci_cache_idx],
+              &ci_cache->alpha_diff[ci_cache_idx], &ci_cache->u[ci_cache_idx],
+              &ci_cache->m[ci_cache_idx], &ci_cache->time_bin[ci_cache_idx],
+              v_hj_inv, v_hi_inv, a, H, &v_a_hydro_xSum, &v_a_hydro_ySum,
+              &v_a_hydro_zSum, &v_h_dtSum, &v_u_dtSum, &v_min_ngb_time_binSum,
+              v_doj_mask);
+#endif
         }
       } /* loop over the parts in ci. */
 
@@ -2472,8 +3347,16 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
       VEC_HADD(v_a_hydro_ySum, pj->a_hydro[1]);
       VEC_HADD(v_a_hydro_zSum, pj->a_hydro[2]);
       VEC_HADD(v_h_dtSum, pj->force.h_dt);
+#if defined(GADGET2_SPH)
       VEC_HMAX(v_sigSum, pj->force.v_sig);
       VEC_HADD(v_entropy_dtSum, pj->entropy_dt);
+#elif defined(SPHENIX_SPH)
+      VEC_HADD(v_u_dtSum, pj->u_dt);
+
+      float min_ngb_time_bin = pj->limiter_data.min_ngb_time_bin;
+      VEC_HMIN(v_min_ngb_time_binSum, min_ngb_time_bin);
+      pj->limiter_data.min_ngb_time_bin = (timebin_t)min_ngb_time_bin;
+#endif
 
     } /* loop over the parts in cj. */
 
@@ -2482,7 +3365,7 @@ void runner_dopair2_force_vec(struct runner *r, struct cell *ci,
 
 #else
 
-  error("Incorrectly calling vectorized Gadget-2 functions!");
+  error("Incorrectly calling vectorized hydro functions!");
 
-#endif /* WITH_VECTORIZATION */
+#endif /* WITH_VECTORIZED_HYDRO */
 }
@@ -33,6 +33,18 @@
 #include "timers.h"
 #include "vector.h"
 
+/* Do we have vectorized interaction loops for this flavour of SPH? The
+ * SPHENIX ones include neither the MHD terms nor the debugging counters. The
+ * sub-grid terms are added by calling the scalar interactions for the lanes
+ * that interact. */
+#if defined(WITH_VECTORIZATION) &&                 \
+    (defined(GADGET2_SPH) ||                       \
+     (defined(SPHENIX_SPH) && defined(NONE_MHD) && \
+      !defined(SWIFT_HYDRO_DENSITY_CHECKS) &&      \
+      !defined(DEBUG_INTERACTIONS_SPH)))
+#define WITH_VECTORIZED_HYDRO
+#endif
+
 /* Function prototypes. */
 void runner_doself_subset_density_vec(struct runner *r,
                                       struct cell *restrict ci,
@@ -49,6 +61,10 @@ void runner_dopair_subset_density_vec(struct runner *r,
 void runner_dopair1_density_vec(struct runner *r, struct cell *restrict ci,
                                 struct cell *restrict cj, const int sid,
                                 const double *shift);
+void runner_doself1_gradient_vec(struct runner *r, struct cell *restrict c);
+void runner_dopair1_gradient_vec(struct runner *r, struct cell *restrict ci,
+                                 struct cell *restrict cj, const int sid,
+                                 const double *shift);
 void runner_dopair2_force_vec(struct runner *r, struct cell *restrict ci,
                               struct cell *restrict cj, const int sid,
                               const double *shift);
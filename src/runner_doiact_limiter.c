@@ -27,6 +27,7 @@
 #include "cell.h"
 #include "engine.h"
 #include "runner.h"
+#include "runner_doiact_limiter_vec.h"
 #include "space_getsid.h"
 #include "timers.h"
 #include "timestep_limiter_iact.h"
@@ -0,0 +1,399 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* This object's header. */
+#include "runner_doiact_limiter_vec.h"
+
+/* Local headers. */
+#include "active.h"
+#include "engine.h"
+#include "kernel_hydro.h"
+#include "limiter_cache.h"
+#include "timers.h"
+#include "timestep_limiter_iact.h"
+#include "vector.h"
+
+#ifdef WITH_VECTORIZED_LIMITER
+
+/**
+ * @brief Finds the first entry of a sorted list further along the axis than
+ * a given distance.
+ *
+ * @param sort The sorted list.
+ * @param count The number of entries in the list.
+ * @param d The distance.
+ */
+static INLINE int runner_limiter_sort_search(
+    const struct sort_entry *restrict sort, const int count, const double d) {
+
+  int lo = 0, hi = count;
+  while (lo < hi) {
+    const int mid = (lo + hi) / 2;
+    if (sort_get_d(sort, mid) > d)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+/**
+ * @brief Finds which of VEC_SIZE particles of a #limiter_cache are within the
+ * kernel of a particle pi and on a time-bin large enough to need waking up.
+ *
+ * @param c The #limiter_cache.
+ * @param pjd The index in the cache of the first particle.
+ * @param v_pix #vector of the x position of pi.
+ * @param v_piy #vector of the y position of pi.
+ * @param v_piz #vector of the z position of pi.
+ * @param v_hig2 #vector of the square of the kernel support of pi.
+ * @param v_wake_bin #vector of the time-bin above which to wake particles up.
+ * @param v_dx (return) #vector of the x separations.
+ * @param v_dy (return) #vector of the y separations.
+ * @param v_dz (return) #vector of the z separations.
+ * @param v_r2 (return) #vector of the square distances.
+ * @return The bit mask of the particles to wake up.
+ */
+__attribute__((always_inline)) INLINE static int runner_limiter_vec_hits(
+    const struct limiter_cache *restrict c, const int pjd, const vector v_pix,
+    const vector v_piy, const vector v_piz, const vector v_hig2,
+    const vector v_wake_bin, vector *v_dx, vector *v_dy, vector *v_dz,
+    vector *v_r2) {
+
+  /* Load 1 set of vectors from the particle cache. */
+  const vector v_pjx = vector_load(&c->x[pjd]);
+  const vector v_pjy = vector_load(&c->y[pjd]);
+  const vector v_pjz = vector_load(&c->z[pjd]);
+  const vector v_time_bin = vector_load(&c->time_bin[pjd]);
+
+  /* Compute the pairwise distance. */
+  v_dx->v = vec_sub(v_pix.v, v_pjx.v);
+  v_dy->v = vec_sub(v_piy.v, v_pjy.v);
+  v_dz->v = vec_sub(v_piz.v, v_pjz.v);
+
+  v_r2->v = vec_mul(v_dx->v, v_dx->v);
+  v_r2->v = vec_fma(v_dy->v, v_dy->v, v_r2->v);
+  v_r2->v = vec_fma(v_dz->v, v_dz->v, v_r2->v);
+
+  /* Form the r2 < hig2 and time-bin masks and combine them. */
+  mask_t v_doi_mask, v_bin_mask;
+  vec_create_mask(v_doi_mask, vec_cmp_lt(v_r2->v, v_hig2.v));
+  vec_create_mask(v_bin_mask, vec_cmp_gt(v_time_bin.v, v_wake_bin.v));
+  vec_combine_masks(v_doi_mask, v_bin_mask);
+
+  return vec_is_mask_true(v_doi_mask);
+}
+
+#endif /* WITH_VECTORIZED_LIMITER */
+
+/**
+ * @brief Compute the time-step limiter cell self-interaction (non-symmetric)
+ * using vector intrinsics with one particle pi at a time.
+ *
+ * Only the positions, smoothing lengths and time-bins are read in the
+ * #limiter_cache and the neighbours are screened VEC_SIZE at a time. The few
+ * that need waking up are then interacted with one by one. As in the scalar
+ * loop, two starting particles within each other's kernel are left alone.
+ *
+ * @param r The #runner.
+ * @param c The #cell.
+ */
+void runner_doself1_limiter_vec(struct runner *r, struct cell *restrict c) {
+
+#ifdef WITH_VECTORIZED_LIMITER
+
+  const struct engine *e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+  const timebin_t max_active_bin = e->max_active_bin;
+  struct part *restrict parts = c->hydro.parts;
+  const int count = c->hydro.count;
+
+  TIMER_TIC;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  for (int i = 0; i < count; i++) {
+    /* Check that particles have been drifted to the current time */
+    if (parts[i].ti_drift != e->ti_current && !part_is_inhibited(&parts[i], e))
+      error("Particle pi not drifted to current time");
+  }
+#endif
+
+  /* Get the particle cache from the runner and re-allocate
+   * the cache if it is not big enough for the cell. */
+  struct limiter_cache *restrict cell_cache = &r->ci_limiter_cache;
+  if (cell_cache->count < count) limiter_cache_init(cell_cache, count);
+
+  /* Read the particles from the cell and store them locally in the cache. */
+  const int count_align =
+      limiter_cache_read_particles(c, cell_cache, NULL, 0, count, c->loc);
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+  /* Loop over the particles in the cell. */
+  for (int pid = 0; pid < count; pid++) {
+
+    /* Get a pointer to the ith particle. */
+    struct part *restrict pi = &parts[pid];
+
+    /* Is the i^th particle starting its time-step? */
+    if (!part_is_starting(pi, e)) continue;
+
+    /* Fill particle pi vectors. */
+    const vector v_pix = vector_set1(cell_cache->x[pid]);
+    const vector v_piy = vector_set1(cell_cache->y[pid]);
+    const vector v_piz = vector_set1(cell_cache->z[pid]);
+    const float hi = cell_cache->h[pid];
+    const vector v_hig2 = vector_set1(hi * hi * kernel_gamma2);
+    const vector v_wake_bin =
+        vector_set1(pi->time_bin + time_bin_neighbour_max_delta_bin);
+
+    /* Find all of particle pi's neighbours to wake up. */
+    for (int pjd = 0; pjd < count_align; pjd += VEC_SIZE) {
+
+      vector v_dx, v_dy, v_dz, v_r2;
+      const int hits =
+          runner_limiter_vec_hits(cell_cache, pjd, v_pix, v_piy, v_piz, v_hig2,
+                                  v_wake_bin, &v_dx, &v_dy, &v_dz, &v_r2);
+      if (!hits) continue;
+
+      for (int k = 0; k < VEC_SIZE; k++) {
+        if (!(hits & (1 << k)) || pjd + k == pid) continue;
+
+        struct part *restrict pj = &parts[pjd + k];
+        const float hj = cell_cache->h[pjd + k];
+
+        /* Leave starting neighbours that have pi within their kernel. */
+        if (pj->time_bin <= max_active_bin &&
+            v_r2.f[k] < hj * hj * kernel_gamma2)
+          continue;
+
+        const float dx[3] = {v_dx.f[k], v_dy.f[k], v_dz.f[k]};
+        runner_iact_nonsym_limiter(v_r2.f[k], dx, hi, hj, pi, pj, a, H);
+      }
+    } /* Loop over all other particles. */
+  }   /* Loop over all particles. */
+
+  TIMER_TOC(timer_doself_limiter);
+
+#else
+
+  error("Incorrectly calling vectorized limiter functions!");
+
+#endif /* WITH_VECTORIZED_LIMITER */
+}
+
+/**
+ * @brief Compute the time-step limiter interactions between a cell pair
+ * (non-symmetric) using vector intrinsics with one particle pi at a time.
+ *
+ * The particles of the cell on the other side of the pair are read in the
+ * #limiter_cache in sorted order, so that the ones possibly in range of pi
+ * are a contiguous range of it.
+ *
+ * @param r The #runner.
+ * @param ci The first #cell.
+ * @param cj The second #cell.
+ * @param sid The direction of the pair.
+ * @param shift The shift vector to apply to the particles in ci.
+ */
+void runner_dopair1_limiter_vec(struct runner *r, struct cell *restrict ci,
+                                struct cell *restrict cj, const int sid,
+                                const double *shift) {
+
+#ifdef WITH_VECTORIZED_LIMITER
+
+  const struct engine *restrict e = r->e;
+  const struct cosmology *restrict cosmo = e->cosmology;
+
+  TIMER_TIC;
+
+  /* Get the cutoff shift. */
+  double rshift = 0.0;
+  for (int k = 0; k < 3; k++) rshift += shift[k] * runner_shift[sid][k];
+
+  /* Pick-out the sorted lists. */
+  const struct sort_entry *restrict sort_i = cell_get_hydro_sorts(ci, sid);
+  const struct sort_entry *restrict sort_j = cell_get_hydro_sorts(cj, sid);
+
+  /* Get some other useful values. */
+  const double hi_max = ci->hydro.h_max * kernel_gamma - rshift;
+  const double hj_max = cj->hydro.h_max * kernel_gamma;
+  const int count_i = ci->hydro.count;
+  const int count_j = cj->hydro.count;
+  struct part *restrict parts_i = ci->hydro.parts;
+  struct part *restrict parts_j = cj->hydro.parts;
+  const double di_max = sort_get_d(sort_i, count_i - 1) - rshift;
+  const double dj_min = sort_get_d(sort_j, 0);
+  const float dx_max = (ci->hydro.dx_max_sort + cj->hydro.dx_max_sort);
+
+  /* Both cells are read in the frame of cj. */
+  const double loc_i[3] = {cj->loc[0] + shift[0], cj->loc[1] + shift[1],
+                           cj->loc[2] + shift[2]};
+
+  /* Cosmological terms */
+  const float a = cosmo->a;
+  const float H = cosmo->H;
+
+#ifdef SWIFT_DEBUG_CHECKS
+  /* Check that particles have been drifted to the current time */
+  for (int pid = 0; pid < count_i; pid++)
+    if (parts_i[pid].ti_drift != e->ti_current &&
+        !part_is_inhibited(&parts_i[pid], e))
+      error("Particle pi not drifted to current time");
+  for (int pjd = 0; pjd < count_j; pjd++)
+    if (parts_j[pjd].ti_drift != e->ti_current &&
+        !part_is_inhibited(&parts_j[pjd], e))
+      error("Particle pj not drifted to current time");
+#endif
+
+  if (cell_is_starting_hydro(ci, e)) {
+
+    /* Read the particles of cj that can be in range in sorted order. The
+     * bound is computed as the one of each pi below to be an upper bound. */
+    const double di_reach = sort_get_d(sort_i, count_i - 1) +
+                            ci->hydro.h_max * kernel_gamma + dx_max - rshift;
+    const int last_j = runner_limiter_sort_search(sort_j, count_j, di_reach);
+    struct limiter_cache *restrict cj_cache = &r->cj_limiter_cache;
+    if (cj_cache->count < count_j) limiter_cache_init(cj_cache, count_j);
+    limiter_cache_read_particles(cj, cj_cache, sort_j, 0, last_j, cj->loc);
+
+    /* Loop over the parts in ci. */
+    for (int pid = count_i - 1;
+         pid >= 0 && sort_get_d(sort_i, pid) + hi_max + dx_max > dj_min;
+         pid--) {
+
+      /* Get a hold of the ith part in ci. */
+      struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid)];
+
+      /* Skip inactive particles */
+      if (!part_is_starting(pi, e)) continue;
+
+      /* Is there anything we need to interact with ? */
+      const float hi = pi->h;
+      const double di =
+          sort_get_d(sort_i, pid) + hi * kernel_gamma + dx_max - rshift;
+      if (di < dj_min) continue;
+
+      /* The particles of cj that can be in range. */
+      const int exit_j = runner_limiter_sort_search(sort_j, count_j, di);
+
+      /* Fill particle pi vectors. */
+      const vector v_pix = vector_set1(pi->x[0] - loc_i[0]);
+      const vector v_piy = vector_set1(pi->x[1] - loc_i[1]);
+      const vector v_piz = vector_set1(pi->x[2] - loc_i[2]);
+      const vector v_hig2 = vector_set1(hi * hi * kernel_gamma2);
+      const vector v_wake_bin =
+          vector_set1(pi->time_bin + time_bin_neighbour_max_delta_bin);
+
+      /* Loop over the parts in cj. */
+      for (int pjd = 0; pjd < exit_j; pjd += VEC_SIZE) {
+
+        vector v_dx, v_dy, v_dz, v_r2;
+        const int hits =
+            runner_limiter_vec_hits(cj_cache, pjd, v_pix, v_piy, v_piz, v_hig2,
+                                    v_wake_bin, &v_dx, &v_dy, &v_dz, &v_r2);
+        if (!hits) continue;
+
+        for (int k = 0; k < VEC_SIZE; k++) {
+          if (!(hits & (1 << k))) continue;
+
+          struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd + k)];
+          const float dx[3] = {v_dx.f[k], v_dy.f[k], v_dz.f[k]};
+          runner_iact_nonsym_limiter(v_r2.f[k], dx, hi, cj_cache->h[pjd + k],
+                                     pi, pj, a, H);
+        }
+      } /* loop over the parts in cj. */
+    }   /* loop over the parts in ci. */
+  }     /* Cell ci is active */
+
+  if (cell_is_starting_hydro(cj, e)) {
+
+    /* Read the particles of ci that can be in range in sorted order, from
+     * the start of a vector. */
+    const int first_i = runner_limiter_sort_search(
+        sort_i, count_i, dj_min - hj_max - dx_max + rshift);
+    struct limiter_cache *restrict ci_cache = &r->ci_limiter_cache;
+    if (ci_cache->count < count_i) limiter_cache_init(ci_cache, count_i);
+    const int count_align_i = limiter_cache_read_particles(
+        ci, ci_cache, sort_i, first_i - first_i % VEC_SIZE, count_i, loc_i);
+
+    /* Loop over the parts in cj. */
+    for (int pjd = 0;
+         pjd < count_j && sort_get_d(sort_j, pjd) - hj_max - dx_max < di_max;
+         pjd++) {
+
+      /* Get a hold of the jth part in cj. */
+      struct part *restrict pj = &parts_j[sort_get_i(sort_j, pjd)];
+
+      /* Skip inactive particles */
+      if (!part_is_starting(pj, e)) continue;
+
+      /* Is there anything we need to interact with ? */
+      const float hj = pj->h;
+      const double dj =
+          sort_get_d(sort_j, pjd) - hj * kernel_gamma - dx_max + rshift;
+      if (dj - rshift > di_max) continue;
+
+      /* The particles of ci that can be in range, from the start of a
+       * vector. */
+      const int entry_i = runner_limiter_sort_search(sort_i, count_i, dj);
+
+      /* Fill particle pj vectors. */
+      const vector v_pjx = vector_set1(pj->x[0] - cj->loc[0]);
+      const vector v_pjy = vector_set1(pj->x[1] - cj->loc[1]);
+      const vector v_pjz = vector_set1(pj->x[2] - cj->loc[2]);
+      const vector v_hjg2 = vector_set1(hj * hj * kernel_gamma2);
+      const vector v_wake_bin =
+          vector_set1(pj->time_bin + time_bin_neighbour_max_delta_bin);
+
+      /* Loop over the parts in ci. */
+      for (int pid = entry_i - entry_i % VEC_SIZE; pid < count_align_i;
+           pid += VEC_SIZE) {
+
+        vector v_dx, v_dy, v_dz, v_r2;
+        const int hits =
+            runner_limiter_vec_hits(ci_cache, pid, v_pjx, v_pjy, v_pjz, v_hjg2,
+                                    v_wake_bin, &v_dx, &v_dy, &v_dz, &v_r2);
+        if (!hits) continue;
+
+        for (int k = 0; k < VEC_SIZE; k++) {
+          if (!(hits & (1 << k))) continue;
+
+          struct part *restrict pi = &parts_i[sort_get_i(sort_i, pid + k)];
+          const float dx[3] = {v_dx.f[k], v_dy.f[k], v_dz.f[k]};
+          runner_iact_nonsym_limiter(v_r2.f[k], dx, hj, ci_cache->h[pid + k],
+                                     pj, pi, a, H);
+        }
+      } /* loop over the parts in ci. */
+    }   /* loop over the parts in cj. */
+  }     /* Cell cj is active */
+
+  TIMER_TOC(timer_dopair_limiter);
+
+#else
+
+  error("Incorrectly calling vectorized limiter functions!");
+
+#endif /* WITH_VECTORIZED_LIMITER */
+}
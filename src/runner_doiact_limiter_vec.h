@@ -0,0 +1,45 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+#ifndef SWIFT_RUNNER_DOIACT_LIMITER_VEC_H
+#define SWIFT_RUNNER_DOIACT_LIMITER_VEC_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Local headers */
+#include "cell.h"
+#include "runner.h"
+
+/* Do we have vectorized time-step limiter loops? They only read the
+ * positions, smoothing lengths and time-bins of the particles in their own
+ * #limiter_cache, so do not depend on the hydro scheme. They only interact
+ * the pairs that need waking up, so do not count the neighbours of the
+ * density checks. */
+#if defined(WITH_VECTORIZATION) && !defined(SWIFT_HYDRO_DENSITY_CHECKS)
+#define WITH_VECTORIZED_LIMITER
+#endif
+
+/* Function prototypes. */
+void runner_doself1_limiter_vec(struct runner *r, struct cell *restrict c);
+void runner_dopair1_limiter_vec(struct runner *r, struct cell *restrict ci,
+                                struct cell *restrict cj, const int sid,
+                                const double *shift);
+
+#endif /* SWIFT_RUNNER_DOIACT_LIMITER_VEC_H */
@@ -31,6 +31,10 @@
 #undef IACT_BH_GAS
 #undef IACT_BH_BH
 #undef GET_MU0
+#undef IACT_BATCH
+#undef IACT_NONSYM_BATCH
+#undef DECLARE_FLUX_BATCH
+#undef FLUSH_FLUX_BATCH
 #undef FUNCTION
 #undef FUNCTION_TASK_LOOP
 
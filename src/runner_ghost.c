@@ -31,6 +31,7 @@
 #include "cell.h"
 #include "engine.h"
 #include "feedback.h"
+#include "ghost_ngb_list.h"
 #include "mhd.h"
 #include "pressure_floor.h"
 #include "pressure_floor_iact.h"
@@ -1073,6 +1074,129 @@ void runner_do_extra_ghost(struct runner *r, struct cell *c, int timer) {
 #endif
 }
 
+/**
+ * @brief Adds the particles of a cell that lie within a given distance of a
+ * particle to its candidate neighbours.
+ *
+ * @param e The #engine.
+ * @param pi The particle.
+ * @param cj The #cell to search, recursed into as long as it is in range.
+ * @param shift The periodic shift to apply to the particle.
+ * @param r2_max The square of the search radius.
+ * @param l The #ghost_ngb_list.
+ *
+ * @return 0 if the lists are full, 1 otherwise.
+ */
+static int runner_ghost_ngb_list_add_cell(const struct engine *e,
+                                          struct part *pi, struct cell *cj,
+                                          const double shift[3],
+                                          const float r2_max,
+                                          struct ghost_ngb_list *l) {
+
+  /* Skip cells that are out of range, allowing for the particles that left
+   * them since they were built. */
+  const double pix[3] = {pi->x[0] - shift[0], pi->x[1] - shift[1],
+                         pi->x[2] - shift[2]};
+  double d2 = 0.;
+  for (int k = 0; k < 3; k++) {
+    const double lo = cj->loc[k] - cj->hydro.dx_max_part;
+    const double hi = cj->loc[k] + cj->width[k] + cj->hydro.dx_max_part;
+    const double d = max(lo - pix[k], pix[k] - hi);
+    if (d > 0.) d2 += d * d;
+  }
+  if (d2 >= r2_max) return 1;
+
+  /* Recurse? */
+  if (cj->split) {
+    for (int k = 0; k < 8; k++)
+      if (cj->progeny[k] != NULL && cj->progeny[k]->hydro.count > 0 &&
+          !runner_ghost_ngb_list_add_cell(e, pi, cj->progeny[k], shift, r2_max,
+                                          l))
+        return 0;
+    return 1;
+  }
+
+  for (int j = 0; j < cj->hydro.count; j++) {
+    struct part *pj = &cj->hydro.parts[j];
+
+    /* Skip oneself and inhibited particles. */
+    if (pj == pi || part_is_inhibited(pj, e)) continue;
+
+    const float dx[3] = {(float)(pix[0] - pj->x[0]), (float)(pix[1] - pj->x[1]),
+                         (float)(pix[2] - pj->x[2])};
+    const float r2 = dx[0] * dx[0] + dx[1] * dx[1] + dx[2] * dx[2];
+    if (r2 < r2_max && !ghost_ngb_list_add(l, pj, dx)) return 0;
+  }
+  return 1;
+}
+
+/**
+ * @brief Gathers the candidate neighbours of the particles of a cell whose
+ * smoothing lengths have not converged.
+ *
+ * The candidates are the particles, in the cells the density tasks of the
+ * cell and of its parents interact with, that lie within margin times the
+ * kernel support of each particle. They stay complete as long as the
+ * smoothing length of the particle does not grow by more than margin.
+ *
+ * @param r The runner thread.
+ * @param c The #cell.
+ * @param pid The indices of the particles.
+ * @param count The number of particles in @c pid.
+ * @param margin The relative margin on the kernel support.
+ * @param l The #ghost_ngb_list to fill.
+ *
+ * @return 1 if the candidates of all the particles were gathered, 0 if there
+ * were too many of them.
+ */
+static int runner_ghost_ngb_list_build(struct runner *r, struct cell *c,
+                                       const int *pid, const int count,
+                                       const float margin,
+                                       struct ghost_ngb_list *l) {
+
+  const struct engine *e = r->e;
+  const struct space *s = e->s;
+  struct part *restrict parts = c->hydro.parts;
+
+  for (int i = 0; i < count; i++) {
+    struct part *pi = &parts[pid[i]];
+    const float h_max = margin * pi->h;
+    const float r2_max = h_max * h_max * kernel_gamma2;
+    l->first[pid[i]] = l->size;
+
+    /* Climb up the cell hierarchy. */
+    for (struct cell *finger = c; finger != NULL; finger = finger->parent) {
+
+      /* Run through this cell's density interactions. */
+      for (struct link *lk = finger->hydro.density; lk != NULL;
+           lk = lk->next) {
+
+        /* Get the other cell and the periodic shift to it. */
+        struct cell *cj = finger;
+        if (lk->t->cj != NULL)
+          cj = (lk->t->ci == finger) ? lk->t->cj : lk->t->ci;
+        double shift[3] = {0., 0., 0.};
+        if (s->periodic) {
+          for (int k = 0; k < 3; k++) {
+            if (cj->loc[k] - finger->loc[k] < -s->dim[k] / 2)
+              shift[k] = s->dim[k];
+            else if (cj->loc[k] - finger->loc[k] > s->dim[k] / 2)
+              shift[k] = -s->dim[k];
+          }
+        }
+
+        if (!runner_ghost_ngb_list_add_cell(e, pi, cj, shift, r2_max, l))
+          return 0;
+      }
+    }
+
+    l->num[pid[i]] = l->size - l->first[pid[i]];
+    l->h_max[pid[i]] = h_max;
+  }
+
+  return 1;
+}
+
 /**
  * @brief Intermediate task after the density to check that the smoothing
  * lengths are correct.
@@ -1104,6 +1228,7 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
   const int use_mass_weighted_num_ngb =
       e->hydro_properties->use_mass_weighted_num_ngb;
   const int max_smoothing_iter = e->hydro_properties->max_smoothing_iterations;
+  const float ngb_list_margin = e->hydro_properties->ghost_ngb_list_margin;
   int redo = 0, count = 0;
 
   /* Running value of the maximal smoothing length */
@@ -1152,6 +1277,12 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
         ++count;
       }
 
+    /* Candidate neighbours of the particles, if we use them. */
+    struct ghost_ngb_list ngb_list;
+    bzero(&ngb_list, sizeof(struct ghost_ngb_list));
+    int *pid_left = NULL;
+    int with_ngb_list = 0;
+
     /* While there are particles that need to be updated... */
     for (int num_reruns = 0; count > 0 && num_reruns < max_smoothing_iter;
          num_reruns++) {
@@ -1494,7 +1625,33 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
 
       /* Re-set the counter for the next loop (potentially). */
       count = redo;
-      if (count > 0) {
+
+      /* Gather the candidate neighbours of the particles the first time
+       * round, unless there are too many of them. */
+      if (count > 0 && num_reruns == 0 && ngb_list_margin > 0.f) {
+        ghost_ngb_list_init(&ngb_list, c->hydro.count,
+                            hydro_props->ghost_ngb_list_max_size);
+        with_ngb_list = runner_ghost_ngb_list_build(r, c, pid, count,
+                                                    ngb_list_margin, &ngb_list);
+        if (with_ngb_list) {
+          if ((pid_left = (int *)malloc(sizeof(int) * count)) == NULL)
+            error("Can't allocate memory for pid_left.");
+        } else {
+          ghost_ngb_list_clean(&ngb_list);
+        }
+      }
+
+      /* The particles whose candidates are complete only need these, the
+       * others go through the neighbouring cells. */
+      int *pid_redo = pid;
+      int count_redo = count;
+      if (count > 0 && with_ngb_list) {
+        count_redo = runner_dosubset_list_density(r, parts, pid, count,
+                                                  &ngb_list, pid_left);
+        pid_redo = pid_left;
+      }
+
+      if (count_redo > 0) {
 
         /* Climb up the cell hierarchy. */
         for (struct cell *finger = c; finger != NULL; finger = finger->parent) {
@@ -1509,35 +1666,36 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
 
             /* Self-interaction? */
             if (l->t->type == task_type_self)
-              runner_doself_subset_branch_density(r, finger, parts, pid, count);
+              runner_doself_subset_branch_density(r, finger, parts, pid_redo,
+                                                  count_redo);
 
             /* Otherwise, pair interaction? */
             else if (l->t->type == task_type_pair) {
 
               /* Left or right? */
               if (l->t->ci == finger)
-                runner_dopair_subset_branch_density(r, finger, parts, pid,
-                                                    count, l->t->cj);
+                runner_dopair_subset_branch_density(r, finger, parts, pid_redo,
+                                                    count_redo, l->t->cj);
               else
-                runner_dopair_subset_branch_density(r, finger, parts, pid,
-                                                    count, l->t->ci);
+                runner_dopair_subset_branch_density(r, finger, parts, pid_redo,
+                                                    count_redo, l->t->ci);
             }
 
             /* Otherwise, sub-self interaction? */
             else if (l->t->type == task_type_sub_self)
-              runner_dosub_subset_density(r, finger, parts, pid, count, NULL,
-                                          1);
+              runner_dosub_subset_density(r, finger, parts, pid_redo,
+                                          count_redo, NULL, 1);
 
             /* Otherwise, sub-pair interaction? */
             else if (l->t->type == task_type_sub_pair) {
 
               /* Left or right? */
               if (l->t->ci == finger)
-                runner_dosub_subset_density(r, finger, parts, pid, count,
-                                            l->t->cj, 1);
+                runner_dosub_subset_density(r, finger, parts, pid_redo,
+                                            count_redo, l->t->cj, 1);
               else
-                runner_dosub_subset_density(r, finger, parts, pid, count,
-                                            l->t->ci, 1);
+                runner_dosub_subset_density(r, finger, parts, pid_redo,
+                                            count_redo, l->t->ci, 1);
             }
           }
         }
@@ -1561,6 +1719,10 @@ void runner_do_ghost(struct runner *r, struct cell *c, int timer) {
     free(right);
     free(pid);
     free(h_0);
+    if (with_ngb_list) {
+      ghost_ngb_list_clean(&ngb_list);
+      free(pid_left);
+    }
   }
 
   /* Update h_max */
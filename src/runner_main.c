@@ -31,6 +31,7 @@
 #include "runner.h"
 
 /* Local headers. */
+#include "active.h"
 #include "engine.h"
 #include "feedback.h"
 #include "runner_doiact_sinks.h"
@@ -125,6 +126,145 @@
 #include "runner_doiact_hydro.h"
 #include "runner_doiact_undef.h"
 
+/**
+ * @brief Runs a hydro loop task of the fused task of a top-level cell.
+ *
+ * @param r The runner thread.
+ * @param t The self, pair, sub-self or sub-pair #task.
+ */
+static void runner_do_hydro_fused_task(struct runner *r, struct task *t) {
+
+  struct cell *ci = t->ci;
+  struct cell *cj = t->cj;
+
+  switch (t->type) {
+    case task_type_self:
+      if (t->subtype == task_subtype_density)
+        runner_doself1_branch_density(r, ci);
+#ifdef EXTRA_HYDRO_LOOP
+      else if (t->subtype == task_subtype_gradient)
+        runner_doself1_branch_gradient(r, ci);
+#endif
+      else
+        runner_doself2_branch_force(r, ci);
+      break;
+    case task_type_pair:
+      if (t->subtype == task_subtype_density)
+        runner_dopair1_branch_density(r, ci, cj);
+#ifdef EXTRA_HYDRO_LOOP
+      else if (t->subtype == task_subtype_gradient)
+        runner_dopair1_branch_gradient(r, ci, cj);
+#endif
+      else
+        runner_dopair2_branch_force(r, ci, cj);
+      break;
+    case task_type_sub_self:
+      if (t->subtype == task_subtype_density)
+        runner_dosub_self1_density(r, ci, 1);
+#ifdef EXTRA_HYDRO_LOOP
+      else if (t->subtype == task_subtype_gradient)
+        runner_dosub_self1_gradient(r, ci, 1);
+#endif
+      else
+        runner_dosub_self2_force(r, ci, 1);
+      break;
+    case task_type_sub_pair:
+      if (t->subtype == task_subtype_density)
+        runner_dosub_pair1_density(r, ci, cj, 1);
+#ifdef EXTRA_HYDRO_LOOP
+      else if (t->subtype == task_subtype_gradient)
+        runner_dosub_pair1_gradient(r, ci, cj, 1);
+#endif
+      else
+        runner_dosub_pair2_force(r, ci, cj, 1);
+      break;
+    default:
+      error("Unknown/invalid task type (%s).", taskID_names[t->type]);
+  }
+
+#ifdef SWIFT_DEBUG_CHECKS
+  t->ti_run = r->e->ti_current;
+#endif
+}
+
+/**
+ * @brief Runs one of the hydro loops of the fused task of a top-level cell
+ * over a cell hierarchy.
+ *
+ * These are all the loop tasks involving an active cell of the top-level
+ * cell, i.e. the ones that would have been unskipped, each of them run from
+ * one of its active cells only.
+ *
+ * @param r The runner thread.
+ * @param c The #cell.
+ * @param subtype The loop, i.e. the #task_subtypes of the tasks.
+ *
+ * @return The number of tasks that were run, including the ghosts after the
+ * density loop.
+ */
+static int runner_do_hydro_fused_loop(struct runner *r, struct cell *c,
+                                      const enum task_subtypes subtype) {
+
+  const struct engine *e = r->e;
+  if (!cell_is_active_hydro(c, e)) return 0;
+
+  struct link *links = c->hydro.force;
+  if (subtype == task_subtype_density) links = c->hydro.density;
+#ifdef EXTRA_HYDRO_LOOP
+  if (subtype == task_subtype_gradient) links = c->hydro.gradient;
+#endif
+
+  int count = 0;
+  for (struct link *l = links; l != NULL; l = l->next) {
+    struct task *t = l->t;
+
+    /* Pairs of active cells of the top-level cell are run from their first
+     * cell. */
+    if (t->cj == c && t->ci->top == c->top && cell_is_active_hydro(t->ci, e))
+      continue;
+
+    runner_do_hydro_fused_task(r, t);
+    count++;
+  }
+  if (subtype == task_subtype_density && c->hydro.ghost != NULL) count++;
+
+  if (c->split)
+    for (int k = 0; k < 8; k++)
+      if (c->progeny[k] != NULL)
+        count += runner_do_hydro_fused_loop(r, c->progeny[k], subtype);
+
+  return count;
+}
+
+/**
+ * @brief Runs the hydro loops and ghosts of a top-level cell one after the
+ * other, in place of their own tasks.
+ *
+ * See cell_set_hydro_fused() for the cells this is done for.
+ *
+ * @param r The runner thread.
+ * @param c The top-level #cell.
+ * @param timer Are we timing this ?
+ */
+static void runner_do_hydro_fused(struct runner *r, struct cell *c,
+                                  int timer) {
+
+  TIMER_TIC;
+
+  int count = runner_do_hydro_fused_loop(r, c, task_subtype_density);
+  runner_do_ghost(r, c, 0);
+#ifdef EXTRA_HYDRO_LOOP
+  count += runner_do_hydro_fused_loop(r, c, task_subtype_gradient);
+  runner_do_extra_ghost(r, c, 0);
+  count++;
+#endif
+  count += runner_do_hydro_fused_loop(r, c, task_subtype_force);
+
+  r->hydro_fused_replaced += count;
+
+  if (timer) TIMER_TOC(timer_do_hydro_fused);
+}
+
 /**
  * @brief The #runner main thread routine.
  *
@@ -136,6 +276,9 @@ void *runner_main(void *data) {
   struct engine *e = r->e;
   struct scheduler *sched = &e->sched;
 
+  /* Record our events in our own trace buffer, if we are tracing. */
+  if (e->trace.buffers != NULL) task_trace_attach(&e->trace, r->id);
+
   /* Main loop. */
   while (1) {
 
@@ -157,13 +300,21 @@ void *runner_main(void *data) {
 
         /* Get the task. */
         TIMER_TIC
+        const ticks idle_tic = getticks();
         t = scheduler_gettask(sched, r->qid, prev);
+        r->idle_time += getticks() - idle_tic;
         TIMER_TOC(timer_gettask);
 
         /* Did I get anything? */
         if (t == NULL) break;
       }
 
+      /* Remember which queue is about to touch the cells of this task. */
+      if (sched->flags &
+          (scheduler_flag_cell_affinity | scheduler_flag_cell_affinity_stats))
+        scheduler_mark_cell_affinity(sched, t, r->qid, &r->cell_affinity_hits,
+                                     &r->cell_affinity_count);
+
       /* Get the cells. */
       struct cell *ci = t->ci;
       struct cell *cj = t->cj;
@@ -422,6 +573,9 @@ void *runner_main(void *data) {
           runner_do_extra_ghost(r, ci, 1);
           break;
 #endif
+        case task_type_hydro_fused:
+          runner_do_hydro_fused(r, ci, 1);
+          break;
         case task_type_stars_ghost:
           runner_do_stars_ghost(r, ci, 1);
           break;
@@ -596,7 +750,30 @@ void *runner_main(void *data) {
         default:
           error("Unknown/invalid task type (%d).", t->type);
       }
-      r->active_time += (getticks() - task_beg);
+      const ticks task_end = getticks();
+      r->active_time += (task_end - task_beg);
+
+      /* Time the hydro loops, fused or not, if they can be fused. */
+      if (e->hydro_properties->fused_loops_max_active_fraction > 0.f) {
+        if (t->type == task_type_hydro_fused) {
+          r->hydro_fused_count++;
+          r->hydro_fused_ticks += task_end - task_beg;
+        } else if (t->type >= task_type_self &&
+                   t->type <= task_type_sub_pair &&
+                   (t->subtype == task_subtype_density ||
+                    t->subtype == task_subtype_gradient ||
+                    t->subtype == task_subtype_force)) {
+          r->hydro_loop_count++;
+          r->hydro_loop_ticks += task_end - task_beg;
+        }
+      }
+
+      /* Trace the task, with its pair direction if it has one. */
+      task_trace_record(task_trace_task, t->tic, task_end, t,
+                        (t->type == task_type_pair ||
+                         t->type == task_type_sub_pair)
+                            ? (int)t->flags
+                            : -1);
 
 /* Mark that we have run this task on these cells */
 #ifdef SWIFT_DEBUG_CHECKS
@@ -31,6 +31,21 @@
 #include "engine.h"
 #include "timers.h"
 
+/* Number of entries from which the leaf sorts use a radix sort. */
+#define runner_sort_radix_min_count 32
+
+/* Number of entries below which the leaf sorts repair the order of their
+ * previous sort rather than sorting from scratch. This is where a radix sort
+ * of the drifted keys catches up with the repair in testSort. */
+#define runner_sort_repair_max_count 48
+
+/* Number of entries of the radix sort buffer kept on the stack. */
+#define runner_sort_buffer_size 1024
+
+/* Maximal number of shifts per entry when repairing a previous sort before
+ * falling back to a full sort. */
+#define runner_sort_repair_max_moves 4
+
 /**
  * @brief Sorts again all the stars in a given cell hierarchy.
  *
@@ -64,14 +79,14 @@ void runner_do_stars_resort(struct runner *r, struct cell *c, const int timer) {
  * @param sort The entries
  * @param N The number of entries.
  */
-void runner_do_sort_ascending(struct sort_entry *sort, int N) {
+void runner_do_sort_ascending(struct sort_key *sort, int N) {
   const int stack_size = 10;
 
   struct {
     short int lo, hi;
   } qstack[stack_size];
   int qpos, i, j, lo, hi, imin;
-  struct sort_entry temp;
+  struct sort_key temp;
   float pivot;
 
   if (N >= (1LL << stack_size)) {
@@ -160,6 +175,117 @@ void runner_do_sort_ascending(struct sort_entry *sort, int N) {
   }
 }
 
+/**
+ * @brief Maps a float to an unsigned integer with the same ordering.
+ *
+ * Positive numbers get their sign bit set, negative ones have all their bits
+ * flipped.
+ *
+ * @param d The float.
+ */
+__attribute__((always_inline, const)) INLINE static uint32_t runner_radix_key(
+    const float d) {
+
+  union {
+    float f;
+    uint32_t u;
+  } key = {d};
+  return key.u ^ ((uint32_t)(-(int32_t)(key.u >> 31)) | 0x80000000u);
+}
+
+/**
+ * @brief Sort the entries in ascending order using a least significant digit
+ * radix sort on the bits of the keys.
+ *
+ * The histograms of all the digits are built in a single pass over the keys
+ * and the passes over digits that are the same for all the entries, e.g. the
+ * exponent bits of the keys of a small cell, are skipped.
+ *
+ * @param sort The entries.
+ * @param buff A buffer of at least N entries.
+ * @param N The number of entries.
+ */
+void runner_do_sort_radix(struct sort_key *restrict sort,
+                          struct sort_key *restrict buff, const int N) {
+
+  if (N < 2) return;
+
+  /* Build the histograms of the four 8-bit digits. */
+  int hist[4][256];
+  bzero(hist, sizeof(hist));
+  for (int k = 0; k < N; k++) {
+    const uint32_t key = runner_radix_key(sort[k].d);
+    hist[0][key & 0xff]++;
+    hist[1][(key >> 8) & 0xff]++;
+    hist[2][(key >> 16) & 0xff]++;
+    hist[3][key >> 24]++;
+  }
+
+  struct sort_key *restrict from = sort;
+  struct sort_key *restrict to = buff;
+  const uint32_t first_key = runner_radix_key(sort[0].d);
+  for (int pass = 0; pass < 4; pass++) {
+    const int shift = 8 * pass;
+
+    /* Nothing to do if all the entries have the same digit. */
+    if (hist[pass][(first_key >> shift) & 0xff] == N) continue;
+
+    /* Turn the histogram into offsets. */
+    int offsets[256];
+    int total = 0;
+    for (int b = 0; b < 256; b++) {
+      offsets[b] = total;
+      total += hist[pass][b];
+    }
+
+    /* Scatter the entries, keeping the order of equal digits. */
+    for (int k = 0; k < N; k++) {
+      const int b = (runner_radix_key(from[k].d) >> shift) & 0xff;
+      to[offsets[b]++] = from[k];
+    }
+
+    struct sort_key *temp = from;
+    from = to;
+    to = temp;
+  }
+
+  /* Bring the result back into the array if it ended in the buffer. */
+  if (from != sort) memcpy(sort, from, N * sizeof(struct sort_key));
+}
+
+/**
+ * @brief Sort entries that are nearly in ascending order using an insertion
+ * sort.
+ *
+ * This is much cheaper than a full sort when the keys only moved a little
+ * since the entries were last sorted, but gives up once more than max_moves
+ * entries had to be shifted. The entries are then still a permutation of the
+ * original ones, but not sorted.
+ *
+ * @param sort The entries.
+ * @param N The number of entries.
+ * @param max_moves The maximal number of shifts allowed.
+ *
+ * @return 1 if the entries were sorted, 0 if we gave up.
+ */
+int runner_do_sort_repair(struct sort_key *sort, const int N,
+                          const int max_moves) {
+
+  int moves = 0;
+  for (int k = 1; k < N; k++) {
+    const struct sort_key temp = sort[k];
+    int j = k;
+    while (j > 0 && sort[j - 1].d > temp.d) {
+      sort[j] = sort[j - 1];
+      j--;
+    }
+    sort[j] = temp;
+    moves += k - j;
+    if (moves > max_moves) return 0;
+  }
+  return 1;
+}
+
 #ifdef SWIFT_DEBUG_CHECKS
 /**
  * @brief Recursively checks that the flags are consistent in a cell hierarchy.
@@ -201,7 +327,7 @@ RUNNER_CHECK_SORTS(stars)
 void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
                           int cleanup, int rt_requests_sort, int clock) {
 
-  struct sort_entry *fingers[8];
+  const struct sort_entry *fingers[8];
   const int count = c->hydro.count;
   const struct part *parts = c->hydro.parts;
   struct xpart *xparts = c->hydro.xparts;
@@ -247,9 +373,16 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
   if (c->hydro.sorted == 0) c->hydro.ti_sort = r->e->ti_current;
 #endif
 
+  /* The sort arrays that are already allocated hold the order of a previous
+   * sort of the same particles (they are freed whenever the cell changes). */
+  const int previous_sorts = c->hydro.sort_allocated;
+
   /* Allocate memory for sorting. */
   cell_malloc_hydro_sorts(c, flags);
 
+  /* Reset the quantization error of the sorts */
+  if (c->hydro.sorted == 0) c->hydro.dx_sort_quant = 0.f;
+
   /* Does this cell have any progeny? */
   if (c->split) {
 
@@ -278,7 +411,6 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
         }
       }
     }
-    c->hydro.dx_max_sort = dx_max_sort;
     c->hydro.dx_max_sort_old = dx_max_sort_old;
 
     /* Loop over the 13 different sort arrays. */
@@ -296,16 +428,22 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
         else
           off[k] = off[k - 1];
 
-      /* Init the entries and indices. */
-      int inds[8];
+      /* Init the entries and indices, and get the range of distances. */
+      int inds[8], pos[8], counts[8];
+      float d_min = FLT_MAX, d_max = -FLT_MAX;
       for (int k = 0; k < 8; k++) {
         inds[k] = k;
+        pos[k] = 0;
         if (c->progeny[k] != NULL && c->progeny[k]->hydro.count > 0) {
           fingers[k] = cell_get_hydro_sorts(c->progeny[k], j);
-          buff[k] = fingers[k]->d;
-          off[k] = off[k];
-        } else
+          counts[k] = c->progeny[k]->hydro.count;
+          buff[k] = sort_get_d(fingers[k], 0);
+          d_min = min(d_min, buff[k]);
+          d_max = max(d_max, sort_get_d(fingers[k], counts[k] - 1));
+        } else {
+          counts[k] = 0;
           buff[k] = FLT_MAX;
+        }
       }
 
       /* Sort the buffer. */
@@ -319,15 +457,20 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
 
       /* For each entry in the new sort list. */
       struct sort_entry *finger = cell_get_hydro_sorts(c, j);
+      const float quant = sort_init(finger, count, d_min, d_max);
+      c->hydro.dx_sort_quant = max(c->hydro.dx_sort_quant, quant);
       for (int ind = 0; ind < count; ind++) {
 
         /* Copy the minimum into the new sort array. */
-        finger[ind].d = buff[inds[0]];
-        finger[ind].i = fingers[inds[0]]->i + off[inds[0]];
+        const int kmin = inds[0];
+        sort_set(finger, ind, buff[kmin],
+                 sort_get_i(fingers[kmin], pos[kmin]) + off[kmin]);
 
         /* Update the buffer. */
-        fingers[inds[0]] += 1;
-        buff[inds[0]] = fingers[inds[0]]->d;
+        pos[kmin] += 1;
+        buff[kmin] = pos[kmin] < counts[kmin]
+                         ? sort_get_d(fingers[kmin], pos[kmin])
+                         : FLT_MAX;
 
         /* Find the smallest entry. */
         for (int k = 1; k < 8 && buff[inds[k]] < buff[inds[k - 1]]; k++) {
@@ -339,16 +482,16 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
       } /* Merge. */
 
       /* Add a sentinel. */
-
-      struct sort_entry *entries = cell_get_hydro_sorts(c, j);
-      entries[count].d = FLT_MAX;
-      entries[count].i = 0;
+      sort_set_sentinel(finger, count);
 
       /* Mark as sorted. */
       atomic_or(&c->hydro.sorted, 1 << j);
 
     } /* loop over sort arrays. */
 
+    /* The merged distances carry the errors of the progeny plus ours. */
+    c->hydro.dx_max_sort = dx_max_sort + c->hydro.dx_sort_quant;
+
   } /* progeny? */
 
   /* Otherwise, just sort. */
@@ -373,28 +516,56 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
       c->hydro.dx_max_sort = 0.f;
     }
 
-    /* Fill the sort array. */
-    for (int k = 0; k < count; k++) {
-      const double px[3] = {parts[k].x[0], parts[k].x[1], parts[k].x[2]};
-      for (int j = 0; j < 13; j++)
-        if (flags & (1 << j)) {
-          struct sort_entry *entries = cell_get_hydro_sorts(c, j);
-          entries[k].i = k;
-          entries[k].d = px[0] * runner_shift[j][0] +
-                         px[1] * runner_shift[j][1] +
-                         px[2] * runner_shift[j][2];
-        }
-    }
+    /* The error on the sorts so far, already included in dx_max_sort. */
+    const float dx_sort_quant_old = c->hydro.dx_sort_quant;
+
+    /* Get buffers for the keys and for the radix sort. */
+    struct sort_key stack_keys[2 * runner_sort_buffer_size];
+    struct sort_key *keys = stack_keys;
+    if (count > runner_sort_buffer_size &&
+        (keys = (struct sort_key *)malloc(2 * sizeof(struct sort_key) *
+                                          count)) == NULL)
+      error("Failed to allocate sort buffer.");
+    struct sort_key *sort_buff = keys + count;
 
-    /* Add the sentinel and sort. */
-    for (int j = 0; j < 13; j++)
-      if (flags & (1 << j)) {
-        struct sort_entry *entries = cell_get_hydro_sorts(c, j);
-        entries[count].d = FLT_MAX;
-        entries[count].i = 0;
-        runner_do_sort_ascending(entries, count);
-        atomic_or(&c->hydro.sorted, 1 << j);
+    for (int j = 0; j < 13; j++) {
+      if (!(flags & (1 << j))) continue;
+
+      /* Re-use the order of the previous sort along this axis if there is
+       * one. The particles only drifted a little since, so this is nearly
+       * sorted already. This only beats a radix sort for small cells. */
+      const int repair = (count < runner_sort_repair_max_count) &&
+                         (previous_sorts & (1 << j));
+
+      /* Fill the keys. */
+      struct sort_entry *entries = cell_get_hydro_sorts(c, j);
+      for (int k = 0; k < count; k++) {
+        const int i = repair ? sort_get_i(entries, k) : k;
+        keys[k].i = i;
+        keys[k].d = parts[i].x[0] * runner_shift[j][0] +
+                    parts[i].x[1] * runner_shift[j][1] +
+                    parts[i].x[2] * runner_shift[j][2];
       }
+
+      /* Sort the keys. */
+      const int repaired =
+          repair && runner_do_sort_repair(keys, count,
+                                          runner_sort_repair_max_moves * count);
+      if (!repaired && count >= runner_sort_radix_min_count)
+        runner_do_sort_radix(keys, sort_buff, count);
+      else if (!repaired)
+        runner_do_sort_ascending(keys, count);
+
+      /* Store them, followed by the sentinel. */
+      const float quant = sort_store(entries, keys, count);
+      c->hydro.dx_sort_quant = max(c->hydro.dx_sort_quant, quant);
+      atomic_or(&c->hydro.sorted, 1 << j);
+    }
+
+    if (keys != stack_keys) free(keys);
+
+    /* Account for the error of the new sorts. */
+    c->hydro.dx_max_sort += c->hydro.dx_sort_quant - dx_sort_quant_old;
   }
 
 #ifdef SWIFT_DEBUG_CHECKS
@@ -403,9 +574,10 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
     if (!(flags & (1 << j))) continue;
     struct sort_entry *finger = cell_get_hydro_sorts(c, j);
     for (int k = 1; k < count; k++) {
-      if (finger[k].d < finger[k - 1].d)
+      if (sort_get_d(finger, k) < sort_get_d(finger, k - 1))
         error("Sorting failed, ascending array.");
-      if (finger[k].i >= count) error("Sorting failed, indices borked.");
+      if (sort_get_i(finger, k) >= count)
+        error("Sorting failed, indices borked.");
     }
   }
 
@@ -445,7 +617,7 @@ void runner_do_hydro_sort(struct runner *r, struct cell *c, int flags,
 void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
                           int cleanup, int clock) {
 
-  struct sort_entry *fingers[8];
+  const struct sort_entry *fingers[8];
   const int count = c->stars.count;
   struct spart *sparts = c->stars.parts;
   float buff[8];
@@ -489,6 +661,9 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
   /* start by allocating the entry arrays in the requested dimensions. */
   cell_malloc_stars_sorts(c, flags);
 
+  /* Reset the quantization error of the sorts */
+  if (c->stars.sorted == 0) c->stars.dx_sort_quant = 0.f;
+
   /* Does this cell have any progeny? */
   if (c->split) {
 
@@ -516,7 +691,6 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
         }
       }
     }
-    c->stars.dx_max_sort = dx_max_sort;
     c->stars.dx_max_sort_old = dx_max_sort_old;
 
     /* Loop over the 13 different sort arrays. */
@@ -534,16 +708,22 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
         else
           off[k] = off[k - 1];
 
-      /* Init the entries and indices. */
-      int inds[8];
+      /* Init the entries and indices, and get the range of distances. */
+      int inds[8], pos[8], counts[8];
+      float d_min = FLT_MAX, d_max = -FLT_MAX;
       for (int k = 0; k < 8; k++) {
         inds[k] = k;
+        pos[k] = 0;
         if (c->progeny[k] != NULL && c->progeny[k]->stars.count > 0) {
           fingers[k] = cell_get_stars_sorts(c->progeny[k], j);
-          buff[k] = fingers[k]->d;
-          off[k] = off[k];
-        } else
+          counts[k] = c->progeny[k]->stars.count;
+          buff[k] = sort_get_d(fingers[k], 0);
+          d_min = min(d_min, buff[k]);
+          d_max = max(d_max, sort_get_d(fingers[k], counts[k] - 1));
+        } else {
+          counts[k] = 0;
           buff[k] = FLT_MAX;
+        }
       }
 
       /* Sort the buffer. */
@@ -557,15 +737,20 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
 
       /* For each entry in the new sort list. */
       struct sort_entry *finger = cell_get_stars_sorts(c, j);
+      const float quant = sort_init(finger, count, d_min, d_max);
+      c->stars.dx_sort_quant = max(c->stars.dx_sort_quant, quant);
       for (int ind = 0; ind < count; ind++) {
 
         /* Copy the minimum into the new sort array. */
-        finger[ind].d = buff[inds[0]];
-        finger[ind].i = fingers[inds[0]]->i + off[inds[0]];
+        const int kmin = inds[0];
+        sort_set(finger, ind, buff[kmin],
+                 sort_get_i(fingers[kmin], pos[kmin]) + off[kmin]);
 
         /* Update the buffer. */
-        fingers[inds[0]] += 1;
-        buff[inds[0]] = fingers[inds[0]]->d;
+        pos[kmin] += 1;
+        buff[kmin] = pos[kmin] < counts[kmin]
+                         ? sort_get_d(fingers[kmin], pos[kmin])
+                         : FLT_MAX;
 
         /* Find the smallest entry. */
         for (int k = 1; k < 8 && buff[inds[k]] < buff[inds[k - 1]]; k++) {
@@ -577,15 +762,16 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
       } /* Merge. */
 
       /* Add a sentinel. */
-      struct sort_entry *entries = cell_get_stars_sorts(c, j);
-      entries[count].d = FLT_MAX;
-      entries[count].i = 0;
+      sort_set_sentinel(finger, count);
 
       /* Mark as sorted. */
       atomic_or(&c->stars.sorted, 1 << j);
 
     } /* loop over sort arrays. */
 
+    /* The merged distances carry the errors of the progeny plus ours. */
+    c->stars.dx_max_sort = dx_max_sort + c->stars.dx_sort_quant;
+
   } /* progeny? */
 
   /* Otherwise, just sort. */
@@ -604,28 +790,40 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
       c->stars.dx_max_sort = 0.f;
     }
 
-    /* Fill the sort array. */
-    for (int k = 0; k < count; k++) {
-      const double px[3] = {sparts[k].x[0], sparts[k].x[1], sparts[k].x[2]};
-      for (int j = 0; j < 13; j++)
-        if (flags & (1 << j)) {
-          struct sort_entry *entries = cell_get_stars_sorts(c, j);
-          entries[k].i = k;
-          entries[k].d = px[0] * runner_shift[j][0] +
-                         px[1] * runner_shift[j][1] +
-                         px[2] * runner_shift[j][2];
-        }
-    }
+    /* The error on the sorts so far, already included in dx_max_sort. */
+    const float dx_sort_quant_old = c->stars.dx_sort_quant;
+
+    /* Get a buffer for the keys. */
+    struct sort_key stack_keys[runner_sort_buffer_size];
+    struct sort_key *keys = stack_keys;
+    if (count > runner_sort_buffer_size &&
+        (keys = (struct sort_key *)malloc(sizeof(struct sort_key) * count)) ==
+            NULL)
+      error("Failed to allocate sort buffer.");
+
+    for (int j = 0; j < 13; j++) {
+      if (!(flags & (1 << j))) continue;
 
-    /* Add the sentinel and sort. */
-    for (int j = 0; j < 13; j++)
-      if (flags & (1 << j)) {
-        struct sort_entry *entries = cell_get_stars_sorts(c, j);
-        entries[count].d = FLT_MAX;
-        entries[count].i = 0;
-        runner_do_sort_ascending(entries, count);
-        atomic_or(&c->stars.sorted, 1 << j);
+      /* Fill the keys and sort them. */
+      for (int k = 0; k < count; k++) {
+        keys[k].i = k;
+        keys[k].d = sparts[k].x[0] * runner_shift[j][0] +
+                    sparts[k].x[1] * runner_shift[j][1] +
+                    sparts[k].x[2] * runner_shift[j][2];
       }
+      runner_do_sort_ascending(keys, count);
+
+      /* Store them, followed by the sentinel. */
+      struct sort_entry *entries = cell_get_stars_sorts(c, j);
+      const float quant = sort_store(entries, keys, count);
+      c->stars.dx_sort_quant = max(c->stars.dx_sort_quant, quant);
+      atomic_or(&c->stars.sorted, 1 << j);
+    }
+
+    if (keys != stack_keys) free(keys);
+
+    /* Account for the error of the new sorts. */
+    c->stars.dx_max_sort += c->stars.dx_sort_quant - dx_sort_quant_old;
   }
 
 #ifdef SWIFT_DEBUG_CHECKS
@@ -634,9 +832,10 @@ void runner_do_stars_sort(struct runner *r, struct cell *c, int flags,
     if (!(flags & (1 << j))) continue;
     struct sort_entry *finger = cell_get_stars_sorts(c, j);
     for (int k = 1; k < count; k++) {
-      if (finger[k].d < finger[k - 1].d)
+      if (sort_get_d(finger, k) < sort_get_d(finger, k - 1))
         error("Sorting failed, ascending array.");
-      if (finger[k].i >= count) error("Sorting failed, indices borked.");
+      if (sort_get_i(finger, k) >= count)
+        error("Sorting failed, indices borked.");
     }
   }
 
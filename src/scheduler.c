@@ -36,6 +36,19 @@
 #include <mpi.h>
 #endif
 
+/* NUMA headers. */
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+/* Futex headers. */
+#ifdef HAVE_LINUX_FUTEX_H
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 /* This object's header. */
 #include "scheduler.h"
 
@@ -53,6 +66,7 @@
 #include "space.h"
 #include "space_getsid.h"
 #include "task.h"
+#include "task_trace.h"
 #include "threadpool.h"
 #include "timers.h"
 #include "version.h"
@@ -1934,15 +1948,192 @@ void scheduler_reset(struct scheduler *s, int size) {
   s->nr_unlocks = 0;
   s->completed_unlock_writes = 0;
   s->active_count = 0;
+  s->launched_count = 0;
   s->total_ticks = 0;
+  if (s->lock_stats != NULL)
+    bzero(s->lock_stats, sizeof(struct queue_lock_stats) * s->nr_queues);
 
   /* Set the task pointers in the queues. */
   for (int k = 0; k < s->nr_queues; k++) s->queues[k].tasks = s->tasks;
 }
 
+/**
+ * @brief Get the index of the #scheduler_cost_model entry of a task.
+ *
+ * @param t The #task.
+ */
+__attribute__((always_inline)) INLINE static int scheduler_cost_model_index(
+    const struct task *t) {
+
+  const int depth = (t->ci != NULL) ? t->ci->depth : 0;
+  return (t->type * task_subtype_count + t->subtype) *
+             scheduler_cost_model_depths +
+         min(depth, scheduler_cost_model_depths - 1);
+}
+
+/**
+ * @brief Estimate the cost of a task, in ticks, from the measured costs of
+ * the same kind of tasks in the previous steps.
+ *
+ * Tasks of a kind that has been measured get their modelled cost scaled by
+ * the measured ticks per unit of modelled cost of that kind, or the mean
+ * measured ticks if the model gives them no cost. Other tasks get their
+ * modelled cost scaled by the mean ratio over all the measured tasks.
+ *
+ * @param s The #scheduler.
+ * @param t The #task.
+ * @param cost The modelled cost of the task.
+ */
+__attribute__((always_inline)) INLINE static float
+scheduler_cost_model_estimate(const struct scheduler *s, const struct task *t,
+                              const float cost) {
+
+  const struct scheduler_cost_model *m =
+      &s->cost_model[scheduler_cost_model_index(t)];
+  if (m->count > 0.) {
+    if (cost > 0.f && m->model > 0.) return cost * (m->ticks / m->model);
+    return m->ticks / m->count;
+  }
+  return cost * s->cost_model_ratio;
+}
+
+/**
+ * @brief Add the sums of some tasks to the step sums of a
+ * #scheduler_cost_model entry, and list the entry as touched if it was not
+ * yet.
+ */
+__attribute__((always_inline)) INLINE static void
+scheduler_cost_model_add(struct scheduler *s, const int index,
+                         const double step_ticks, const double step_model,
+                         const double step_count) {
+
+  struct scheduler_cost_model *m = &s->cost_model[index];
+  atomic_add_d(&m->step_ticks, step_ticks);
+  atomic_add_d(&m->step_model, step_model);
+  atomic_add_d(&m->step_count, step_count);
+
+  /* Remember the entry so that the update only visits what changed. */
+  if (!m->touched && atomic_cas(&m->touched, 0, 1) == 0)
+    s->cost_model_touched[atomic_inc(&s->cost_model_nr_touched)] = index;
+}
+
+/**
+ * @brief Accumulate the measured cost of the tasks that ran since a given
+ * time into the #scheduler_cost_model, from a list of task indices.
+ *
+ * The tasks are first summed in a small direct-mapped table of entries, so
+ * that the shared entries are only updated once per chunk and entry rather
+ * than once per task.
+ */
+void scheduler_update_cost_model_mapper(void *map_data, int num_elements,
+                                        void *extra_data) {
+
+  struct scheduler *s = (struct scheduler *)extra_data;
+  struct task *tasks = s->tasks;
+  int *tid = (int *)map_data;
+  const ticks tic = s->cost_model_tic;
+
+  int cache_index[scheduler_cost_model_cache_size];
+  double cache_ticks[scheduler_cost_model_cache_size];
+  double cache_model[scheduler_cost_model_cache_size];
+  double cache_count[scheduler_cost_model_cache_size];
+  for (int k = 0; k < scheduler_cost_model_cache_size; k++)
+    cache_index[k] = -1;
+
+  for (int ind = 0; ind < num_elements; ind++) {
+    const struct task *t = &tasks[tid[ind]];
+
+    /* Only consider the tasks that did something in this launch. */
+    if (t->implicit || t->tic < tic || t->toc < t->tic) continue;
+
+    /* Flush the slot of our entry if another one is in there. */
+    const int index = scheduler_cost_model_index(t);
+    const int slot = index % scheduler_cost_model_cache_size;
+    if (cache_index[slot] != index) {
+      if (cache_index[slot] >= 0)
+        scheduler_cost_model_add(s, cache_index[slot], cache_ticks[slot],
+                                 cache_model[slot], cache_count[slot]);
+      cache_index[slot] = index;
+      cache_ticks[slot] = 0.;
+      cache_model[slot] = 0.;
+      cache_count[slot] = 0.;
+    }
+
+    cache_ticks[slot] += (double)(t->toc - t->tic);
+    cache_model[slot] += t->cost;
+    cache_count[slot] += 1.;
+  }
+
+  /* Flush what is left. */
+  for (int k = 0; k < scheduler_cost_model_cache_size; k++)
+    if (cache_index[k] >= 0)
+      scheduler_cost_model_add(s, cache_index[k], cache_ticks[k],
+                               cache_model[k], cache_count[k]);
+}
+
+/**
+ * @brief Update the measured task costs used by the adaptive re-weighting
+ * with the tasks that ran in the last launch.
+ *
+ * @param s The #scheduler.
+ * @param tic The time at which the launch started.
+ * @param verbose Are we talkative?
+ */
+void scheduler_update_cost_model(struct scheduler *s, ticks tic,
+                                 int verbose) {
+
+  if (s->cost_model == NULL) return;
+  const ticks tic2 = getticks();
+
+  /* Collect the times of the tasks that ran, i.e. those that were active
+   * when the launch started. */
+  s->cost_model_tic = tic;
+  if (s->launched_count > 1000) {
+    threadpool_map(s->threadpool, scheduler_update_cost_model_mapper,
+                   s->tid_active, s->launched_count, sizeof(int),
+                   threadpool_auto_chunk_size, s);
+  } else {
+    scheduler_update_cost_model_mapper(s->tid_active, s->launched_count, s);
+  }
+
+  /* Fold them into the running sums of the entries they touched, and update
+   * the totals over all the entries accordingly. */
+  for (int k = 0; k < s->cost_model_nr_touched; k++) {
+    struct scheduler_cost_model *m = &s->cost_model[s->cost_model_touched[k]];
+    if (m->model > 0.) {
+      s->cost_model_total_ticks -= m->ticks;
+      s->cost_model_total_model -= m->model;
+    }
+    m->ticks = scheduler_cost_model_decay * m->ticks + m->step_ticks;
+    m->model = scheduler_cost_model_decay * m->model + m->step_model;
+    m->count = scheduler_cost_model_decay * m->count + m->step_count;
+    m->step_ticks = 0.;
+    m->step_model = 0.;
+    m->step_count = 0.;
+    m->touched = 0;
+    if (m->model > 0.) {
+      s->cost_model_total_ticks += m->ticks;
+      s->cost_model_total_model += m->model;
+    }
+  }
+  s->cost_model_nr_touched = 0;
+  if (s->cost_model_total_model > 0.)
+    s->cost_model_ratio =
+        s->cost_model_total_ticks / s->cost_model_total_model;
+
+  if (verbose)
+    message("took %.3f %s.", clocks_from_ticks(getticks() - tic2),
+            clocks_getunit());
+}
+
 /**
  * @brief Compute the task weights
  *
+ * With #scheduler_flag_adaptive_weights, the cost of each active task is
+ * estimated from the measured costs of the previous steps, and the weights
+ * are the lengths of the measured critical paths from each task to the end
+ * of the step. Inactive tasks do not contribute.
+ *
  * @param s The #scheduler.
  * @param verbose Are we talkative?
  */
@@ -2226,6 +2417,9 @@ void scheduler_reweight(struct scheduler *s, int verbose) {
       case task_type_extra_ghost:
         if (t->ci == t->ci->hydro.super) cost = wscale * count_i;
         break;
+      case task_type_hydro_fused:
+        cost = wscale * count_i;
+        break;
       case task_type_stars_ghost:
         if (t->ci == t->ci->hydro.super) cost = wscale * scount_i;
         break;
@@ -2331,7 +2525,13 @@ void scheduler_reweight(struct scheduler *s, int verbose) {
         cost = 0;
         break;
     }
-    t->weight += cost;
+
+    if (s->cost_model != NULL) {
+      t->cost = cost;
+      if (!t->skip) t->weight += scheduler_cost_model_estimate(s, t, cost);
+    } else {
+      t->weight += cost;
+    }
   }
 
   if (verbose)
@@ -2418,7 +2618,8 @@ void scheduler_start(struct scheduler *s) {
     scheduler_enqueue_mapper(s->tid_active, s->active_count, s);
   }
 
-  /* Clear the list of active tasks. */
+  /* Clear the list of active tasks, but remember what it held. */
+  s->launched_count = s->active_count;
   s->active_count = 0;
 
   /* To be safe, fire of one last sleep_cond in a safe way. */
@@ -2427,6 +2628,195 @@ void scheduler_start(struct scheduler *s) {
   pthread_mutex_unlock(&s->sleep_mutex);
 }
 
+/**
+ * @brief Sleep on a futex as long as it holds the given value.
+ *
+ * The timeout is only a safety net, runners are woken up explicitly.
+ *
+ * @param addr The futex.
+ * @param val The value we expect it to hold.
+ */
+static void scheduler_futex_wait(volatile int *addr, const int val) {
+#ifdef HAVE_LINUX_FUTEX_H
+  const struct timespec timeout = {0, scheduler_idle_park_ns};
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, &timeout, NULL, 0);
+#else
+  error("SWIFT was not compiled with futex support.");
+#endif
+}
+
+/**
+ * @brief Wake up to a given number of threads sleeping on a futex.
+ *
+ * @param addr The futex.
+ * @param nr The maximal number of threads to wake up.
+ */
+static void scheduler_futex_wake(volatile int *addr, const int nr) {
+#ifdef HAVE_LINUX_FUTEX_H
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, nr, NULL, NULL, 0);
+#else
+  error("SWIFT was not compiled with futex support.");
+#endif
+}
+
+/**
+ * @brief Wake up a single runner parked on the given queue.
+ *
+ * @param q The #queue.
+ */
+static void scheduler_wake_queue(struct queue *q) {
+  atomic_inc(&q->wake_seq);
+  scheduler_futex_wake(&q->wake_seq, 1);
+}
+
+/**
+ * @brief Wake up at most one parked runner that can reach a given queue.
+ *
+ * The runners of the queue itself are preferred. If we can steal, we then
+ * look at the other queues, closest first if we know the topology.
+ *
+ * @param s The #scheduler.
+ * @param qid The queue that just received work or -1 for any queue.
+ */
+static void scheduler_wake_one(struct scheduler *s, const int qid) {
+
+  const int nr_queues = s->nr_queues;
+
+  /* Anybody asleep at all? */
+  if (s->nr_sleepers == 0) return;
+
+  if (qid >= 0 && s->queues[qid].sleepers > 0) {
+    scheduler_wake_queue(&s->queues[qid]);
+    return;
+  }
+  if (qid >= 0 && !(s->flags & scheduler_flag_steal)) return;
+
+  /* Try the other queues, or every queue if the work can go anywhere. */
+  const int nr_others = qid >= 0 ? nr_queues - 1 : nr_queues;
+  for (int k = 0; k < nr_others; k++) {
+    int other;
+    if (qid < 0)
+      other = k;
+    else if (s->steal_queues != NULL)
+      other = s->steal_queues[qid * nr_queues + k];
+    else
+      other = (qid + 1 + k) % nr_queues;
+    if (s->queues[other].sleepers > 0) {
+      scheduler_wake_queue(&s->queues[other]);
+      return;
+    }
+  }
+}
+
+/**
+ * @brief Wake up all the sleeping runners.
+ *
+ * @param s The #scheduler.
+ */
+void scheduler_wake_all(struct scheduler *s) {
+
+  pthread_mutex_lock(&s->sleep_mutex);
+  pthread_cond_broadcast(&s->sleep_cond);
+  pthread_mutex_unlock(&s->sleep_mutex);
+
+  if (s->flags & scheduler_flag_idle_futex) {
+    for (int k = 0; k < s->nr_queues; k++) {
+      struct queue *q = &s->queues[k];
+      if (q->sleepers > 0) {
+        atomic_inc(&q->wake_seq);
+        scheduler_futex_wake(&q->wake_seq, INT_MAX);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Mark a task as done for the sleeping runners.
+ *
+ * @param s The #scheduler.
+ */
+static void scheduler_task_done_wakeup(struct scheduler *s) {
+
+  if (s->flags & scheduler_flag_idle_futex) {
+
+    /* Last task? Everybody can go home. Otherwise, a runner may now be able
+     * to lock a task it had to leave in its queue. */
+    if (atomic_dec(&s->waiting) == 1)
+      scheduler_wake_all(s);
+    else
+      scheduler_wake_one(s, -1);
+
+  } else {
+    pthread_mutex_lock(&s->sleep_mutex);
+    atomic_dec(&s->waiting);
+    pthread_cond_broadcast(&s->sleep_cond);
+    pthread_mutex_unlock(&s->sleep_mutex);
+  }
+}
+
+/**
+ * @brief Park a runner on the futex of its queue until new work arrives.
+ *
+ * @param s The #scheduler.
+ * @param qid The queue of the runner.
+ * @param prev The previous task that was run.
+ *
+ * @return A task if one arrived while we were getting ready to sleep.
+ */
+static struct task *scheduler_park(struct scheduler *s, const int qid,
+                                   const struct task *prev) {
+
+  struct queue *q = &s->queues[qid];
+  struct task *res = NULL;
+
+  /* Announce that we are about to sleep. Whoever enqueues work from now on
+   * will change the futex value. */
+  const int seq = q->wake_seq;
+  atomic_inc(&q->sleepers);
+  atomic_inc(&s->nr_sleepers);
+
+  /* Last chance, did anything arrive meanwhile? */
+  if (q->count > 0 || q->count_incoming > 0)
+    res = queue_gettask(q, prev, /*blocking=*/0);
+
+  if (res == NULL && s->waiting > 0) {
+    const ticks sleep_tic = getticks();
+    scheduler_futex_wait(&q->wake_seq, seq);
+    task_trace_record(task_trace_sleep, sleep_tic, getticks(), NULL, qid);
+  }
+
+  atomic_dec(&s->nr_sleepers);
+  atomic_dec(&q->sleepers);
+  return res;
+}
+
+/**
+ * @brief Let the CPU know that we are spinning.
+ */
+__attribute__((always_inline)) INLINE static void scheduler_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#endif
+}
+
+/**
+ * @brief Get the queue on which to enqueue tasks acting on a given cell.
+ *
+ * This is the queue of the runner that last ran a task on the cell, if any
+ * and if we are using cell affinity, or the cell's owner otherwise.
+ *
+ * @param s The #scheduler.
+ * @param c The #cell.
+ */
+__attribute__((always_inline)) INLINE static int scheduler_cell_qid(
+    const struct scheduler *s, const struct cell *c) {
+
+  if ((s->flags & scheduler_flag_cell_affinity) && c->nodeID == s->nodeID &&
+      c->last_qid >= 0)
+    return c->last_qid;
+  return c->owner;
+}
+
 /**
  * @brief Put a task on one of the queues.
  *
@@ -2475,17 +2865,20 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
       case task_type_sub_self:
         if (t->subtype == task_subtype_grav ||
             t->subtype == task_subtype_external_grav)
-          qid = t->ci->grav.super->owner;
+          qid = scheduler_cell_qid(s, t->ci->grav.super);
         else
-          qid = t->ci->hydro.super->owner;
+          qid = scheduler_cell_qid(s, t->ci->hydro.super);
         break;
       case task_type_sort:
       case task_type_ghost:
       case task_type_drift_part:
-        qid = t->ci->hydro.super->owner;
+        qid = scheduler_cell_qid(s, t->ci->hydro.super);
+        break;
+      case task_type_hydro_fused:
+        qid = scheduler_cell_qid(s, t->ci);
         break;
       case task_type_drift_gpart:
-        qid = t->ci->grav.super->owner;
+        qid = scheduler_cell_qid(s, t->ci->grav.super);
         break;
       case task_type_kick1:
       case task_type_kick2:
@@ -2493,14 +2886,15 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
       case task_type_csds:
       case task_type_stars_sort:
       case task_type_timestep:
-        qid = t->ci->super->owner;
+        qid = scheduler_cell_qid(s, t->ci->super);
         break;
       case task_type_pair:
       case task_type_sub_pair:
-        qid = t->ci->super->owner;
+        qid = scheduler_cell_qid(s, t->ci->super);
         if (qid < 0 ||
-            s->queues[qid].count > s->queues[t->cj->super->owner].count)
-          qid = t->cj->super->owner;
+            s->queues[qid].count >
+                s->queues[scheduler_cell_qid(s, t->cj->super)].count)
+          qid = scheduler_cell_qid(s, t->cj->super);
         break;
       case task_type_recv:
 #ifdef WITH_MPI
@@ -2730,6 +3124,9 @@ void scheduler_enqueue(struct scheduler *s, struct task *t) {
 
     /* Insert the task into that queue. */
     queue_insert(&s->queues[qid], t);
+
+    /* Wake up a runner that can get to it. */
+    if (s->flags & scheduler_flag_idle_futex) scheduler_wake_one(s, qid);
   }
 }
 
@@ -2764,10 +3161,7 @@ struct task *scheduler_done(struct scheduler *s, struct task *t) {
   if (!t->implicit) {
     t->toc = getticks();
     t->total_ticks += t->toc - t->tic;
-    pthread_mutex_lock(&s->sleep_mutex);
-    atomic_dec(&s->waiting);
-    pthread_cond_broadcast(&s->sleep_cond);
-    pthread_mutex_unlock(&s->sleep_mutex);
+    scheduler_task_done_wakeup(s);
   }
 
   /* Mark the task as skip. */
@@ -2805,10 +3199,7 @@ struct task *scheduler_unlock(struct scheduler *s, struct task *t) {
   if (!t->implicit) {
     t->toc = getticks();
     t->total_ticks += t->toc - t->tic;
-    pthread_mutex_lock(&s->sleep_mutex);
-    atomic_dec(&s->waiting);
-    pthread_cond_broadcast(&s->sleep_cond);
-    pthread_mutex_unlock(&s->sleep_mutex);
+    scheduler_task_done_wakeup(s);
   }
 
   /* Return the next best task. Note that we currently do not
@@ -2817,6 +3208,203 @@ struct task *scheduler_unlock(struct scheduler *s, struct task *t) {
   return NULL;
 }
 
+/**
+ * @brief Get an identifier of the last-level cache used by a given CPU.
+ *
+ * This is the lowest CPU index sharing the highest-level cache listed in
+ * /sys/devices/system/cpu/cpuX/cache/ or the CPU itself if that cannot be
+ * read.
+ *
+ * @param cpu The index of the CPU.
+ */
+static int scheduler_cpu_llc_id(const int cpu) {
+
+  int llc_id = cpu;
+  int llc_level = 0;
+
+  for (int index = 0; index < 16; index++) {
+    char path[200];
+
+    /* Get the level of this cache. */
+    int level = 0;
+    sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu,
+            index);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) break;
+    if (fscanf(file, "%d", &level) != 1) level = 0;
+    fclose(file);
+    if (level <= llc_level) continue;
+
+    /* The first CPU sharing it is a good enough identifier. */
+    int first = -1;
+    sprintf(path, "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list",
+            cpu, index);
+    file = fopen(path, "r");
+    if (file == NULL) continue;
+    if (fscanf(file, "%d", &first) == 1 && first >= 0) {
+      llc_id = first;
+      llc_level = level;
+    }
+    fclose(file);
+  }
+
+  return llc_id;
+}
+
+/**
+ * @brief Get the NUMA node of a given CPU, 0 if unknown.
+ *
+ * @param cpu The index of the CPU.
+ */
+static int scheduler_cpu_numa_node(const int cpu) {
+
+#ifdef HAVE_LIBNUMA
+  if (numa_available() >= 0) {
+    const int node = numa_node_of_cpu(cpu);
+    if (node >= 0) return node;
+  }
+#endif
+  return 0;
+}
+
+/**
+ * @brief Prepare the topology-aware task stealing.
+ *
+ * For each queue, we sort the other queues such that the ones sharing its
+ * last-level cache come first, followed by the ones on the same NUMA node and
+ * then all the others. scheduler_gettask() will then steal from the closest
+ * queues first and only go to other NUMA nodes after repeated failures.
+ *
+ * @param s The #scheduler.
+ * @param queue_cpuid The CPU on which the runners using each queue are pinned.
+ * @param verbose Are we talkative?
+ */
+void scheduler_init_topology(struct scheduler *s, const int *queue_cpuid,
+                             int verbose) {
+
+  const int nr_queues = s->nr_queues;
+
+  /* We need to know where all the queues live. */
+  for (int k = 0; k < nr_queues; k++) {
+    if (queue_cpuid[k] < 0) {
+      if (s->nodeID == 0)
+        message("Queue %d has no pinned runner, stealing at random.", k);
+      return;
+    }
+  }
+
+  /* Get the domains of each queue. */
+  int *llc = (int *)malloc(sizeof(int) * nr_queues);
+  int *numa = (int *)malloc(sizeof(int) * nr_queues);
+  if (llc == NULL || numa == NULL) error("Failed to allocate domain lists.");
+  for (int k = 0; k < nr_queues; k++) {
+    llc[k] = scheduler_cpu_llc_id(queue_cpuid[k]);
+    numa[k] = scheduler_cpu_numa_node(queue_cpuid[k]);
+    if (verbose)
+      message("queue %d on cpuid=%d, llc=%d, numa=%d.", k, queue_cpuid[k],
+              llc[k], numa[k]);
+  }
+
+  if ((s->steal_queues = (int *)swift_malloc(
+           "steal_queues", sizeof(int) * nr_queues * nr_queues)) == NULL ||
+      (s->steal_level_end = (int *)swift_malloc(
+           "steal_level_end",
+           sizeof(int) * nr_queues * scheduler_steal_level_count)) == NULL)
+    error("Failed to allocate steal lists.");
+
+  /* Build the lists, one level at a time. */
+  for (int qid = 0; qid < nr_queues; qid++) {
+    int *queues = &s->steal_queues[qid * nr_queues];
+    int *level_end = &s->steal_level_end[qid * scheduler_steal_level_count];
+    int count = 0;
+
+    for (int level = 0; level < scheduler_steal_level_count; level++) {
+      for (int k = 0; k < nr_queues; k++) {
+        if (k == qid) continue;
+        const int same_llc = (llc[k] == llc[qid] && numa[k] == numa[qid]);
+        const int same_numa = (numa[k] == numa[qid]);
+        if ((level == scheduler_steal_llc && same_llc) ||
+            (level == scheduler_steal_numa && same_numa && !same_llc) ||
+            (level == scheduler_steal_remote && !same_numa))
+          queues[count++] = k;
+      }
+      level_end[level] = count;
+    }
+  }
+
+  for (int level = 0; level < scheduler_steal_level_count; level++)
+    s->steal_counts[level] = 0;
+
+  if (s->nodeID == 0)
+    message("Topology-aware stealing: queue 0 has %d llc, %d numa and %d "
+            "remote neighbours.",
+            s->steal_level_end[scheduler_steal_llc],
+            s->steal_level_end[scheduler_steal_numa] -
+                s->steal_level_end[scheduler_steal_llc],
+            s->steal_level_end[scheduler_steal_remote] -
+                s->steal_level_end[scheduler_steal_numa]);
+
+  free(llc);
+  free(numa);
+}
+
+/**
+ * @brief Steal a task from the queues closest to the given one.
+ *
+ * @param s The #scheduler.
+ * @param qid The ID of the queue we are stealing for.
+ * @param prev The previous task that was run.
+ * @param failed_rounds The number of times we already failed to find a task.
+ * @param seed The random seed used to pick the victims.
+ * @param victim (return) The queue the task was stolen from.
+ *
+ * @return A pointer to a #task or @c NULL if nothing could be stolen.
+ */
+static struct task *scheduler_steal_topology(struct scheduler *s,
+                                             const int qid,
+                                             const struct task *prev,
+                                             const int failed_rounds,
+                                             unsigned int *seed, int *victim) {
+
+  const int nr_queues = s->nr_queues;
+  const int *queues = &s->steal_queues[qid * nr_queues];
+  const int *level_end = &s->steal_level_end[qid * scheduler_steal_level_count];
+
+  /* Only cross NUMA domains once we have failed locally a few times. */
+  const int nr_levels = failed_rounds < scheduler_steal_remote_rounds
+                            ? scheduler_steal_remote
+                            : scheduler_steal_level_count;
+
+  int nr_steals = 0, qids[nr_queues];
+  for (int level = 0; level < nr_levels && nr_steals < scheduler_maxsteal;
+       level++) {
+
+    /* Collect the non-empty queues at this level. */
+    int count = 0;
+    for (int k = (level > 0 ? level_end[level - 1] : 0); k < level_end[level];
+         k++) {
+      const struct queue *q = &s->queues[queues[k]];
+      if (q->count > 0 || q->count_incoming > 0) qids[count++] = queues[k];
+    }
+
+    /* And try them in random order. */
+    for (; nr_steals < scheduler_maxsteal && count > 0; nr_steals++) {
+      const int ind = rand_r(seed) % count;
+      TIMER_TIC
+      struct task *res = queue_steal(&s->queues[qids[ind]], prev);
+      TIMER_TOC(timer_qsteal_llc + level);
+      if (res != NULL) {
+        atomic_inc(&s->steal_counts[level]);
+        *victim = qids[ind];
+        return res;
+      }
+      qids[ind] = qids[--count];
+    }
+  }
+
+  return NULL;
+}
+
 /**
  * @brief Get a task, preferably from the given queue.
  *
@@ -2831,6 +3419,10 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
   struct task *res = NULL;
   const int nr_queues = s->nr_queues;
   unsigned int seed = qid;
+  int failed_rounds = 0;
+  int spins = 0;
+  int victim = qid;
+  const ticks get_tic = getticks();
 
   /* Check qid. */
   if (qid >= nr_queues || qid < 0) error("Bad queue ID.");
@@ -2849,7 +3441,11 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
       }
 
       /* If unsuccessful, try stealing from the other queues. */
-      if (s->flags & scheduler_flag_steal) {
+      if ((s->flags & scheduler_flag_steal) && s->steal_queues != NULL) {
+        res = scheduler_steal_topology(s, qid, prev, failed_rounds++, &seed,
+                                       &victim);
+        if (res != NULL) break;
+      } else if (s->flags & scheduler_flag_steal) {
         int count = 0, qids[nr_queues];
         for (int k = 0; k < nr_queues; k++)
           if (s->queues[k].count > 0 || s->queues[k].count_incoming > 0) {
@@ -2858,11 +3454,12 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
         for (int k = 0; k < scheduler_maxsteal && count > 0; k++) {
           const int ind = rand_r(&seed) % count;
           TIMER_TIC
-          res = queue_gettask(&s->queues[qids[ind]], prev, 0);
+          res = queue_steal(&s->queues[qids[ind]], prev);
           TIMER_TOC(timer_qsteal);
-          if (res != NULL)
+          if (res != NULL) {
+            victim = qids[ind];
             break;
-          else
+          } else
             qids[ind] = qids[--count];
         }
         if (res != NULL) break;
@@ -2876,18 +3473,36 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
     if (res == NULL)
 #endif
     {
-      pthread_mutex_lock(&s->sleep_mutex);
-      res = queue_gettask(&s->queues[qid], prev, 1);
-      if (res == NULL && s->waiting > 0) {
-        pthread_cond_wait(&s->sleep_cond, &s->sleep_mutex);
+      if (s->flags & scheduler_flag_idle_futex) {
+
+        /* Spin for a little while before parking on our queue. */
+        if (spins < scheduler_idle_spins) {
+          spins++;
+          for (int k = 0; k < scheduler_idle_pause; k++) scheduler_cpu_relax();
+        } else {
+          spins = 0;
+          res = scheduler_park(s, qid, prev);
+        }
+
+      } else {
+        pthread_mutex_lock(&s->sleep_mutex);
+        res = queue_gettask(&s->queues[qid], prev, 1);
+        if (res == NULL && s->waiting > 0) {
+          const ticks sleep_tic = getticks();
+          pthread_cond_wait(&s->sleep_cond, &s->sleep_mutex);
+          task_trace_record(task_trace_sleep, sleep_tic, getticks(), NULL,
+                            qid);
+        }
+        pthread_mutex_unlock(&s->sleep_mutex);
       }
-      pthread_mutex_unlock(&s->sleep_mutex);
     }
   }
 
   /* Start the timer on this task, if we got one. */
   if (res != NULL) {
     res->tic = getticks();
+    task_trace_record(victim == qid ? task_trace_get : task_trace_steal,
+                      get_tic, res->tic, res, victim);
 #ifdef SWIFT_DEBUG_TASKS
     res->rid = qid;
 #endif
@@ -2897,6 +3512,51 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
   return res;
 }
 
+/**
+ * @brief Record that the runner of a given queue is about to run a task.
+ *
+ * The cells of the task, as well as their super-cells, remember the queue
+ * so that the tasks depending on this one can be sent there. If requested,
+ * we also count how often the runner was the last one to touch the cell.
+ *
+ * @param s The #scheduler.
+ * @param t The #task about to be run.
+ * @param qid The queue of the runner.
+ * @param hits (return) Incremented if the task's cell was last touched by
+ * the same queue.
+ * @param count (return) Incremented if the task's cell was touched before.
+ */
+void scheduler_mark_cell_affinity(const struct scheduler *s,
+                                  const struct task *t, int qid, int *hits,
+                                  int *count) {
+
+  struct cell *cells[2] = {t->ci, t->cj};
+
+  /* Was the data last used by this queue's runners? */
+  if ((s->flags & scheduler_flag_cell_affinity_stats) && t->ci != NULL &&
+      t->ci->nodeID == s->nodeID) {
+    const struct cell *c = t->ci->super != NULL ? t->ci->super : t->ci;
+    if (c->last_qid >= 0) {
+      *count += 1;
+      if (c->last_qid == qid) *hits += 1;
+    }
+  }
+
+  for (int k = 0; k < 2; k++) {
+    struct cell *c = cells[k];
+    if (c == NULL || c->nodeID != s->nodeID) continue;
+
+    /* Only write if needed, to avoid dirtying the cache lines. */
+    if (c->last_qid != qid) c->last_qid = qid;
+    if (c->super != NULL && c->super->last_qid != qid)
+      c->super->last_qid = qid;
+    if (c->hydro.super != NULL && c->hydro.super->last_qid != qid)
+      c->hydro.super->last_qid = qid;
+    if (c->grav.super != NULL && c->grav.super->last_qid != qid)
+      c->grav.super->last_qid = qid;
+  }
+}
+
 /**
  * @brief Initialize the #scheduler.
  *
@@ -2904,13 +3564,14 @@ struct task *scheduler_gettask(struct scheduler *s, int qid,
  * @param space The #space we are working with
  * @param nr_tasks The number of tasks to allocate initially.
  * @param nr_queues The number of queues in this scheduler.
+ * @param queue_type The #queue_types backend of the queues.
  * @param flags The #scheduler flags.
  * @param nodeID The MPI rank
  * @param tp Parallel processing threadpool.
  */
 void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
-                    int nr_queues, unsigned int flags, int nodeID,
-                    struct threadpool *tp) {
+                    int nr_queues, enum queue_types queue_type,
+                    unsigned int flags, int nodeID, struct threadpool *tp) {
   /* Init the lock. */
   lock_init(&s->lock);
 
@@ -2920,7 +3581,40 @@ void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
     error("Failed to allocate queues.");
 
   /* Initialize each queue. */
-  for (int k = 0; k < nr_queues; k++) queue_init(&s->queues[k], NULL);
+  for (int k = 0; k < nr_queues; k++)
+    queue_init(&s->queues[k], NULL, queue_type);
+
+  /* Attach the lock contention statistics, if we want them. */
+  s->lock_stats = NULL;
+  if (flags & scheduler_flag_lock_stats) {
+    if (swift_memalign("lock_stats", (void **)&s->lock_stats,
+                       queue_struct_align,
+                       sizeof(struct queue_lock_stats) * nr_queues) != 0)
+      error("Failed to allocate queue lock statistics.");
+    bzero(s->lock_stats, sizeof(struct queue_lock_stats) * nr_queues);
+    for (int k = 0; k < nr_queues; k++)
+      s->queues[k].stats = &s->lock_stats[k];
+  }
+
+  /* Allocate the measured task costs, if we want adaptive weights. */
+  s->cost_model = NULL;
+  s->cost_model_touched = NULL;
+  s->cost_model_nr_touched = 0;
+  s->cost_model_ratio = 1.;
+  s->cost_model_total_ticks = 0.;
+  s->cost_model_total_model = 0.;
+  if (flags & scheduler_flag_adaptive_weights) {
+    const size_t nr_entries =
+        task_type_count * task_subtype_count * scheduler_cost_model_depths;
+    if (swift_memalign("cost_model", (void **)&s->cost_model,
+                       SWIFT_STRUCT_ALIGNMENT,
+                       sizeof(struct scheduler_cost_model) * nr_entries) != 0)
+      error("Failed to allocate task cost model.");
+    bzero(s->cost_model, sizeof(struct scheduler_cost_model) * nr_entries);
+    if ((s->cost_model_touched = (int *)swift_malloc(
+             "cost_model_touched", sizeof(int) * nr_entries)) == NULL)
+      error("Failed to allocate the list of touched task costs.");
+  }
 
   /* Init the sleep mutex and cond. */
   if (pthread_cond_init(&s->sleep_cond, NULL) != 0 ||
@@ -2939,6 +3633,10 @@ void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
 
   /* Set the scheduler variables. */
   s->nr_queues = nr_queues;
+  s->queue_type = queue_type;
+  s->steal_queues = NULL;
+  s->steal_level_end = NULL;
+  s->nr_sleepers = 0;
   s->flags = flags;
   s->space = space;
   s->nodeID = nodeID;
@@ -2985,6 +3683,15 @@ void scheduler_clean(struct scheduler *s) {
   swift_free("unlock_ind", s->unlock_ind);
   for (int i = 0; i < s->nr_queues; ++i) queue_clean(&s->queues[i]);
   swift_free("queues", s->queues);
+  if (s->steal_queues != NULL) {
+    swift_free("steal_queues", s->steal_queues);
+    swift_free("steal_level_end", s->steal_level_end);
+  }
+  if (s->lock_stats != NULL) swift_free("lock_stats", s->lock_stats);
+  if (s->cost_model != NULL) {
+    swift_free("cost_model", s->cost_model);
+    swift_free("cost_model_touched", s->cost_model_touched);
+  }
 }
 
 /**
@@ -3174,3 +3881,44 @@ void scheduler_report_task_times(const struct scheduler *s,
   message("took %.3f %s.", clocks_from_ticks(getticks() - tic),
           clocks_getunit());
 }
+
+/**
+ * @brief Display the lock contention statistics of the queues, per task type,
+ * since the last rebuild.
+ *
+ * Does nothing unless the statistics are collected.
+ *
+ * @param s The #scheduler.
+ */
+void scheduler_report_lock_stats(const struct scheduler *s) {
+
+  if (s->lock_stats == NULL) return;
+
+  long long lock_fails[task_type_count] = {0};
+  long long reweights[task_type_count] = {0};
+  long long steals[task_type_count] = {0};
+  long long steal_attempts = 0;
+  ticks spin = 0;
+
+  /* Sum over the queues. */
+  for (int k = 0; k < s->nr_queues; k++) {
+    const struct queue_lock_stats *stats = &s->lock_stats[k];
+    for (int i = 0; i < task_type_count; i++) {
+      lock_fails[i] += stats->lock_fails[i];
+      reweights[i] += stats->reweights[i];
+      steals[i] += stats->steals[i];
+    }
+    steal_attempts += stats->steal_attempts;
+    spin += stats->spin;
+  }
+
+  message("*** Task lock failures, re-weights and steals per task type:");
+  for (int i = 0; i < task_type_count; i++) {
+    if (lock_fails[i] == 0 && steals[i] == 0) continue;
+    message("*** %20s: %12lld %12lld %12lld", taskID_names[i], lock_fails[i],
+            reweights[i], steals[i]);
+  }
+  message("*** %20s: %12lld", "steal attempts", steal_attempts);
+  message("*** %20s: %8.2f %s", "spin time", clocks_from_ticks(spin),
+          clocks_getunit());
+}
@@ -45,14 +45,54 @@
 #define scheduler_dosub 1
 #define scheduler_maxsteal 10
 #define scheduler_maxtries 2
+#define scheduler_steal_remote_rounds 1
+#define scheduler_idle_spins 16
+#define scheduler_idle_pause 64
+#define scheduler_idle_park_ns 1000000
+#define scheduler_cost_model_depths 8
+#define scheduler_cost_model_decay 0.5
+#define scheduler_cost_model_cache_size 64
 #define scheduler_doforcesplit            \
   0 /* Beware: switching this on can/will \
        break engine_addlink as it assumes \
        a maximum number of tasks per cell. */
 
+/* The last try before sleeping must be allowed to steal from everybody. */
+#if scheduler_steal_remote_rounds >= scheduler_maxtries
+#error "scheduler_steal_remote_rounds must be smaller than scheduler_maxtries"
+#endif
+
 /* Flags . */
 #define scheduler_flag_none 0
 #define scheduler_flag_steal (1 << 1)
+#define scheduler_flag_cell_affinity (1 << 2)
+#define scheduler_flag_cell_affinity_stats (1 << 3)
+#define scheduler_flag_idle_futex (1 << 4)
+#define scheduler_flag_activate_by_cells (1 << 5)
+#define scheduler_flag_activation_stats (1 << 6)
+#define scheduler_flag_lock_stats (1 << 7)
+#define scheduler_flag_adaptive_weights (1 << 8)
+
+/* Levels of the topology-aware task stealing, from closest to furthest. */
+enum scheduler_steal_levels {
+  scheduler_steal_llc = 0, /* Queues sharing our last-level cache. */
+  scheduler_steal_numa,    /* Queues on our NUMA node. */
+  scheduler_steal_remote,  /* Everybody else. */
+  scheduler_steal_level_count
+};
+
+/* Measured cost of the tasks of one type, sub-type and cell depth. */
+struct scheduler_cost_model {
+  /* Exponentially-decaying sums of the measured ticks, of the modelled costs
+   * and of the number of tasks run. */
+  double ticks, model, count;
+
+  /* The same sums over the tasks run since the last update. */
+  double step_ticks, step_model, step_count;
+
+  /* Has a task been added to the step sums since the last update? */
+  int touched;
+};
 
 /* Data of a scheduler. */
 struct scheduler {
@@ -65,6 +105,36 @@ struct scheduler {
   /* Array of queues. */
   struct queue *queues;
 
+  /* The backend used by the queues. */
+  enum queue_types queue_type;
+
+  /* For each queue, all the other queues sorted by topological distance and
+   * the index in that list at which each #scheduler_steal_levels ends. NULL
+   * if the topology is not known, in which case we steal at random. */
+  int *steal_queues;
+  int *steal_level_end;
+
+  /* Number of tasks stolen at each #scheduler_steal_levels. */
+  int steal_counts[scheduler_steal_level_count];
+
+  /* Lock contention statistics of each queue, if we collect them. */
+  struct queue_lock_stats *lock_stats;
+
+  /* Measured task costs per type, sub-type and depth, if the weights are
+   * adaptive, and the mean number of ticks per unit of modelled cost. */
+  struct scheduler_cost_model *cost_model;
+  double cost_model_ratio;
+
+  /* Indices of the cost model entries touched since the last update, and
+   * the sums of the decaying ticks and modelled costs of all the entries
+   * with a modelled cost. */
+  int *cost_model_touched;
+  int cost_model_nr_touched;
+  double cost_model_total_ticks, cost_model_total_model;
+
+  /* Start of the launch whose tasks are being added to the cost model. */
+  ticks cost_model_tic;
+
   /* Total number of tasks. */
   int nr_tasks, size, tasks_next;
 
@@ -81,6 +151,11 @@ struct scheduler {
   int *tid_active;
   int active_count;
 
+  /* Number of tasks of the list of initial tasks that were launched by the
+   * last call to scheduler_start(). They stay in the list until the next
+   * task is activated. */
+  int launched_count;
+
   /* The task unlocks. */
   struct task **volatile unlocks;
   int *volatile unlock_ind;
@@ -93,6 +168,9 @@ struct scheduler {
   pthread_mutex_t sleep_mutex;
   pthread_cond_t sleep_cond;
 
+  /* Total number of runners parked on the queue futexes. */
+  volatile int nr_sleepers;
+
   /* The space associated with this scheduler. */
   struct space *space;
 
@@ -262,11 +340,17 @@ scheduler_activate_unpack(struct scheduler *s, struct link *link,
 /* Function prototypes. */
 void scheduler_clear_active(struct scheduler *s);
 void scheduler_init(struct scheduler *s, struct space *space, int nr_tasks,
-                    int nr_queues, unsigned int flags, int nodeID,
-                    struct threadpool *tp);
+                    int nr_queues, enum queue_types queue_type,
+                    unsigned int flags, int nodeID, struct threadpool *tp);
+void scheduler_init_topology(struct scheduler *s, const int *queue_cpuid,
+                             int verbose);
 struct task *scheduler_gettask(struct scheduler *s, int qid,
                                const struct task *prev);
+void scheduler_mark_cell_affinity(const struct scheduler *s,
+                                  const struct task *t, int qid, int *hits,
+                                  int *count);
 void scheduler_enqueue(struct scheduler *s, struct task *t);
+void scheduler_wake_all(struct scheduler *s);
 void scheduler_start(struct scheduler *s);
 void scheduler_reset(struct scheduler *s, int nr_tasks);
 void scheduler_ranktasks(struct scheduler *s);
@@ -291,5 +375,7 @@ void scheduler_write_task_level(const struct scheduler *s, int step);
 void scheduler_dump_queues(struct engine *e);
 void scheduler_report_task_times(const struct scheduler *s,
                                  const int nr_threads);
+void scheduler_report_lock_stats(const struct scheduler *s);
+void scheduler_update_cost_model(struct scheduler *s, ticks tic, int verbose);
 
 #endif /* SWIFT_SCHEDULER_H */
@@ -23,9 +23,67 @@
 /* Config parameters. */
 #include <config.h>
 
+/* Some standard headers. */
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+
 /* Local includes. */
 #include "inline.h"
 
+/**
+ * @brief A distance on an axis and a particle index, the form in which the
+ * particles are sorted before being stored in the #sort_entry lists.
+ */
+struct sort_key {
+
+  /*! Distance on the axis */
+  float d;
+
+  /*! Particle index */
+  int i;
+};
+
+#ifdef SWIFT_COMPACT_SORTS
+
+/**
+ * @brief Entry in a list of sorted indices, in compact form.
+ *
+ * The distance is quantized relative to the range of distances of the list
+ * and stored in the high bits, the index of the particle in the cell in the
+ * low bits. The lists are preceded by a #sort_header.
+ */
+struct sort_entry {
+
+  /*! Quantized distance and particle index. */
+  uint32_t key;
+};
+
+/**
+ * @brief Quantization of the distances of a compact list of sorted indices.
+ */
+struct sort_header {
+
+  /*! Smallest distance of the list. */
+  float d_min;
+
+  /*! Distance between two quantized values and its inverse. */
+  float scale, inv_scale;
+
+  /*! Number of bits used by the particle indices. */
+  uint32_t index_bits;
+};
+
+/* Number of entries taken by the header of each list. */
+#define sort_header_size \
+  ((int)(sizeof(struct sort_header) / sizeof(struct sort_entry)))
+
+/* Maximal number of bits of the quantized distances, i.e. those of the
+ * mantissa of a float. */
+#define sort_max_key_bits 24
+
+#else
+
 /**
  * @brief Entry in a list of sorted indices.
  */
@@ -38,6 +96,157 @@ struct sort_entry {
   int i;
 };
 
+/* Number of entries taken by the header of each list. */
+#define sort_header_size 0
+
+#endif /* SWIFT_COMPACT_SORTS */
+
+/**
+ * @brief Returns the distance on the axis of an entry of a list of sorted
+ * indices.
+ *
+ * @param sort The list.
+ * @param k The entry.
+ */
+__attribute__((always_inline)) INLINE static float sort_get_d(
+    const struct sort_entry *sort, const int k) {
+
+#ifdef SWIFT_COMPACT_SORTS
+  const struct sort_header *h = (const struct sort_header *)sort - 1;
+  return h->d_min + (float)(sort[k].key >> h->index_bits) * h->scale;
+#else
+  return sort[k].d;
+#endif
+}
+
+/**
+ * @brief Returns the particle index of an entry of a list of sorted indices.
+ *
+ * @param sort The list.
+ * @param k The entry.
+ */
+__attribute__((always_inline)) INLINE static int sort_get_i(
+    const struct sort_entry *sort, const int k) {
+
+#ifdef SWIFT_COMPACT_SORTS
+  const struct sort_header *h = (const struct sort_header *)sort - 1;
+  return sort[k].key & ((1u << h->index_bits) - 1u);
+#else
+  return sort[k].i;
+#endif
+}
+
+/**
+ * @brief Prepares a list of sorted indices to receive its entries.
+ *
+ * For compact lists, this sets the quantization of the distances, which must
+ * all lie between d_min and d_max. Empty lists may pass d_min > d_max.
+ *
+ * @param sort The list.
+ * @param count The number of particles in the list.
+ * @param d_min The smallest distance.
+ * @param d_max The largest distance.
+ *
+ * @return The maximal error on the distances stored in the list.
+ */
+__attribute__((always_inline)) INLINE static float sort_init(
+    struct sort_entry *sort, const int count, const float d_min,
+    const float d_max) {
+
+#ifdef SWIFT_COMPACT_SORTS
+  struct sort_header *h = (struct sort_header *)sort - 1;
+
+  /* Enough bits for the indices, the rest for the distances. */
+  int index_bits = 0;
+  while ((1 << index_bits) < count) index_bits++;
+  int key_bits = 32 - index_bits;
+  if (key_bits > sort_max_key_bits) key_bits = sort_max_key_bits;
+
+  h->d_min = d_min;
+  h->scale =
+      d_max > d_min ? (d_max - d_min) / (float)((1u << key_bits) - 1u) : 0.f;
+  h->inv_scale = h->scale > 0.f ? 1.f / h->scale : 0.f;
+  h->index_bits = index_bits;
+
+  /* Rounding to the nearest value, plus the float rounding of the encoding
+   * and decoding. */
+  if (d_max <= d_min) return 0.f;
+  const float d_abs = fabsf(d_min) > fabsf(d_max) ? fabsf(d_min) : fabsf(d_max);
+  return 0.5f * h->scale + 4.f * FLT_EPSILON * d_abs;
+#else
+  return 0.f;
+#endif
+}
+
+/**
+ * @brief Sets an entry of a list of sorted indices.
+ *
+ * @param sort The list.
+ * @param k The entry.
+ * @param d The distance on the axis.
+ * @param i The particle index.
+ */
+__attribute__((always_inline)) INLINE static void sort_set(
+    struct sort_entry *sort, const int k, const float d, const int i) {
+
+#ifdef SWIFT_COMPACT_SORTS
+  const struct sort_header *h = (const struct sort_header *)sort - 1;
+  const int key_bits = 32 - (int)h->index_bits < sort_max_key_bits
+                           ? 32 - (int)h->index_bits
+                           : sort_max_key_bits;
+  const float key_max = (float)((1u << key_bits) - 1u);
+
+  /* Round to the nearest value, making sure rounding errors on the range
+   * do not push us out of it. */
+  float key = (d - h->d_min) * h->inv_scale + 0.5f;
+  key = key < 0.f ? 0.f : key;
+  key = key > key_max ? key_max : key;
+  sort[k].key = ((uint32_t)key << h->index_bits) | (uint32_t)i;
+#else
+  sort[k].d = d;
+  sort[k].i = i;
+#endif
+}
+
+/**
+ * @brief Sets the sentinel at the end of a list of sorted indices, an entry
+ * with a distance that is not smaller than any other.
+ *
+ * @param sort The list.
+ * @param count The number of particles in the list.
+ */
+__attribute__((always_inline)) INLINE static void sort_set_sentinel(
+    struct sort_entry *sort, const int count) {
+
+#ifdef SWIFT_COMPACT_SORTS
+  const struct sort_header *h = (const struct sort_header *)sort - 1;
+  sort[count].key = ~((1u << h->index_bits) - 1u);
+#else
+  sort[count].d = FLT_MAX;
+  sort[count].i = 0;
+#endif
+}
+
+/**
+ * @brief Stores sorted keys in a list of sorted indices, followed by a
+ * sentinel.
+ *
+ * @param sort The list.
+ * @param keys The keys, sorted in ascending order.
+ * @param count The number of keys.
+ *
+ * @return The maximal error on the distances stored in the list.
+ */
+__attribute__((always_inline)) INLINE static float sort_store(
+    struct sort_entry *sort, const struct sort_key *keys, const int count) {
+
+  const float quant = sort_init(sort, count, count > 0 ? keys[0].d : 0.f,
+                                count > 0 ? keys[count - 1].d : 0.f);
+  for (int k = 0; k < count; k++) sort_set(sort, k, keys[k].d, keys[k].i);
+  sort_set_sentinel(sort, count);
+  return quant;
+}
+
 /* Orientation of the cell pairs */
 static const double runner_shift[13][3] = {
     {5.773502691896258e-01, 5.773502691896258e-01, 5.773502691896258e-01},
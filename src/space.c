@@ -572,6 +572,44 @@ void space_list_useful_top_level_cells(struct space *s) {
             clocks_getunit());
 }
 
+/**
+ * @brief Number the leaves of every cell hierarchy and attach to each
+ * top-level cell its bit fields of locked leaves.
+ *
+ * Does nothing, beyond freeing the old fields, unless the cells are locked by
+ * their leaves. This must be called once the local and foreign cell trees
+ * have been built, and before any task is locked.
+ *
+ * @param s The #space.
+ */
+void space_allocate_leaf_locks(struct space *s) {
+
+  if (s->leaf_locks_top != NULL) {
+    swift_free("leaf_locks_top", s->leaf_locks_top);
+    s->leaf_locks_top = NULL;
+  }
+
+  if (!s->with_leaf_locks) return;
+
+  /* Number the leaves of each hierarchy and count the words we need. */
+  size_t size = 0;
+  for (int k = 0; k < s->nr_cells; k++) {
+    cell_number_leaves(&s->cells_top[k], /*first=*/0);
+    size += cell_lock_count * cell_leaf_locks_size(&s->cells_top[k]);
+  }
+
+  if (swift_memalign("leaf_locks_top", (void **)&s->leaf_locks_top,
+                     SWIFT_CACHE_ALIGNMENT, size * sizeof(uint64_t)) != 0)
+    error("Failed to allocate the locked leaves of the top-level cells.");
+  bzero(s->leaf_locks_top, size * sizeof(uint64_t));
+
+  size_t offset = 0;
+  for (int k = 0; k < s->nr_cells; k++) {
+    s->cells_top[k].leaf_locks = s->leaf_locks_top + offset;
+    offset += cell_lock_count * cell_leaf_locks_size(&s->cells_top[k]);
+  }
+}
+
 void space_synchronize_part_positions_mapper(void *map_data, int nr_parts,
                                              void *extra_data) {
   /* Unpack the data */
@@ -2325,11 +2363,15 @@ void space_clean(struct space *s) {
   for (int i = 0; i < s->nr_cells; ++i) cell_clean(&s->cells_top[i]);
   swift_free("cells_top", s->cells_top);
   swift_free("multipoles_top", s->multipoles_top);
+  if (s->leaf_locks_top != NULL)
+    swift_free("leaf_locks_top", s->leaf_locks_top);
   swift_free("local_cells_top", s->local_cells_top);
   swift_free("local_cells_with_tasks_top", s->local_cells_with_tasks_top);
   swift_free("cells_with_particles_top", s->cells_with_particles_top);
   swift_free("local_cells_with_particles_top",
              s->local_cells_with_particles_top);
+  if (s->grav_long_range_offsets != NULL)
+    swift_free("grav_long_range_offsets", s->grav_long_range_offsets);
   swift_free("parts", s->parts);
   swift_free("xparts", s->xparts);
   swift_free("gparts", s->gparts);
@@ -2493,12 +2535,15 @@ void space_struct_restore(struct space *s, FILE *stream) {
   s->cells_sub = NULL;
   s->multipoles_top = NULL;
   s->multipoles_sub = NULL;
+  s->leaf_locks_top = NULL;
   s->local_cells_top = NULL;
   s->local_cells_with_tasks_top = NULL;
   s->cells_with_particles_top = NULL;
   s->local_cells_with_particles_top = NULL;
+  s->grav_long_range_offsets = NULL;
   s->nr_local_cells_with_tasks = 0;
   s->nr_cells_with_particles = 0;
+  s->nr_grav_long_range_offsets = 0;
 #ifdef WITH_MPI
   s->parts_foreign = NULL;
   s->size_parts_foreign = 0;
@@ -107,6 +107,10 @@ struct space {
   /*! Are we doing gravity? */
   int with_self_gravity;
 
+  /*! Are the cells locked by their leaves rather than by holding their
+   * parents? */
+  int with_leaf_locks;
+
   /*! Are we doing star formation? */
   int with_star_formation;
 
@@ -167,6 +171,9 @@ struct space {
   /*! Buffer of unused multipoles for the sub-cells. */
   struct gravity_tensors *multipoles_sub;
 
+  /*! The bit fields of locked leaves of the top-level cells, if any */
+  uint64_t *leaf_locks_top;
+
   /*! The indices of the *local* top-level cells */
   int *local_cells_top;
 
@@ -179,6 +186,13 @@ struct space {
   /*! The indices of the top-level cells that have >0 particles (of any kind) */
   int *local_cells_with_particles_top;
 
+  /*! The offsets (3 per entry) of the top-level cells within the mesh cut-off
+   * radius of any top-level cell, NULL without a periodic mesh */
+  int *grav_long_range_offsets;
+
+  /*! Number of entries in grav_long_range_offsets */
+  int nr_grav_long_range_offsets;
+
   /*! The total number of #part in the space. */
   size_t nr_parts;
 
@@ -394,6 +408,7 @@ void space_allocate_extras(struct space *s, int verbose);
 void space_split(struct space *s, int verbose);
 void space_reorder_extras(struct space *s, int verbose);
 void space_list_useful_top_level_cells(struct space *s);
+void space_allocate_leaf_locks(struct space *s);
 void space_parts_get_cell_index(struct space *s, int *ind, int *cell_counts,
                                 size_t *count_inhibited_parts,
                                 size_t *count_extra_parts, int verbose);
@@ -736,7 +736,7 @@ void space_parts_get_cell_index(struct space *s, int *ind, int *cell_counts,
   data.count_extra_sink = 0;
 
   threadpool_map(&s->e->threadpool, space_parts_get_cell_index_mapper, s->parts,
-                 s->nr_parts, sizeof(struct part), threadpool_auto_chunk_size,
+                 s->nr_parts, sizeof(struct part), threadpool_steal_chunk_size,
                  &data);
 
   *count_inhibited_parts = data.count_inhibited_part;
@@ -788,7 +788,7 @@ void space_gparts_get_cell_index(struct space *s, int *gind, int *cell_counts,
 
   threadpool_map(&s->e->threadpool, space_gparts_get_cell_index_mapper,
                  s->gparts, s->nr_gparts, sizeof(struct gpart),
-                 threadpool_auto_chunk_size, &data);
+                 threadpool_steal_chunk_size, &data);
 
   *count_inhibited_gparts = data.count_inhibited_gpart;
   *count_extra_gparts = data.count_extra_gpart;
@@ -839,7 +839,7 @@ void space_sparts_get_cell_index(struct space *s, int *sind, int *cell_counts,
 
   threadpool_map(&s->e->threadpool, space_sparts_get_cell_index_mapper,
                  s->sparts, s->nr_sparts, sizeof(struct spart),
-                 threadpool_auto_chunk_size, &data);
+                 threadpool_steal_chunk_size, &data);
 
   *count_inhibited_sparts = data.count_inhibited_spart;
   *count_extra_sparts = data.count_extra_spart;
@@ -887,7 +887,7 @@ void space_sinks_get_cell_index(struct space *s, int *sink_ind,
   data.count_extra_sink = 0;
 
   threadpool_map(&s->e->threadpool, space_sinks_get_cell_index_mapper, s->sinks,
-                 s->nr_sinks, sizeof(struct sink), threadpool_auto_chunk_size,
+                 s->nr_sinks, sizeof(struct sink), threadpool_steal_chunk_size,
                  &data);
 
   *count_inhibited_sinks = data.count_inhibited_sink;
@@ -939,7 +939,7 @@ void space_bparts_get_cell_index(struct space *s, int *bind, int *cell_counts,
 
   threadpool_map(&s->e->threadpool, space_bparts_get_cell_index_mapper,
                  s->bparts, s->nr_bparts, sizeof(struct bpart),
-                 threadpool_auto_chunk_size, &data);
+                 threadpool_steal_chunk_size, &data);
 
   *count_inhibited_bparts = data.count_inhibited_bpart;
   *count_extra_bparts = data.count_extra_bpart;
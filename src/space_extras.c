@@ -158,7 +158,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("gparts", (void **)&gparts_new, gpart_align,
                          sizeof(struct gpart) * size_gparts) != 0)
         error("Failed to allocate new gpart data");
-      memcpy(gparts_new, s->gparts, sizeof(struct gpart) * s->size_gparts);
+      threadpool_first_touch(&s->e->threadpool, gparts_new, s->gparts,
+                             s->size_gparts, sizeof(struct gpart));
       swift_free("gparts", s->gparts);
       s->gparts = gparts_new;
 
@@ -246,7 +247,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("parts", (void **)&parts_new, part_align,
                          sizeof(struct part) * size_parts) != 0)
         error("Failed to allocate new part data");
-      memcpy(parts_new, s->parts, sizeof(struct part) * s->size_parts);
+      threadpool_first_touch(&s->e->threadpool, parts_new, s->parts,
+                             s->size_parts, sizeof(struct part));
       swift_free("parts", s->parts);
       s->parts = parts_new;
 
@@ -255,7 +257,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("xparts", (void **)&xparts_new, xpart_align,
                          sizeof(struct xpart) * size_parts) != 0)
         error("Failed to allocate new xpart data");
-      memcpy(xparts_new, s->xparts, sizeof(struct xpart) * s->size_parts);
+      threadpool_first_touch(&s->e->threadpool, xparts_new, s->xparts,
+                             s->size_parts, sizeof(struct xpart));
       swift_free("xparts", s->xparts);
       s->xparts = xparts_new;
 
@@ -337,7 +340,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("sinks", (void **)&sinks_new, sink_align,
                          sizeof(struct sink) * size_sinks) != 0)
         error("Failed to allocate new sink data");
-      memcpy(sinks_new, s->sinks, sizeof(struct sink) * s->size_sinks);
+      threadpool_first_touch(&s->e->threadpool, sinks_new, s->sinks,
+                             s->size_sinks, sizeof(struct sink));
       swift_free("sinks", s->sinks);
       s->sinks = sinks_new;
 
@@ -419,7 +423,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("sparts", (void **)&sparts_new, spart_align,
                          sizeof(struct spart) * size_sparts) != 0)
         error("Failed to allocate new spart data");
-      memcpy(sparts_new, s->sparts, sizeof(struct spart) * s->size_sparts);
+      threadpool_first_touch(&s->e->threadpool, sparts_new, s->sparts,
+                             s->size_sparts, sizeof(struct spart));
       swift_free("sparts", s->sparts);
       s->sparts = sparts_new;
 
@@ -501,7 +506,8 @@ void space_allocate_extras(struct space *s, int verbose) {
       if (swift_memalign("bparts", (void **)&bparts_new, bpart_align,
                          sizeof(struct bpart) * size_bparts) != 0)
         error("Failed to allocate new bpart data");
-      memcpy(bparts_new, s->bparts, sizeof(struct bpart) * s->size_bparts);
+      threadpool_first_touch(&s->e->threadpool, bparts_new, s->bparts,
+                             s->size_bparts, sizeof(struct bpart));
       swift_free("bparts", s->bparts);
       s->bparts = bparts_new;
 
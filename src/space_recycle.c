@@ -100,9 +100,11 @@ void space_rebuild_recycle_mapper(void *map_data, int num_elements,
     c->grav.mm = NULL;
     c->hydro.dx_max_part = 0.0f;
     c->hydro.dx_max_sort = 0.0f;
+    c->hydro.dx_sort_quant = 0.0f;
     c->sinks.dx_max_part = 0.f;
     c->stars.dx_max_part = 0.f;
     c->stars.dx_max_sort = 0.f;
+    c->stars.dx_sort_quant = 0.f;
     c->black_holes.dx_max_part = 0.f;
     c->hydro.sorted = 0;
     c->hydro.sort_allocated = 0;
@@ -123,6 +125,7 @@ void space_rebuild_recycle_mapper(void *map_data, int num_elements,
     c->grav.init = NULL;
     c->grav.init_out = NULL;
     c->hydro.extra_ghost = NULL;
+    c->hydro.fused = NULL;
     c->hydro.ghost_in = NULL;
     c->hydro.ghost_out = NULL;
     c->hydro.ghost = NULL;
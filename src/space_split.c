@@ -234,10 +234,12 @@ void space_split_recursive(struct space *s, struct cell *c,
       cp->hydro.h_max_active = 0.f;
       cp->hydro.dx_max_part = 0.f;
       cp->hydro.dx_max_sort = 0.f;
+      cp->hydro.dx_sort_quant = 0.f;
       cp->stars.h_max = 0.f;
       cp->stars.h_max_active = 0.f;
       cp->stars.dx_max_part = 0.f;
       cp->stars.dx_max_sort = 0.f;
+      cp->stars.dx_sort_quant = 0.f;
       cp->sinks.r_cut_max = 0.f;
       cp->sinks.r_cut_max_active = 0.f;
       cp->sinks.dx_max_part = 0.f;
@@ -688,6 +690,7 @@ void space_split_recursive(struct space *s, struct cell *c,
                s->nr_gparts;
   else
     c->owner = 0; /* Ok, there is really nothing on this rank... */
+  c->last_qid = -1;
 
   /* Store the global max depth */
   if (c->depth == 0) atomic_max(&s->maxdepth, maxdepth);
@@ -47,6 +47,7 @@
 #include "inline.h"
 #include "lock.h"
 #include "mpiuse.h"
+#include "task_trace.h"
 
 /* Task type names. */
 const char *taskID_names[task_type_count] = {
@@ -62,6 +63,7 @@ const char *taskID_names[task_type_count] = {
     "ghost",
     "ghost_out",
     "extra_ghost",
+    "hydro_fused",
     "drift_part",
     "drift_spart",
     "drift_sink",
@@ -229,6 +231,7 @@ __attribute__((always_inline)) INLINE static enum task_actions task_acts_on(
     case task_type_sort:
     case task_type_ghost:
     case task_type_extra_ghost:
+    case task_type_hydro_fused:
     case task_type_cooling:
     case task_type_end_hydro_force:
       return task_action_part;
@@ -540,6 +543,7 @@ void task_unlock(struct task *t) {
     case task_type_sort:
     case task_type_ghost:
     case task_type_extra_ghost:
+    case task_type_hydro_fused:
     case task_type_end_hydro_force:
     case task_type_timestep_limiter:
     case task_type_timestep_sync:
@@ -739,6 +743,9 @@ int task_lock(struct task *t) {
       /* And log deactivation, if logging enabled. */
       if (res) {
         mpiuse_log_allocation(t->type, t->subtype, &t->req, 0, 0, 0, 0);
+        const ticks tic = getticks();
+        task_trace_record(task_trace_mpi, tic, tic, t,
+                          type == task_type_recv ? ci->nodeID : cj->nodeID);
       }
 
       return res;
@@ -763,6 +770,7 @@ int task_lock(struct task *t) {
     case task_type_sort:
     case task_type_ghost:
     case task_type_extra_ghost:
+    case task_type_hydro_fused:
     case task_type_end_hydro_force:
     case task_type_timestep_limiter:
     case task_type_timestep_sync:
@@ -1758,6 +1766,7 @@ enum task_categories task_get_category(const struct task *t) {
 
     case task_type_ghost:
     case task_type_extra_ghost:
+    case task_type_hydro_fused:
     case task_type_end_hydro_force:
       return task_category_hydro;
 
@@ -55,6 +55,7 @@ enum task_types {
   task_type_ghost,
   task_type_ghost_out, /* Implicit */
   task_type_extra_ghost,
+  task_type_hydro_fused,
   task_type_drift_part,
   task_type_drift_spart,
   task_type_drift_sink,
@@ -257,6 +258,9 @@ struct task {
   /*! Weight of the task */
   float weight;
 
+  /*! Modelled cost of the task, as of the last re-weighting */
+  float cost;
+
   /*! Number of tasks unlocked by this one */
   int nr_unlock_tasks;
 
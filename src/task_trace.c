@@ -0,0 +1,295 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+/* This object's header. */
+#include "task_trace.h"
+
+/* Local headers. */
+#include "cell.h"
+#include "clocks.h"
+#include "error.h"
+#include "memuse.h"
+#include "task.h"
+
+/* The buffer of the calling thread, NULL if it does not trace. */
+__thread struct task_trace_buffer *task_trace_local = NULL;
+
+/**
+ * @brief Write the events that are ready in all the buffers to the file.
+ *
+ * Each batch of events is preceded by the index of its buffer and the
+ * number of events in it.
+ *
+ * @param tt The #task_trace.
+ */
+static void task_trace_flush(struct task_trace *tt) {
+
+  for (int k = 0; k < tt->nr_buffers; k++) {
+    struct task_trace_buffer *b = &tt->buffers[k];
+
+    /* Everything up to head has been completely written by the owner. */
+    const size_t head = __atomic_load_n(&b->head, __ATOMIC_ACQUIRE);
+    const size_t tail = b->tail;
+    if (head == tail) continue;
+
+    const int32_t batch[2] = {k, (int32_t)(head - tail)};
+    const size_t first = tail & b->mask;
+    const size_t count = head - tail;
+    const size_t count_end = min(count, b->mask + 1 - first);
+    if (fwrite(batch, sizeof(int32_t), 2, tt->file) != 2 ||
+        fwrite(&b->events[first], sizeof(struct task_trace_event), count_end,
+               tt->file) != count_end ||
+        fwrite(b->events, sizeof(struct task_trace_event), count - count_end,
+               tt->file) != count - count_end)
+      error("Failed to write task trace (%s).", strerror(errno));
+
+    /* Give the space back to the owner. */
+    __atomic_store_n(&b->tail, head, __ATOMIC_RELEASE);
+  }
+}
+
+/**
+ * @brief The flushing thread, empties the buffers every
+ * #task_trace_flush_ms milliseconds until told to stop.
+ */
+static void *task_trace_flusher(void *data) {
+
+  struct task_trace *tt = (struct task_trace *)data;
+
+  pthread_mutex_lock(&tt->mutex);
+  while (!tt->done) {
+    struct timespec until;
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_nsec += task_trace_flush_ms * 1000000L;
+    until.tv_sec += until.tv_nsec / 1000000000L;
+    until.tv_nsec %= 1000000000L;
+    pthread_cond_timedwait(&tt->cond, &tt->mutex, &until);
+    task_trace_flush(tt);
+  }
+  pthread_mutex_unlock(&tt->mutex);
+
+  return NULL;
+}
+
+/**
+ * @brief Start tracing the tasks.
+ *
+ * The trace is written to "task_trace.dat", or "task_trace_rank<n>.dat" when
+ * running with MPI. It starts with the magic string #task_trace_magic,
+ * followed by the #task_trace_version, the size of a #task_trace_event, the
+ * rank, the number of buffers and the CPU frequency, as int32 values but for
+ * the frequency, which is an int64.
+ *
+ * @param tt The #task_trace.
+ * @param nr_buffers The number of threads that will be tracing.
+ * @param size The number of events in each buffer, rounded up to a power of
+ * two.
+ * @param rank The MPI rank of this node.
+ */
+void task_trace_init(struct task_trace *tt, int nr_buffers, size_t size,
+                     int rank) {
+
+  /* Round the size up to a power of two. */
+  size_t size_pow2 = 1;
+  while (size_pow2 < size) size_pow2 <<= 1;
+
+  /* Allocate the buffers. */
+  if (swift_memalign("task_trace", (void **)&tt->buffers, 64,
+                     nr_buffers * sizeof(struct task_trace_buffer)) != 0)
+    error("Failed to allocate task trace buffers.");
+  tt->nr_buffers = nr_buffers;
+  for (int k = 0; k < nr_buffers; k++) {
+    struct task_trace_buffer *b = &tt->buffers[k];
+    if ((b->events = (struct task_trace_event *)swift_malloc(
+             "task_trace", size_pow2 * sizeof(struct task_trace_event))) ==
+        NULL)
+      error("Failed to allocate task trace buffer.");
+    b->head = 0;
+    b->tail = 0;
+    b->dropped = 0;
+    b->mask = size_pow2 - 1;
+  }
+
+  /* Open the file and write the header. */
+  char filename[64];
+#ifdef WITH_MPI
+  snprintf(filename, sizeof(filename), "task_trace_rank%d.dat", rank);
+#else
+  snprintf(filename, sizeof(filename), "task_trace.dat");
+#endif
+  if ((tt->file = fopen(filename, "wb")) == NULL)
+    error("Could not create file '%s'.", filename);
+  const int32_t header[4] = {task_trace_version,
+                             (int32_t)sizeof(struct task_trace_event), rank,
+                             nr_buffers};
+  const int64_t cpufreq = clocks_get_cpufreq();
+  if (fwrite(task_trace_magic, 1, 8, tt->file) != 8 ||
+      fwrite(header, sizeof(int32_t), 4, tt->file) != 4 ||
+      fwrite(&cpufreq, sizeof(int64_t), 1, tt->file) != 1)
+    error("Failed to write task trace header (%s).", strerror(errno));
+
+  /* Start the flusher. */
+  tt->done = 0;
+  if (pthread_mutex_init(&tt->mutex, NULL) != 0 ||
+      pthread_cond_init(&tt->cond, NULL) != 0)
+    error("Failed to initialise task trace flusher.");
+  if (pthread_create(&tt->thread, NULL, &task_trace_flusher, tt) != 0)
+    error("Failed to create task trace flusher.");
+}
+
+/**
+ * @brief Make the calling thread record its events in a given buffer.
+ *
+ * @param tt The #task_trace.
+ * @param buffer The index of the buffer, each thread needs its own.
+ */
+void task_trace_attach(struct task_trace *tt, int buffer) {
+
+  if (buffer < 0 || buffer >= tt->nr_buffers)
+    error("Invalid task trace buffer %d.", buffer);
+  task_trace_local = &tt->buffers[buffer];
+}
+
+/**
+ * @brief Stop tracing, write what is left in the buffers and close the file.
+ *
+ * Must be called once the threads have stopped tracing.
+ *
+ * @param tt The #task_trace.
+ */
+void task_trace_clean(struct task_trace *tt) {
+
+  /* Stop the flusher. */
+  pthread_mutex_lock(&tt->mutex);
+  tt->done = 1;
+  pthread_cond_signal(&tt->cond);
+  pthread_mutex_unlock(&tt->mutex);
+  if (pthread_join(tt->thread, NULL) != 0)
+    error("Failed to join task trace flusher.");
+
+  /* Write out the last events. */
+  task_trace_flush(tt);
+  fclose(tt->file);
+
+  size_t dropped = 0;
+  for (int k = 0; k < tt->nr_buffers; k++) {
+    dropped += tt->buffers[k].dropped;
+    swift_free("task_trace", tt->buffers[k].events);
+  }
+  swift_free("task_trace", tt->buffers);
+  tt->buffers = NULL;
+  task_trace_local = NULL;
+
+  if (dropped > 0)
+    message("Dropped %zu task trace events, consider increasing "
+            "Scheduler:task_trace_buffer_size.",
+            dropped);
+}
+
+/**
+ * @brief Append an event to a buffer, or drop it if the buffer is full.
+ *
+ * Only the thread owning the buffer may call this.
+ *
+ * @param b The #task_trace_buffer.
+ * @param ev The #task_trace_event.
+ */
+void task_trace_push(struct task_trace_buffer *b,
+                     const struct task_trace_event *ev) {
+
+  const size_t head = b->head;
+  if (head - __atomic_load_n(&b->tail, __ATOMIC_ACQUIRE) > b->mask) {
+    b->dropped++;
+    return;
+  }
+  b->events[head & b->mask] = *ev;
+  __atomic_store_n(&b->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Record an event about a #task in the calling thread's buffer.
+ *
+ * @param kind The #task_trace_kinds of the event.
+ * @param tic The start of the event.
+ * @param toc The end of the event.
+ * @param t The #task, may be NULL.
+ * @param extra The queue, pair direction or rank, depending on the kind.
+ */
+void task_trace_push_task(enum task_trace_kinds kind, ticks tic, ticks toc,
+                          const struct task *t, int extra) {
+
+  struct task_trace_event ev;
+  bzero(&ev, sizeof(struct task_trace_event));
+  ev.tic = tic;
+  ev.toc = toc;
+  ev.kind = kind;
+  ev.extra = extra;
+  if (t != NULL) {
+    ev.type = t->type;
+    ev.subtype = t->subtype;
+    ev.self = (t->cj == NULL);
+    if (t->ci != NULL) {
+      ev.count_i = t->ci->hydro.count;
+      ev.gcount_i = t->ci->grav.count;
+    }
+    if (t->cj != NULL) {
+      ev.count_j = t->cj->hydro.count;
+      ev.gcount_j = t->cj->grav.count;
+    }
+  }
+  task_trace_push(task_trace_local, &ev);
+}
+
+/**
+ * @brief Record the start and end of a step in the calling thread's buffer.
+ *
+ * The numbers of updated particles are saturated at INT_MAX.
+ *
+ * @param tic The start of the step.
+ * @param toc The end of the step.
+ * @param step The step number.
+ * @param updates The number of updated gas particles.
+ * @param g_updates The number of updated gravity particles.
+ * @param s_updates The number of updated star particles.
+ */
+void task_trace_push_step(ticks tic, ticks toc, int step, long long updates,
+                          long long g_updates, long long s_updates) {
+
+  if (task_trace_local == NULL) return;
+
+  struct task_trace_event ev;
+  bzero(&ev, sizeof(struct task_trace_event));
+  ev.tic = tic;
+  ev.toc = toc;
+  ev.kind = task_trace_step;
+  ev.count_i = step;
+  ev.count_j = min(updates, (long long)INT_MAX);
+  ev.gcount_i = min(g_updates, (long long)INT_MAX);
+  ev.gcount_j = min(s_updates, (long long)INT_MAX);
+  task_trace_push(task_trace_local, &ev);
+}
@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (c) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+#ifndef SWIFT_TASK_TRACE_H
+#define SWIFT_TASK_TRACE_H
+
+/* Config parameters. */
+#include <config.h>
+
+/* Standard headers. */
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* Local includes. */
+#include "cycle.h"
+#include "inline.h"
+
+/* Some constants. */
+#define task_trace_magic "SWIFTTRC"
+#define task_trace_version 1
+#define task_trace_default_size 65536
+#define task_trace_flush_ms 50
+
+/* Forward declarations. */
+struct task;
+
+/* The different kinds of events. */
+enum task_trace_kinds {
+  task_trace_task = 0, /* A task ran between tic and toc. */
+  task_trace_get,      /* A task was taken from the runner's own queue. */
+  task_trace_steal,    /* A task was stolen from another queue. */
+  task_trace_sleep,    /* The runner slept between tic and toc. */
+  task_trace_mpi,      /* The communication of a send/recv completed. */
+  task_trace_step,     /* A whole step ran between tic and toc. */
+  task_trace_kind_count
+};
+
+/* A single event, as written to the trace file. */
+struct task_trace_event {
+
+  /*! Start and end time of the event, equal for instantaneous events. */
+  uint64_t tic, toc;
+
+  /*! Hydro and gravity particle counts of the cells of the task, or the step
+   * number and the numbers of updated particles for step events. */
+  int32_t count_i, count_j, gcount_i, gcount_j;
+
+  /*! The #task_trace_kinds of the event. */
+  uint8_t kind;
+
+  /*! Type and sub-type of the task. */
+  uint8_t type, subtype;
+
+  /*! Is the task acting on a single cell? */
+  uint8_t self;
+
+  /*! The pair direction for tasks, the queue for get and steal events and
+   * the other rank for MPI events. */
+  int16_t extra;
+
+  /*! Padding. */
+  int16_t pad;
+};
+
+/* Ring buffer of events written by a single thread. */
+struct task_trace_buffer {
+
+  /*! The events, #task_trace size of them. */
+  struct task_trace_event *events;
+
+  /*! Number of events written by the owner and by the flusher. */
+  volatile size_t head, tail;
+
+  /*! Number of events dropped because the buffer was full. */
+  size_t dropped;
+
+  /*! Mask to get an index into the buffer from a count. */
+  size_t mask;
+
+} __attribute__((aligned(64)));
+
+/* The tracing state of an engine. */
+struct task_trace {
+
+  /*! One buffer per runner, plus one for the engine's main thread. */
+  struct task_trace_buffer *buffers;
+  int nr_buffers;
+
+  /*! The trace file. */
+  FILE *file;
+
+  /*! The flushing thread and the means to wake it up. */
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  volatile int done;
+};
+
+/* The buffer of the calling thread, NULL if it does not trace. */
+extern __thread struct task_trace_buffer *task_trace_local;
+
+/* Function prototypes. */
+void task_trace_init(struct task_trace *tt, int nr_buffers, size_t size,
+                     int rank);
+void task_trace_attach(struct task_trace *tt, int buffer);
+void task_trace_clean(struct task_trace *tt);
+void task_trace_push(struct task_trace_buffer *b,
+                     const struct task_trace_event *ev);
+void task_trace_push_task(enum task_trace_kinds kind, ticks tic, ticks toc,
+                          const struct task *t, int extra);
+void task_trace_push_step(ticks tic, ticks toc, int step, long long updates,
+                          long long g_updates, long long s_updates);
+
+/**
+ * @brief Record an event about a #task, if the calling thread is tracing.
+ *
+ * @param kind The #task_trace_kinds of the event.
+ * @param tic The start of the event.
+ * @param toc The end of the event.
+ * @param t The #task, may be NULL.
+ * @param extra The queue, pair direction or rank, depending on the kind.
+ */
+__attribute__((always_inline)) INLINE static void task_trace_record(
+    const enum task_trace_kinds kind, const ticks tic, const ticks toc,
+    const struct task *t, const int extra) {
+
+  if (task_trace_local != NULL) task_trace_push_task(kind, tic, toc, t, extra);
+}
+
+#endif /* SWIFT_TASK_TRACE_H */
@@ -44,7 +44,7 @@
  * @brief Store a log entry of the given chunk.
  */
 static void threadpool_log(struct threadpool *tp, int tid, size_t chunk_size,
-                           ticks tic, ticks toc) {
+                           ticks tic, ticks toc, int steals) {
   struct mapper_log *log = &tp->logs[tid > 0 ? tid : 0];
 
   /* Check if we need to re-allocate the log buffer. */
@@ -66,6 +66,7 @@ static void threadpool_log(struct threadpool *tp, int tid, size_t chunk_size,
   entry->tic = tic;
   entry->toc = toc;
   entry->map_function = tp->map_function;
+  entry->steals = steals;
   log->count++;
 }
 
@@ -87,7 +88,7 @@ void threadpool_dump_log(struct threadpool *tp, const char *filename,
   bzero(names, sizeof(struct name_entry) * max_names);
 
   /* Write a header. */
-  fprintf(fd, "# map_function thread_id chunk_size tic toc\n");
+  fprintf(fd, "# map_function thread_id chunk_size tic toc steals\n");
   fprintf(fd, "# {'num_threads': %i, 'cpufreq': %lli}\n", tp->num_threads,
           clocks_get_cpufreq());
 
@@ -116,8 +117,8 @@ void threadpool_dump_log(struct threadpool *tp, const char *filename,
       }
 
       /* Log a line to the file. */
-      fprintf(fd, "%s %i %i %lli %lli\n", names[nid].name, entry->tid,
-              entry->chunk_size, entry->tic, entry->toc);
+      fprintf(fd, "%s %i %i %lli %lli %i\n", names[nid].name, entry->tid,
+              entry->chunk_size, entry->tic, entry->toc, entry->steals);
     }
 
     /* Clear the log if requested. */
@@ -164,16 +165,109 @@ static void threadpool_chomp(struct threadpool *tp, int tid) {
     tp->map_function((char *)tp->map_data + (tp->map_data_stride * task_ind),
                      chunk_size, tp->map_extra_data);
 #ifdef SWIFT_DEBUG_THREADPOOL
-    threadpool_log(tp, tid, chunk_size, tic, getticks());
+    threadpool_log(tp, tid, chunk_size, tic, getticks(), /*steals=*/0);
 #endif
   }
 }
 
+/**
+ * @brief Steal the second half of the range of another thread.
+ *
+ * The victims are tried in order, starting with the next thread, so that
+ * the stolen data tends to be close to the thief's own range.
+ *
+ * @param tp The #threadpool.
+ * @param tid The ID of the thief, whose own range is empty.
+ *
+ * @return 1 if something was stolen, 0 if all the ranges are empty.
+ */
+static int threadpool_steal_range(struct threadpool *tp, int tid) {
+
+  const int num_threads = tp->num_threads;
+
+  for (int k = 1; k < num_threads; k++) {
+    struct threadpool_range *victim = &tp->ranges[(tid + k) % num_threads];
+
+    /* Don't bother locking empty ranges. */
+    if (victim->first >= victim->last) continue;
+
+    lock_lock(&victim->lock);
+    const size_t count = victim->last - victim->first;
+    if (count == 0) {
+      lock_unlock_blind(&victim->lock);
+      continue;
+    }
+    const size_t half = (count + 1) / 2;
+    victim->last -= half;
+    const size_t first = victim->last;
+    lock_unlock_blind(&victim->lock);
+
+    /* Make the stolen half our own range. */
+    struct threadpool_range *own = &tp->ranges[tid];
+    lock_lock(&own->lock);
+    own->first = first;
+    own->last = first + half;
+    lock_unlock_blind(&own->lock);
+
+    atomic_inc(&tp->num_steals);
+    return 1;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Runner main loop in the work-stealing mode.
+ *
+ * Each thread works through its own range, one chunk at a time, and steals
+ * half of the range of another thread once it is done.
+ */
+static void threadpool_chomp_steal(struct threadpool *tp, int tid) {
+
+  struct threadpool_range *own = &tp->ranges[tid];
+  int steals = 0;
+
+  while (1) {
+
+    /* Take a chunk from the front of our range. */
+    lock_lock(&own->lock);
+    size_t chunk_size = own->last - own->first;
+    if (chunk_size > (size_t)tp->map_data_chunk)
+      chunk_size = tp->map_data_chunk;
+    if (chunk_size > INT_MAX) chunk_size = INT_MAX;
+    const size_t task_ind = own->first;
+    own->first += chunk_size;
+    lock_unlock_blind(&own->lock);
+
+    /* Nothing left? Look elsewhere. */
+    if (chunk_size == 0) {
+      if (!threadpool_steal_range(tp, tid)) break;
+      steals++;
+      continue;
+    }
+
+/* Call the mapper function. */
+#ifdef SWIFT_DEBUG_THREADPOOL
+    ticks tic = getticks();
+#endif
+    tp->map_function((char *)tp->map_data + (tp->map_data_stride * task_ind),
+                     chunk_size, tp->map_extra_data);
+#ifdef SWIFT_DEBUG_THREADPOOL
+    threadpool_log(tp, tid, chunk_size, tic, getticks(), steals);
+#endif
+    steals = 0;
+  }
+}
+
 static void *threadpool_runner(void *data) {
 
   /* Our threadpool. */
   struct threadpool *tp = (struct threadpool *)data;
 
+  /* Our ID, which does not change from one call to the next so that the
+   * ranges of the work-stealing mode always go to the same threads. */
+  const int tid = atomic_inc(&tp->num_threads_running);
+
   /* Main loop. */
   while (1) {
 
@@ -188,7 +282,10 @@ static void *threadpool_runner(void *data) {
     if (tp->map_function == NULL) pthread_exit(NULL);
 
     /* Do actual work. */
-    threadpool_chomp(tp, atomic_inc(&tp->num_threads_running));
+    if (tp->map_steal)
+      threadpool_chomp_steal(tp, tid);
+    else
+      threadpool_chomp(tp, tid);
   }
 }
 
@@ -231,6 +328,9 @@ void threadpool_init(struct threadpool *tp, int num_threads) {
   tp->map_data_stride = 0;
   tp->map_data_chunk = 0;
   tp->map_function = NULL;
+  tp->map_steal = 0;
+  tp->num_threads_running = 0;
+  tp->num_steals = 0;
 
   /* Allocate the threads, one less than requested since the calling thread
      works as well. */
@@ -239,6 +339,17 @@ void threadpool_init(struct threadpool *tp, int num_threads) {
     error("Failed to allocate thread array.");
   }
 
+  /* Allocate the ranges of the work-stealing mode. */
+  if (posix_memalign((void **)&tp->ranges, 64,
+                     sizeof(struct threadpool_range) * num_threads) != 0)
+    error("Failed to allocate threadpool ranges.");
+  for (int k = 0; k < num_threads; k++) {
+    tp->ranges[k].first = 0;
+    tp->ranges[k].last = 0;
+    if (lock_init(&tp->ranges[k].lock) != 0)
+      error("Failed to initialize threadpool range lock.");
+  }
+
   /* Create and start the threads. */
   for (int k = 0; k < num_threads - 1; k++) {
     if (pthread_create(&tp->threads[k], NULL, &threadpool_runner, tp) != 0)
@@ -264,7 +375,9 @@ void threadpool_init(struct threadpool *tp, int num_threads) {
  *        or #threadpool_auto_chunk_size to choose the number dynamically
  *        depending on the number of threads and tasks (recommended), or
  *        #threadpool_uniform_chunk_size to spread the tasks evenly over the
- *        threads in one go.
+ *        threads in one go, or #threadpool_steal_chunk_size to give each
+ *        thread its own contiguous range, the same one at every call, and let
+ *        the threads that are done steal half of the range of the others.
  * @param extra_data Addtitional pointer that will be passed to the mapping
  *        function, may contain additional data.
  */
@@ -284,7 +397,7 @@ void threadpool_map(struct threadpool *tp, threadpool_map_function map_function,
 
 #ifdef SWIFT_DEBUG_THREADPOOL
       tp->map_function = map_function;
-      threadpool_log(tp, 0, N, tic_total, getticks());
+      threadpool_log(tp, 0, N, tic_total, getticks(), /*steals=*/0);
 #endif
     } else {
 
@@ -302,7 +415,7 @@ void threadpool_map(struct threadpool *tp, threadpool_map_function map_function,
         map_function((char *)map_data + (stride * data_count), chunk_size,
                      extra_data);
 #ifdef SWIFT_DEBUG_THREADPOOL
-        threadpool_log(tp, 0, chunk_size, tic, getticks());
+        threadpool_log(tp, 0, chunk_size, tic, getticks(), /*steals=*/0);
 #endif
         /* Get the next chunk and check its size. */
         data_count += chunk_size;
@@ -324,29 +437,92 @@ void threadpool_map(struct threadpool *tp, threadpool_map_function map_function,
         max((N / (tp->num_threads * threadpool_default_chunk_ratio)), 1U);
   } else if (chunk == threadpool_uniform_chunk_size) {
     tp->map_data_chunk = threadpool_uniform_chunk_size;
+  } else if (chunk == threadpool_steal_chunk_size) {
+    tp->map_data_chunk =
+        max((N / (tp->num_threads * threadpool_default_chunk_ratio)), 1U);
   } else {
     tp->map_data_chunk = chunk;
   }
   tp->map_function = map_function;
   tp->map_data = map_data;
   tp->map_extra_data = extra_data;
-  tp->num_threads_running = 0;
+  tp->map_steal = (chunk == threadpool_steal_chunk_size);
+  tp->num_steals = 0;
+
+  /* Split the data in one range per thread. */
+  if (tp->map_steal) {
+    for (int k = 0; k < tp->num_threads; k++) {
+      tp->ranges[k].first = k * N / tp->num_threads;
+      tp->ranges[k].last = (k + 1) * N / tp->num_threads;
+    }
+  }
 
   /* Wait for all the threads to be up and running. */
   swift_barrier_wait(&tp->run_barrier);
 
   /* Do some work while I'm at it. */
-  threadpool_chomp(tp, tp->num_threads - 1);
+  if (tp->map_steal)
+    threadpool_chomp_steal(tp, tp->num_threads - 1);
+  else
+    threadpool_chomp(tp, tp->num_threads - 1);
 
   /* Wait for all threads to be done. */
   swift_barrier_wait(&tp->wait_barrier);
 
 #ifdef SWIFT_DEBUG_THREADPOOL
   /* Log the total call time to thread id -1. */
-  threadpool_log(tp, -1, N, tic_total, getticks());
+  threadpool_log(tp, -1, N, tic_total, getticks(), tp->num_steals);
 #endif
 }
 
+/**
+ * @brief Data of the first-touch copy.
+ */
+struct threadpool_first_touch_data {
+  char *dest;
+  const char *src;
+  int stride;
+};
+
+/**
+ * @brief Copy or zero a chunk of the first-touch data.
+ */
+static void threadpool_first_touch_mapper(void *map_data, int num_elements,
+                                          void *extra_data) {
+  struct threadpool_first_touch_data *data =
+      (struct threadpool_first_touch_data *)extra_data;
+  char *dest = (char *)map_data;
+  const size_t size = (size_t)num_elements * data->stride;
+  if (data->src != NULL)
+    memcpy(dest, data->src + (dest - data->dest), size);
+  else
+    bzero(dest, size);
+}
+
+/**
+ * @brief Write a freshly allocated array in parallel, one range per thread.
+ *
+ * With a first-touch NUMA policy, the pages of the array end up on the
+ * memory of the thread that writes them first. The ranges are the same as
+ * those used by #threadpool_map with #threadpool_steal_chunk_size on the same
+ * number of elements, so that later calls in that mode mostly read memory
+ * that is local to the thread.
+ *
+ * @param tp The #threadpool.
+ * @param dest The array to write.
+ * @param src The data to copy into @c dest, or NULL to zero it.
+ * @param N Number of elements to write.
+ * @param stride Size, in bytes, of each element.
+ */
+void threadpool_first_touch(struct threadpool *tp, void *dest, const void *src,
+                            size_t N, int stride) {
+
+  struct threadpool_first_touch_data data = {(char *)dest, (const char *)src,
+                                             stride};
+  threadpool_map(tp, threadpool_first_touch_mapper, dest, N, stride,
+                 threadpool_steal_chunk_size, &data);
+}
+
 /**
  * @brief Re-sets the log for this #threadpool.
  */
@@ -378,6 +554,10 @@ void threadpool_clean(struct threadpool *tp) {
       error("Failed to destroy threadpool barriers.");
 
     /* Clean up memory. */
+    for (int k = 0; k < tp->num_threads; k++)
+      if (lock_destroy(&tp->ranges[k].lock) != 0)
+        error("Failed to destroy threadpool range lock.");
+    free(tp->ranges);
     free(tp->threads);
   }
 
@@ -29,12 +29,14 @@
 /* Local includes. */
 #include "barrier.h"
 #include "cycle.h"
+#include "lock.h"
 
 /* Local defines. */
 #define threadpool_log_initial_size 1000
 #define threadpool_default_chunk_ratio 7
 #define threadpool_auto_chunk_size 0
 #define threadpool_uniform_chunk_size -1
+#define threadpool_steal_chunk_size -2
 
 /* Function type for mappings. */
 typedef void (*threadpool_map_function)(void *map_data, int num_elements,
@@ -54,6 +56,10 @@ struct mapper_log_entry {
 
   /*! Start and end time of this task */
   ticks tic, toc;
+
+  /* Number of ranges stolen by the thread before this chunk, or in total
+   * for the whole call. */
+  int steals;
 };
 
 struct mapper_log {
@@ -67,6 +73,17 @@ struct mapper_log {
   int count;
 };
 
+/* Range of map data owned by a thread in the work-stealing mode. */
+struct threadpool_range {
+
+  /* First and last (excluded) elements left in this range. */
+  size_t first, last;
+
+  /* Lock protecting this range. */
+  swift_lock_type lock;
+
+} __attribute__((aligned(64)));
+
 /* Data of a threadpool. */
 struct threadpool {
 
@@ -83,12 +100,21 @@ struct threadpool {
   volatile ptrdiff_t map_data_chunk;
   volatile threadpool_map_function map_function;
 
+  /* Are we splitting the map data in per-thread ranges? */
+  volatile int map_steal;
+
   /* Number of threads in this pool. */
   int num_threads;
 
-  /* Counter for the number of threads that are done. */
+  /* Counter used to hand out the thread IDs. */
   volatile int num_threads_running;
 
+  /* Per-thread ranges of the work-stealing mode. */
+  struct threadpool_range *ranges;
+
+  /* Total number of ranges stolen during the current call. */
+  volatile int num_steals;
+
 #ifdef SWIFT_DEBUG_THREADPOOL
   struct mapper_log *logs;
 #endif
@@ -99,6 +125,8 @@ void threadpool_init(struct threadpool *tp, int num_threads);
 void threadpool_map(struct threadpool *tp, threadpool_map_function map_function,
                     void *map_data, size_t N, int stride, int chunk,
                     void *extra_data);
+void threadpool_first_touch(struct threadpool *tp, void *dest, const void *src,
+                            size_t N, int stride);
 void threadpool_clean(struct threadpool *tp);
 #ifdef SWIFT_DEBUG_THREADPOOL
 void threadpool_reset_log(struct threadpool *tp);
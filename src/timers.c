@@ -107,6 +107,7 @@ const char* timers_names[timer_count] = {
     "dosub_subset",
     "do_ghost",
     "do_extra_ghost",
+    "do_hydro_fused",
     "do_stars_ghost",
     "do_black_holes_ghost",
     "dorecv_part",
@@ -120,6 +121,9 @@ const char* timers_names[timer_count] = {
     "gettask",
     "qget",
     "qsteal",
+    "qsteal_llc",
+    "qsteal_numa",
+    "qsteal_remote",
     "locktree",
     "runners",
     "step",
@@ -107,6 +107,7 @@ enum {
   timer_dosub_subset,
   timer_do_ghost,
   timer_do_extra_ghost,
+  timer_do_hydro_fused,
   timer_do_stars_ghost,
   timer_do_black_holes_ghost,
   timer_dorecv_part,
@@ -120,6 +121,9 @@ enum {
   timer_gettask,
   timer_qget,
   timer_qsteal,
+  timer_qsteal_llc,
+  timer_qsteal_numa,
+  timer_qsteal_remote,
   timer_locktree,
   timer_runners,
   timer_step,
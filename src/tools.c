@@ -894,7 +894,7 @@ int compare_values(double a, double b, double threshold, double *absDiff,
  */
 int compare_particles(struct part *a, struct part *b, double threshold) {
 
-#ifdef GADGET2_SPH
+#if defined(GADGET2_SPH) || defined(SPHENIX_SPH)
 
   int result = 0;
   double absDiff = 0.0, absSum = 0.0, relDiff = 0.0;
@@ -976,6 +976,7 @@ int compare_particles(struct part *a, struct part *b, double threshold) {
     message("a = %e, b = %e", a->force.h_dt, b->force.h_dt);
     result = 1;
   }
+#ifdef GADGET2_SPH
   if (compare_values(a->force.v_sig, b->force.v_sig, threshold, &absDiff,
                      &absSum, &relDiff)) {
     message(
@@ -1003,6 +1004,50 @@ int compare_particles(struct part *a, struct part *b, double threshold) {
     message("a = %e, b = %e", a->density.div_v, b->density.div_v);
     result = 1;
   }
+#else
+  if (compare_values(a->viscosity.v_sig, b->viscosity.v_sig, threshold,
+                     &absDiff, &absSum, &relDiff)) {
+    message(
+        "Relative difference (%e) larger than tolerance (%e) for v_sig of "
+        "particle %lld.",
+        relDiff, threshold, a->id);
+    message("a = %e, b = %e", a->viscosity.v_sig, b->viscosity.v_sig);
+    result = 1;
+  }
+  if (compare_values(a->u_dt, b->u_dt, threshold, &absDiff, &absSum,
+                     &relDiff)) {
+    message(
+        "Relative difference (%e) larger than tolerance (%e) for u_dt of "
+        "particle %lld.",
+        relDiff, threshold, a->id);
+    message("a = %e, b = %e", a->u_dt, b->u_dt);
+    result = 1;
+  }
+  if (compare_values(a->viscosity.div_v, b->viscosity.div_v, threshold,
+                     &absDiff, &absSum, &relDiff)) {
+    message(
+        "Relative difference (%e) larger than tolerance (%e) for div_v of "
+        "particle %lld.",
+        relDiff, threshold, a->id);
+    message("a = %e, b = %e", a->viscosity.div_v, b->viscosity.div_v);
+    result = 1;
+  }
+  if (compare_values(a->diffusion.laplace_u, b->diffusion.laplace_u, threshold,
+                     &absDiff, &absSum, &relDiff)) {
+    message(
+        "Relative difference (%e) larger than tolerance (%e) for laplace_u of "
+        "particle %lld.",
+        relDiff, threshold, a->id);
+    message("a = %e, b = %e", a->diffusion.laplace_u, b->diffusion.laplace_u);
+    result = 1;
+  }
+  if (a->limiter_data.min_ngb_time_bin != b->limiter_data.min_ngb_time_bin) {
+    message("Different min_ngb_time_bin of particle %lld.", a->id);
+    message("a = %d, b = %d", a->limiter_data.min_ngb_time_bin,
+            b->limiter_data.min_ngb_time_bin);
+    result = 1;
+  }
+#endif
   for (int k = 0; k < 3; k++) {
     if (compare_values(a->density.rot_v[k], b->density.rot_v[k], threshold,
                        &absDiff, &absSum, &relDiff)) {
@@ -23,9 +23,61 @@
 /* Config parameters. */
 #include <config.h>
 
+/* Some standard headers. */
+#include <stdint.h>
+
 /* Local headers */
 #include "inline.h"
 
+/* Storage type of the quantities kept at half precision in the particle
+ * caches: bfloat16, i.e. the upper half of a float, which keeps its
+ * exponent range and 8 bits of its mantissa. */
+#ifdef SWIFT_HALF_PRECISION_CACHES
+typedef uint16_t half_float;
+#else
+typedef float half_float;
+#endif
+
+/**
+ * @brief Rounds a float to the nearest #half_float.
+ *
+ * @param x The value to round.
+ */
+__attribute__((always_inline)) INLINE static half_float half_float_pack(
+    const float x) {
+
+#ifdef SWIFT_HALF_PRECISION_CACHES
+  union {
+    float f;
+    uint32_t i;
+  } u = {x};
+
+  /* Round to nearest, ties to even. */
+  return (uint16_t)((u.i + 0x7FFFu + ((u.i >> 16) & 1u)) >> 16);
+#else
+  return x;
+#endif
+}
+
+/**
+ * @brief Converts a #half_float back to a float.
+ *
+ * @param x The value to convert.
+ */
+__attribute__((always_inline)) INLINE static float half_float_unpack(
+    const half_float x) {
+
+#ifdef SWIFT_HALF_PRECISION_CACHES
+  union {
+    uint32_t i;
+    float f;
+  } u = {(uint32_t)x << 16};
+  return u.f;
+#else
+  return x;
+#endif
+}
+
 #ifdef WITH_VECTORIZATION
 
 /* Need to check whether compiler supports this (IBM does not)
@@ -51,6 +103,9 @@
 #define VEC_INT __m512i
 #define KNL_MASK_16 __mmask16
 #define vec_load(a) _mm512_load_ps(a)
+#define vec_load_bf16(a)                 \
+  _mm512_castsi512_ps(_mm512_slli_epi32( \
+      _mm512_cvtepu16_epi32(_mm256_loadu_si256((__m256i *)(a))), 16))
 #define vec_store(a, addr) _mm512_store_ps(addr, a)
 #define vec_setzero() _mm512_setzero_ps()
 #define vec_setintzero() _mm512_setzero_epi32()
@@ -74,7 +129,7 @@
 #define vec_ftoi(a) _mm512_cvttps_epi32(a)
 #define vec_fmin(a, b) _mm512_min_ps(a, b)
 #define vec_fmax(a, b) _mm512_max_ps(a, b)
-#define vec_fabs(a) _mm512_andnot_ps(_mm512_set1_ps(-0.f), a)
+#define vec_fabs(a) _mm512_abs_ps(a)
 #define vec_floor(a) _mm512_floor_ps(a)
 #define vec_cmp_gt(a, b) _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ)
 #define vec_cmp_lt(a, b) _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ)
@@ -140,6 +195,9 @@
 /* Finds the horizontal maximum of vector b and returns a float. */
 #define VEC_HMAX(a, b) b = _mm512_reduce_max_ps(a.v)
 
+/* Finds the horizontal minimum of vector b and returns a float. */
+#define VEC_HMIN(a, b) b = _mm512_reduce_min_ps(a.v)
+
 /* Performs a left-pack on a vector based upon a mask and returns the result. */
 #define VEC_LEFT_PACK(a, mask, result) \
   _mm512_mask_compressstoreu_ps(result, mask, a)
@@ -223,6 +281,13 @@
     for (int k = 0; k < VEC_SIZE; k++) b = max(b, a.f[k]); \
   }
 
+/* Performs a horizontal minimum on the vector and takes the minimum of the
+ * result with a float, b. */
+#define VEC_HMIN(a, b)                                     \
+  {                                                        \
+    for (int k = 0; k < VEC_SIZE; k++) b = min(b, a.f[k]); \
+  }
+
 /* Returns the lower 128-bits of the 256-bit vector. */
 #define VEC_GET_LOW(a) _mm256_castps256_ps128(a)
 
@@ -238,6 +303,9 @@
 #define identity_indices 0x0706050403020100
 #define VEC_HAVE_GATHER
 #define vec_gather(base, offsets) _mm256_i32gather_ps(base, offsets.m, 1)
+#define vec_load_bf16(a)                 \
+  _mm256_castsi256_ps(_mm256_slli_epi32( \
+      _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i *)(a))), 16))
 
 /* Takes an integer mask and forms a left-packed integer vector
  * containing indices of the set bits in the integer mask.
@@ -359,6 +427,9 @@
 /* If SSE4.1 doesn't exist on architecture use alternative blend strategy. */
 #ifdef HAVE_SSE4_1
 #define vec_blend(mask, a, b) _mm_blendv_ps(a, b, mask.v)
+#define vec_load_bf16(a) \
+  _mm_castsi128_ps(      \
+      _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64((__m128i *)(a))), 16))
 #else
 #define vec_blend(mask, a, b) \
   _mm_or_ps(_mm_and_ps(mask.v, b), _mm_andnot_ps(mask.v, a))
@@ -391,6 +462,13 @@
     for (int k = 0; k < VEC_SIZE; k++) b = max(b, a.f[k]); \
   }
 
+/* Performs a horizontal minimum on the vector and takes the minimum of the
+ * result with a float, b. */
+#define VEC_HMIN(a, b)                                     \
+  {                                                        \
+    for (int k = 0; k < VEC_SIZE; k++) b = min(b, a.f[k]); \
+  }
+
 /* Create an FMA using vec_add and vec_mul if AVX2 is not present. */
 #ifndef vec_fma
 #define vec_fma(a, b, c) vec_add(vec_mul(a, b), c)
@@ -500,6 +578,27 @@ __attribute__((always_inline)) INLINE vector vector_setzero(void) {
   return temp;
 }
 
+/**
+ * @brief Returns a new vector with data loaded from an array of
+ * #half_float.
+ *
+ * @param x memory address to load from.
+ * @return Loaded #vector.
+ */
+__attribute__((always_inline)) INLINE static vector vector_load_half(
+    half_float *const x) {
+
+  vector temp;
+#if !defined(SWIFT_HALF_PRECISION_CACHES)
+  temp.v = vec_load(x);
+#elif defined(vec_load_bf16)
+  temp.v = vec_load_bf16(x);
+#else
+  for (int k = 0; k < VEC_SIZE; k++) temp.f[k] = half_float_unpack(x[k]);
+#endif
+  return temp;
+}
+
 #else
 /* Needed for cache alignment. */
 #define VEC_SIZE 8
@@ -0,0 +1,253 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "swift.h"
+
+/* A top-level cell split twice, one of its grand-children split again and
+ * one of its children only partly split: 65 leaves. */
+#define nr_test_cells (1 + 8 + 7 * 8 + 8 + 2)
+#define nr_threads 4
+#define nr_tries 200000
+
+/* The cell locks, in the order of #cell_lock_type. */
+int (*const locktree[cell_lock_count])(struct cell *) = {
+    cell_locktree,  cell_glocktree,     cell_mlocktree,
+    cell_slocktree, cell_sink_locktree, cell_blocktree};
+void (*const unlocktree[cell_lock_count])(struct cell *) = {
+    cell_unlocktree,  cell_gunlocktree,     cell_munlocktree,
+    cell_sunlocktree, cell_sink_unlocktree, cell_bunlocktree};
+
+/* Data shared by the threads of the concurrent test. */
+struct test_data {
+  struct cell *cells;
+  int type;
+  volatile int locked[nr_test_cells];
+};
+
+/**
+ * @brief Make a progeny of a cell.
+ */
+struct cell *make_progeny(struct cell *cells, int *count, struct cell *c,
+                          const int k) {
+
+  struct cell *cp = &cells[(*count)++];
+  cp->parent = c;
+  cp->top = c->top;
+  cp->depth = c->depth + 1;
+  c->progeny[k] = cp;
+  c->split = 1;
+  return cp;
+}
+
+/**
+ * @brief Build the tree of cells and initialise their locks.
+ */
+void make_tree(struct cell *cells) {
+
+  bzero(cells, nr_test_cells * sizeof(struct cell));
+  struct cell *top = &cells[0];
+  top->top = top;
+  int count = 1;
+
+  for (int k = 0; k < 8; k++) {
+
+    /* The last child only has two children of its own */
+    struct cell *cp = make_progeny(cells, &count, top, k);
+    for (int l = 0; l < (k < 7 ? 8 : 2); l++) {
+
+      struct cell *cpp =
+          make_progeny(cells, &count, cp, k < 7 ? l : 5 * l + 1);
+      if (k == 2 && l == 5)
+        for (int m = 0; m < 8; m++) make_progeny(cells, &count, cpp, m);
+    }
+  }
+  if (count != nr_test_cells)
+    error("Built %d cells instead of %d.", count, nr_test_cells);
+
+  for (int k = 0; k < nr_test_cells; k++) {
+    if (lock_init(&cells[k].hydro.lock) != 0 ||
+        lock_init(&cells[k].grav.plock) != 0 ||
+        lock_init(&cells[k].grav.mlock) != 0 ||
+        lock_init(&cells[k].stars.lock) != 0 ||
+        lock_init(&cells[k].sinks.lock) != 0 ||
+        lock_init(&cells[k].black_holes.lock) != 0)
+      error("Failed to init the locks.");
+  }
+}
+
+/**
+ * @brief Is one of two cells a parent of, or the same as, the other?
+ */
+int cells_are_related(const struct cell *ci, const struct cell *cj) {
+
+  for (const struct cell *c = ci; c != NULL; c = c->parent)
+    if (c == cj) return 1;
+  for (const struct cell *c = cj; c != NULL; c = c->parent)
+    if (c == ci) return 1;
+  return 0;
+}
+
+/**
+ * @brief Check that, with a first cell locked, a second one can be locked if
+ * and only if neither is a parent of the other, and that the other kinds of
+ * locks are unaffected.
+ */
+void test_pairs(struct cell *cells, const char *name) {
+
+  for (int type = 0; type < cell_lock_count; type++) {
+    for (int i = 0; i < nr_test_cells; i++) {
+
+      struct cell *ci = &cells[i];
+      if (locktree[type](ci) != 0)
+        error("%s: failed to lock free cell %d with lock %d.", name, i, type);
+
+      for (int j = 0; j < nr_test_cells; j++) {
+
+        struct cell *cj = &cells[j];
+        const int failed = (locktree[type](cj) != 0);
+        if (failed != cells_are_related(ci, cj))
+          error("%s: lock %d of cell %d %s with cell %d locked.", name, type,
+                j, failed ? "failed" : "succeeded", i);
+        if (!failed) unlocktree[type](cj);
+      }
+
+      /* The other kinds of locks are independent */
+      const int other = (type + 1) % cell_lock_count;
+      if (locktree[other](ci) != 0)
+        error("%s: lock %d of cell %d failed with lock %d taken.", name,
+              other, i, type);
+      unlocktree[other](ci);
+
+      unlocktree[type](ci);
+    }
+  }
+
+  /* Nothing is left locked or held */
+  for (int k = 0; k < nr_test_cells; k++)
+    if (cells[k].hydro.hold || cells[k].grav.phold || cells[k].grav.mhold ||
+        cells[k].stars.hold || cells[k].sinks.hold ||
+        cells[k].black_holes.hold)
+      error("%s: cell %d still held.", name, k);
+  if (cells[0].leaf_locks != NULL) {
+    const int size = cell_lock_count * cell_leaf_locks_size(&cells[0]);
+    for (int k = 0; k < size; k++)
+      if (cells[0].leaf_locks[k] != 0)
+        error("%s: leaves still locked in word %d.", name, k);
+  }
+
+  message("%s: pairs of cells lock as expected.", name);
+}
+
+/**
+ * @brief Lock random cells and check that no other thread has locked the same
+ * cell, one of its parents or one of its progeny in the meantime.
+ */
+void *runner(void *data) {
+
+  struct test_data *d = (struct test_data *)data;
+  unsigned int seed = (unsigned int)pthread_self();
+
+  for (int n = 0; n < nr_tries; n++) {
+
+    struct cell *c = &d->cells[rand_r(&seed) % nr_test_cells];
+    if (locktree[d->type](c) != 0) continue;
+
+    const int id = c - d->cells;
+    if (atomic_inc(&d->locked[id]) != 0)
+      error("Cell %d locked by two threads.", id);
+
+    for (int k = 0; k < nr_test_cells; k++)
+      if (k != id && d->locked[k] && cells_are_related(&d->cells[k], c))
+        error("Cells %d and %d locked at the same time.", k, id);
+
+    atomic_dec(&d->locked[id]);
+
+    unlocktree[d->type](c);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Run the concurrent test on every kind of lock.
+ */
+void test_threads(struct cell *cells, const char *name) {
+
+  for (int type = 0; type < cell_lock_count; type++) {
+
+    struct test_data d;
+    bzero(&d, sizeof(struct test_data));
+    d.cells = cells;
+    d.type = type;
+
+    pthread_t threads[nr_threads];
+    for (int k = 0; k < nr_threads; k++)
+      if (pthread_create(&threads[k], NULL, runner, &d) != 0)
+        error("Failed to create thread.");
+    for (int k = 0; k < nr_threads; k++) pthread_join(threads[k], NULL);
+  }
+
+  message("%s: no related cells locked by two threads at once.", name);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  struct cell *cells = NULL;
+  if (posix_memalign((void **)&cells, cell_align,
+                     nr_test_cells * sizeof(struct cell)) != 0)
+    error("Failed to allocate cells.");
+  make_tree(cells);
+
+  struct space s;
+  bzero(&s, sizeof(struct space));
+  s.nr_cells = 1;
+  s.cells_top = cells;
+
+  /* Locks that hold the parents */
+  test_pairs(cells, "holds");
+  test_threads(cells, "holds");
+
+  /* Locks that set the bits of the leaves */
+  s.with_leaf_locks = 1;
+  space_allocate_leaf_locks(&s);
+  if (cells[0].leaf_count != 65)
+    error("Numbered %d leaves instead of 65.", cells[0].leaf_count);
+  test_pairs(cells, "leaves");
+  test_threads(cells, "leaves");
+
+  s.with_leaf_locks = 0;
+  space_allocate_leaf_locks(&s);
+  free(cells);
+
+  return 0;
+}
@@ -0,0 +1,231 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Local headers. */
+#include "multipole_batch.h"
+#include "swift.h"
+
+#define nr_sources 1000
+#define nr_sinks 200
+#define nr_gparts 8
+
+/* Number of terms in a field tensor */
+#define nr_terms                                                           \
+  ((SELF_GRAVITY_MULTIPOLE_ORDER + 1) * (SELF_GRAVITY_MULTIPOLE_ORDER + 2) * \
+   (SELF_GRAVITY_MULTIPOLE_ORDER + 3) / 6)
+
+/* Relative tolerance on the field tensors */
+const float tolerance = 1e-4f;
+
+/**
+ * @brief Constructs a multipole from a few particles spread around a
+ * position, with a given softening length.
+ */
+void make_multipole(struct gravity_tensors *t, const double x[3], double w,
+                    float eps, struct gravity_props *grav_props) {
+
+  struct gpart gparts[nr_gparts];
+  bzero(gparts, sizeof(gparts));
+  for (int k = 0; k < nr_gparts; k++) {
+    for (int d = 0; d < 3; d++)
+      gparts[k].x[d] = x[d] + w * (rand() / ((double)RAND_MAX) - 0.5);
+    gparts[k].mass = 0.5 + rand() / ((double)RAND_MAX);
+    gparts[k].type = swift_type_dark_matter;
+    gparts[k].time_bin = 1;
+#ifdef MULTI_SOFTENING_GRAVITY
+    gparts[k].epsilon = eps;
+#endif
+  }
+
+  grav_props->epsilon_DM_cur = eps;
+  gravity_reset(t);
+  gravity_P2M(t, gparts, nr_gparts, grav_props);
+  gravity_multipole_compute_power(&t->m_pole);
+}
+
+/**
+ * @brief Computes the field tensor of a sink due to all the sources with the
+ * scalar and the batched M2L kernels and checks that they agree.
+ */
+void check_M2L_batch(const struct gravity_tensors *sink,
+                     const struct gravity_tensors *sources,
+                     const struct gravity_props *grav_props, int periodic,
+                     const double dim[3], float r_s_inv,
+                     struct multipole_batch *b) {
+
+  /* Scalar version, also keeping the sum of the absolute values of the
+   * contributions to scale the errors */
+  struct grav_tensor l_ref, l_abs;
+  gravity_field_tensors_init(&l_ref, 0);
+  gravity_field_tensors_init(&l_abs, 0);
+  for (int n = 0; n < nr_sources; n++) {
+    struct grav_tensor l;
+    gravity_field_tensors_init(&l, 0);
+    gravity_M2L_nonsym(&l, &sources[n].m_pole, sink->CoM, sources[n].CoM,
+                       grav_props, periodic, dim, r_s_inv);
+    const float *F = &l.F_000;
+    float *F_ref = &l_ref.F_000;
+    float *F_abs = &l_abs.F_000;
+    for (int k = 0; k < nr_terms; k++) {
+      F_ref[k] += F[k];
+      F_abs[k] += fabsf(F[k]);
+    }
+  }
+
+  /* Batched version */
+  struct grav_tensor l_batch;
+  gravity_field_tensors_init(&l_batch, 0);
+  multipole_batch_init(b);
+  for (int n = 0; n < nr_sources; n++) {
+    if (b->count == multipole_batch_size) {
+      gravity_M2L_batch(&l_batch, b, periodic, r_s_inv);
+      multipole_batch_init(b);
+    }
+    multipole_batch_add(b, &sources[n].m_pole, sink->CoM, sources[n].CoM,
+                        periodic, dim);
+  }
+  gravity_M2L_batch(&l_batch, b, periodic, r_s_inv);
+
+  const float *F_ref = &l_ref.F_000;
+  const float *F_abs = &l_abs.F_000;
+  const float *F_batch = &l_batch.F_000;
+  for (int k = 0; k < nr_terms; k++)
+    if (fabsf(F_batch[k] - F_ref[k]) > tolerance * F_abs[k])
+      error(
+          "Batched M2L (periodic=%d) differs in term %d: %e instead of %e "
+          "(sum of magnitudes %e).",
+          periodic, k, F_batch[k], F_ref[k], F_abs[k]);
+
+  if (!l_batch.interacted) error("Batched M2L did not record interaction.");
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  /* Get some randomness going */
+  const int seed = time(NULL);
+  message("Seed = %d", seed);
+  srand(seed);
+
+  /* Construct gravity properties */
+  struct gravity_props grav_props;
+  bzero(&grav_props, sizeof(struct gravity_props));
+  grav_props.G_Newton = 1.;
+  grav_props.mesh_size = 64;
+  grav_props.a_smooth = 1.25;
+
+  /* Space properites */
+  const double dim[3] = {100., 100., 100.};
+  const double r_s = grav_props.a_smooth * dim[0] / grav_props.mesh_size;
+  const float r_s_inv = 1. / r_s;
+
+  struct gravity_tensors *sinks = NULL, *sources = NULL;
+  if (posix_memalign((void **)&sinks, SWIFT_CACHE_ALIGNMENT,
+                     nr_sinks * sizeof(struct gravity_tensors)) != 0 ||
+      posix_memalign((void **)&sources, SWIFT_CACHE_ALIGNMENT,
+                     nr_sources * sizeof(struct gravity_tensors)) != 0)
+    error("Error allocating memory for multipoles array.");
+  struct multipole_batch *b = NULL;
+  if (posix_memalign((void **)&b, SWIFT_CACHE_ALIGNMENT,
+                     sizeof(struct multipole_batch)) != 0)
+    error("Error allocating memory for multipole batch.");
+
+  /* Sinks in the middle of the box, sources up to the mesh cut-off radius
+   * away, a few of them close enough to be softened */
+  for (int n = 0; n < nr_sinks; n++) {
+    const double x[3] = {50. + rand() / ((double)RAND_MAX),
+                         50. + rand() / ((double)RAND_MAX),
+                         50. + rand() / ((double)RAND_MAX)};
+    make_multipole(&sinks[n], x, 1., 0.1f, &grav_props);
+  }
+  for (int n = 0; n < nr_sources; n++) {
+    double x[3];
+    double r2;
+    do {
+      for (int d = 0; d < 3; d++)
+        x[d] = 50. + 4.5 * r_s * (2. * rand() / ((double)RAND_MAX) - 1.);
+      r2 = (x[0] - 50.) * (x[0] - 50.) + (x[1] - 50.) * (x[1] - 50.) +
+           (x[2] - 50.) * (x[2] - 50.);
+    } while (r2 < 4.);
+    make_multipole(&sources[n], x, 1., n % 10 == 0 ? 5.f : 0.1f, &grav_props);
+  }
+
+  /* Check the accuracy of the batched kernel */
+  for (int periodic = 0; periodic < 2; periodic++)
+    for (int n = 0; n < nr_sinks; n++)
+      check_M2L_batch(&sinks[n], sources, &grav_props, periodic, dim, r_s_inv,
+                      b);
+
+  /* And time both kernels */
+  for (int periodic = 0; periodic < 2; periodic++) {
+
+    ticks tic = getticks();
+    for (int n = 0; n < nr_sinks; n++)
+      for (int m = 0; m < nr_sources; m++)
+        gravity_M2L_nonsym(&sinks[n].pot, &sources[m].m_pole, sinks[n].CoM,
+                           sources[m].CoM, &grav_props, periodic, dim,
+                           r_s_inv);
+    const ticks time_scalar = getticks() - tic;
+
+    tic = getticks();
+    for (int n = 0; n < nr_sinks; n++) {
+      multipole_batch_init(b);
+      for (int m = 0; m < nr_sources; m++) {
+        if (b->count == multipole_batch_size) {
+          gravity_M2L_batch(&sinks[n].pot, b, periodic, r_s_inv);
+          multipole_batch_init(b);
+        }
+        multipole_batch_add(b, &sources[m].m_pole, sinks[n].CoM,
+                            sources[m].CoM, periodic, dim);
+      }
+      gravity_M2L_batch(&sinks[n].pot, b, periodic, r_s_inv);
+    }
+    const ticks time_batch = getticks() - tic;
+
+    message(
+        "%s M2L at order %d: scalar %5.1f ns, batched %5.1f ns per "
+        "interaction.",
+        periodic ? "Periodic" : "Non-periodic", SELF_GRAVITY_MULTIPOLE_ORDER,
+        1e6 * clocks_from_ticks(time_scalar) / nr_sinks / nr_sources,
+        1e6 * clocks_from_ticks(time_batch) / nr_sinks / nr_sources);
+  }
+
+  free(sinks);
+  free(sources);
+  free(b);
+  return 0;
+}
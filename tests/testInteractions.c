@@ -27,15 +27,24 @@
 
 /* Local includes */
 #include "swift.h"
+#include "timestep_limiter_iact.h"
 
 /* Other schemes need to be added here if they are not vectorized, otherwise
  * this test will simply not compile. */
 
-#if defined(GADGET2_SPH) && defined(WITH_VECTORIZATION)
+#if defined(WITH_VECTORIZATION) && \
+    (defined(GADGET2_SPH) || (defined(SPHENIX_SPH) && defined(NONE_MHD)))
 
 #define array_align sizeof(float) * VEC_SIZE
 #define ACC_THRESHOLD 1e-5
 
+/* Where the velocity divergence is accumulated. */
+#if defined(SPHENIX_SPH)
+#define test_div_v viscosity.div_v
+#else
+#define test_div_v density.div_v
+#endif
+
 #ifndef IACT
 #define IACT runner_iact_nonsym_density
 #define IACT_VEC runner_iact_nonsym_1_vec_density
@@ -126,6 +135,26 @@ void prepare_force(struct part *parts, size_t count) {
     p->force.v_sig = 0.0f;
     p->force.h_dt = 0.0f;
   }
+#elif defined(SPHENIX_SPH)
+  struct part *p;
+  for (size_t i = 0; i < count; ++i) {
+    p = &parts[i];
+    p->rho = i + 1;
+    p->u = random_uniform(1.0, 2.0);
+    p->force.f = random_uniform(0.0, 1.0);
+    p->force.balsara = random_uniform(0.0, 1.0);
+    p->force.pressure = i + 1;
+    p->force.soundspeed = random_uniform(2.0, 3.0);
+    p->force.h_dt = 0.0f;
+    p->force.alpha_visc_max_ngb = 0.0f;
+    p->viscosity.alpha = random_uniform(0.0, 1.0);
+    p->viscosity.v_sig = 0.0f;
+    p->diffusion.alpha = random_uniform(0.0, 1.0);
+    p->diffusion.laplace_u = 0.0f;
+    p->u_dt = 0.0f;
+    p->time_bin = 1 + i % 20;
+    p->limiter_data.min_ngb_time_bin = num_time_bins;
+  }
 #endif
 }
 
@@ -146,7 +175,7 @@ void dump_indv_particle_fields(char *fileName, struct part *p) {
     defined(SHADOWFAX_SPH) || defined(PHANTOM_SPH) || defined(GASOLINE_SPH)
           0.f,
 #else
-          p->density.div_v,
+          p->test_div_v,
 #endif
           hydro_get_drifted_comoving_entropy(p),
           hydro_get_drifted_comoving_internal_energy(p),
@@ -156,9 +185,11 @@ void dump_indv_particle_fields(char *fileName, struct part *p) {
           p->force.v_sig, p->entropy_dt, 0.f
 #elif defined(PHANTOM_SPH)
           p->force.v_sig, 0.f, p->force.u_dt
+#elif defined(SPHENIX_SPH)
+          p->viscosity.v_sig, 0.f, p->u_dt
 #elif defined(MINIMAL_SPH) || defined(HOPKINS_PU_SPH) ||           \
     defined(HOPKINS_PU_SPH_MONAGHAN) || defined(ANARCHY_PU_SPH) || \
-    defined(SPHENIX_SPH) || defined(PHANTOM_SPH) || defined(GASOLINE_SPH)
+    defined(PHANTOM_SPH) || defined(GASOLINE_SPH)
           p->force.v_sig, 0.f, p->u_dt
 #else
           0.f, 0.f, 0.f
@@ -391,7 +422,7 @@ void test_interactions(struct part test_part, struct part *parts, size_t count,
     VEC_HADD(rho_dhSum, piq[0]->density.rho_dh);
     VEC_HADD(wcountSum, piq[0]->density.wcount);
     VEC_HADD(wcount_dhSum, piq[0]->density.wcount_dh);
-    VEC_HADD(div_vSum, piq[0]->density.div_v);
+    VEC_HADD(div_vSum, piq[0]->test_div_v);
     VEC_HADD(curlvxSum, piq[0]->density.rot_v[0]);
     VEC_HADD(curlvySum, piq[0]->density.rot_v[1]);
     VEC_HADD(curlvzSum, piq[0]->density.rot_v[2]);
@@ -415,6 +446,8 @@ void test_interactions(struct part test_part, struct part *parts, size_t count,
   message("Speed up: %15fx.", (double)(serial_time) / vec_time);
 }
 
+#if defined(GADGET2_SPH)
+
 /*
  * @brief Calls the serial and vectorised version of the non-symmetrical force
  * interaction.
@@ -485,7 +518,7 @@ void test_force_interactions(struct part test_part, struct part *parts,
   float rhojq[count] __attribute__((aligned(array_align)));
   float grad_hjq[count] __attribute__((aligned(array_align)));
   float pOrhoj2q[count] __attribute__((aligned(array_align)));
-  float balsarajq[count] __attribute__((aligned(array_align)));
+  half_float balsarajq[count] __attribute__((aligned(array_align)));
   float cjq[count] __attribute__((aligned(array_align)));
 
   /* Call serial interaction a set number of times. */
@@ -587,7 +620,7 @@ void test_force_interactions(struct part test_part, struct part *parts,
     !defined(GASOLINE_SPH)
       pOrhoj2q[i] = pj_vec[i].force.P_over_rho2;
 #endif
-      balsarajq[i] = pj_vec[i].force.balsara;
+      balsarajq[i] = half_float_pack(pj_vec[i].force.balsara);
       cjq[i] = pj_vec[i].force.soundspeed;
     }
 
@@ -695,6 +728,479 @@ void test_force_interactions(struct part test_part, struct part *parts,
   message("Speed up: %15fx.", (double)(serial_time) / vec_time);
 }
 
+#elif defined(SPHENIX_SPH)
+
+/*
+ * @brief Calls the serial and vectorised version of the non-symmetrical
+ * gradient interaction.
+ *
+ * @param test_part Particle that will be updated
+ * @param parts Particle array to be interacted
+ * @param count No. of particles to be interacted
+ * @param filePrefix Prefix of the files the particles are dumped to
+ * @param runs No. of times to call interactions
+ */
+void test_gradient_interactions(struct part test_part, struct part *parts,
+                                size_t count, char *filePrefix, int runs) {
+
+  ticks serial_time = 0;
+  ticks vec_time = 0;
+
+  char serial_filename[200] = "";
+  char vec_filename[200] = "";
+
+  const float a = 1.f;
+  const float H = 0.f;
+
+  strcpy(serial_filename, filePrefix);
+  strcpy(vec_filename, filePrefix);
+  sprintf(serial_filename + strlen(serial_filename), "_serial.dat");
+  sprintf(vec_filename + strlen(vec_filename), "_1_vec.dat");
+
+  write_header(serial_filename);
+  write_header(vec_filename);
+
+  struct part pi_serial, pi_vec;
+  struct part pj_serial[count], pj_vec[count];
+
+  float r2[count] __attribute__((aligned(array_align)));
+  float dx[3 * count] __attribute__((aligned(array_align)));
+
+  float r2q[count] __attribute__((aligned(array_align)));
+  float dxq[count] __attribute__((aligned(array_align)));
+  float dyq[count] __attribute__((aligned(array_align)));
+  float dzq[count] __attribute__((aligned(array_align)));
+
+  float mjq[count] __attribute__((aligned(array_align)));
+  float vjxq[count] __attribute__((aligned(array_align)));
+  float vjyq[count] __attribute__((aligned(array_align)));
+  float vjzq[count] __attribute__((aligned(array_align)));
+  float ujq[count] __attribute__((aligned(array_align)));
+  float rhojq[count] __attribute__((aligned(array_align)));
+  float cjq[count] __attribute__((aligned(array_align)));
+  half_float alphajq[count] __attribute__((aligned(array_align)));
+
+  /* Call serial interaction a set number of times. */
+  for (int r = 0; r < runs; r++) {
+    /* Reset particle to initial setup */
+    pi_serial = test_part;
+    for (size_t i = 0; i < count; i++) pj_serial[i] = parts[i];
+
+    /* Perform serial interaction */
+    for (size_t i = 0; i < count; i++) {
+      /* Compute the pairwise distance. */
+      r2[i] = 0.0f;
+      for (int k = 0; k < 3; k++) {
+        int ind = (3 * i) + k;
+        dx[ind] = pi_serial.x[k] - pj_serial[i].x[k];
+        r2[i] += dx[ind] * dx[ind];
+      }
+    }
+
+    const ticks tic = getticks();
+/* Perform serial interaction */
+#ifdef __ICC
+#pragma novector
+#endif
+    for (size_t i = 0; i < count; i++) {
+      runner_iact_nonsym_gradient(r2[i], &(dx[3 * i]), pi_serial.h,
+                                  pj_serial[i].h, &pi_serial, &pj_serial[i], a,
+                                  H);
+    }
+    serial_time += getticks() - tic;
+  }
+
+  /* Dump result of serial interaction. */
+  dump_indv_particle_fields(serial_filename, &pi_serial);
+  for (size_t i = 0; i < count; i++)
+    dump_indv_particle_fields(serial_filename, &pj_serial[i]);
+
+  /* Call vector interaction a set number of times. */
+  for (int r = 0; r < runs; r++) {
+    /* Reset particle to initial setup */
+    pi_vec = test_part;
+    for (size_t i = 0; i < count; i++) pj_vec[i] = parts[i];
+
+    /* Setup arrays for vector interaction. */
+    for (size_t i = 0; i < count; i++) {
+      /* Compute the pairwise distance. */
+      float my_r2 = 0.0f;
+      float my_dx[3];
+      for (int k = 0; k < 3; k++) {
+        my_dx[k] = pi_vec.x[k] - pj_vec[i].x[k];
+        my_r2 += my_dx[k] * my_dx[k];
+      }
+
+      r2q[i] = my_r2;
+      dxq[i] = my_dx[0];
+      dyq[i] = my_dx[1];
+      dzq[i] = my_dx[2];
+
+      mjq[i] = pj_vec[i].mass;
+      vjxq[i] = pj_vec[i].v[0];
+      vjyq[i] = pj_vec[i].v[1];
+      vjzq[i] = pj_vec[i].v[2];
+      ujq[i] = pj_vec[i].u;
+      rhojq[i] = pj_vec[i].rho;
+      cjq[i] = pj_vec[i].force.soundspeed;
+      alphajq[i] = half_float_pack(pj_vec[i].viscosity.alpha);
+    }
+
+    /* Perform vector interaction. */
+    const vector hi_inv_vec = vector_set1(1.f / pi_vec.h);
+    const vector vix_vec = vector_set1(pi_vec.v[0]);
+    const vector viy_vec = vector_set1(pi_vec.v[1]);
+    const vector viz_vec = vector_set1(pi_vec.v[2]);
+    const vector ui_vec = vector_set1(pi_vec.u);
+    const vector ci_vec = vector_set1(pi_vec.force.soundspeed);
+
+    vector v_sigSum = vector_set1(pi_vec.viscosity.v_sig);
+    vector laplace_uSum = vector_setzero();
+    vector alpha_visc_max_ngbSum = vector_set1(pi_vec.force.alpha_visc_max_ngb);
+
+    mask_t mask;
+    vec_init_mask_true(mask);
+
+    const ticks vec_tic = getticks();
+
+    for (size_t i = 0; i < count; i += VEC_SIZE) {
+
+      vector my_r2, my_dx, my_dy, my_dz;
+      my_r2.v = vec_load(&(r2q[i]));
+      my_dx.v = vec_load(&(dxq[i]));
+      my_dy.v = vec_load(&(dyq[i]));
+      my_dz.v = vec_load(&(dzq[i]));
+
+      runner_iact_nonsym_1_vec_gradient(
+          &my_r2, &my_dx, &my_dy, &my_dz, vix_vec, viy_vec, viz_vec, ui_vec,
+          ci_vec, &(vjxq[i]), &(vjyq[i]), &(vjzq[i]), &(ujq[i]), &(rhojq[i]),
+          &(cjq[i]), &(alphajq[i]), &(mjq[i]), hi_inv_vec, a, H, &v_sigSum,
+          &laplace_uSum, &alpha_visc_max_ngbSum, mask);
+    }
+
+    VEC_HMAX(v_sigSum, pi_vec.viscosity.v_sig);
+    VEC_HADD(laplace_uSum, pi_vec.diffusion.laplace_u);
+    VEC_HMAX(alpha_visc_max_ngbSum, pi_vec.force.alpha_visc_max_ngb);
+
+    vec_time += getticks() - vec_tic;
+  }
+
+  /* Dump result of vector interaction. */
+  dump_indv_particle_fields(vec_filename, &pi_vec);
+  for (size_t i = 0; i < count; i++)
+    dump_indv_particle_fields(vec_filename, &pj_vec[i]);
+
+  /* Check serial results against the vectorised results. */
+  if (check_results(pi_serial, pj_serial, pi_vec, pj_vec, count))
+    message("Differences found...");
+  if (pi_serial.force.alpha_visc_max_ngb != pi_vec.force.alpha_visc_max_ngb)
+    message("Differences found in alpha_visc_max_ngb...");
+
+  message("The serial interactions took     : %.3f %s.",
+          clocks_from_ticks(serial_time / runs), clocks_getunit());
+  message("The vectorised interactions took : %.3f %s.",
+          clocks_from_ticks(vec_time / runs), clocks_getunit());
+  message("Speed up: %15fx.", (double)(serial_time) / vec_time);
+}
+
+/*
+ * @brief Calls the serial and vectorised version of the non-symmetrical force
+ * interaction, including the time-step limiter.
+ *
+ * @param test_part Particle that will be updated
+ * @param parts Particle array to be interacted
+ * @param count No. of particles to be interacted
+ * @param filePrefix Prefix of the files the particles are dumped to
+ * @param runs No. of times to call interactions
+ */
+void test_force_interactions(struct part test_part, struct part *parts,
+                             size_t count, char *filePrefix, int runs) {
+
+  ticks serial_time = 0;
+  ticks vec_time = 0;
+
+  char serial_filename[200] = "";
+  char vec_filename[200] = "";
+
+  const float a = 1.f;
+  const float H = 0.f;
+
+  strcpy(serial_filename, filePrefix);
+  strcpy(vec_filename, filePrefix);
+  sprintf(serial_filename + strlen(serial_filename), "_serial.dat");
+  sprintf(vec_filename + strlen(vec_filename), "_1_vec.dat");
+
+  write_header(serial_filename);
+  write_header(vec_filename);
+
+  struct part pi_serial, pi_vec;
+  struct part pj_serial[count], pj_vec[count];
+
+  float r2[count] __attribute__((aligned(array_align)));
+  float dx[3 * count] __attribute__((aligned(array_align)));
+
+  float r2q[count] __attribute__((aligned(array_align)));
+  float dxq[count] __attribute__((aligned(array_align)));
+  float dyq[count] __attribute__((aligned(array_align)));
+  float dzq[count] __attribute__((aligned(array_align)));
+
+  float hjq[count] __attribute__((aligned(array_align)));
+  float mjq[count] __attribute__((aligned(array_align)));
+  float vjxq[count] __attribute__((aligned(array_align)));
+  float vjyq[count] __attribute__((aligned(array_align)));
+  float vjzq[count] __attribute__((aligned(array_align)));
+  float rhojq[count] __attribute__((aligned(array_align)));
+  float grad_hjq[count] __attribute__((aligned(array_align)));
+  float pressurejq[count] __attribute__((aligned(array_align)));
+  half_float balsarajq[count] __attribute__((aligned(array_align)));
+  float cjq[count] __attribute__((aligned(array_align)));
+  half_float alpha_viscjq[count] __attribute__((aligned(array_align)));
+  half_float alpha_diffjq[count] __attribute__((aligned(array_align)));
+  float ujq[count] __attribute__((aligned(array_align)));
+  float time_binjq[count] __attribute__((aligned(array_align)));
+
+  /* Call serial interaction a set number of times. */
+  for (int r = 0; r < runs; r++) {
+    /* Reset particle to initial setup */
+    pi_serial = test_part;
+    for (size_t i = 0; i < count; i++) pj_serial[i] = parts[i];
+
+    /* Perform serial interaction */
+    for (size_t i = 0; i < count; i++) {
+      /* Compute the pairwise distance. */
+      r2[i] = 0.0f;
+      for (int k = 0; k < 3; k++) {
+        int ind = (3 * i) + k;
+        dx[ind] = pi_serial.x[k] - pj_serial[i].x[k];
+        r2[i] += dx[ind] * dx[ind];
+      }
+    }
+
+    const ticks tic = getticks();
+/* Perform serial interaction */
+#ifdef __ICC
+#pragma novector
+#endif
+    for (size_t i = 0; i < count; i++) {
+      runner_iact_nonsym_force(r2[i], &(dx[3 * i]), pi_serial.h, pj_serial[i].h,
+                               &pi_serial, &pj_serial[i], a, H);
+      runner_iact_nonsym_timebin(r2[i], &(dx[3 * i]), pi_serial.h,
+                                 pj_serial[i].h, &pi_serial, &pj_serial[i], a,
+                                 H);
+    }
+    serial_time += getticks() - tic;
+  }
+
+  /* Dump result of serial interaction. */
+  dump_indv_particle_fields(serial_filename, &pi_serial);
+  for (size_t i = 0; i < count; i++)
+    dump_indv_particle_fields(serial_filename, &pj_serial[i]);
+
+  /* Call vector interaction a set number of times. */
+  for (int r = 0; r < runs; r++) {
+    /* Reset particle to initial setup */
+    pi_vec = test_part;
+    for (size_t i = 0; i < count; i++) pj_vec[i] = parts[i];
+
+    /* Setup arrays for vector interaction. */
+    for (size_t i = 0; i < count; i++) {
+      /* Compute the pairwise distance. */
+      float my_r2 = 0.0f;
+      float my_dx[3];
+      for (int k = 0; k < 3; k++) {
+        my_dx[k] = pi_vec.x[k] - pj_vec[i].x[k];
+        my_r2 += my_dx[k] * my_dx[k];
+      }
+
+      r2q[i] = my_r2;
+      dxq[i] = my_dx[0];
+      dyq[i] = my_dx[1];
+      dzq[i] = my_dx[2];
+
+      hjq[i] = pj_vec[i].h;
+      mjq[i] = pj_vec[i].mass;
+      vjxq[i] = pj_vec[i].v[0];
+      vjyq[i] = pj_vec[i].v[1];
+      vjzq[i] = pj_vec[i].v[2];
+      rhojq[i] = pj_vec[i].rho;
+      grad_hjq[i] = pj_vec[i].force.f;
+      pressurejq[i] = pj_vec[i].force.pressure;
+      balsarajq[i] = half_float_pack(pj_vec[i].force.balsara);
+      cjq[i] = pj_vec[i].force.soundspeed;
+      alpha_viscjq[i] = half_float_pack(pj_vec[i].viscosity.alpha);
+      alpha_diffjq[i] = half_float_pack(pj_vec[i].diffusion.alpha);
+      ujq[i] = pj_vec[i].u;
+      time_binjq[i] = pj_vec[i].time_bin;
+    }
+
+    /* Perform vector interaction. */
+    const vector hi_inv_vec = vector_set1(1.f / pi_vec.h);
+    const vector vix_vec = vector_set1(pi_vec.v[0]);
+    const vector viy_vec = vector_set1(pi_vec.v[1]);
+    const vector viz_vec = vector_set1(pi_vec.v[2]);
+    const vector rhoi_vec = vector_set1(pi_vec.rho);
+    const vector grad_hi_vec = vector_set1(pi_vec.force.f);
+    const vector pressure_i_vec = vector_set1(pi_vec.force.pressure);
+    const vector balsara_i_vec = vector_set1(pi_vec.force.balsara);
+    const vector ci_vec = vector_set1(pi_vec.force.soundspeed);
+    const vector alpha_visc_i_vec = vector_set1(pi_vec.viscosity.alpha);
+    const vector alpha_diff_i_vec = vector_set1(pi_vec.diffusion.alpha);
+    const vector ui_vec = vector_set1(pi_vec.u);
+    const vector mi_vec = vector_set1(pi_vec.mass);
+
+    vector a_hydro_xSum = vector_setzero();
+    vector a_hydro_ySum = vector_setzero();
+    vector a_hydro_zSum = vector_setzero();
+    vector h_dtSum = vector_setzero();
+    vector u_dtSum = vector_setzero();
+    vector min_ngb_time_binSum =
+        vector_set1(pi_vec.limiter_data.min_ngb_time_bin);
+
+    mask_t mask;
+    vec_init_mask_true(mask);
+
+    const ticks vec_tic = getticks();
+
+    for (size_t i = 0; i < count; i += VEC_SIZE) {
+
+      vector my_r2, my_dx, my_dy, my_dz, hj, hj_inv;
+      my_r2.v = vec_load(&(r2q[i]));
+      my_dx.v = vec_load(&(dxq[i]));
+      my_dy.v = vec_load(&(dyq[i]));
+      my_dz.v = vec_load(&(dzq[i]));
+      hj.v = vec_load(&(hjq[i]));
+      hj_inv = vec_reciprocal(hj);
+
+      runner_iact_nonsym_1_vec_force(
+          &my_r2, &my_dx, &my_dy, &my_dz, vix_vec, viy_vec, viz_vec, rhoi_vec,
+          grad_hi_vec, pressure_i_vec, balsara_i_vec, ci_vec, alpha_visc_i_vec,
+          alpha_diff_i_vec, ui_vec, mi_vec, &(vjxq[i]), &(vjyq[i]), &(vjzq[i]),
+          &(rhojq[i]), &(grad_hjq[i]), &(pressurejq[i]), &(balsarajq[i]),
+          &(cjq[i]), &(alpha_viscjq[i]), &(alpha_diffjq[i]), &(ujq[i]),
+          &(mjq[i]), &(time_binjq[i]), hi_inv_vec, hj_inv, a, H, &a_hydro_xSum,
+          &a_hydro_ySum, &a_hydro_zSum, &h_dtSum, &u_dtSum,
+          &min_ngb_time_binSum, mask);
+    }
+
+    VEC_HADD(a_hydro_xSum, pi_vec.a_hydro[0]);
+    VEC_HADD(a_hydro_ySum, pi_vec.a_hydro[1]);
+    VEC_HADD(a_hydro_zSum, pi_vec.a_hydro[2]);
+    VEC_HADD(h_dtSum, pi_vec.force.h_dt);
+    VEC_HADD(u_dtSum, pi_vec.u_dt);
+    float min_ngb_time_bin = pi_vec.limiter_data.min_ngb_time_bin;
+    VEC_HMIN(min_ngb_time_binSum, min_ngb_time_bin);
+    pi_vec.limiter_data.min_ngb_time_bin = (timebin_t)min_ngb_time_bin;
+
+    vec_time += getticks() - vec_tic;
+  }
+
+  /* Dump result of vector interaction. */
+  dump_indv_particle_fields(vec_filename, &pi_vec);
+  for (size_t i = 0; i < count; i++)
+    dump_indv_particle_fields(vec_filename, &pj_vec[i]);
+
+  /* Check serial results against the vectorised results. */
+  if (check_results(pi_serial, pj_serial, pi_vec, pj_vec, count))
+    message("Differences found...");
+
+  message("The serial interactions took     : %.3f %s.",
+          clocks_from_ticks(serial_time / runs), clocks_getunit());
+  message("The vectorised interactions took : %.3f %s.",
+          clocks_from_ticks(vec_time / runs), clocks_getunit());
+  message("Speed up: %15fx.", (double)(serial_time) / vec_time);
+}
+
+#endif /* GADGET2_SPH */
+
+#if defined(GADGET2_SPH) || defined(SPHENIX_SPH)
+
+/**
+ * @brief Rounds the fields of the particles that the caches store as
+ * #half_float, so that the serial and vectorised interactions see the same
+ * values.
+ */
+void round_half_fields(struct part *parts, size_t count) {
+
+  for (size_t i = 0; i < count; i++) {
+    struct part *p = &parts[i];
+#define ROUND_HALF_FIELD(name, field) \
+  p->field = half_float_unpack(half_float_pack(p->field));
+    HYDRO_CACHE_HALF_FIELDS(ROUND_HALF_FIELD)
+#undef ROUND_HALF_FIELD
+  }
+}
+
+/**
+ * @brief Measures the error made on the serial force interactions by
+ * rounding the fields that the caches store as #half_float, and reports the
+ * memory used by the caches for each particle.
+ */
+void test_half_precision_error(struct part test_part, struct part *parts,
+                               size_t count) {
+
+  const float a = 1.f;
+  const float H = 0.f;
+
+  struct part pi_full = test_part, pi_half = test_part;
+  struct part pj_full[count], pj_half[count];
+  for (size_t i = 0; i < count; i++) pj_full[i] = pj_half[i] = parts[i];
+  round_half_fields(&pi_half, 1);
+  round_half_fields(pj_half, count);
+
+  for (size_t i = 0; i < count; i++) {
+    float dx[3], r2 = 0.f;
+    for (int k = 0; k < 3; k++) {
+      dx[k] = pi_full.x[k] - pj_full[i].x[k];
+      r2 += dx[k] * dx[k];
+    }
+    runner_iact_nonsym_force(r2, dx, pi_full.h, pj_full[i].h, &pi_full,
+                             &pj_full[i], a, H);
+    runner_iact_nonsym_force(r2, dx, pi_half.h, pj_half[i].h, &pi_half,
+                             &pj_half[i], a, H);
+  }
+
+  /* Relative errors on the accelerations and the time derivatives. */
+  float a_norm = 0.f, a_diff = 0.f;
+  for (int k = 0; k < 3; k++) {
+    a_norm += pi_full.a_hydro[k] * pi_full.a_hydro[k];
+    a_diff += (pi_half.a_hydro[k] - pi_full.a_hydro[k]) *
+              (pi_half.a_hydro[k] - pi_full.a_hydro[k]);
+  }
+  const float err_a = sqrtf(a_diff / a_norm);
+  const float err_h_dt = fabsf(pi_half.force.h_dt - pi_full.force.h_dt) /
+                         fabsf(pi_full.force.h_dt);
+#if defined(SPHENIX_SPH)
+  const float err_u_dt =
+      fabsf(pi_half.u_dt - pi_full.u_dt) / fabsf(pi_full.u_dt);
+#else
+  const float err_u_dt = fabsf(pi_half.entropy_dt - pi_full.entropy_dt) /
+                         fabsf(pi_full.entropy_dt);
+#endif
+
+  /* The cache stores the positions, smoothing lengths, masses, velocities
+   * and neighbour indices next to the fields of the scheme. */
+#define COUNT_FIELD(name, field) +1
+  const size_t num_float = 0 HYDRO_CACHE_FIELDS(COUNT_FIELD);
+  const size_t num_half = 0 HYDRO_CACHE_HALF_FIELDS(COUNT_FIELD);
+#undef COUNT_FIELD
+  message("Particle caches: %zu bytes per particle, %zu for the fields "
+          "stored as %zu-byte floats.",
+          8 * sizeof(float) + sizeof(int) + num_float * sizeof(float) +
+              num_half * sizeof(half_float),
+          num_half * sizeof(half_float), sizeof(half_float));
+  message("Relative error of the force interactions with the rounded fields: "
+          "a_hydro %e, h_dt %e, u_dt %e.",
+          err_a, err_h_dt, err_u_dt);
+
+  /* bfloat16 keeps 8 bits of mantissa, the switches only weight the
+   * artificial viscosity and diffusion. */
+  if (err_a > 1e-2f || err_h_dt > 1e-2f || err_u_dt > 1e-2f)
+    error("Rounding the cache fields to half precision changes the force "
+          "interactions too much.");
+}
+
+#endif
+
 /* And go... */
 int main(int argc, char *argv[]) {
   size_t runs = 10000;
@@ -759,10 +1265,26 @@ int main(int argc, char *argv[]) {
 
   prepare_force(particles, count);
 
+#if defined(GADGET2_SPH) || defined(SPHENIX_SPH)
+  /* Measure the error due to the fields stored at half precision in the
+   * caches, then compare the serial and vectorised interactions on the same
+   * rounded values. */
+  test_half_precision_error(particles[0], &particles[1], count - 1);
+  round_half_fields(particles, count);
+#endif
+
+#if defined(GADGET2_SPH)
   test_force_interactions(test_particle, &particles[1], count - 1,
                           "test_nonsym_force", runs, 1);
   test_force_interactions(test_particle, &particles[1], count - 1,
                           "test_nonsym_force", runs, 2);
+#elif defined(SPHENIX_SPH)
+  test_particle = particles[0];
+  test_gradient_interactions(test_particle, &particles[1], count - 1,
+                             "test_nonsym_gradient", runs);
+  test_force_interactions(test_particle, &particles[1], count - 1,
+                          "test_nonsym_force", runs);
+#endif
 
   return 0;
 }
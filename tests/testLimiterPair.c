@@ -0,0 +1,358 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "runner_doiact_limiter_vec.h"
+#include "space_getsid.h"
+#include "swift.h"
+
+#define nr_runs 200
+#define nr_active_bins 4
+
+/* The scalar limiter loops. */
+void runner_doself1_limiter(struct runner *r, struct cell *c);
+void runner_dopair1_limiter(struct runner *r, struct cell *ci,
+                            struct cell *cj, const int sid,
+                            const double *shift);
+
+/* The limiter loops called by the tasks. */
+void runner_doself1_branch_limiter(struct runner *r, struct cell *c);
+void runner_dopair1_branch_limiter(struct runner *r, struct cell *ci,
+                                   struct cell *cj);
+
+/**
+ * @brief Constructs a cell of n^3 particles on a perturbed grid, with random
+ * time-bins and smoothing lengths.
+ *
+ * @param n The cube root of the number of particles.
+ * @param offset The position of the cell.
+ * @param h The smoothing length in units of the inter-particle separation.
+ * @param ti_current The current time on the time-line.
+ */
+struct cell *make_cell(int n, const double offset[3], double h,
+                       integertime_t ti_current) {
+
+  const int count = n * n * n;
+  struct cell *c = NULL;
+  if (posix_memalign((void **)&c, cell_align, sizeof(struct cell)) != 0)
+    error("Couldn't allocate the cell");
+  bzero(c, sizeof(struct cell));
+  if (posix_memalign((void **)&c->hydro.parts, part_align,
+                     count * sizeof(struct part)) != 0)
+    error("Couldn't allocate the particles");
+  bzero(c->hydro.parts, count * sizeof(struct part));
+
+  float h_max = 0.f;
+  struct part *p = c->hydro.parts;
+  for (int x = 0; x < n; x++) {
+    for (int y = 0; y < n; y++) {
+      for (int z = 0; z < n; z++) {
+        p->x[0] = offset[0] + (x + random_uniform(0., 1.)) / n;
+        p->x[1] = offset[1] + (y + random_uniform(0., 1.)) / n;
+        p->x[2] = offset[2] + (z + random_uniform(0., 1.)) / n;
+        p->h = h * random_uniform(1., 1.3) / n;
+        h_max = fmaxf(h_max, p->h);
+
+        /* Half the particles start their step, the others are spread over
+         * the time-bins, a few of them close enough not to be woken up. */
+        if (random_uniform(0., 1.) < 0.5)
+          p->time_bin = 1 + rand() % nr_active_bins;
+        else
+          p->time_bin = nr_active_bins + 1 + rand() % 16;
+#ifdef SWIFT_DEBUG_CHECKS
+        p->ti_drift = ti_current;
+#endif
+        p++;
+      }
+    }
+  }
+
+  c->hydro.count = count;
+  c->hydro.h_max = h_max;
+  c->hydro.super = c;
+  c->hydro.ti_old_part = ti_current;
+  c->hydro.ti_beg_max = ti_current;
+  for (int k = 0; k < 3; k++) {
+    c->loc[k] = offset[k];
+    c->width[k] = 1.;
+  }
+  c->dmin = 1.;
+  return c;
+}
+
+/**
+ * @brief Reset the limiter data of the particles of a cell.
+ */
+void reset_wakeup(struct cell *c) {
+  for (int k = 0; k < c->hydro.count; k++)
+    c->hydro.parts[k].limiter_data.wakeup = time_bin_not_awake;
+}
+
+/**
+ * @brief Copies the wakeup values of the particles of a cell.
+ */
+void save_wakeup(const struct cell *c, timebin_t *wakeup) {
+  for (int k = 0; k < c->hydro.count; k++)
+    wakeup[k] = c->hydro.parts[k].limiter_data.wakeup;
+}
+
+/**
+ * @brief Checks that the wakeup values of the particles of a cell match
+ * saved ones.
+ */
+void check_wakeup(const struct cell *c, const timebin_t *wakeup,
+                  const char *name) {
+  for (int k = 0; k < c->hydro.count; k++)
+    if (c->hydro.parts[k].limiter_data.wakeup != wakeup[k])
+      error("%s: particle %d woken up by bin %d instead of %d.", name, k,
+            -c->hydro.parts[k].limiter_data.wakeup, -wakeup[k]);
+}
+
+/**
+ * @brief Runs the scalar and vectorized limiter loops on a cell, or on a
+ * pair of cells if cj is not NULL, checks they agree and times them.
+ */
+void test_limiter(struct runner *r, struct cell *ci, struct cell *cj,
+                  const char *name) {
+
+  const int count_i = ci->hydro.count;
+  const int count_j = cj != NULL ? cj->hydro.count : 0;
+  timebin_t *wakeup_i = (timebin_t *)malloc(count_i * sizeof(timebin_t));
+  timebin_t *wakeup_j =
+      (timebin_t *)malloc((count_j + 1) * sizeof(timebin_t));
+  if (wakeup_i == NULL || wakeup_j == NULL)
+    error("Failed to allocate wakeup arrays.");
+
+  double shift[3] = {0.0, 0.0, 0.0};
+  int sid = 0;
+  if (cj != NULL) sid = space_getsid(r->e->s, &ci, &cj, shift);
+
+  /* Scalar version. */
+  ticks tic = getticks();
+  for (int run = 0; run < nr_runs; run++) {
+    reset_wakeup(ci);
+    if (cj != NULL) {
+      reset_wakeup(cj);
+      runner_dopair1_limiter(r, ci, cj, sid, shift);
+    } else {
+      runner_doself1_limiter(r, ci);
+    }
+  }
+  const ticks time_scalar = getticks() - tic;
+  save_wakeup(ci, wakeup_i);
+  if (cj != NULL) save_wakeup(cj, wakeup_j);
+
+  /* Vectorized version. */
+  tic = getticks();
+  for (int run = 0; run < nr_runs; run++) {
+    reset_wakeup(ci);
+    if (cj != NULL) {
+      reset_wakeup(cj);
+      runner_dopair1_limiter_vec(r, ci, cj, sid, shift);
+    } else {
+      runner_doself1_limiter_vec(r, ci);
+    }
+  }
+  const ticks time_vec = getticks() - tic;
+  check_wakeup(ci, wakeup_i, name);
+  if (cj != NULL) check_wakeup(cj, wakeup_j, name);
+
+  int nr_woken = 0;
+  for (int k = 0; k < count_i; k++)
+    nr_woken += (wakeup_i[k] != time_bin_not_awake);
+  for (int k = 0; k < count_j; k++)
+    nr_woken += (wakeup_j[k] != time_bin_not_awake);
+
+  const double nr_pairs =
+      cj != NULL ? (double)count_i * count_j : (double)count_i * count_i;
+  message(
+      "%-6s: %4d woken up, scalar %6.3f ns, vectorized %6.3f ns per pair of "
+      "particles.",
+      name, nr_woken,
+      1e6 * clocks_from_ticks(time_scalar) / nr_runs / nr_pairs,
+      1e6 * clocks_from_ticks(time_vec) / nr_runs / nr_pairs);
+
+  free(wakeup_i);
+  free(wakeup_j);
+}
+
+#ifdef SWIFT_HYDRO_DENSITY_CHECKS
+
+/**
+ * @brief Checks the neighbours counted by the limiter loop of the tasks on
+ * a cell, or on a pair of cells if cj is not NULL, against a brute-force
+ * count.
+ *
+ * Every starting particle counts all the particles within its kernel, the
+ * ones of the other cell for a pair and the other ones of its own cell for
+ * a self-interaction.
+ */
+void test_limiter_counts(struct runner *r, struct cell *ci, struct cell *cj,
+                         const char *name) {
+
+  const struct engine *e = r->e;
+  struct cell *cells[2] = {ci, cj};
+  const int nr_cells = cj != NULL ? 2 : 1;
+
+  for (int n = 0; n < nr_cells; n++) {
+    for (int k = 0; k < cells[n]->hydro.count; k++) {
+      cells[n]->hydro.parts[k].limiter_data.n_limiter = 0.f;
+      cells[n]->hydro.parts[k].limiter_data.N_limiter = 0;
+    }
+  }
+
+  if (cj != NULL)
+    runner_dopair1_branch_limiter(r, ci, cj);
+  else
+    runner_doself1_branch_limiter(r, ci);
+
+  for (int n = 0; n < nr_cells; n++) {
+
+    const struct cell *c = cells[n];
+    const struct cell *c_ngb = cj != NULL ? cells[1 - n] : ci;
+
+    for (int k = 0; k < c->hydro.count; k++) {
+
+      const struct part *pi = &c->hydro.parts[k];
+      int N_exact = 0;
+      double n_exact = 0.;
+
+      if (part_is_starting(pi, e)) {
+        const float hig2 = pi->h * pi->h * kernel_gamma2;
+        for (int l = 0; l < c_ngb->hydro.count; l++) {
+
+          const struct part *pj = &c_ngb->hydro.parts[l];
+          if (pj == pi) continue;
+
+          float r2 = 0.f;
+          for (int d = 0; d < 3; d++)
+            r2 += (pi->x[d] - pj->x[d]) * (pi->x[d] - pj->x[d]);
+          if (r2 >= hig2) continue;
+
+          float wi;
+          kernel_eval(sqrtf(r2) / pi->h, &wi);
+          n_exact += wi;
+          N_exact++;
+        }
+      }
+
+      if (pi->limiter_data.N_limiter != N_exact ||
+          fabs(pi->limiter_data.n_limiter - n_exact) > 1e-4 * (n_exact + 1.))
+        error(
+            "%s: particle %d counted %d neighbours (weight %e) instead of %d "
+            "(weight %e).",
+            name, k, pi->limiter_data.N_limiter, pi->limiter_data.n_limiter,
+            N_exact, n_exact);
+    }
+  }
+
+  message("%-6s: neighbour counts of the density checks agree.", name);
+}
+
+#endif /* SWIFT_HYDRO_DENSITY_CHECKS */
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+#if defined(WITH_VECTORIZED_LIMITER) || defined(SWIFT_HYDRO_DENSITY_CHECKS)
+
+  srand(1234);
+
+  struct space space;
+  bzero(&space, sizeof(struct space));
+  space.periodic = 0;
+  space.dim[0] = 3.;
+  space.dim[1] = 3.;
+  space.dim[2] = 3.;
+
+  struct cosmology cosmo;
+  cosmology_init_no_cosmo(&cosmo);
+
+  struct engine engine;
+  bzero(&engine, sizeof(struct engine));
+  engine.s = &space;
+  engine.ti_current = 8;
+  engine.max_active_bin = nr_active_bins;
+  engine.cosmology = &cosmo;
+
+  struct runner *runner;
+  if (posix_memalign((void **)&runner, SWIFT_STRUCT_ALIGNMENT,
+                     sizeof(struct runner)) != 0)
+    error("couldn't allocate runner");
+  bzero(runner, sizeof(struct runner));
+  runner->e = &engine;
+  limiter_cache_init(&runner->ci_limiter_cache, 512);
+  limiter_cache_init(&runner->cj_limiter_cache, 512);
+
+  /* A cell and its neighbours across a face, an edge and a corner. */
+  const double offsets[4][3] = {
+      {1., 1., 1.}, {2., 1., 1.}, {2., 2., 1.}, {2., 2., 2.}};
+  const char *names[4] = {"self", "face", "edge", "corner"};
+  struct cell *cells[4];
+  for (int k = 0; k < 4; k++) {
+    cells[k] = make_cell(8, offsets[k], 1.2348, engine.ti_current);
+    runner_do_hydro_sort(runner, cells[k], 0x1FFF, 0, 0, 0);
+  }
+
+#ifdef WITH_VECTORIZED_LIMITER
+  test_limiter(runner, cells[0], NULL, names[0]);
+  for (int k = 1; k < 4; k++)
+    test_limiter(runner, cells[0], cells[k], names[k]);
+#endif
+
+#ifdef SWIFT_HYDRO_DENSITY_CHECKS
+  test_limiter_counts(runner, cells[0], NULL, names[0]);
+  for (int k = 1; k < 4; k++)
+    test_limiter_counts(runner, cells[0], cells[k], names[k]);
+#endif
+
+  for (int k = 0; k < 4; k++) {
+    cell_free_hydro_sorts(cells[k]);
+    free(cells[k]->hydro.parts);
+    free(cells[k]);
+  }
+  limiter_cache_clean(&runner->ci_limiter_cache);
+  limiter_cache_clean(&runner->cj_limiter_cache);
+  free(runner);
+
+#else
+
+  message("No vectorized limiter loops in this build.");
+
+#endif /* WITH_VECTORIZED_LIMITER || SWIFT_HYDRO_DENSITY_CHECKS */
+
+  return 0;
+}
@@ -0,0 +1,233 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "swift.h"
+
+#define top_cdim 8
+#define nr_cells (top_cdim * top_cdim * top_cdim)
+#define nr_particles (1 << 18)
+#define mesh_N 64
+#define nr_runs 10
+
+/* Ways of writing to the mesh */
+#define nr_modes 3
+const char *mode_names[nr_modes] = {"atomics", "local patches", "slabs"};
+
+/**
+ * @brief Constructs the top-level cells of a unit box and their particles,
+ * half of them in a clump, all drifted a bit out of their cells.
+ */
+void make_cells(struct cell *cells, int *local_cells, struct gpart *gparts) {
+
+  /* Random positions, binned by cell */
+  double *x = (double *)malloc(3 * nr_particles * sizeof(double));
+  int *cid = (int *)malloc(nr_particles * sizeof(int));
+  int counts[nr_cells] = {0};
+  const int cdim[3] = {top_cdim, top_cdim, top_cdim};
+  if (x == NULL || cid == NULL) error("Failed to allocate positions.");
+  for (int n = 0; n < nr_particles; n++) {
+    for (int d = 0; d < 3; d++) {
+      if (n % 2)
+        x[3 * n + d] = random_uniform(0., 1.);
+      else
+        x[3 * n + d] = 0.3 + 0.02 * random_uniform(-1., 1.);
+    }
+    cid[n] = cell_getid(cdim, (int)(x[3 * n] * top_cdim),
+                        (int)(x[3 * n + 1] * top_cdim),
+                        (int)(x[3 * n + 2] * top_cdim));
+    counts[cid[n]]++;
+  }
+
+  int offset = 0;
+  for (int c = 0; c < nr_cells; c++) {
+    bzero(&cells[c], sizeof(struct cell));
+    cells[c].loc[0] = (c / (top_cdim * top_cdim)) / (double)top_cdim;
+    cells[c].loc[1] = ((c / top_cdim) % top_cdim) / (double)top_cdim;
+    cells[c].loc[2] = (c % top_cdim) / (double)top_cdim;
+    for (int d = 0; d < 3; d++) cells[c].width[d] = 1. / top_cdim;
+    cells[c].grav.parts = &gparts[offset];
+    offset += counts[c];
+    counts[c] = 0;
+    local_cells[c] = c;
+  }
+
+  /* Store the particles, drifted by up to a quarter of a cell */
+  bzero(gparts, nr_particles * sizeof(struct gpart));
+  for (int n = 0; n < nr_particles; n++) {
+    struct cell *c = &cells[cid[n]];
+    struct gpart *gp = &c->grav.parts[c->grav.count++];
+    for (int d = 0; d < 3; d++)
+      gp->x[d] = x[3 * n + d] + 0.25 / top_cdim * random_uniform(-1., 1.);
+    gp->mass = random_uniform(0.5, 1.5);
+    gp->type = swift_type_dark_matter;
+    gp->time_bin = 1;
+  }
+
+  free(x);
+  free(cid);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+#ifdef HAVE_FFTW
+
+  srand(1234);
+
+  struct cell *cells = NULL;
+  struct gpart *gparts = NULL;
+  if (posix_memalign((void **)&cells, cell_align,
+                     nr_cells * sizeof(struct cell)) != 0 ||
+      posix_memalign((void **)&gparts, gpart_align,
+                     nr_particles * sizeof(struct gpart)) != 0)
+    error("Failed to allocate cells and particles.");
+  int local_cells[nr_cells];
+  make_cells(cells, local_cells, gparts);
+
+  double total_mass = 0.;
+  for (int n = 0; n < nr_particles; n++) total_mass += gparts[n].mass;
+
+  /* Just enough of a space and engine for the mesh assignment */
+  struct neutrino_props neutrino_properties;
+  bzero(&neutrino_properties, sizeof(struct neutrino_props));
+  struct engine engine;
+  bzero(&engine, sizeof(struct engine));
+  engine.neutrino_properties = &neutrino_properties;
+  struct space space;
+  bzero(&space, sizeof(struct space));
+  space.e = &engine;
+  for (int d = 0; d < 3; d++) space.dim[d] = 1.;
+  space.cells_top = cells;
+  space.local_cells_top = local_cells;
+  space.nr_local_cells = nr_cells;
+  space.gparts = gparts;
+  space.nr_gparts = nr_particles;
+
+  struct pm_mesh mesh;
+  bzero(&mesh, sizeof(struct pm_mesh));
+  mesh.periodic = 1;
+  mesh.N = mesh_N;
+  for (int d = 0; d < 3; d++) mesh.dim[d] = 1.;
+  mesh.cell_fac = mesh_N;
+  mesh.window_order = 2;
+
+  const size_t mesh_size = mesh_N * mesh_N * mesh_N;
+  double *rho_ref = (double *)malloc(mesh_size * sizeof(double));
+  double *rho = (double *)malloc(mesh_size * sizeof(double));
+  if (rho_ref == NULL || rho == NULL) error("Failed to allocate meshes.");
+
+  const int nr_threads[3] = {16, 64, 128};
+  for (int t = 0; t < 3; t++) {
+
+    struct threadpool tp;
+    threadpool_init(&tp, nr_threads[t]);
+
+    double times[nr_modes];
+    for (int mode = 0; mode < nr_modes; mode++) {
+      mesh.use_local_patches = (mode == 1);
+      mesh.use_slabs = (mode == 2);
+
+      const ticks tic = getticks();
+      for (int run = 0; run < nr_runs; run++)
+        pm_mesh_compute_density(&mesh, &space, &tp, rho, /*shifted=*/0);
+      times[mode] = clocks_from_ticks(getticks() - tic) / nr_runs;
+
+      /* Check against the first assignment with atomics, up to the order of
+       * the sums */
+      if (t == 0 && mode == 0) {
+        memcpy(rho_ref, rho, mesh_size * sizeof(double));
+        double sum = 0.;
+        for (size_t n = 0; n < mesh_size; n++) sum += rho[n];
+        if (fabs(sum - total_mass) > 1e-10 * total_mass)
+          error("Mesh mass %e instead of %e.", sum, total_mass);
+      } else {
+        for (size_t n = 0; n < mesh_size; n++)
+          if (fabs(rho[n] - rho_ref[n]) > 1e-10 * fabs(rho_ref[n]) + 1e-12)
+            error("%s with %d threads: mesh cell %zu has density %e instead "
+                  "of %e.",
+                  mode_names[mode], nr_threads[t], n, rho[n], rho_ref[n]);
+      }
+    }
+
+    message(
+        "%3d threads: atomics %7.3f %s, local patches %7.3f %s, slabs %7.3f "
+        "%s per assignment.",
+        nr_threads[t], times[0], clocks_getunit(), times[1], clocks_getunit(),
+        times[2], clocks_getunit());
+
+    threadpool_clean(&tp);
+  }
+
+  /* The higher order windows and the shifted mesh must conserve the mass */
+  struct threadpool tp;
+  threadpool_init(&tp, nr_threads[0]);
+  mesh.use_local_patches = 0;
+  mesh.use_slabs = 0;
+  for (int order = 2; order <= 4; order++) {
+    for (int shifted = 0; shifted < 2; shifted++) {
+      mesh.window_order = order;
+
+      const ticks tic = getticks();
+      pm_mesh_compute_density(&mesh, &space, &tp, rho, shifted);
+      const double time = clocks_from_ticks(getticks() - tic);
+
+      double sum = 0.;
+      for (size_t n = 0; n < mesh_size; n++) sum += rho[n];
+      if (fabs(sum - total_mass) > 1e-10 * total_mass)
+        error("Mesh mass %e instead of %e with window order %d, shifted=%d.",
+              sum, total_mass, order, shifted);
+
+      message("Window order %d, shifted=%d: %7.3f %s per assignment.", order,
+              shifted, time, clocks_getunit());
+    }
+  }
+  threadpool_clean(&tp);
+
+  free(rho_ref);
+  free(rho);
+  free(cells);
+  free(gparts);
+
+#else
+
+  message("No FFTW library found, no mesh to assign particles to.");
+
+#endif /* HAVE_FFTW */
+
+  return 0;
+}
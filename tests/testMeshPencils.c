@@ -0,0 +1,391 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* MPI headers. */
+#ifdef WITH_MPI
+#include <mpi.h>
+#endif
+
+/* FFTW headers. */
+#ifdef HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+/* Includes. */
+#include "mesh_gravity_mpi.h"
+#include "mesh_gravity_patch.h"
+#include "mesh_gravity_pencils.h"
+#include "swift.h"
+
+#define top_cdim 4
+#define nr_cells (top_cdim * top_cdim * top_cdim)
+#define nr_patches 3
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+/**
+ * @brief Check the pencil FFTs against a serial FFT of the whole mesh.
+ *
+ * Every rank builds the same random density, transforms its own pencil of
+ * it and compares the modes it ends up with to the serial transform. The
+ * backward transform must then give back N^3 times the density.
+ *
+ * @param N The side-length of the mesh.
+ * @param single_precision Whether to do the pencil FFTs in single precision.
+ * @param tp The #threadpool.
+ */
+void test_pencil_FFTs(const int N, const int single_precision,
+                      struct threadpool *tp) {
+
+  const int Nk = N / 2 + 1;
+  const size_t mesh_size = (size_t)N * N * N;
+
+  /* The same density on every rank, and its serial transform */
+  double *rho = (double *)fftw_malloc(mesh_size * sizeof(double));
+  double *rho_copy = (double *)fftw_malloc(mesh_size * sizeof(double));
+  fftw_complex *frho =
+      (fftw_complex *)fftw_malloc((size_t)N * N * Nk * sizeof(fftw_complex));
+  if (rho == NULL || rho_copy == NULL || frho == NULL)
+    error("Failed to allocate the serial meshes.");
+  srand(N);
+  for (size_t i = 0; i < mesh_size; i++) rho[i] = random_uniform(-1., 1.);
+  memcpy(rho_copy, rho, mesh_size * sizeof(double));
+  fftw_plan plan =
+      fftw_plan_dft_r2c_3d(N, N, N, rho_copy, frho, FFTW_ESTIMATE);
+  fftw_execute(plan);
+  fftw_destroy_plan(plan);
+
+  double max_mode = 0.;
+  for (size_t i = 0; i < (size_t)N * N * Nk; i++)
+    max_mode = max(max_mode, hypot(frho[i][0], frho[i][1]));
+
+  struct mesh_pencils p;
+  mesh_pencils_init(&p, N, single_precision);
+  const int x0 = p.x_offset[p.px], nx = p.x_offset[p.px + 1] - x0;
+  const int y0 = p.y_offset[p.py], ny = p.y_offset[p.py + 1] - y0;
+  const int ky0 = p.ky_offset[p.px], nky = p.ky_offset[p.px + 1] - ky0;
+  const int kz0 = p.kz_offset[p.py], nkz = p.kz_offset[p.py + 1] - kz0;
+
+  /* Our pencil of the density, padded along z */
+  double *rho_pencil =
+      (double *)calloc(mesh_pencils_local_size(&p), sizeof(double));
+  if (rho_pencil == NULL) error("Failed to allocate the pencil.");
+  for (int i = 0; i < nx; i++)
+    for (int j = 0; j < ny; j++)
+      for (int k = 0; k < N; k++)
+        rho_pencil[((size_t)i * ny + j) * 2 * Nk + k] =
+            rho[row_major_id_periodic(x0 + i, y0 + j, k, N)];
+
+  mesh_pencils_forward_FFT(&p, rho_pencil, tp, /*verbose=*/0);
+
+  /* Compare the modes of our pencil along kx, stored as [kz][ky][kx] */
+  const double tol = single_precision ? 1e-5 : 1e-12;
+  for (int kz = kz0; kz < kz0 + nkz; kz++) {
+    for (int ky = ky0; ky < ky0 + nky; ky++) {
+      for (int kx = 0; kx < N; kx++) {
+
+        const size_t local = ((size_t)(kz - kz0) * nky + ky - ky0) * N + kx;
+        const size_t global = ((size_t)kx * N + ky) * Nk + kz;
+        double re, im;
+        if (single_precision) {
+          re = ((float *)p.data)[2 * local + 0];
+          im = ((float *)p.data)[2 * local + 1];
+        } else {
+          re = ((double *)p.data)[2 * local + 0];
+          im = ((double *)p.data)[2 * local + 1];
+        }
+
+        if (hypot(re - frho[global][0], im - frho[global][1]) >
+            tol * max_mode)
+          error(
+              "N=%d, single_precision=%d: mode (%d, %d, %d) is (%e, %e) "
+              "instead of (%e, %e).",
+              N, single_precision, kx, ky, kz, re, im, frho[global][0],
+              frho[global][1]);
+      }
+    }
+  }
+
+  /* And back to real space, without normalisation */
+  mesh_pencils_backward_FFT(&p, rho_pencil, tp, /*verbose=*/0);
+  for (int i = 0; i < nx; i++) {
+    for (int j = 0; j < ny; j++) {
+      for (int k = 0; k < N; k++) {
+
+        const double value =
+            rho_pencil[((size_t)i * ny + j) * 2 * Nk + k] / mesh_size;
+        const double expected =
+            rho[row_major_id_periodic(x0 + i, y0 + j, k, N)];
+        if (fabs(value - expected) > tol)
+          error(
+              "N=%d, single_precision=%d: cell (%d, %d, %d) is %e instead of "
+              "%e after the round trip.",
+              N, single_precision, x0 + i, y0 + j, k, value, expected);
+      }
+    }
+  }
+
+  mesh_pencils_clean(&p);
+  free(rho_pencil);
+  fftw_free(rho);
+  fftw_free(rho_copy);
+  fftw_free(frho);
+}
+
+/**
+ * @brief Check that the density in local patches is summed into the right
+ * slab or pencil, and that the potential is fetched back from it.
+ *
+ * @param N The side-length of the mesh.
+ * @param use_pencils Whether to decompose the mesh in pencils or in slabs.
+ * @param tp The #threadpool.
+ */
+void test_routing(const int N, const int use_pencils, struct threadpool *tp) {
+
+  int nr_nodes, nodeID;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &nodeID);
+
+  const size_t mesh_size = (size_t)N * N * N;
+
+  /* Slabs of uneven thickness, or pencils */
+  struct mesh_pencils p;
+  if (use_pencils)
+    mesh_pencils_init(&p, N, /*single_precision=*/0);
+  else
+    mesh_pencils_init_slabs(&p, N, N / nr_nodes + (nodeID < N % nr_nodes));
+  const size_t local_size = mesh_pencils_local_size(&p);
+
+  /* Every mesh cell belongs to exactly one rank */
+  char *seen = (char *)calloc(local_size, sizeof(char));
+  if (seen == NULL) error("Failed to allocate the ownership flags.");
+  long long nr_owned = 0;
+  for (int i = 0; i < N; i++) {
+    for (int j = 0; j < N; j++) {
+      for (int k = 0; k < N; k++) {
+
+        const size_t key = row_major_id_periodic_size_t_padded(i, j, k, N);
+        const int rank = mesh_pencils_get_rank(&p, key);
+        if (rank < 0 || rank >= nr_nodes)
+          error("Cell (%d, %d, %d) on invalid rank %d.", i, j, k, rank);
+        if (rank != nodeID) continue;
+
+        if (i < p.x_offset[p.px] || i >= p.x_offset[p.px + 1] ||
+            j < p.y_offset[p.py] || j >= p.y_offset[p.py + 1])
+          error("Cell (%d, %d, %d) outside of the local slice.", i, j, k);
+        const size_t index = mesh_pencils_local_index(&p, key);
+        if (index >= local_size || seen[index])
+          error("Cell (%d, %d, %d) has invalid local index %zu.", i, j, k,
+                index);
+        seen[index] = 1;
+        nr_owned++;
+      }
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, &nr_owned, 1, MPI_LONG_LONG, MPI_SUM,
+                MPI_COMM_WORLD);
+  if (nr_owned != (long long)mesh_size)
+    error("%lld mesh cells owned instead of %zu.", nr_owned, mesh_size);
+  free(seen);
+
+  /* Random patches on every rank, possibly overlapping and wrapping around
+   * the box, and the full mesh they add up to */
+  srand(1000 * N + nodeID);
+  double *expected = (double *)calloc(mesh_size, sizeof(double));
+  if (expected == NULL) error("Failed to allocate the expected mesh.");
+  struct pm_mesh_patch patches[nr_patches];
+  for (int n = 0; n < nr_patches; n++) {
+    struct pm_mesh_patch *patch = &patches[n];
+    bzero(patch, sizeof(struct pm_mesh_patch));
+    patch->N = N;
+    patch->fac = N;
+    int count = 1;
+    for (int d = 0; d < 3; d++) {
+      patch->mesh_min[d] = (int)random_uniform(-3., N);
+      patch->mesh_size[d] = 1 + (int)random_uniform(0., 6.);
+      patch->mesh_max[d] = patch->mesh_min[d] + patch->mesh_size[d] - 1;
+      count *= patch->mesh_size[d];
+    }
+    if (swift_memalign("mesh_patch", (void **)&patch->mesh,
+                       SWIFT_CACHE_ALIGNMENT, count * sizeof(double)) != 0)
+      error("Failed to allocate a mesh patch.");
+
+    for (int i = 0; i < patch->mesh_size[0]; i++) {
+      for (int j = 0; j < patch->mesh_size[1]; j++) {
+        for (int k = 0; k < patch->mesh_size[2]; k++) {
+          const double value = random_uniform(0., 1.);
+          patch->mesh[pm_mesh_patch_index(patch, i, j, k)] = value;
+          expected[row_major_id_periodic(
+              i + patch->mesh_min[0], j + patch->mesh_min[1],
+              k + patch->mesh_min[2], N)] += value;
+        }
+      }
+    }
+  }
+  MPI_Allreduce(MPI_IN_PLACE, expected, mesh_size, MPI_DOUBLE, MPI_SUM,
+                MPI_COMM_WORLD);
+
+  double *slice = (double *)calloc(local_size, sizeof(double));
+  if (slice == NULL) error("Failed to allocate the local slice.");
+  mpi_mesh_local_patches_to_slices(&p, patches, nr_patches, slice, tp,
+                                   /*verbose=*/0);
+
+  for (int i = p.x_offset[p.px]; i < p.x_offset[p.px + 1]; i++) {
+    for (int j = p.y_offset[p.py]; j < p.y_offset[p.py + 1]; j++) {
+      for (int k = 0; k < N; k++) {
+
+        const size_t key = row_major_id_periodic_size_t_padded(i, j, k, N);
+        const double value = slice[mesh_pencils_local_index(&p, key)];
+        const double ref = expected[row_major_id_periodic(i, j, k, N)];
+        if (fabs(value - ref) > 1e-12 * (1. + fabs(ref)))
+          error("use_pencils=%d: cell (%d, %d, %d) has density %e instead "
+                "of %e.",
+                use_pencils, i, j, k, value, ref);
+      }
+    }
+  }
+  free(expected);
+
+  /* Now a potential that tells which cell it was read from */
+  for (int i = p.x_offset[p.px]; i < p.x_offset[p.px + 1]; i++)
+    for (int j = p.y_offset[p.py]; j < p.y_offset[p.py + 1]; j++)
+      for (int k = 0; k < N; k++)
+        slice[mesh_pencils_local_index(
+            &p, row_major_id_periodic_size_t_padded(i, j, k, N))] =
+            row_major_id_periodic(i, j, k, N);
+
+  /* Some of the top-level cells of a unit box on each rank */
+  struct cell *cells = NULL;
+  if (posix_memalign((void **)&cells, cell_align,
+                     nr_cells * sizeof(struct cell)) != 0)
+    error("Failed to allocate cells.");
+  bzero(cells, nr_cells * sizeof(struct cell));
+  int local_cells[nr_cells];
+  int nr_local_cells = 0;
+  for (int c = 0; c < nr_cells; c++) {
+    cells[c].loc[0] = (c / (top_cdim * top_cdim)) / (double)top_cdim;
+    cells[c].loc[1] = ((c / top_cdim) % top_cdim) / (double)top_cdim;
+    cells[c].loc[2] = (c % top_cdim) / (double)top_cdim;
+    for (int d = 0; d < 3; d++) cells[c].width[d] = 1. / top_cdim;
+    if (c % nr_nodes == nodeID) {
+      cells[c].grav.count = 1;
+      local_cells[nr_local_cells++] = c;
+    }
+  }
+
+  struct space s;
+  bzero(&s, sizeof(struct space));
+  for (int d = 0; d < 3; d++) s.dim[d] = 1.;
+  s.cells_top = cells;
+  s.local_cells_top = local_cells;
+  s.nr_local_cells = nr_local_cells;
+
+  struct pm_mesh_patch *local_patches = (struct pm_mesh_patch *)calloc(
+      nr_local_cells, sizeof(struct pm_mesh_patch));
+  if (local_patches == NULL) error("Failed to allocate the local patches.");
+  mpi_mesh_fetch_potential(N, /*fac=*/N, &s, &p, slice, local_patches, tp,
+                           /*verbose=*/0);
+
+  for (int n = 0; n < nr_local_cells; n++) {
+    const struct pm_mesh_patch *patch = &local_patches[n];
+    for (int i = 0; i < patch->mesh_size[0]; i++) {
+      for (int j = 0; j < patch->mesh_size[1]; j++) {
+        for (int k = 0; k < patch->mesh_size[2]; k++) {
+
+          const double value = patch->mesh[pm_mesh_patch_index(patch, i, j, k)];
+          const int ref = row_major_id_periodic(i + patch->mesh_min[0],
+                                                j + patch->mesh_min[1],
+                                                k + patch->mesh_min[2], N);
+          if (value != ref)
+            error("use_pencils=%d: potential of cell %d fetched from %d.",
+                  use_pencils, ref, (int)value);
+        }
+      }
+    }
+  }
+
+  for (int n = 0; n < nr_local_cells; n++)
+    pm_mesh_patch_clean(&local_patches[n]);
+  free(local_patches);
+  free(cells);
+  free(slice);
+  mesh_pencils_clean(&p);
+}
+
+#endif /* WITH_MPI && HAVE_FFTW */
+
+int main(int argc, char *argv[]) {
+
+#if defined(WITH_MPI) && defined(HAVE_FFTW)
+
+  if (MPI_Init(&argc, &argv) != MPI_SUCCESS)
+    error("Call to MPI_Init failed.");
+  int nr_nodes, nodeID;
+  MPI_Comm_size(MPI_COMM_WORLD, &nr_nodes);
+  MPI_Comm_rank(MPI_COMM_WORLD, &nodeID);
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  struct threadpool tp;
+  threadpool_init(&tp, 2);
+
+  /* A mesh that splits evenly and one that does not */
+  const int sizes[2] = {16, 10};
+  for (int n = 0; n < 2; n++) {
+
+    test_pencil_FFTs(sizes[n], /*single_precision=*/0, &tp);
+#ifdef HAVE_FLOAT_FFTW
+    test_pencil_FFTs(sizes[n], /*single_precision=*/1, &tp);
+#endif
+    test_routing(sizes[n], /*use_pencils=*/0, &tp);
+    test_routing(sizes[n], /*use_pencils=*/1, &tp);
+
+    if (nodeID == 0)
+      message("N=%d: pencil FFTs and mesh routing correct on %d ranks.",
+              sizes[n], nr_nodes);
+  }
+
+  threadpool_clean(&tp);
+  MPI_Finalize();
+
+#else
+
+  message("No MPI or FFTW library found, no distributed mesh to test.");
+
+#endif /* WITH_MPI && HAVE_FFTW */
+
+  return 0;
+}
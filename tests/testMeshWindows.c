@@ -0,0 +1,248 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "swift.h"
+
+#define mesh_N 16
+#define a_smooth 1.25
+#define nr_test_particles 200
+#define nr_point_masses 4
+
+/* Maximal rms force error, relative to the rms force, of each window order
+ * (CIC, TSC, PCS) without and with interlacing */
+const double max_error[3][2] = {
+    {2.5e-2, 6.5e-3}, {6.5e-3, 6e-3}, {6e-3, 6e-3}};
+
+const char *window_names[3] = {"CIC", "TSC", "PCS"};
+
+/* Largest mode of the direct sums: the Green function is < 1e-6 beyond */
+#define n_max 24
+#define n_modes (2 * n_max + 1)
+
+/**
+ * @brief Tabulate the long-range Green function, -4 pi W(k r_s) / k^2, of the
+ * modes of a periodic unit box.
+ *
+ * @param r_s The smoothing scale of the long-range forces.
+ * @param green (return) The Green function of the modes (i, j, k) with
+ * -n_max <= i, j, k <= n_max.
+ */
+void tabulate_Green_function(const double r_s, double *green) {
+
+  for (int i = -n_max; i <= n_max; ++i) {
+    for (int j = -n_max; j <= n_max; ++j) {
+      for (int k = -n_max; k <= n_max; ++k) {
+
+        const int index =
+            ((i + n_max) * n_modes + j + n_max) * n_modes + k + n_max;
+        const double k2 = 4. * M_PI * M_PI * (i * i + j * j + k * k);
+
+        double W;
+        fourier_kernel_long_grav_eval(k2 * r_s * r_s, &W);
+        green[index] = -4. * M_PI * W / (k2 + FLT_MIN);
+      }
+    }
+  }
+
+  /* No mean field */
+  green[(n_max * n_modes + n_max) * n_modes + n_max] = 0.;
+}
+
+/**
+ * @brief Long-range acceleration of a unit point mass in a periodic unit box,
+ * summing the modes of the Green function directly.
+ *
+ * @param dx The position relative to the point mass.
+ * @param green The tabulated Green function.
+ * @param a (return) The acceleration.
+ */
+void point_mass_acceleration(const double dx[3], const double *green,
+                             double a[3]) {
+
+  /* exp(i k dx) along each axis */
+  double c[3][n_modes], s[3][n_modes];
+  for (int d = 0; d < 3; ++d) {
+    for (int i = -n_max; i <= n_max; ++i) {
+      c[d][i + n_max] = cos(2. * M_PI * i * dx[d]);
+      s[d][i + n_max] = sin(2. * M_PI * i * dx[d]);
+    }
+  }
+
+  a[0] = a[1] = a[2] = 0.;
+  for (int i = 0; i < n_modes; ++i) {
+    for (int j = 0; j < n_modes; ++j) {
+
+      const double c_xy = c[0][i] * c[1][j] - s[0][i] * s[1][j];
+      const double s_xy = s[0][i] * c[1][j] + c[0][i] * s[1][j];
+
+      for (int k = 0; k < n_modes; ++k) {
+
+        /* -grad of the potential green * exp(i k.dx) */
+        const double s_xyz = s_xy * c[2][k] + c_xy * s[2][k];
+        const double fac =
+            2. * M_PI * green[(i * n_modes + j) * n_modes + k] * s_xyz;
+        a[0] += fac * (i - n_max);
+        a[1] += fac * (j - n_max);
+        a[2] += fac * (k - n_max);
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+#ifdef HAVE_FFTW
+
+  srand(1234);
+
+  const double r_s = a_smooth / mesh_N;
+
+  /* A unit point mass followed by massless test particles */
+  const int nr_gparts = nr_test_particles + 1;
+  struct gpart *gparts = NULL;
+  if (posix_memalign((void **)&gparts, gpart_align,
+                     nr_gparts * sizeof(struct gpart)) != 0)
+    error("Failed to allocate particles.");
+
+  /* Just enough of a space and engine for the mesh forces */
+  struct phys_const physical_constants;
+  bzero(&physical_constants, sizeof(struct phys_const));
+  physical_constants.const_newton_G = 1.;
+  struct neutrino_props neutrino_properties;
+  bzero(&neutrino_properties, sizeof(struct neutrino_props));
+  struct engine engine;
+  bzero(&engine, sizeof(struct engine));
+  engine.physical_constants = &physical_constants;
+  engine.neutrino_properties = &neutrino_properties;
+  struct space space;
+  bzero(&space, sizeof(struct space));
+  space.e = &engine;
+  for (int d = 0; d < 3; d++) space.dim[d] = 1.;
+  space.gparts = gparts;
+  space.nr_gparts = nr_gparts;
+
+  struct threadpool tp;
+  threadpool_init(&tp, 4);
+
+  double *green =
+      (double *)malloc(n_modes * n_modes * n_modes * sizeof(double));
+  if (green == NULL) error("Failed to allocate the Green function.");
+  tabulate_Green_function(r_s, green);
+
+  /* Squared force errors and forces of each window, summed over the point
+   * masses and test particles */
+  double error2[3][2] = {{0.}}, force2[3][2] = {{0.}};
+
+  for (int n = 0; n < nr_point_masses; n++) {
+
+    bzero(gparts, nr_gparts * sizeof(struct gpart));
+    for (int i = 0; i < nr_gparts; i++) {
+      for (int d = 0; d < 3; d++) gparts[i].x[d] = random_uniform(0., 1.);
+      gparts[i].mass = (i == 0) ? 1.f : 0.f;
+      gparts[i].type = swift_type_dark_matter;
+      gparts[i].time_bin = 1;
+    }
+
+    /* The exact long-range forces */
+    double a_ref[nr_test_particles][3];
+    for (int i = 0; i < nr_test_particles; i++) {
+      double dx[3];
+      for (int d = 0; d < 3; d++)
+        dx[d] = gparts[i + 1].x[d] - gparts[0].x[d];
+      point_mass_acceleration(dx, green, a_ref[i]);
+    }
+
+    for (int order = 2; order <= 4; order++) {
+      for (int interlacing = 0; interlacing < 2; interlacing++) {
+
+        struct pm_mesh mesh;
+        bzero(&mesh, sizeof(struct pm_mesh));
+        mesh.periodic = 1;
+        mesh.N = mesh_N;
+        for (int d = 0; d < 3; d++) mesh.dim[d] = 1.;
+        mesh.cell_fac = mesh_N;
+        mesh.r_s = r_s;
+        mesh.r_s_inv = 1. / r_s;
+        mesh.window_order = order;
+        mesh.use_interlacing = interlacing;
+        pm_mesh_allocate(&mesh);
+
+        pm_mesh_compute_potential(&mesh, &space, &tp, /*verbose=*/0);
+
+        for (int i = 0; i < nr_test_particles; i++) {
+          for (int d = 0; d < 3; d++) {
+            const double diff = gparts[i + 1].a_grav_mesh[d] - a_ref[i][d];
+            error2[order - 2][interlacing] += diff * diff;
+            force2[order - 2][interlacing] += a_ref[i][d] * a_ref[i][d];
+          }
+        }
+
+        pm_mesh_free(&mesh);
+      }
+    }
+  }
+
+  /* Compare the rms errors to what the windows are expected to achieve */
+  for (int order = 2; order <= 4; order++) {
+    for (int interlacing = 0; interlacing < 2; interlacing++) {
+
+      const double err = sqrt(error2[order - 2][interlacing] /
+                              force2[order - 2][interlacing]);
+      message("%s window, interlacing=%d: rms force error %.3e.",
+              window_names[order - 2], interlacing, err);
+
+      if (err > max_error[order - 2][interlacing])
+        error("%s window, interlacing=%d: rms force error %e above %e.",
+              window_names[order - 2], interlacing, err,
+              max_error[order - 2][interlacing]);
+    }
+  }
+
+  threadpool_clean(&tp);
+  free(green);
+  free(gparts);
+
+#else
+
+  message("No FFTW library found, no mesh to compute forces on.");
+
+#endif /* HAVE_FFTW */
+
+  return 0;
+}
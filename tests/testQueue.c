@@ -0,0 +1,146 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "swift.h"
+
+#define nr_tasks 200000
+#define nr_threads 4
+
+/* Data shared by the threads of the concurrent test. */
+struct test_data {
+  struct queue *q;
+  struct task *tasks;
+  int *seen;
+  volatile int nr_done;
+  int next_insert;
+};
+
+/**
+ * @brief Insert a share of the tasks, then consume tasks until all of them
+ * have been seen. Even threads act as the owner, odd ones as thieves.
+ */
+void *test_runner(void *data) {
+
+  struct test_data *d = (struct test_data *)data;
+  static volatile int thread_count = 0;
+  const int id = atomic_inc(&thread_count);
+
+  while (d->nr_done < nr_tasks) {
+
+    /* Insert a few tasks, if there are any left. */
+    for (int k = 0; k < 4; k++) {
+      const int ind = atomic_inc(&d->next_insert);
+      if (ind >= nr_tasks) break;
+      queue_insert(d->q, &d->tasks[ind]);
+    }
+
+    /* And get one out. */
+    struct task *t = (id % 2 == 0) ? queue_gettask(d->q, NULL, 0)
+                                   : queue_steal(d->q, NULL);
+    if (t == NULL) continue;
+    if (atomic_inc(&d->seen[t - d->tasks]) != 0)
+      error("Task %td obtained more than once.", t - d->tasks);
+    atomic_inc(&d->nr_done);
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief Run the tests on a #queue of the given type.
+ */
+void test_queue(enum queue_types type) {
+
+  message("Testing '%s' queue.", queue_type_names[type]);
+
+  struct task *tasks = (struct task *)calloc(nr_tasks, sizeof(struct task));
+  int *seen = (int *)calloc(nr_tasks, sizeof(int));
+  if (tasks == NULL || seen == NULL) error("Failed to allocate tasks.");
+
+  /* Tasks without any cells, so that task_lock() always succeeds. */
+  for (int k = 0; k < nr_tasks; k++) {
+    tasks[k].type = task_type_none;
+    tasks[k].weight = (float)(rand() % 1000000);
+  }
+
+  struct queue q;
+  queue_init(&q, tasks, type);
+
+  /* Serial test: the heaviest task comes out first. */
+  const int nr_serial = 1000;
+  float max_weight = 0.f;
+  for (int k = 0; k < nr_serial; k++) {
+    queue_insert(&q, &tasks[k]);
+    max_weight = max(max_weight, tasks[k].weight);
+  }
+  struct task *first = queue_gettask(&q, NULL, 1);
+  if (type == queue_type_heap && first->weight != max_weight)
+    error("Heaviest task not returned first (%e vs %e).", first->weight,
+          max_weight);
+  if (type == queue_type_deque &&
+      ilogbf(first->weight) / queue_deque_bucket_width !=
+          ilogbf(max_weight) / queue_deque_bucket_width)
+    error("Task not taken from the heaviest bucket (%e vs %e).", first->weight,
+          max_weight);
+  int count = 1;
+  while (queue_gettask(&q, NULL, 1) != NULL) count++;
+  if (count != nr_serial)
+    error("Got %d tasks out of the queue instead of %d.", count, nr_serial);
+  if (q.count != 0) error("Queue not empty (count=%d).", q.count);
+
+  /* Concurrent test: every task must come out exactly once. */
+  struct test_data data = {&q, tasks, seen, 0, 0};
+  pthread_t threads[nr_threads];
+  for (int k = 0; k < nr_threads; k++)
+    if (pthread_create(&threads[k], NULL, test_runner, &data) != 0)
+      error("Failed to create thread.");
+  for (int k = 0; k < nr_threads; k++) pthread_join(threads[k], NULL);
+
+  for (int k = 0; k < nr_tasks; k++)
+    if (seen[k] != 1) error("Task %d seen %d times.", k, seen[k]);
+  if (q.count != 0 || q.count_incoming != 0)
+    error("Queue not empty (count=%d, count_incoming=%d).", q.count,
+          q.count_incoming);
+
+  queue_clean(&q);
+  free(tasks);
+  free(seen);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  for (int type = 0; type < queue_type_count; type++)
+    test_queue((enum queue_types)type);
+
+  return 0;
+}
@@ -37,6 +37,7 @@
 const float max_abs_error = 1e-3f;
 const float max_rel_error = 1e-3f;
 const float min_threshold = 1e-2f;
+const float max_batch_error = 1e-4f;
 
 /**
  * @brief Checks whether two numbers are opposite of each others.
@@ -147,6 +148,88 @@ void check_riemann_symmetry(void) {
   }
 }
 
+/**
+ * @brief Check that a batch of Riemann problems gives the same fluxes as
+ * solving them one at a time, vacuum generation included.
+ */
+void check_riemann_batch(void) {
+
+  struct riemann_batch batch, batch_middle;
+  riemann_batch_init(&batch);
+  riemann_batch_init(&batch_middle);
+
+  float WL[RIEMANN_BATCH_SIZE][5], WR[RIEMANN_BATCH_SIZE][5];
+  float n_unit[RIEMANN_BATCH_SIZE][3], vij[RIEMANN_BATCH_SIZE][3];
+  for (int i = 0; i < RIEMANN_BATCH_SIZE; i++) {
+    WL[i][0] = random_uniform(0.1f, 1.0f);
+    WL[i][1] = random_uniform(-10.0f, 10.0f);
+    WL[i][2] = random_uniform(-10.0f, 10.0f);
+    WL[i][3] = random_uniform(-10.0f, 10.0f);
+    WL[i][4] = random_uniform(0.1f, 1.0f);
+    WR[i][0] = random_uniform(0.1f, 1.0f);
+    WR[i][1] = random_uniform(-10.0f, 10.0f);
+    WR[i][2] = random_uniform(-10.0f, 10.0f);
+    WR[i][3] = random_uniform(-10.0f, 10.0f);
+    WR[i][4] = random_uniform(0.1f, 1.0f);
+
+    n_unit[i][0] = random_uniform(-1.0f, 1.0f);
+    n_unit[i][1] = random_uniform(-1.0f, 1.0f);
+    n_unit[i][2] = random_uniform(-1.0f, 1.0f);
+    const float n_norm =
+        sqrtf(n_unit[i][0] * n_unit[i][0] + n_unit[i][1] * n_unit[i][1] +
+              n_unit[i][2] * n_unit[i][2]);
+    n_unit[i][0] /= n_norm;
+    n_unit[i][1] /= n_norm;
+    n_unit[i][2] /= n_norm;
+
+    /* Some states moving apart fast enough to generate vacuum. */
+    if (i % 16 == 1) {
+      for (int k = 0; k < 3; k++) {
+        WL[i][k + 1] = -30.0f * n_unit[i][k];
+        WR[i][k + 1] = 30.0f * n_unit[i][k];
+      }
+    }
+
+    vij[i][0] = random_uniform(-10.0f, 10.0f);
+    vij[i][1] = random_uniform(-10.0f, 10.0f);
+    vij[i][2] = random_uniform(-10.0f, 10.0f);
+
+    riemann_batch_add(&batch, WL[i], WR[i], n_unit[i], vij[i]);
+    riemann_batch_add(&batch_middle, WL[i], WR[i], n_unit[i], vij[i]);
+  }
+
+  riemann_solve_batch_for_flux(&batch);
+  riemann_solve_batch_for_middle_state_flux(&batch_middle);
+
+  for (int i = 0; i < RIEMANN_BATCH_SIZE; i++) {
+    float totflux[5], totflux_batch[5], totflux_middle[5];
+    float totflux_middle_batch[5];
+    riemann_solve_for_flux(WL[i], WR[i], n_unit[i], vij[i], totflux);
+    riemann_solve_for_middle_state_flux(WL[i], WR[i], n_unit[i], vij[i],
+                                        totflux_middle);
+    riemann_batch_get_flux(&batch, i, totflux_batch);
+    riemann_batch_get_flux(&batch_middle, i, totflux_middle_batch);
+
+    /* Compare the fluxes relative to their largest component. */
+    float scale = 1.0f, scale_middle = 1.0f;
+    for (int k = 0; k < 5; k++) {
+      scale = max(scale, fabsf(totflux[k]));
+      scale_middle = max(scale_middle, fabsf(totflux_middle[k]));
+    }
+    for (int k = 0; k < 5; k++) {
+      if (fabsf(totflux_batch[k] - totflux[k]) > max_batch_error * scale)
+        error("Batched flux %d of problem %d is %.8e instead of %.8e.", k, i,
+              totflux_batch[k], totflux[k]);
+      if (fabsf(totflux_middle_batch[k] - totflux_middle[k]) >
+          max_batch_error * scale_middle)
+        error(
+            "Batched middle state flux %d of problem %d is %.8e instead of "
+            "%.8e.",
+            k, i, totflux_middle_batch[k], totflux_middle[k]);
+    }
+  }
+}
+
 /**
  * @brief Check the HLLC Riemann solver
  */
@@ -171,5 +254,10 @@ int main(int argc, char *argv[]) {
     check_riemann_symmetry();
   }
 
+  /* batched solver test */
+  for (int i = 0; i < 1000; i++) {
+    check_riemann_batch();
+  }
+
   return 0;
 }
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Includes. */
+#include "swift.h"
+
+#define test_nr_queues 4
+
+/* Data shared with the runner thread. */
+struct test_data {
+  struct scheduler *s;
+  struct task *res;
+  volatile int done;
+};
+
+/**
+ * @brief Get a task for queue 0, as a runner would.
+ */
+void *test_runner(void *data) {
+
+  struct test_data *d = (struct test_data *)data;
+  d->res = scheduler_gettask(d->s, 0, NULL);
+  d->done = 1;
+  return NULL;
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* A task without any cells, so that task_lock() always succeeds. */
+  struct task tasks[1];
+  bzero(tasks, sizeof(tasks));
+  tasks[0].type = task_type_none;
+  tasks[0].weight = 1.f;
+
+  /* A scheduler with just enough in it for scheduler_gettask(). */
+  struct scheduler s;
+  bzero(&s, sizeof(s));
+  s.nr_queues = test_nr_queues;
+  s.flags = scheduler_flag_steal;
+  s.waiting = 1;
+  if (pthread_mutex_init(&s.sleep_mutex, NULL) != 0 ||
+      pthread_cond_init(&s.sleep_cond, NULL) != 0)
+    error("Failed to initialize the sleep mutex.");
+  s.queues = (struct queue *)malloc(sizeof(struct queue) * test_nr_queues);
+  if (s.queues == NULL) error("Failed to allocate queues.");
+  for (int k = 0; k < test_nr_queues; k++)
+    queue_init(&s.queues[k], tasks, queue_type_heap);
+
+  /* Queues 0 and 1 share a last-level cache, queue 2 is on the same NUMA
+   * node and queue 3 is on another one. */
+  const int llc[test_nr_queues] = {0, 0, 1, 2};
+  const int numa[test_nr_queues] = {0, 0, 0, 1};
+  s.steal_queues =
+      (int *)malloc(sizeof(int) * test_nr_queues * test_nr_queues);
+  s.steal_level_end = (int *)malloc(sizeof(int) * test_nr_queues *
+                                    scheduler_steal_level_count);
+  if (s.steal_queues == NULL || s.steal_level_end == NULL)
+    error("Failed to allocate steal lists.");
+  for (int qid = 0; qid < test_nr_queues; qid++) {
+    int *queues = &s.steal_queues[qid * test_nr_queues];
+    int *level_end = &s.steal_level_end[qid * scheduler_steal_level_count];
+    int count = 0;
+    for (int level = 0; level < scheduler_steal_level_count; level++) {
+      for (int k = 0; k < test_nr_queues; k++) {
+        if (k == qid) continue;
+        const int same_llc = (llc[k] == llc[qid] && numa[k] == numa[qid]);
+        const int same_numa = (numa[k] == numa[qid]);
+        if ((level == scheduler_steal_llc && same_llc) ||
+            (level == scheduler_steal_numa && same_numa && !same_llc) ||
+            (level == scheduler_steal_remote && !same_numa))
+          queues[count++] = k;
+      }
+      level_end[level] = count;
+    }
+  }
+
+  /* The only queued task is on the remote NUMA node. */
+  queue_insert(&s.queues[3], &tasks[0]);
+
+  /* A runner on queue 0 must steal it rather than go to sleep. */
+  struct test_data data = {&s, NULL, 0};
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, test_runner, &data) != 0)
+    error("Failed to create thread.");
+  for (int k = 0; k < 1000 && !data.done; k++) usleep(1000);
+  if (!data.done)
+    error("Runner went to sleep while a remote queue had a task.");
+  pthread_join(thread, NULL);
+
+  if (data.res != &tasks[0]) error("Runner did not get the remote task.");
+  if (s.steal_counts[scheduler_steal_remote] != 1)
+    error("Task not counted as a remote steal (count=%d).",
+          s.steal_counts[scheduler_steal_remote]);
+  if (s.queues[3].count != 0) error("Remote queue not empty.");
+
+  message("Remote task stolen before sleeping.");
+
+  for (int k = 0; k < test_nr_queues; k++) queue_clean(&s.queues[k]);
+  free(s.queues);
+  free(s.steal_queues);
+  free(s.steal_level_end);
+  pthread_mutex_destroy(&s.sleep_mutex);
+  pthread_cond_destroy(&s.sleep_cond);
+
+  return 0;
+}
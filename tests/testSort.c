@@ -0,0 +1,200 @@
+/*******************************************************************************
+ * This file is part of SWIFT.
+ * Copyright (C) 2026 agent (agent@local)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ ******************************************************************************/
+
+/* Config parameters. */
+#include <config.h>
+
+/* Some standard headers. */
+#include <fenv.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Includes. */
+#include "swift.h"
+
+#define nr_runs 2000
+
+/**
+ * @brief Check that the entries are sorted and are a permutation of 0..N-1.
+ */
+void check_sorted(const struct sort_key *sort, int N, const char *name) {
+
+  int *seen = (int *)calloc(N, sizeof(int));
+  if (seen == NULL) error("Failed to allocate check array.");
+  for (int k = 0; k < N; k++) {
+    if (k > 0 && sort[k].d < sort[k - 1].d)
+      error("%s: entries %d and %d not in order (%e > %e).", name, k - 1, k,
+            sort[k - 1].d, sort[k].d);
+    if (sort[k].i < 0 || sort[k].i >= N || seen[sort[k].i]++)
+      error("%s: invalid or repeated index %d.", name, sort[k].i);
+  }
+  free(seen);
+}
+
+/**
+ * @brief Check that sorted keys are stored in a list of sorted indices in
+ * order and up to the error returned when storing them.
+ */
+void check_store(const struct sort_key *keys, int N) {
+
+  struct sort_entry *list = (struct sort_entry *)malloc(
+      (N + 1 + sort_header_size) * sizeof(struct sort_entry));
+  if (list == NULL) error("Failed to allocate list.");
+  struct sort_entry *sort = list + sort_header_size;
+
+  const float quant = sort_store(sort, keys, N);
+  for (int k = 0; k < N; k++) {
+    if (sort_get_i(sort, k) != keys[k].i)
+      error("store: index %d changed to %d.", keys[k].i, sort_get_i(sort, k));
+    if (fabsf(sort_get_d(sort, k) - keys[k].d) > quant)
+      error("store: distance %e stored as %e, error larger than %e.",
+            keys[k].d, sort_get_d(sort, k), quant);
+    if (k > 0 && sort_get_d(sort, k) < sort_get_d(sort, k - 1))
+      error("store: entries %d and %d not in order.", k - 1, k);
+  }
+  if (N > 0 && sort_get_d(sort, N) < sort_get_d(sort, N - 1))
+    error("store: invalid sentinel.");
+  free(list);
+}
+
+/**
+ * @brief Time the sorts of N entries with keys spread over a cell of width
+ * w at position x0, as in a leaf cell.
+ */
+void test_sort(int N, float x0, float w) {
+
+  struct sort_key *keys = (struct sort_key *)malloc(
+      (size_t)nr_runs * N * sizeof(struct sort_key));
+  struct sort_key *sort =
+      (struct sort_key *)malloc(N * sizeof(struct sort_key));
+  struct sort_key *buff =
+      (struct sort_key *)malloc(N * sizeof(struct sort_key));
+  if (keys == NULL || sort == NULL || buff == NULL)
+    error("Failed to allocate entries.");
+
+  /* Random keys for each run. */
+  for (int r = 0; r < nr_runs; r++)
+    for (int k = 0; k < N; k++) {
+      keys[r * N + k].d = x0 + w * (float)rand() / (float)RAND_MAX;
+      keys[r * N + k].i = k;
+    }
+
+  /* Quicksort. */
+  ticks tic = getticks();
+  for (int r = 0; r < nr_runs; r++) {
+    memcpy(sort, &keys[r * N], N * sizeof(struct sort_key));
+    runner_do_sort_ascending(sort, N);
+  }
+  const ticks time_quick = getticks() - tic;
+  check_sorted(sort, N, "quicksort");
+
+  /* Radix sort. */
+  tic = getticks();
+  for (int r = 0; r < nr_runs; r++) {
+    memcpy(sort, &keys[r * N], N * sizeof(struct sort_key));
+    runner_do_sort_radix(sort, buff, N);
+  }
+  const ticks time_radix = getticks() - tic;
+  check_sorted(sort, N, "radix sort");
+  check_store(sort, N);
+
+  /* Sort the keys and move them by up to 10% of the cell width, the
+   * space_maxreldx threshold after which a cell gets sorted again. */
+  for (int r = 0; r < nr_runs; r++) {
+    runner_do_sort_radix(&keys[r * N], buff, N);
+    for (int k = 0; k < N; k++)
+      keys[r * N + k].d += 0.1f * w * ((float)rand() / (float)RAND_MAX - 0.5f);
+  }
+
+  /* Repair of the previous order. */
+  int nr_repaired = 0;
+  tic = getticks();
+  for (int r = 0; r < nr_runs; r++) {
+    memcpy(sort, &keys[r * N], N * sizeof(struct sort_key));
+    if (runner_do_sort_repair(sort, N, 4 * N))
+      nr_repaired++;
+    else
+      runner_do_sort_ascending(sort, N);
+  }
+  const ticks time_repair = getticks() - tic;
+  check_sorted(sort, N, "repair");
+
+  /* Re-sorting the drifted keys from scratch. */
+  tic = getticks();
+  for (int r = 0; r < nr_runs; r++) {
+    memcpy(sort, &keys[r * N], N * sizeof(struct sort_key));
+    runner_do_sort_ascending(sort, N);
+  }
+  const ticks time_resort = getticks() - tic;
+
+  /* Radix sort of the drifted keys, which the repair competes with in
+   * runner_do_hydro_sort() above runner_sort_radix_min_count entries. */
+  tic = getticks();
+  for (int r = 0; r < nr_runs; r++) {
+    memcpy(sort, &keys[r * N], N * sizeof(struct sort_key));
+    runner_do_sort_radix(sort, buff, N);
+  }
+  const ticks time_radix_drifted = getticks() - tic;
+  check_sorted(sort, N, "radix sort of drifted keys");
+
+  message(
+      "N=%4d: quicksort %6.1f ns, radix %6.1f ns, quicksort of drifted keys "
+      "%6.1f ns, radix of drifted keys %6.1f ns, repair %6.1f ns (%d/%d "
+      "repaired) per entry.",
+      N, 1e6 * clocks_from_ticks(time_quick) / nr_runs / N,
+      1e6 * clocks_from_ticks(time_radix) / nr_runs / N,
+      1e6 * clocks_from_ticks(time_resort) / nr_runs / N,
+      1e6 * clocks_from_ticks(time_radix_drifted) / nr_runs / N,
+      1e6 * clocks_from_ticks(time_repair) / nr_runs / N, nr_repaired,
+      nr_runs);
+
+  free(keys);
+  free(sort);
+  free(buff);
+}
+
+int main(int argc, char *argv[]) {
+
+  /* Initialize CPU frequency, this also starts time. */
+  unsigned long long cpufreq = 0;
+  clocks_set_cpufreq(cpufreq);
+
+  /* Choke on FPEs */
+#ifdef HAVE_FE_ENABLE_EXCEPT
+  feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+
+  srand(1234);
+
+  /* Small and large leaf cells, away from and around the origin. */
+  test_sort(1, 10.f, 1.f);
+  test_sort(16, 10.f, 1.f);
+  test_sort(24, 10.f, 1.f);
+  test_sort(32, 10.f, 1.f);
+  test_sort(48, 10.f, 1.f);
+  test_sort(64, 10.f, 1.f);
+  test_sort(128, 10.f, 1.f);
+  test_sort(256, 10.f, 1.f);
+  test_sort(1000, 10.f, 1.f);
+  test_sort(1000, -0.5f, 1.f);
+
+  return 0;
+}
@@ -23,6 +23,7 @@
 // Standard includes.
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
 // Local includes.
@@ -70,6 +71,16 @@ void map_function_check_uniform(void *map_data, int num_elements,
   printf("    map_function_check_uniform handled %d elements\n", num_elements);
 }
 
+void map_function_check_steal(void *map_data, int num_elements,
+                              void *extra_data) {
+  int *visits = (int *)map_data;
+  for (int ind = 0; ind < num_elements; ind++) {
+    /* Make the first elements expensive, so that the others need to steal. */
+    if (visits - (int *)extra_data + ind < 100) usleep(1000);
+    atomic_inc(&visits[ind]);
+  }
+}
+
 int main(int argc, char *argv[]) {
 
   // Some constants for this test.
@@ -169,5 +180,49 @@ int main(int argc, char *argv[]) {
 
   printf("# passed uniform checks\n");
 
+  printf("# threadpool_steal_chunk_size checks\n");
+
+  /* Every element must be visited exactly once, stolen or not. */
+  const int num_steal = 10000;
+  int *visits = (int *)calloc(num_steal, sizeof(int));
+  int *copy = (int *)malloc(num_steal * sizeof(int));
+  if (visits == NULL || copy == NULL) {
+    printf("  failed to allocate the steal check data.\n");
+    exit(1);
+  }
+  for (int num_thread = 1; num_thread <= 16; num_thread *= 4) {
+    struct threadpool stp;
+    threadpool_init(&stp, num_thread);
+    for (int run = 0; run < num_runs; run++) {
+      threadpool_map(&stp, map_function_check_steal, visits, num_steal,
+                     sizeof(int), threadpool_steal_chunk_size, visits);
+      for (int i = 0; i < num_steal; i++) {
+        if (visits[i] != run + 1) {
+          printf("  work stealing not correct, element %d visited %d times.\n",
+                 i, visits[i] - run);
+          fflush(stdout);
+          exit(1);
+        }
+      }
+    }
+
+    /* The first-touch copy uses the same ranges. */
+    threadpool_first_touch(&stp, copy, visits, num_steal, sizeof(int));
+    for (int i = 0; i < num_steal; i++) {
+      if (copy[i] != visits[i]) {
+        printf("  first-touch copy not correct at element %d.\n", i);
+        fflush(stdout);
+        exit(1);
+      }
+    }
+    bzero(visits, num_steal * sizeof(int));
+
+    threadpool_clean(&stp);
+  }
+  free(visits);
+  free(copy);
+
+  printf("# passed steal checks\n");
+
   return 0;
 }
@@ -0,0 +1,114 @@
+#!/usr/bin/env python
+
+################################################################################
+# This file is part of SWIFT.
+# Copyright (c) 2026 agent (agent@local)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU Lesser General Public License as published
+# by the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+################################################################################
+
+# Sums the task lock statistics reported by SWIFT runs with
+# Scheduler:lock_stats switched on and the -v 1 flag, and plots them.
+#
+# Usage:
+#   python analyse_lock_stats.py stdout_1.txt [stdout_2.txt ...]
+
+import re
+import sys
+import matplotlib
+
+matplotlib.use("Agg")
+from pylab import *
+
+# Plot parameters
+params = {
+    "axes.labelsize": 10,
+    "axes.titlesize": 10,
+    "font.size": 12,
+    "legend.fontsize": 12,
+    "xtick.labelsize": 10,
+    "ytick.labelsize": 10,
+    "figure.figsize": (12.45, 6.45),
+    "figure.subplot.left": 0.16,
+    "figure.subplot.right": 0.99,
+    "figure.subplot.bottom": 0.08,
+    "figure.subplot.top": 0.99,
+}
+rcParams.update(params)
+
+prefix = r"scheduler_report_lock_stats: \*\*\* +"
+
+lock_fails = {}
+reweights = {}
+steals = {}
+steal_attempts = 0
+spin_time = 0.0
+
+for filename in sys.argv[1:]:
+
+    print("Analysing %s" % filename)
+
+    file = open(filename, "r")
+    for line in file:
+
+        if not re.search(prefix, line):
+            continue
+
+        # Per task type counters.
+        m = re.search(prefix + r"(\w+): +(\d+) +(\d+) +(\d+)$", line)
+        if m:
+            name = m.group(1)
+            lock_fails[name] = lock_fails.get(name, 0) + int(m.group(2))
+            reweights[name] = reweights.get(name, 0) + int(m.group(3))
+            steals[name] = steals.get(name, 0) + int(m.group(4))
+            continue
+
+        # Totals.
+        m = re.search(prefix + r"steal attempts: +(\d+)$", line)
+        if m:
+            steal_attempts += int(m.group(1))
+            continue
+        m = re.search(prefix + r"spin time: +([-+]?\d*\.\d+|\d+) ms", line)
+        if m:
+            spin_time += float(m.group(1))
+
+    file.close()
+
+if len(lock_fails) == 0:
+    print("No lock statistics found, was Scheduler:lock_stats switched on?")
+    exit(1)
+
+# Sort the task types by number of lock failures
+names = sorted(lock_fails.keys(), key=lambda n: -lock_fails[n])
+
+print("\n%20s %14s %14s %14s" % ("task type", "lock fails", "re-weights", "steals"))
+for name in names:
+    print(
+        "%20s %14d %14d %14d"
+        % (name, lock_fails[name], reweights[name], steals[name])
+    )
+print("\nTotal steal attempts: %d" % steal_attempts)
+print("Total spin time: %.3f s" % (spin_time / 1000.0))
+
+# Plot the failures and steals per task type
+pos = arange(len(names))
+figure()
+barh(pos - 0.2, [lock_fails[n] for n in names], height=0.4, label="lock fails")
+barh(pos + 0.2, [steals[n] for n in names], height=0.4, label="steals")
+yticks(pos, names)
+gca().invert_yaxis()
+xscale("log")
+legend(loc="lower right")
+savefig("lock_stats.png")
@@ -225,6 +225,7 @@ def task_is_hydro(name):
         "ghost",
         "ghost_out",
         "extra_ghost",
+        "hydro_fused",
         "cooling",
         "cooling_in",
         "cooling_out",
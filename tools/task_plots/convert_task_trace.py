@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""
+Usage:
+    convert_task_trace.py [options] task_trace.dat [task_trace_rank1.dat ...]
+
+where the input files are the binary task traces written by SWIFT runs with
+the Scheduler:task_trace parameter switched on, one per rank. These do not
+require building with the --enable-task-debugging configure option.
+
+For each step found in the traces, a thread info file is written in the same
+format as the ones created by the '-y interval' flag of the swift command,
+i.e. 'thread_info-step<n>.dat', or 'thread_info_MPI-step<n>.dat' if the traces
+come from an MPI run. These can then be used with plot_tasks.py,
+analyse_tasks.py and the process_plot_tasks scripts.
+
+A summary of the queue, stealing, sleeping and MPI events of each thread is
+printed as well.
+
+This file is part of SWIFT.
+Copyright (c) 2026 agent (agent@local)
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published
+by the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""
+
+import argparse
+import bisect
+import struct
+import sys
+
+# Layout of the file, see src/task_trace.h.
+MAGIC = b"SWIFTTRC"
+HEADER = struct.Struct("<8s4iq")
+BATCH = struct.Struct("<2i")
+EVENT = struct.Struct("<QQiiiiBBBBhh")
+KINDS = ["task", "get", "steal", "sleep", "mpi", "step"]
+
+parser = argparse.ArgumentParser(description="Convert binary task traces")
+parser.add_argument("input", nargs="+", help="Task trace files, one per rank")
+parser.add_argument(
+    "-s",
+    "--steps",
+    dest="steps",
+    help="Comma delimited list of steps to convert (def: all)",
+    default=None,
+    type=str,
+)
+parser.add_argument(
+    "--mpi",
+    dest="mpi",
+    help="Write MPI thread info files even for a single rank (def: False)",
+    default=False,
+    action="store_true",
+)
+args = parser.parse_args()
+if args.steps != None:
+    wanted = set([int(item) for item in args.steps.split(",")])
+else:
+    wanted = None
+
+
+def read_trace(filename):
+    """Read a trace file, returns the header values and the events of each
+    buffer."""
+    with open(filename, "rb") as infile:
+        data = infile.read()
+    magic, version, size, rank, nbuffers, cpufreq = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        sys.exit("%s is not a task trace file" % filename)
+    if size != EVENT.size:
+        sys.exit(
+            "%s has events of %d bytes, expected %d" % (filename, size, EVENT.size)
+        )
+    events = [[] for i in range(nbuffers)]
+    offset = HEADER.size
+    while offset + BATCH.size <= len(data):
+        buffer, count = BATCH.unpack_from(data, offset)
+        offset += BATCH.size
+        for i in range(count):
+            events[buffer].append(EVENT.unpack_from(data, offset))
+            offset += EVENT.size
+    return rank, cpufreq, events
+
+
+mpimode = args.mpi or len(args.input) > 1
+outputs = {}
+for filename in args.input:
+    rank, cpufreq, events = read_trace(filename)
+    print(
+        "# Rank %d: %d threads, CPU frequency %d" % (rank, len(events) - 1, cpufreq)
+    )
+
+    # The steps are recorded by the last buffer.
+    steps = sorted(
+        [ev for ev in events[-1] if KINDS[ev[6]] == "step"], key=lambda ev: ev[0]
+    )
+    step_tics = [ev[0] for ev in steps]
+    lines = [[] for step in steps]
+
+    for rid, buffer in enumerate(events[:-1]):
+        counts = dict([(kind, 0) for kind in KINDS])
+        sleep = 0
+        for ev in buffer:
+            tic, toc, ci, cj, gci, gcj, kind, ttype, subtype, self, extra, pad = ev
+            counts[KINDS[kind]] += 1
+            if KINDS[kind] == "sleep":
+                sleep += toc - tic
+            if KINDS[kind] != "task":
+                continue
+
+            # Find the step this task ran in.
+            ind = bisect.bisect_right(step_tics, tic) - 1
+            if ind < 0 or tic > steps[ind][1]:
+                continue
+            if mpimode:
+                lines[ind].append(
+                    " %03i %i %i %i %i %i %i %i %i %i %i 0 %i\n"
+                    % (
+                        (rank, rid, ttype, subtype, self, tic, toc)
+                        + (ci, cj, gci, gcj, extra)
+                    )
+                )
+            else:
+                lines[ind].append(
+                    " %i %i %i %i %i %i %i %i %i %i %i\n"
+                    % (rid, ttype, subtype, self, tic, toc, ci, cj, gci, gcj, extra)
+                )
+        print(
+            "# Thread %3d: %8d tasks %8d gets %8d steals %8d sleeps (%.3f ms) %8d mpi"
+            % (
+                rid,
+                counts["task"],
+                counts["get"],
+                counts["steal"],
+                counts["sleep"],
+                sleep / cpufreq * 1000.0,
+                counts["mpi"],
+            )
+        )
+
+    # Header line of each step, with the information needed by the plots.
+    for ind, ev in enumerate(steps):
+        tic, toc, step, updates, g_updates, s_updates = ev[:6]
+        if wanted != None and step not in wanted:
+            continue
+        if mpimode:
+            header = " %03d 0 0 0 0 %d %d %d %d %d 0 0 %d\n" % (
+                rank,
+                tic,
+                toc,
+                updates,
+                g_updates,
+                s_updates,
+                cpufreq,
+            )
+        else:
+            header = " %d %d %d %d %d %d %d %d %d %d %d\n" % (
+                -2,
+                -1,
+                -1,
+                1,
+                tic,
+                toc,
+                updates,
+                g_updates,
+                s_updates,
+                0,
+                cpufreq,
+            )
+        outputs.setdefault(step, []).append(header)
+        outputs[step].extend(lines[ind])
+
+for step in sorted(outputs.keys()):
+    if mpimode:
+        filename = "thread_info_MPI-step%d.dat" % step
+    else:
+        filename = "thread_info-step%d.dat" % step
+    with open(filename, "w") as outfile:
+        outfile.writelines(outputs[step])
+    print("# Wrote %s" % filename)
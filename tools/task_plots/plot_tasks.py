@@ -5,7 +5,9 @@ Usage:
 
 where input.dat is a thread info file for a step.  Use the '-y interval' flag
 of the swift or swift_mpi commands to create these (these will need to be
-built with the --enable-task-debugging configure option). The output plot will
+built with the --enable-task-debugging configure option), or convert the
+binary traces written with Scheduler:task_trace using convert_task_trace.py.
+The output plot will
 be called 'png-output-prefix.png' or 'png-output-prefix<mpi-rank>.png',
 depending on whether the input thread info file is generated by the swift or
 swift_mpi command. If swift_mpi each rank has a separate plot.
@@ -22,6 +22,7 @@ TASKTYPES = [
     "ghost",
     "ghost_out",
     "extra_ghost",
+    "hydro_fused",
     "drift_part",
     "drift_spart",
     "drift_sink",